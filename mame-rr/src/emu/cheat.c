@@ -154,6 +154,19 @@ struct _output_argument
 };
 
 
+/* an action that just stores a constant, lowered to a direct memory patch */
+typedef struct _cheat_patch cheat_patch;
+struct _cheat_patch
+{
+	const address_space *space;							/* address space to patch */
+	offs_t				address;						/* byte address to patch */
+	UINT8				size;							/* size of the patch in bytes */
+	UINT8				translate;						/* apply logical to physical translation? */
+	UINT64				keepmask;						/* bits of the old value to keep */
+	UINT64				value;							/* bits to OR in */
+};
+
+
 /* a single entry within a script, either an expression to execute or a string to output */
 typedef struct _script_entry script_entry;
 struct _script_entry
@@ -161,6 +174,7 @@ struct _script_entry
 	script_entry *		next;							/* link to next entry */
 	parsed_expression *	condition;						/* condition under which this is executed */
 	parsed_expression *	expression;						/* expression to execute */
+	cheat_patch *		patch;							/* lowered form of the expression, or NULL */
 	astring				format;							/* string format to print */
 	output_argument *	arglist;						/* list of arguments */
 	INT8				line;							/* which line to print on */
@@ -174,6 +188,8 @@ struct _cheat_script
 {
 	script_entry *		entrylist;						/* list of actions to perform */
 	script_state		state;							/* which state this script is for */
+	cheat_patch *		patchlist;						/* flat list of patches if every entry is one */
+	int					numpatches;						/* number of entries in patchlist */
 };
 
 
@@ -215,6 +231,7 @@ struct _cheat_private
 static void cheat_exit(running_machine &machine);
 static void cheat_frame(running_machine &machine);
 static void cheat_execute_script(cheat_private *cheatinfo, cheat_entry *cheat, script_state state);
+static void cheat_apply_patch(const cheat_patch *patch);
 
 static cheat_entry *cheat_list_load(running_machine *machine, const char *filename);
 static int cheat_list_save(const char *filename, const cheat_entry *cheatlist);
@@ -231,6 +248,7 @@ static void cheat_script_free(running_machine *machine, cheat_script *script);
 static script_entry *script_entry_load(running_machine *machine, const char *filename, xml_data_node *entrynode, cheat_entry *cheat, int isaction);
 static void script_entry_save(mame_file *cheatfile, const script_entry *entry);
 static void script_entry_free(running_machine *machine, script_entry *entry);
+static cheat_patch *script_entry_lower(running_machine *machine, parsed_expression *expression);
 
 static astring &quote_astring_expression(astring &string, int isattribute);
 static int validate_format(const char *filename, int line, const script_entry *entry);
@@ -933,6 +951,17 @@ static void cheat_execute_script(cheat_private *cheatinfo, cheat_entry *cheat, s
 	if (cheatinfo->disabled || cheat->script[state] == NULL)
 		return;
 
+	/* scripts made only of constant stores just patch memory */
+	if (cheat->script[state]->patchlist != NULL)
+	{
+		const cheat_patch *patch = cheat->script[state]->patchlist;
+		int patchnum;
+
+		for (patchnum = 0; patchnum < cheat->script[state]->numpatches; patchnum++)
+			cheat_apply_patch(&patch[patchnum]);
+		return;
+	}
+
 	/* iterate over entries */
 	for (entry = cheat->script[state]->entrylist; entry != NULL; entry = entry->next)
 	{
@@ -952,7 +981,9 @@ static void cheat_execute_script(cheat_private *cheatinfo, cheat_entry *cheat, s
 		}
 
 		/* if there is an action, execute it */
-		if (entry->expression != NULL)
+		if (entry->patch != NULL)
+			cheat_apply_patch(entry->patch);
+		else if (entry->expression != NULL)
 		{
 			error = expression_execute(entry->expression, &result);
 			if (error != EXPRERR_NONE)
@@ -1004,6 +1035,53 @@ static void cheat_execute_script(cheat_private *cheatinfo, cheat_entry *cheat, s
 }
 
 
+/*-------------------------------------------------
+    cheat_apply_patch - apply a lowered constant
+    store directly to RAM, falling back to the
+    debugger accessors for anything else
+-------------------------------------------------*/
+
+static void cheat_apply_patch(const cheat_patch *patch)
+{
+	const address_space *space = patch->space;
+	int buswidth = space->dbits / 8;
+	int little = (space->endianness == ENDIANNESS_LITTLE);
+	int bytexor = little ? NATIVE_ENDIAN_VALUE_LE_BE(0, buswidth - 1) : NATIVE_ENDIAN_VALUE_LE_BE(buswidth - 1, 0);
+	offs_t address = patch->address;
+	UINT8 *dest[8];
+	int bytenum;
+
+	/* translate the way the debugger would; if not mapped, we're done */
+	if (patch->translate && !debug_cpu_translate(space, TRANSLATE_WRITE_DEBUG, &address))
+		return;
+
+	/* find the RAM behind every byte */
+	for (bytenum = 0; bytenum < patch->size; bytenum++)
+	{
+		offs_t byteaddress = address + bytenum;
+		UINT8 *base = (UINT8 *)memory_get_write_ptr(space, byteaddress & ~(buswidth - 1));
+
+		/* not RAM: go through the debugger like the expression would */
+		if (base == NULL)
+		{
+			UINT64 data = patch->value;
+			if (patch->keepmask != 0)
+				data |= debug_read_memory(space, address, patch->size, FALSE) & patch->keepmask;
+			debug_write_memory(space, address, data, patch->size, FALSE);
+			return;
+		}
+		dest[bytenum] = &base[(byteaddress & (buswidth - 1)) ^ bytexor];
+	}
+
+	/* merge in the new value a byte at a time */
+	for (bytenum = 0; bytenum < patch->size; bytenum++)
+	{
+		int shift = little ? 8 * bytenum : 8 * (patch->size - 1 - bytenum);
+		*dest[bytenum] = (*dest[bytenum] & (UINT8)(patch->keepmask >> shift)) | (UINT8)(patch->value >> shift);
+	}
+}
+
+
 
 /***************************************************************************
     CHEAT FILE ACCESS
@@ -1516,6 +1594,30 @@ static cheat_script *cheat_script_load(running_machine *machine, const char *fil
 		*entrytailptr = curentry;
 		entrytailptr = &curentry->next;
 	}
+
+	/* if every entry is an unconditional patch, gather them into a flat list */
+	if (script->entrylist != NULL)
+	{
+		script_entry *entry;
+
+		for (entry = script->entrylist; entry != NULL; entry = entry->next)
+		{
+			if (entry->patch == NULL || entry->condition != NULL || entry->format.len() != 0)
+				break;
+			script->numpatches++;
+		}
+
+		if (entry == NULL)
+		{
+			int patchnum = 0;
+
+			script->patchlist = auto_alloc_array(machine, cheat_patch, script->numpatches);
+			for (entry = script->entrylist; entry != NULL; entry = entry->next)
+				script->patchlist[patchnum++] = *entry->patch;
+		}
+		else
+			script->numpatches = 0;
+	}
 	return script;
 
 error:
@@ -1568,6 +1670,8 @@ static void cheat_script_free(running_machine *machine, cheat_script *script)
 		script_entry_free(machine, entry);
 	}
 
+	if (script->patchlist != NULL)
+		auto_free(machine, script->patchlist);
 	auto_free(machine, script);
 }
 
@@ -1614,6 +1718,9 @@ static script_entry *script_entry_load(running_machine *machine, const char *fil
 			mame_printf_error("%s.xml(%d): error parsing cheat expression \"%s\" (%s)\n", filename, entrynode->line, expression, exprerr_to_string(experr));
 			goto error;
 		}
+
+		/* see if it can be applied as a direct patch */
+		entry->patch = script_entry_lower(machine, entry->expression);
 	}
 
 	/* otherwise, parse the attributes and arguments */
@@ -1769,6 +1876,8 @@ static void script_entry_free(running_machine *machine, script_entry *entry)
 		expression_free(entry->condition);
 	if (entry->expression != NULL)
 		expression_free(entry->expression);
+	if (entry->patch != NULL)
+		auto_free(machine, entry->patch);
 
 	while (entry->arglist != NULL)
 	{
@@ -1785,6 +1894,55 @@ static void script_entry_free(running_machine *machine, script_entry *entry)
 
 
 
+/*-------------------------------------------------
+    script_entry_lower - turn an action that
+    stores a constant into a fixed location of a
+    named CPU's address space into a patch
+-------------------------------------------------*/
+
+static cheat_patch *script_entry_lower(running_machine *machine, parsed_expression *expression)
+{
+	device_memory_interface *memory;
+	expression_constant_store store;
+	const address_space *space;
+	device_t *device;
+	cheat_patch *patch;
+	int spacenum;
+
+	/* only simple stores to an explicitly named device */
+	if (!expression_get_constant_store(expression, &store) || store.name == NULL)
+		return NULL;
+
+	/* only the CPU address spaces; opcode, RAM and region accesses stay general */
+	if (store.space >= EXPSPACE_PROGRAM_LOGICAL && store.space <= EXPSPACE_SPACE3_LOGICAL)
+		spacenum = ADDRESS_SPACE_PROGRAM + (store.space - EXPSPACE_PROGRAM_LOGICAL);
+	else if (store.space >= EXPSPACE_PROGRAM_PHYSICAL && store.space <= EXPSPACE_SPACE3_PHYSICAL)
+		spacenum = ADDRESS_SPACE_PROGRAM + (store.space - EXPSPACE_PROGRAM_PHYSICAL);
+	else
+		return NULL;
+
+	/* find the device the same way the debugger does */
+	for (device = machine->m_devicelist.first(); device != NULL; device = device->next())
+		if (mame_stricmp(device->tag(), store.name) == 0)
+			break;
+	if (device == NULL || !device->interface(memory))
+		return NULL;
+	space = memory->space(spacenum);
+	if (space == NULL)
+		return NULL;
+
+	patch = auto_alloc_clear(machine, cheat_patch);
+	patch->space = space;
+	patch->address = memory_address_to_byte(space, store.address) & space->logbytemask;
+	patch->size = store.size;
+	patch->translate = (store.space <= EXPSPACE_SPACE3_LOGICAL);
+	patch->keepmask = store.keepmask;
+	patch->value = store.value;
+	return patch;
+}
+
+
+
 /***************************************************************************
     MISC HELPERS
 ***************************************************************************/
@@ -0,0 +1,656 @@
+/***************************************************************************
+
+    bintrace.c
+
+    Compact binary instruction traces.
+
+****************************************************************************
+
+    A trace file starts with a small uncompressed header:
+
+        8 bytes     "MAMETRC\0"
+        1 byte      format version (1)
+        1 byte      opcode bytes recorded per instruction
+        1 byte      number of registers recorded per instruction
+        1 byte      reserved
+        string      CPU tag, NUL-terminated
+        strings     one NUL-terminated name per register
+
+    followed by a sequence of chunks, each one being
+
+        4 bytes     raw length (little-endian)
+        4 bytes     stored length; equal to the raw length if the
+                    chunk is stored uncompressed
+        n bytes     zlib-compressed entries
+
+    Entries start with a type byte. Frame entries carry the new frame
+    number as a varint. Instruction entries carry the PC, the cycles
+    elapsed since the previous instruction and the register values as
+    varints. The opcode bytes are only stored if they differ from the
+    ones last stored for the same PC slot of a small direct-mapped
+    cache, which the reader mirrors.
+
+    Chunks are compressed and written on a work queue, so the emulation
+    thread only ever encodes into memory.
+
+***************************************************************************/
+
+#include "emu.h"
+#include "bintrace.h"
+#include <zlib.h>
+
+
+
+/***************************************************************************
+    CONSTANTS
+***************************************************************************/
+
+#define BINTRACE_VERSION		1
+
+#define CHUNK_SIZE				(256 * 1024)	/* raw bytes per chunk */
+#define CHUNK_COUNT				4				/* chunks in flight */
+#define MAX_ENTRY_SIZE			(1 + 5 + 10 + 2 * BINTRACE_MAX_OPBYTES + 10 * BINTRACE_MAX_REGS)
+
+#define CACHE_SIZE				4096			/* opcode cache slots */
+
+/* type byte flags */
+#define ENTRY_TYPE_MASK			0x0f
+#define ENTRY_FLAG_OPBYTES		0x10			/* opcode bytes follow */
+#define ENTRY_FLAG_ARGBYTES		0x20			/* argument bytes follow (they differ) */
+
+static const char bintrace_magic[8] = { 'M', 'A', 'M', 'E', 'T', 'R', 'C', 0 };
+
+
+
+/***************************************************************************
+    TYPE DEFINITIONS
+***************************************************************************/
+
+/* a cached copy of the opcode bytes last stored for a PC */
+typedef struct _opcode_cache_entry opcode_cache_entry;
+struct _opcode_cache_entry
+{
+	offs_t				pc;								/* PC the bytes belong to */
+	UINT8				valid;							/* has this slot been filled? */
+	UINT8				opbytes[BINTRACE_MAX_OPBYTES];	/* opcode bytes */
+	UINT8				argbytes[BINTRACE_MAX_OPBYTES];	/* argument bytes */
+};
+
+
+/* a chunk of entries on its way to disk */
+typedef struct _bintrace_chunk bintrace_chunk;
+struct _bintrace_chunk
+{
+	bintrace_writer *	writer;							/* owning writer */
+	UINT8 *				raw;							/* encoded entries */
+	UINT32				rawlength;						/* bytes used in raw */
+	UINT8 *				compressed;						/* compression buffer */
+	UINT32				compsize;						/* size of the compression buffer */
+	osd_work_item *		item;							/* work item writing it, if any */
+};
+
+
+struct _bintrace_writer
+{
+	running_machine *	machine;						/* owning machine */
+	FILE *				file;							/* output file */
+	osd_work_queue *	queue;							/* single-threaded queue doing the writing */
+	int					opbytes;						/* opcode bytes per instruction */
+	int					numregs;						/* registers per instruction */
+	bintrace_chunk		chunk[CHUNK_COUNT];				/* chunk buffers */
+	int					curchunk;						/* chunk currently being filled */
+	UINT64				lastcycles;						/* cycle count of the previous instruction */
+	opcode_cache_entry *cache;							/* opcode cache */
+};
+
+
+struct _bintrace_reader
+{
+	running_machine *	machine;						/* owning machine */
+	FILE *				file;							/* input file */
+	astring				cputag;							/* tag of the traced CPU */
+	int					opbytes;						/* opcode bytes per instruction */
+	int					numregs;						/* registers per instruction */
+	astring				regname[BINTRACE_MAX_REGS];		/* register names */
+	UINT8 *				raw;							/* decoded chunk */
+	UINT8 *				compressed;						/* chunk as read from disk */
+	UINT32				rawlength;						/* bytes in raw */
+	UINT32				rawpos;							/* current position in raw */
+	UINT32				frame;							/* current frame */
+	UINT64				cycles;							/* cycle count of the last instruction */
+	opcode_cache_entry *cache;							/* mirror of the writer's opcode cache */
+};
+
+
+
+/***************************************************************************
+    INLINE FUNCTIONS
+***************************************************************************/
+
+/*-------------------------------------------------
+    cache_slot - return the opcode cache slot for
+    a PC
+-------------------------------------------------*/
+
+INLINE int cache_slot(offs_t pc)
+{
+	return (pc ^ (pc >> 12)) & (CACHE_SIZE - 1);
+}
+
+
+/*-------------------------------------------------
+    put_varint - append an unsigned LEB128 value
+-------------------------------------------------*/
+
+INLINE UINT8 *put_varint(UINT8 *dest, UINT64 value)
+{
+	while (value >= 0x80)
+	{
+		*dest++ = (UINT8)value | 0x80;
+		value >>= 7;
+	}
+	*dest++ = (UINT8)value;
+	return dest;
+}
+
+
+/*-------------------------------------------------
+    get_varint - fetch an unsigned LEB128 value;
+    returns FALSE if it runs off the end
+-------------------------------------------------*/
+
+INLINE int get_varint(bintrace_reader *reader, UINT64 *value)
+{
+	int shift = 0;
+
+	*value = 0;
+	while (reader->rawpos < reader->rawlength)
+	{
+		UINT8 data = reader->raw[reader->rawpos++];
+		*value |= (UINT64)(data & 0x7f) << shift;
+		if ((data & 0x80) == 0)
+			return TRUE;
+		shift += 7;
+	}
+	return FALSE;
+}
+
+
+/*-------------------------------------------------
+    put_le32/get_le32 - 32-bit little-endian
+    serialization for the chunk headers
+-------------------------------------------------*/
+
+INLINE void put_le32(UINT8 *dest, UINT32 value)
+{
+	dest[0] = value >> 0;
+	dest[1] = value >> 8;
+	dest[2] = value >> 16;
+	dest[3] = value >> 24;
+}
+
+INLINE UINT32 get_le32(const UINT8 *src)
+{
+	return src[0] | (src[1] << 8) | (src[2] << 16) | (src[3] << 24);
+}
+
+
+
+/***************************************************************************
+    WRITING
+***************************************************************************/
+
+/*-------------------------------------------------
+    write_chunk - compress a chunk and write it
+    out; runs on the work queue
+-------------------------------------------------*/
+
+static void *write_chunk(void *param, int threadid)
+{
+	bintrace_chunk *chunk = (bintrace_chunk *)param;
+	uLongf complength = chunk->compsize;
+	const UINT8 *data = chunk->compressed;
+	UINT8 header[8];
+
+	/* fall back to storing the chunk if it doesn't compress */
+	if (compress2(chunk->compressed, &complength, chunk->raw, chunk->rawlength, Z_BEST_SPEED) != Z_OK || complength >= chunk->rawlength)
+	{
+		complength = chunk->rawlength;
+		data = chunk->raw;
+	}
+
+	put_le32(&header[0], chunk->rawlength);
+	put_le32(&header[4], complength);
+	fwrite(header, 1, sizeof(header), chunk->writer->file);
+	fwrite(data, 1, complength, chunk->writer->file);
+	return NULL;
+}
+
+
+/*-------------------------------------------------
+    wait_chunk - wait for a chunk to be written
+    so that it can be reused
+-------------------------------------------------*/
+
+static void wait_chunk(bintrace_chunk *chunk)
+{
+	if (chunk->item != NULL)
+	{
+		/* the buffers are still in use until the write lands, so never give up on it */
+		while (!osd_work_item_wait(chunk->item, 100 * osd_ticks_per_second()))
+			mame_printf_warning("Trace file write is taking a long time; still waiting\n");
+		osd_work_item_release(chunk->item);
+		chunk->item = NULL;
+	}
+	chunk->rawlength = 0;
+}
+
+
+/*-------------------------------------------------
+    flush_chunk - hand the current chunk to the
+    work queue and move to the next one
+-------------------------------------------------*/
+
+static void flush_chunk(bintrace_writer *writer)
+{
+	bintrace_chunk *chunk = &writer->chunk[writer->curchunk];
+
+	if (chunk->rawlength == 0)
+		return;
+
+	/* without a queue, just do the work here */
+	if (writer->queue != NULL)
+		chunk->item = osd_work_item_queue(writer->queue, write_chunk, chunk, 0);
+	if (chunk->item == NULL)
+		write_chunk(chunk, 0);
+
+	/* the next chunk may still be in flight from a previous round */
+	writer->curchunk = (writer->curchunk + 1) % CHUNK_COUNT;
+	wait_chunk(&writer->chunk[writer->curchunk]);
+}
+
+
+/*-------------------------------------------------
+    entry_space - return a pointer where the next
+    entry can be encoded
+-------------------------------------------------*/
+
+static UINT8 *entry_space(bintrace_writer *writer)
+{
+	bintrace_chunk *chunk = &writer->chunk[writer->curchunk];
+
+	if (chunk->rawlength + MAX_ENTRY_SIZE > CHUNK_SIZE)
+	{
+		flush_chunk(writer);
+		chunk = &writer->chunk[writer->curchunk];
+	}
+	return &chunk->raw[chunk->rawlength];
+}
+
+
+/*-------------------------------------------------
+    entry_done - note the end of an entry
+    encoded at entry_space()
+-------------------------------------------------*/
+
+static void entry_done(bintrace_writer *writer, UINT8 *end)
+{
+	bintrace_chunk *chunk = &writer->chunk[writer->curchunk];
+	chunk->rawlength = end - chunk->raw;
+}
+
+
+/*-------------------------------------------------
+    bintrace_writer_open - create a trace file
+-------------------------------------------------*/
+
+bintrace_writer *bintrace_writer_open(running_machine *machine, const char *filename, const char *cputag, int opbytes, int numregs, const char *const *regnames)
+{
+	bintrace_writer *writer;
+	UINT8 header[12];
+	int chunknum, regnum;
+	FILE *file;
+
+	file = fopen(filename, "wb");
+	if (file == NULL)
+		return NULL;
+
+	writer = auto_alloc_clear(machine, bintrace_writer);
+	writer->machine = machine;
+	writer->file = file;
+	writer->opbytes = MIN(opbytes, BINTRACE_MAX_OPBYTES);
+	writer->numregs = MIN(numregs, BINTRACE_MAX_REGS);
+	writer->cache = auto_alloc_array_clear(machine, opcode_cache_entry, CACHE_SIZE);
+
+	/* compression happens off the emulation thread */
+	writer->queue = osd_work_queue_alloc(WORK_QUEUE_FLAG_IO);
+	for (chunknum = 0; chunknum < CHUNK_COUNT; chunknum++)
+	{
+		bintrace_chunk *chunk = &writer->chunk[chunknum];
+		chunk->writer = writer;
+		chunk->raw = auto_alloc_array(machine, UINT8, CHUNK_SIZE);
+		chunk->compsize = compressBound(CHUNK_SIZE);
+		chunk->compressed = auto_alloc_array(machine, UINT8, chunk->compsize);
+	}
+
+	/* write the header */
+	memcpy(&header[0], bintrace_magic, sizeof(bintrace_magic));
+	header[8] = BINTRACE_VERSION;
+	header[9] = writer->opbytes;
+	header[10] = writer->numregs;
+	header[11] = 0;
+	fwrite(header, 1, sizeof(header), file);
+	fwrite(cputag, 1, strlen(cputag) + 1, file);
+	for (regnum = 0; regnum < writer->numregs; regnum++)
+		fwrite(regnames[regnum], 1, strlen(regnames[regnum]) + 1, file);
+	return writer;
+}
+
+
+/*-------------------------------------------------
+    bintrace_writer_close - flush everything and
+    close the file
+-------------------------------------------------*/
+
+void bintrace_writer_close(bintrace_writer *writer)
+{
+	running_machine *machine = writer->machine;
+	int chunknum;
+
+	/* write the last chunk and wait for everything to land */
+	flush_chunk(writer);
+	if (writer->queue != NULL)
+	{
+		osd_work_queue_wait(writer->queue, 100 * osd_ticks_per_second());
+		for (chunknum = 0; chunknum < CHUNK_COUNT; chunknum++)
+			wait_chunk(&writer->chunk[chunknum]);
+		osd_work_queue_free(writer->queue);
+	}
+	fclose(writer->file);
+
+	for (chunknum = 0; chunknum < CHUNK_COUNT; chunknum++)
+	{
+		auto_free(machine, writer->chunk[chunknum].raw);
+		auto_free(machine, writer->chunk[chunknum].compressed);
+	}
+	auto_free(machine, writer->cache);
+	auto_free(machine, writer);
+}
+
+
+/*-------------------------------------------------
+    bintrace_writer_frame - note the start of a
+    new frame
+-------------------------------------------------*/
+
+void bintrace_writer_frame(bintrace_writer *writer, UINT32 frame)
+{
+	UINT8 *dest = entry_space(writer);
+
+	*dest++ = BINTRACE_ENTRY_FRAME;
+	dest = put_varint(dest, frame);
+	entry_done(writer, dest);
+}
+
+
+/*-------------------------------------------------
+    bintrace_writer_instruction - record one
+    instruction
+-------------------------------------------------*/
+
+void bintrace_writer_instruction(bintrace_writer *writer, offs_t pc, UINT64 cycles, const UINT8 *opbytes, const UINT8 *argbytes, const UINT64 *regs)
+{
+	opcode_cache_entry *cache = &writer->cache[cache_slot(pc)];
+	UINT8 *dest = entry_space(writer);
+	UINT8 *type = dest++;
+	int regnum;
+
+	*type = BINTRACE_ENTRY_INSTRUCTION;
+	dest = put_varint(dest, pc);
+	dest = put_varint(dest, cycles - writer->lastcycles);
+	writer->lastcycles = cycles;
+
+	/* only store the opcode bytes if the cache doesn't already know them */
+	if (!cache->valid || cache->pc != pc || memcmp(cache->opbytes, opbytes, writer->opbytes) != 0 || memcmp(cache->argbytes, argbytes, writer->opbytes) != 0)
+	{
+		cache->valid = TRUE;
+		cache->pc = pc;
+		memcpy(cache->opbytes, opbytes, writer->opbytes);
+		memcpy(cache->argbytes, argbytes, writer->opbytes);
+
+		*type |= ENTRY_FLAG_OPBYTES;
+		memcpy(dest, opbytes, writer->opbytes);
+		dest += writer->opbytes;
+		if (memcmp(opbytes, argbytes, writer->opbytes) != 0)
+		{
+			*type |= ENTRY_FLAG_ARGBYTES;
+			memcpy(dest, argbytes, writer->opbytes);
+			dest += writer->opbytes;
+		}
+	}
+
+	for (regnum = 0; regnum < writer->numregs; regnum++)
+		dest = put_varint(dest, regs[regnum]);
+	entry_done(writer, dest);
+}
+
+
+
+/***************************************************************************
+    READING
+***************************************************************************/
+
+/*-------------------------------------------------
+    read_string - read a NUL-terminated string
+    from the header
+-------------------------------------------------*/
+
+static int read_string(FILE *file, astring &string)
+{
+	int ch;
+
+	string.reset();
+	while ((ch = fgetc(file)) != 0)
+	{
+		char c = ch;
+		if (ch == EOF)
+			return FALSE;
+		string.cat(&c, 1);
+	}
+	return TRUE;
+}
+
+
+/*-------------------------------------------------
+    read_chunk - read and decompress the next
+    chunk; returns FALSE at the end of the file
+-------------------------------------------------*/
+
+static int read_chunk(bintrace_reader *reader)
+{
+	UINT32 rawlength, complength;
+	uLongf destlength;
+	UINT8 header[8];
+
+	reader->rawlength = reader->rawpos = 0;
+	if (fread(header, 1, sizeof(header), reader->file) != sizeof(header))
+		return FALSE;
+	rawlength = get_le32(&header[0]);
+	complength = get_le32(&header[4]);
+	if (rawlength > CHUNK_SIZE || complength > compressBound(CHUNK_SIZE) || complength > rawlength)
+		return FALSE;
+
+	/* stored chunks go straight into the raw buffer */
+	if (complength == rawlength)
+	{
+		if (fread(reader->raw, 1, rawlength, reader->file) != rawlength)
+			return FALSE;
+	}
+	else
+	{
+		if (fread(reader->compressed, 1, complength, reader->file) != complength)
+			return FALSE;
+		destlength = rawlength;
+		if (uncompress(reader->raw, &destlength, reader->compressed, complength) != Z_OK || destlength != rawlength)
+			return FALSE;
+	}
+	reader->rawlength = rawlength;
+	return TRUE;
+}
+
+
+/*-------------------------------------------------
+    bintrace_reader_open - open a trace file
+-------------------------------------------------*/
+
+bintrace_reader *bintrace_reader_open(running_machine *machine, const char *filename)
+{
+	bintrace_reader *reader;
+	UINT8 header[12];
+	int regnum;
+	FILE *file;
+
+	file = fopen(filename, "rb");
+	if (file == NULL)
+		return NULL;
+
+	/* validate the header */
+	if (fread(header, 1, sizeof(header), file) != sizeof(header) || memcmp(header, bintrace_magic, sizeof(bintrace_magic)) != 0 ||
+		header[8] != BINTRACE_VERSION || header[9] > BINTRACE_MAX_OPBYTES || header[10] > BINTRACE_MAX_REGS)
+	{
+		fclose(file);
+		return NULL;
+	}
+
+	reader = auto_alloc(machine, bintrace_reader);
+	reader->machine = machine;
+	reader->file = file;
+	reader->opbytes = header[9];
+	reader->numregs = header[10];
+	reader->raw = auto_alloc_array(machine, UINT8, CHUNK_SIZE);
+	reader->compressed = auto_alloc_array(machine, UINT8, compressBound(CHUNK_SIZE));
+	reader->rawlength = reader->rawpos = 0;
+	reader->frame = 0;
+	reader->cycles = 0;
+	reader->cache = auto_alloc_array_clear(machine, opcode_cache_entry, CACHE_SIZE);
+
+	/* read the tag and register names */
+	int valid = read_string(file, reader->cputag);
+	for (regnum = 0; regnum < reader->numregs && valid; regnum++)
+		valid = read_string(file, reader->regname[regnum]);
+	if (!valid)
+	{
+		bintrace_reader_close(reader);
+		return NULL;
+	}
+	return reader;
+}
+
+
+/*-------------------------------------------------
+    bintrace_reader_close - close a trace file
+-------------------------------------------------*/
+
+void bintrace_reader_close(bintrace_reader *reader)
+{
+	running_machine *machine = reader->machine;
+
+	fclose(reader->file);
+	auto_free(machine, reader->raw);
+	auto_free(machine, reader->compressed);
+	auto_free(machine, reader->cache);
+	auto_free(machine, reader);
+}
+
+
+/*-------------------------------------------------
+    bintrace_reader_next - decode the next entry
+-------------------------------------------------*/
+
+int bintrace_reader_next(bintrace_reader *reader, bintrace_entry *entry)
+{
+	opcode_cache_entry *cache;
+	UINT64 value;
+	UINT8 type;
+	int regnum;
+
+	/* move to the next chunk when this one runs out */
+	while (reader->rawpos >= reader->rawlength)
+		if (!read_chunk(reader))
+			return FALSE;
+
+	type = reader->raw[reader->rawpos++];
+	switch (type & ENTRY_TYPE_MASK)
+	{
+		case BINTRACE_ENTRY_FRAME:
+			if (!get_varint(reader, &value))
+				return FALSE;
+			reader->frame = (UINT32)value;
+			entry->type = BINTRACE_ENTRY_FRAME;
+			entry->frame = reader->frame;
+			entry->cycles = reader->cycles;
+			return TRUE;
+
+		case BINTRACE_ENTRY_INSTRUCTION:
+			entry->type = BINTRACE_ENTRY_INSTRUCTION;
+			entry->frame = reader->frame;
+			if (!get_varint(reader, &value))
+				return FALSE;
+			entry->pc = (offs_t)value;
+			if (!get_varint(reader, &value))
+				return FALSE;
+			reader->cycles += value;
+			entry->cycles = reader->cycles;
+
+			/* opcode bytes come either from the entry or from the cache */
+			cache = &reader->cache[cache_slot(entry->pc)];
+			if (type & ENTRY_FLAG_OPBYTES)
+			{
+				int count = (type & ENTRY_FLAG_ARGBYTES) ? 2 * reader->opbytes : reader->opbytes;
+				if (reader->rawpos + count > reader->rawlength)
+					return FALSE;
+				cache->valid = TRUE;
+				cache->pc = entry->pc;
+				memcpy(cache->opbytes, &reader->raw[reader->rawpos], reader->opbytes);
+				memcpy(cache->argbytes, &reader->raw[reader->rawpos + count - reader->opbytes], reader->opbytes);
+				reader->rawpos += count;
+			}
+			else if (!cache->valid || cache->pc != entry->pc)
+				return FALSE;
+			memcpy(entry->opbytes, cache->opbytes, reader->opbytes);
+			memcpy(entry->argbytes, cache->argbytes, reader->opbytes);
+
+			for (regnum = 0; regnum < reader->numregs; regnum++)
+				if (!get_varint(reader, &entry->regs[regnum]))
+					return FALSE;
+			return TRUE;
+	}
+
+	/* anything else means the file is damaged */
+	return FALSE;
+}
+
+
+/*-------------------------------------------------
+    bintrace_reader_* - header information
+-------------------------------------------------*/
+
+const char *bintrace_reader_cputag(bintrace_reader *reader)
+{
+	return reader->cputag;
+}
+
+int bintrace_reader_opbytes(bintrace_reader *reader)
+{
+	return reader->opbytes;
+}
+
+int bintrace_reader_numregs(bintrace_reader *reader)
+{
+	return reader->numregs;
+}
+
+const char *bintrace_reader_regname(bintrace_reader *reader, int index)
+{
+	return (index >= 0 && index < reader->numregs) ? reader->regname[index].cstr() : NULL;
+}
@@ -0,0 +1,91 @@
+/***************************************************************************
+
+    bintrace.h
+
+    Compact binary instruction traces.
+
+***************************************************************************/
+
+#pragma once
+
+#ifndef __BINTRACE_H__
+#define __BINTRACE_H__
+
+
+/***************************************************************************
+    CONSTANTS
+***************************************************************************/
+
+#define BINTRACE_MAX_OPBYTES	32		/* opcode bytes recorded per instruction */
+#define BINTRACE_MAX_REGS		16		/* registers recorded per instruction */
+
+/* entry types */
+enum
+{
+	BINTRACE_ENTRY_FRAME = 0,			/* a new video frame started */
+	BINTRACE_ENTRY_INSTRUCTION			/* an instruction is about to execute */
+};
+
+
+
+/***************************************************************************
+    TYPE DEFINITIONS
+***************************************************************************/
+
+typedef struct _bintrace_writer bintrace_writer;
+typedef struct _bintrace_reader bintrace_reader;
+
+
+/* a decoded trace entry */
+typedef struct _bintrace_entry bintrace_entry;
+struct _bintrace_entry
+{
+	int					type;							/* BINTRACE_ENTRY_* */
+	UINT32				frame;							/* current frame number */
+	offs_t				pc;								/* PC of the instruction */
+	UINT64				cycles;							/* total cycles when it started */
+	UINT8				opbytes[BINTRACE_MAX_OPBYTES];	/* opcode bytes */
+	UINT8				argbytes[BINTRACE_MAX_OPBYTES];	/* argument bytes */
+	UINT64				regs[BINTRACE_MAX_REGS];		/* selected register values */
+};
+
+
+
+/***************************************************************************
+    FUNCTION PROTOTYPES
+***************************************************************************/
+
+/* ----- writing ----- */
+
+/* create a trace file; returns NULL if it can't be opened */
+bintrace_writer *bintrace_writer_open(running_machine *machine, const char *filename, const char *cputag, int opbytes, int numregs, const char *const *regnames);
+
+/* finish writing and close the file */
+void bintrace_writer_close(bintrace_writer *writer);
+
+/* note the start of a new frame */
+void bintrace_writer_frame(bintrace_writer *writer, UINT32 frame);
+
+/* record one instruction */
+void bintrace_writer_instruction(bintrace_writer *writer, offs_t pc, UINT64 cycles, const UINT8 *opbytes, const UINT8 *argbytes, const UINT64 *regs);
+
+
+/* ----- reading ----- */
+
+/* open a trace file; returns NULL if it is missing or not a trace */
+bintrace_reader *bintrace_reader_open(running_machine *machine, const char *filename);
+
+/* close a trace file */
+void bintrace_reader_close(bintrace_reader *reader);
+
+/* fetch the next entry; returns FALSE at the end of the trace */
+int bintrace_reader_next(bintrace_reader *reader, bintrace_entry *entry);
+
+/* information from the header */
+const char *bintrace_reader_cputag(bintrace_reader *reader);
+int bintrace_reader_opbytes(bintrace_reader *reader);
+int bintrace_reader_numregs(bintrace_reader *reader);
+const char *bintrace_reader_regname(bintrace_reader *reader, int index);
+
+
+#endif	/* __BINTRACE_H__ */
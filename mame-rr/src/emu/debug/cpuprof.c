@@ -0,0 +1,456 @@
+/***************************************************************************
+
+    cpuprof.c
+
+    Per-CPU sampling profiler and code coverage.
+
+****************************************************************************
+
+    The profiler is fed every instruction from the debugger's instruction
+    hook and takes a sample every N instructions. Samples are kept in a
+    calling context tree: each node is an (address, parent) pair, so a
+    flat profile is simply every sample hanging off the root.
+
+    With call stacks enabled the profiler follows calls with the
+    disassembler's DASMFLAG_STEP_OVER flag, and keeps a shadow stack of
+    the address each call would fall through to. A call that does not
+    fall through pushes the address it lands on along with that return
+    address; a frame is popped when execution reaches its return address,
+    and a DASMFLAG_STEP_OUT return unwinds to whichever recorded frame it
+    lands in. STEP_OVER is also set on loop instructions such as 68000
+    DBcc and Z80 DJNZ/LDIR, so a step-over instruction taken again from
+    the frame it opened is not pushed twice; the loop simply ends when it
+    falls through. Returns to addresses that were never recorded, such as
+    from interrupt handlers, leave the stack alone.
+
+    The flags are looked up through a small direct-mapped cache keyed by
+    PC and the leading opcode bytes, so banked or rewritten code is
+    disassembled afresh.
+
+    Profiles are written in the folded stack format understood by
+    flamegraph.pl and most profile viewers:
+
+        <entry>;<entry>;<pc> <samples>
+
+    Coverage is a bitmap with one bit per address, in 64k-address pages
+    that are allocated on first use. It is written as one hex address per
+    line in ascending order, so two runs can be compared with diff.
+
+***************************************************************************/
+
+#include "emu.h"
+#include "cpuprof.h"
+
+
+
+/***************************************************************************
+    CONSTANTS
+***************************************************************************/
+
+#define FLAGS_CACHE_SIZE		4096			/* disassembler flag cache slots */
+#define MAX_STACK_DEPTH			256				/* deepest call stack we record */
+
+#define COVERAGE_PAGE_SHIFT		16				/* log2 of addresses per coverage page */
+#define COVERAGE_PAGE_WORDS		((1 << COVERAGE_PAGE_SHIFT) / 32)
+#define COVERAGE_PAGES			(1 << (32 - COVERAGE_PAGE_SHIFT))
+
+/* what the previous instruction might do to the call stack */
+enum
+{
+	PENDING_NONE = 0,
+	PENDING_CALL,
+	PENDING_RETURN
+};
+
+
+
+/***************************************************************************
+    TYPE DEFINITIONS
+***************************************************************************/
+
+/* a node in the calling context tree */
+typedef struct _profile_node profile_node;
+struct _profile_node
+{
+	offs_t				addr;							/* function entry, or sampled PC for leaves */
+	UINT32				parent;							/* index of the parent node */
+	UINT64				samples;						/* samples taken here */
+};
+
+
+/* a cached disassembler result */
+typedef struct _flags_cache_entry flags_cache_entry;
+struct _flags_cache_entry
+{
+	offs_t				pc;								/* PC the flags belong to */
+	UINT32				opcode;							/* leading opcode bytes at that PC */
+	UINT32				dasmresult;						/* length and flags */
+	UINT8				valid;							/* has this slot been filled? */
+};
+
+
+struct _cpu_profiler
+{
+	running_machine *	machine;						/* owning machine */
+	UINT32				interval;						/* instructions per sample */
+	UINT32				countdown;						/* instructions until the next sample */
+
+	/* calling context tree */
+	profile_node *		node;							/* nodes; node 0 is the root */
+	UINT32				numnodes;						/* nodes in use */
+	UINT32				allocnodes;						/* nodes allocated */
+	UINT32 *			hash;							/* open-addressed node lookup; 0 is empty */
+	UINT32				hashsize;						/* slots in hash (a power of two) */
+
+	/* call stack tracking */
+	int					callstacks;						/* following calls and returns? */
+	cpu_profiler_dasm_func dasm;						/* disassembler callback */
+	cpu_profiler_opcode_func opcode;					/* opcode fetch callback */
+	void *				param;							/* parameter for the callbacks */
+	flags_cache_entry *	cache;							/* disassembler flag cache */
+	UINT32				context;						/* node of the current function */
+	int					depth;							/* depth of the current function */
+	offs_t				retaddr[MAX_STACK_DEPTH];		/* return address of each frame */
+	int					pending;						/* PENDING_* for the previous instruction */
+	offs_t				fallthrough;					/* address after the previous instruction */
+};
+
+
+struct _cpu_coverage
+{
+	running_machine *	machine;						/* owning machine */
+	UINT32 *			page[COVERAGE_PAGES];			/* bitmap pages, or NULL if untouched */
+};
+
+
+
+/***************************************************************************
+    INLINE FUNCTIONS
+***************************************************************************/
+
+/*-------------------------------------------------
+    node_hash - hash a parent/address pair
+-------------------------------------------------*/
+
+INLINE UINT32 node_hash(UINT32 parent, offs_t addr)
+{
+	return (addr ^ (addr >> 13) ^ (parent * 2654435761U));
+}
+
+
+/*-------------------------------------------------
+    flags_slot - return the flag cache slot for a
+    PC
+-------------------------------------------------*/
+
+INLINE int flags_slot(offs_t pc)
+{
+	return (pc ^ (pc >> 12)) & (FLAGS_CACHE_SIZE - 1);
+}
+
+
+
+/***************************************************************************
+    CALLING CONTEXT TREE
+***************************************************************************/
+
+/*-------------------------------------------------
+    profiler_rehash - rebuild the node lookup at
+    a new size
+-------------------------------------------------*/
+
+static void profiler_rehash(cpu_profiler *prof, UINT32 hashsize)
+{
+	UINT32 index;
+
+	auto_free(prof->machine, prof->hash);
+	prof->hash = auto_alloc_array_clear(prof->machine, UINT32, hashsize);
+	prof->hashsize = hashsize;
+
+	for (index = 1; index < prof->numnodes; index++)
+	{
+		UINT32 slot = node_hash(prof->node[index].parent, prof->node[index].addr) & (hashsize - 1);
+		while (prof->hash[slot] != 0)
+			slot = (slot + 1) & (hashsize - 1);
+		prof->hash[slot] = index;
+	}
+}
+
+
+/*-------------------------------------------------
+    profiler_node - find or create the node for
+    an address under a given parent
+-------------------------------------------------*/
+
+static UINT32 profiler_node(cpu_profiler *prof, UINT32 parent, offs_t addr)
+{
+	UINT32 slot = node_hash(parent, addr) & (prof->hashsize - 1);
+	UINT32 index;
+
+	/* look for an existing node */
+	for (index = prof->hash[slot]; index != 0; index = prof->hash[slot])
+	{
+		if (prof->node[index].parent == parent && prof->node[index].addr == addr)
+			return index;
+		slot = (slot + 1) & (prof->hashsize - 1);
+	}
+
+	/* grow the node array if full */
+	if (prof->numnodes == prof->allocnodes)
+	{
+		profile_node *oldnode = prof->node;
+		prof->allocnodes *= 2;
+		prof->node = auto_alloc_array(prof->machine, profile_node, prof->allocnodes);
+		memcpy(prof->node, oldnode, sizeof(*oldnode) * prof->numnodes);
+		auto_free(prof->machine, oldnode);
+	}
+
+	/* add the new node */
+	index = prof->numnodes++;
+	prof->node[index].addr = addr;
+	prof->node[index].parent = parent;
+	prof->node[index].samples = 0;
+	prof->hash[slot] = index;
+
+	/* keep the lookup at most half full */
+	if (prof->numnodes * 2 > prof->hashsize)
+		profiler_rehash(prof, prof->hashsize * 2);
+	return index;
+}
+
+
+
+/***************************************************************************
+    SAMPLING PROFILER
+***************************************************************************/
+
+/*-------------------------------------------------
+    cpu_profiler_alloc - create a profiler
+-------------------------------------------------*/
+
+cpu_profiler *cpu_profiler_alloc(running_machine *machine, UINT32 interval, int callstacks, cpu_profiler_dasm_func dasm, cpu_profiler_opcode_func opcode, void *param)
+{
+	cpu_profiler *prof = auto_alloc_clear(machine, cpu_profiler);
+
+	prof->machine = machine;
+	prof->interval = MAX(interval, 1);
+	prof->countdown = prof->interval;
+	prof->callstacks = (callstacks && dasm != NULL && opcode != NULL);
+	prof->dasm = dasm;
+	prof->opcode = opcode;
+	prof->param = param;
+
+	/* start with just the root */
+	prof->allocnodes = 1024;
+	prof->node = auto_alloc_array_clear(machine, profile_node, prof->allocnodes);
+	prof->numnodes = 1;
+	prof->hashsize = 2048;
+	prof->hash = auto_alloc_array_clear(machine, UINT32, prof->hashsize);
+
+	if (prof->callstacks)
+		prof->cache = auto_alloc_array_clear(machine, flags_cache_entry, FLAGS_CACHE_SIZE);
+	return prof;
+}
+
+
+/*-------------------------------------------------
+    cpu_profiler_free - free a profiler
+-------------------------------------------------*/
+
+void cpu_profiler_free(cpu_profiler *prof)
+{
+	auto_free(prof->machine, prof->node);
+	auto_free(prof->machine, prof->hash);
+	if (prof->cache != NULL)
+		auto_free(prof->machine, prof->cache);
+	auto_free(prof->machine, prof);
+}
+
+
+/*-------------------------------------------------
+    profiler_track_stack - update the call stack
+    for the instruction about to execute
+-------------------------------------------------*/
+
+static void profiler_track_stack(cpu_profiler *prof, offs_t pc)
+{
+	flags_cache_entry *entry;
+	UINT32 opcode;
+
+	/* reaching the innermost return address ends that frame, however we got there */
+	if (prof->depth > 0 && pc == prof->retaddr[prof->depth - 1])
+	{
+		prof->context = prof->node[prof->context].parent;
+		prof->depth--;
+	}
+
+	/* settle what the previous instruction did, unless it fell through */
+	else if (prof->pending == PENDING_CALL && pc != prof->fallthrough)
+	{
+		/* a loop instruction branching again from the frame it opened is not a new call */
+		int reentered = (prof->depth > 0 && prof->retaddr[prof->depth - 1] == prof->fallthrough);
+		if (!reentered && prof->depth < MAX_STACK_DEPTH)
+		{
+			prof->context = profiler_node(prof, prof->context, pc);
+			prof->retaddr[prof->depth++] = prof->fallthrough;
+		}
+	}
+	else if (prof->pending == PENDING_RETURN && pc != prof->fallthrough)
+	{
+		int frame;
+
+		/* unwind to the frame whose return address we landed on, if any */
+		for (frame = prof->depth - 1; frame >= 0; frame--)
+			if (prof->retaddr[frame] == pc)
+				break;
+		while (frame >= 0 && prof->depth > frame)
+		{
+			prof->context = prof->node[prof->context].parent;
+			prof->depth--;
+		}
+	}
+
+	/* look up this instruction's flags */
+	opcode = (*prof->opcode)(prof->param, pc);
+	entry = &prof->cache[flags_slot(pc)];
+	if (!entry->valid || entry->pc != pc || entry->opcode != opcode)
+	{
+		entry->pc = pc;
+		entry->opcode = opcode;
+		entry->dasmresult = (*prof->dasm)(prof->param, pc);
+		entry->valid = TRUE;
+	}
+
+	prof->pending = PENDING_NONE;
+	if ((entry->dasmresult & DASMFLAG_SUPPORTED) != 0)
+	{
+		if ((entry->dasmresult & DASMFLAG_STEP_OVER) != 0)
+			prof->pending = PENDING_CALL;
+		else if ((entry->dasmresult & DASMFLAG_STEP_OUT) != 0)
+			prof->pending = PENDING_RETURN;
+	}
+	prof->fallthrough = pc + (entry->dasmresult & DASMFLAG_LENGTHMASK);
+}
+
+
+/*-------------------------------------------------
+    cpu_profiler_instruction - note that an
+    instruction is about to execute
+-------------------------------------------------*/
+
+void cpu_profiler_instruction(cpu_profiler *prof, offs_t pc)
+{
+	if (prof->callstacks)
+		profiler_track_stack(prof, pc);
+
+	/* take a sample every interval instructions */
+	if (--prof->countdown == 0)
+	{
+		prof->countdown = prof->interval;
+		prof->node[profiler_node(prof, prof->context, pc)].samples++;
+	}
+}
+
+
+/*-------------------------------------------------
+    cpu_profiler_write - write the samples in
+    folded stack format
+-------------------------------------------------*/
+
+UINT64 cpu_profiler_write(cpu_profiler *prof, FILE *file, int addrchars)
+{
+	offs_t path[MAX_STACK_DEPTH + 1];
+	UINT64 total = 0;
+	UINT32 index;
+
+	for (index = 1; index < prof->numnodes; index++)
+		if (prof->node[index].samples != 0)
+		{
+			int depth = 0;
+			UINT32 scan;
+
+			/* walk up to the root, then print outermost first */
+			for (scan = index; scan != 0 && depth < (int)ARRAY_LENGTH(path); scan = prof->node[scan].parent)
+				path[depth++] = prof->node[scan].addr;
+			while (depth-- > 0)
+				fprintf(file, (depth > 0) ? "%0*X;" : "%0*X", addrchars, path[depth]);
+			fprintf(file, " %" I64FMT "u\n", prof->node[index].samples);
+			total += prof->node[index].samples;
+		}
+	return total;
+}
+
+
+
+/***************************************************************************
+    CODE COVERAGE
+***************************************************************************/
+
+/*-------------------------------------------------
+    cpu_coverage_alloc - create an empty coverage
+    bitmap
+-------------------------------------------------*/
+
+cpu_coverage *cpu_coverage_alloc(running_machine *machine)
+{
+	cpu_coverage *cov = auto_alloc_clear(machine, cpu_coverage);
+	cov->machine = machine;
+	return cov;
+}
+
+
+/*-------------------------------------------------
+    cpu_coverage_free - free a coverage bitmap
+-------------------------------------------------*/
+
+void cpu_coverage_free(cpu_coverage *cov)
+{
+	int pagenum;
+
+	for (pagenum = 0; pagenum < COVERAGE_PAGES; pagenum++)
+		if (cov->page[pagenum] != NULL)
+			auto_free(cov->machine, cov->page[pagenum]);
+	auto_free(cov->machine, cov);
+}
+
+
+/*-------------------------------------------------
+    cpu_coverage_mark - mark an address as
+    executed
+-------------------------------------------------*/
+
+void cpu_coverage_mark(cpu_coverage *cov, offs_t pc)
+{
+	UINT32 *page = cov->page[pc >> COVERAGE_PAGE_SHIFT];
+	if (page == NULL)
+		page = cov->page[pc >> COVERAGE_PAGE_SHIFT] = auto_alloc_array_clear(cov->machine, UINT32, COVERAGE_PAGE_WORDS);
+	page[(pc >> 5) & (COVERAGE_PAGE_WORDS - 1)] |= (UINT32)1 << (pc & 31);
+}
+
+
+/*-------------------------------------------------
+    cpu_coverage_write - write the executed
+    addresses in ascending order
+-------------------------------------------------*/
+
+UINT32 cpu_coverage_write(cpu_coverage *cov, FILE *file, int addrchars)
+{
+	UINT32 count = 0;
+	int pagenum, word, bit;
+
+	for (pagenum = 0; pagenum < COVERAGE_PAGES; pagenum++)
+	{
+		const UINT32 *page = cov->page[pagenum];
+		if (page == NULL)
+			continue;
+		for (word = 0; word < COVERAGE_PAGE_WORDS; word++)
+			if (page[word] != 0)
+				for (bit = 0; bit < 32; bit++)
+					if (page[word] & ((UINT32)1 << bit))
+					{
+						fprintf(file, "%0*X\n", addrchars, ((offs_t)pagenum << COVERAGE_PAGE_SHIFT) | (word << 5) | bit);
+						count++;
+					}
+	}
+	return count;
+}
@@ -0,0 +1,66 @@
+/***************************************************************************
+
+    cpuprof.h
+
+    Per-CPU sampling profiler and code coverage.
+
+***************************************************************************/
+
+#pragma once
+
+#ifndef __CPUPROF_H__
+#define __CPUPROF_H__
+
+
+/***************************************************************************
+    TYPE DEFINITIONS
+***************************************************************************/
+
+typedef struct _cpu_profiler cpu_profiler;
+typedef struct _cpu_coverage cpu_coverage;
+
+
+/* returns the disassembler's length and flags for the instruction at pc */
+typedef UINT32 (*cpu_profiler_dasm_func)(void *param, offs_t pc);
+
+/* returns the leading opcode bytes at pc, to tell apart code sharing an address */
+typedef UINT32 (*cpu_profiler_opcode_func)(void *param, offs_t pc);
+
+
+
+/***************************************************************************
+    FUNCTION PROTOTYPES
+***************************************************************************/
+
+/* ----- sampling profiler ----- */
+
+/* create a profiler sampling every interval instructions; with callstacks set,
+   dasm and opcode are used to follow calls and returns */
+cpu_profiler *cpu_profiler_alloc(running_machine *machine, UINT32 interval, int callstacks, cpu_profiler_dasm_func dasm, cpu_profiler_opcode_func opcode, void *param);
+
+/* free a profiler */
+void cpu_profiler_free(cpu_profiler *prof);
+
+/* note that an instruction is about to execute */
+void cpu_profiler_instruction(cpu_profiler *prof, offs_t pc);
+
+/* write the samples in folded stack format; returns the number of samples */
+UINT64 cpu_profiler_write(cpu_profiler *prof, FILE *file, int addrchars);
+
+
+/* ----- code coverage ----- */
+
+/* create an empty coverage bitmap */
+cpu_coverage *cpu_coverage_alloc(running_machine *machine);
+
+/* free a coverage bitmap */
+void cpu_coverage_free(cpu_coverage *cov);
+
+/* mark an address as executed */
+void cpu_coverage_mark(cpu_coverage *cov, offs_t pc);
+
+/* write the executed addresses, one per line; returns how many there were */
+UINT32 cpu_coverage_write(cpu_coverage *cov, FILE *file, int addrchars);
+
+
+#endif	/* __CPUPROF_H__ */
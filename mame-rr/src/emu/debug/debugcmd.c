@@ -19,6 +19,7 @@
 #include "debughlp.h"
 #include "debugvw.h"
 #include "render.h"
+#include "ramsearch.h"
 #include <ctype.h>
 
 
@@ -84,6 +85,7 @@ struct _cheat_region_map
 
 static global_entry global_array[MAX_GLOBALS];
 static cheat_system cheat;
+static ramsearch_state *ramsearch;
 
 
 
@@ -130,17 +132,29 @@ static void execute_wpclear(running_machine *machine, int ref, int params, const
 static void execute_wpdisenable(running_machine *machine, int ref, int params, const char **param);
 static void execute_wplist(running_machine *machine, int ref, int params, const char **param);
 static void execute_hotspot(running_machine *machine, int ref, int params, const char **param);
+static void execute_heatmap(running_machine *machine, int ref, int params, const char **param);
+static void execute_heatmapclear(running_machine *machine, int ref, int params, const char **param);
+static void execute_heatmapsave(running_machine *machine, int ref, int params, const char **param);
 static void execute_save(running_machine *machine, int ref, int params, const char **param);
 static void execute_dump(running_machine *machine, int ref, int params, const char **param);
 static void execute_cheatinit(running_machine *machine, int ref, int params, const char **param);
 static void execute_cheatnext(running_machine *machine, int ref, int params, const char **param);
 static void execute_cheatlist(running_machine *machine, int ref, int params, const char **param);
 static void execute_cheatundo(running_machine *machine, int ref, int params, const char **param);
+static void execute_rsinit(running_machine *machine, int ref, int params, const char **param);
+static void execute_rsupdate(running_machine *machine, int ref, int params, const char **param);
+static void execute_rsnext(running_machine *machine, int ref, int params, const char **param);
+static void execute_rslist(running_machine *machine, int ref, int params, const char **param);
 static void execute_dasm(running_machine *machine, int ref, int params, const char **param);
 static void execute_find(running_machine *machine, int ref, int params, const char **param);
 static void execute_trace(running_machine *machine, int ref, int params, const char **param);
 static void execute_traceover(running_machine *machine, int ref, int params, const char **param);
 static void execute_traceflush(running_machine *machine, int ref, int params, const char **param);
+static void execute_tracebin(running_machine *machine, int ref, int params, const char **param);
+static void execute_tracedasm(running_machine *machine, int ref, int params, const char **param);
+static void execute_tracehot(running_machine *machine, int ref, int params, const char **param);
+static void execute_profile(running_machine *machine, int ref, int params, const char **param);
+static void execute_coverage(running_machine *machine, int ref, int params, const char **param);
 static void execute_history(running_machine *machine, int ref, int params, const char **param);
 static void execute_snap(running_machine *machine, int ref, int params, const char **param);
 static void execute_source(running_machine *machine, int ref, int params, const char **param);
@@ -311,6 +325,12 @@ void debug_command_init(running_machine *machine)
 
 	debug_console_register_command(machine, "hotspot",   CMDFLAG_NONE, 0, 0, 3, execute_hotspot);
 
+	debug_console_register_command(machine, "heatmap",   CMDFLAG_NONE, ADDRESS_SPACE_PROGRAM, 1, 3, execute_heatmap);
+	debug_console_register_command(machine, "heatmapd",  CMDFLAG_NONE, ADDRESS_SPACE_DATA, 1, 3, execute_heatmap);
+	debug_console_register_command(machine, "heatmapi",  CMDFLAG_NONE, ADDRESS_SPACE_IO, 1, 3, execute_heatmap);
+	debug_console_register_command(machine, "heatmapclear", CMDFLAG_NONE, 0, 0, 1, execute_heatmapclear);
+	debug_console_register_command(machine, "heatmapsave", CMDFLAG_NONE, 0, 1, 3, execute_heatmapsave);
+
 	debug_console_register_command(machine, "save",      CMDFLAG_NONE, ADDRESS_SPACE_PROGRAM, 3, 4, execute_save);
 	debug_console_register_command(machine, "saved",     CMDFLAG_NONE, ADDRESS_SPACE_DATA, 3, 4, execute_save);
 	debug_console_register_command(machine, "savei",     CMDFLAG_NONE, ADDRESS_SPACE_IO, 3, 4, execute_save);
@@ -336,6 +356,12 @@ void debug_command_init(running_machine *machine)
 	debug_console_register_command(machine, "cheatundo", CMDFLAG_NONE, 0, 0, 0, execute_cheatundo);
 	debug_console_register_command(machine, "cu",        CMDFLAG_NONE, 0, 0, 0, execute_cheatundo);
 
+	debug_console_register_command(machine, "rsinit",    CMDFLAG_NONE, 0, 0, 3, execute_rsinit);
+	debug_console_register_command(machine, "rsupdate",  CMDFLAG_NONE, 0, 0, 0, execute_rsupdate);
+	debug_console_register_command(machine, "rsnext",    CMDFLAG_NONE, RAMSEARCH_SPECIFIC, 1, 3, execute_rsnext);
+	debug_console_register_command(machine, "rschanges", CMDFLAG_NONE, RAMSEARCH_CHANGES, 2, 3, execute_rsnext);
+	debug_console_register_command(machine, "rslist",    CMDFLAG_NONE, 0, 0, 2, execute_rslist);
+
 	debug_console_register_command(machine, "f",         CMDFLAG_KEEP_QUOTES, ADDRESS_SPACE_PROGRAM, 3, MAX_COMMAND_PARAMS, execute_find);
 	debug_console_register_command(machine, "find",      CMDFLAG_KEEP_QUOTES, ADDRESS_SPACE_PROGRAM, 3, MAX_COMMAND_PARAMS, execute_find);
 	debug_console_register_command(machine, "fd",        CMDFLAG_KEEP_QUOTES, ADDRESS_SPACE_DATA, 3, MAX_COMMAND_PARAMS, execute_find);
@@ -348,6 +374,11 @@ void debug_command_init(running_machine *machine)
 	debug_console_register_command(machine, "trace",     CMDFLAG_NONE, 0, 1, 3, execute_trace);
 	debug_console_register_command(machine, "traceover", CMDFLAG_NONE, 0, 1, 3, execute_traceover);
 	debug_console_register_command(machine, "traceflush",CMDFLAG_NONE, 0, 0, 0, execute_traceflush);
+	debug_console_register_command(machine, "tracebin",  CMDFLAG_NONE, 0, 1, MAX_COMMAND_PARAMS, execute_tracebin);
+	debug_console_register_command(machine, "tracedasm", CMDFLAG_NONE, 0, 2, 4, execute_tracedasm);
+	debug_console_register_command(machine, "tracehot",  CMDFLAG_NONE, 0, 1, 4, execute_tracehot);
+	debug_console_register_command(machine, "profile",   CMDFLAG_NONE, 0, 1, 4, execute_profile);
+	debug_console_register_command(machine, "coverage",  CMDFLAG_NONE, 0, 1, 2, execute_coverage);
 
 	debug_console_register_command(machine, "history",   CMDFLAG_NONE, 0, 0, 2, execute_history);
 
@@ -385,10 +416,16 @@ static void debug_command_exit(running_machine &machine)
 {
 	/* turn off all traces */
 	for (device_t *device = machine.m_devicelist.first(); device != NULL; device = device->next())
+	{
 		device->debug()->trace(NULL, 0, NULL);
+		device->debug()->trace_binary(NULL);
+	}
 
 	if (cheat.length)
 		auto_free(&machine, cheat.cheatmap);
+
+	/* the RAM search is freed along with the machine */
+	ramsearch = NULL;
 }
 
 
@@ -2072,6 +2109,138 @@ static void execute_cheatundo(running_machine *machine, int ref, int params, con
 }
 
 
+/*-------------------------------------------------
+    execute_rsinit - snapshot RAM and start a
+    new RAM search
+-------------------------------------------------*/
+
+static void execute_rsinit(running_machine *machine, int ref, int params, const char *param[])
+{
+	UINT64 size = 1, is_signed = 0;
+	const address_space *space;
+
+	/* validate parameters */
+	if (params > 0 && !debug_command_parameter_number(machine, param[0], &size))
+		return;
+	if (params > 1 && !debug_command_parameter_number(machine, param[1], &is_signed))
+		return;
+	if (!debug_command_parameter_cpu_space(machine, (params > 2) ? param[2] : NULL, ADDRESS_SPACE_PROGRAM, &space))
+		return;
+	if (size != 1 && size != 2 && size != 4)
+	{
+		debug_console_printf(machine, "Invalid size: expected 1, 2 or 4\n");
+		return;
+	}
+
+	if (ramsearch == NULL)
+		ramsearch = ramsearch_alloc(machine);
+	debug_console_printf(machine, "%u values in RAM search\n", ramsearch_reset(ramsearch, space, size, is_signed, TRUE));
+}
+
+
+/*-------------------------------------------------
+    execute_rsupdate - take a new snapshot and
+    count the changed values
+-------------------------------------------------*/
+
+static void execute_rsupdate(running_machine *machine, int ref, int params, const char *param[])
+{
+	if (ramsearch == NULL || ramsearch_get_space(ramsearch) == NULL)
+	{
+		debug_console_printf(machine, "Use rsinit before rsupdate\n");
+		return;
+	}
+	ramsearch_update(ramsearch);
+}
+
+
+/*-------------------------------------------------
+    execute_rsnext - narrow down the RAM search
+-------------------------------------------------*/
+
+static void execute_rsnext(running_machine *machine, int ref, int params, const char *param[])
+{
+	UINT64 operand = 0, extra = 0;
+	int compare, target = ref;
+
+	if (ramsearch == NULL || ramsearch_get_space(ramsearch) == NULL)
+	{
+		debug_console_printf(machine, "Use rsinit before searching\n");
+		return;
+	}
+
+	/* decode the condition */
+	compare = ramsearch_compare_from_string(param[0]);
+	if (compare < 0)
+	{
+		debug_console_printf(machine, "Invalid condition type\n");
+		return;
+	}
+
+	/* without a value, rsnext compares against the last search */
+	if (params < 2 || param[1][0] == 0)
+	{
+		if (ref == RAMSEARCH_CHANGES)
+		{
+			debug_console_printf(machine, "Missing change count\n");
+			return;
+		}
+		target = RAMSEARCH_PREVIOUS;
+	}
+	else if (!debug_command_parameter_number(machine, param[1], &operand))
+		return;
+	if (params > 2 && !debug_command_parameter_number(machine, param[2], &extra))
+		return;
+
+	debug_console_printf(machine, "%u values left\n", ramsearch_search(ramsearch, compare, target, (INT64)operand, (INT64)extra));
+}
+
+
+/*-------------------------------------------------
+    execute_rslist - show the RAM search results
+-------------------------------------------------*/
+
+static void execute_rslist(running_machine *machine, int ref, int params, const char *param[])
+{
+	UINT64 maxresults = 100, first = 0;
+	ramsearch_result results[16];
+	const address_space *space;
+	UINT32 found, index;
+
+	if (ramsearch == NULL || (space = ramsearch_get_space(ramsearch)) == NULL)
+	{
+		debug_console_printf(machine, "Use rsinit before rslist\n");
+		return;
+	}
+	if (params > 0 && !debug_command_parameter_number(machine, param[0], &maxresults))
+		return;
+	if (params > 1 && !debug_command_parameter_number(machine, param[1], &first))
+		return;
+
+	/* fetch the results a few at a time */
+	while (maxresults > 0)
+	{
+		found = ramsearch_results(ramsearch, first, results, MIN(maxresults, ARRAY_LENGTH(results)));
+		if (found == 0)
+			break;
+		for (index = 0; index < found; index++)
+		{
+			char value[16], previous[16];
+
+			/* values are at most 32 bits, signed or not */
+			sprintf(value, (results[index].value < 0) ? "%d" : "%u", (INT32)results[index].value);
+			sprintf(previous, (results[index].previous < 0) ? "%d" : "%u", (INT32)results[index].previous);
+			debug_console_printf(machine, "%s: %11s  (was %11s)  %5d changes\n",
+				core_i64_hex_format(memory_byte_to_address(space, results[index].address), space->logaddrchars),
+				value, previous, results[index].changes);
+		}
+		first += found;
+		maxresults -= found;
+	}
+	debug_console_printf(machine, "%u values in RAM search\n", ramsearch_count(ramsearch));
+}
+
+
 /*-------------------------------------------------
     execute_find - execute the find command
 -------------------------------------------------*/
@@ -2366,6 +2535,406 @@ static void execute_traceflush(running_machine *machine, int ref, int params, co
 }
 
 
+/*-------------------------------------------------
+    execute_tracebin - execute the binary trace
+    command
+-------------------------------------------------*/
+
+static void execute_tracebin(running_machine *machine, int ref, int params, const char *param[])
+{
+	const char *filename = param[0];
+	device_t *cpu;
+
+	/* validate parameters */
+	if (!debug_command_parameter_cpu(machine, (params > 1) ? param[1] : NULL, &cpu))
+		return;
+	if (params - 2 > BINTRACE_MAX_REGS)
+	{
+		debug_console_printf(machine, "At most %d registers can be traced\n", BINTRACE_MAX_REGS);
+		return;
+	}
+
+	/* turning it off? */
+	if (mame_stricmp(filename, "off") == 0)
+	{
+		cpu->debug()->trace_binary(NULL);
+		debug_console_printf(machine, "Stopped binary tracing on CPU '%s'\n", cpu->tag());
+		return;
+	}
+
+	/* do it */
+	if (!cpu->debug()->trace_binary(filename, MAX(params - 2, 0), &param[2]))
+	{
+		debug_console_printf(machine, "Error opening file '%s' or unknown register\n", filename);
+		return;
+	}
+	debug_console_printf(machine, "Binary tracing CPU '%s' to file %s\n", cpu->tag(), filename);
+}
+
+
+/*-------------------------------------------------
+    open_binary_trace - open a binary trace and
+    find the CPU it was recorded from
+-------------------------------------------------*/
+
+static bintrace_reader *open_binary_trace(running_machine *machine, const char *filename, device_t **cpu)
+{
+	bintrace_reader *reader = bintrace_reader_open(machine, filename);
+	if (reader == NULL)
+	{
+		debug_console_printf(machine, "Error opening binary trace '%s'\n", filename);
+		return NULL;
+	}
+
+	*cpu = machine->device(bintrace_reader_cputag(reader));
+	if (*cpu == NULL || (*cpu)->debug() == NULL)
+	{
+		debug_console_printf(machine, "Trace was recorded from CPU '%s', which this machine does not have\n", bintrace_reader_cputag(reader));
+		bintrace_reader_close(reader);
+		return NULL;
+	}
+	return reader;
+}
+
+
+/*-------------------------------------------------
+    execute_tracedasm - disassemble a binary
+    trace to a text file
+-------------------------------------------------*/
+
+static void execute_tracedasm(running_machine *machine, int ref, int params, const char *param[])
+{
+	UINT64 startpc = 0, endpc = ~(UINT64)0, count = 0;
+	bintrace_reader *reader;
+	bintrace_entry entry;
+	device_t *cpu;
+	FILE *f;
+
+	/* validate parameters */
+	if (params > 2 && !debug_command_parameter_number(machine, param[2], &startpc))
+		return;
+	if (params > 3 && !debug_command_parameter_number(machine, param[3], &endpc))
+		return;
+	if ((reader = open_binary_trace(machine, param[0], &cpu)) == NULL)
+		return;
+
+	f = fopen(param[1], "w");
+	if (f == NULL)
+	{
+		debug_console_printf(machine, "Error opening file '%s'\n", param[1]);
+		bintrace_reader_close(reader);
+		return;
+	}
+
+	/* disassemble from the recorded bytes rather than current memory */
+	int logaddrchars = cpu->debug()->logaddrchars();
+	int numregs = bintrace_reader_numregs(reader);
+	while (bintrace_reader_next(reader, &entry))
+	{
+		if (entry.type == BINTRACE_ENTRY_FRAME)
+		{
+			fprintf(f, "\n   (frame %d)\n\n", entry.frame);
+			continue;
+		}
+		if (entry.pc < startpc || entry.pc > endpc)
+			continue;
+
+		char buffer[200];
+		cpu->debug()->disassemble(buffer, entry.pc, entry.opbytes, entry.argbytes);
+		fprintf(f, "%0*X: %-40s", logaddrchars, entry.pc, buffer);
+		for (int regnum = 0; regnum < numregs; regnum++)
+			fprintf(f, " %s=%s", bintrace_reader_regname(reader, regnum), core_i64_hex_format(entry.regs[regnum], 0));
+		fprintf(f, "\n");
+		count++;
+	}
+
+	fclose(f);
+	bintrace_reader_close(reader);
+	debug_console_printf(machine, "Disassembled %d instructions to %s\n", (UINT32)count, param[1]);
+}
+
+
+/*-------------------------------------------------
+    execute_tracehot - show the most frequently
+    executed PCs in a binary trace
+-------------------------------------------------*/
+
+typedef struct _tracehot_entry tracehot_entry;
+struct _tracehot_entry
+{
+	offs_t				pc;					/* PC of the instruction */
+	UINT8				used;				/* is this slot in use? */
+	UINT64				hits;				/* number of times it was executed */
+	UINT64				cycles;				/* cycles until the next instruction */
+};
+
+static tracehot_entry *tracehot_find(tracehot_entry *table, UINT32 size, offs_t pc)
+{
+	UINT32 slot = (pc * 2654435761U) & (size - 1);
+	while (table[slot].used && table[slot].pc != pc)
+		slot = (slot + 1) & (size - 1);
+	table[slot].used = TRUE;
+	table[slot].pc = pc;
+	return &table[slot];
+}
+
+static int CLIB_DECL tracehot_compare(const void *item1, const void *item2)
+{
+	const tracehot_entry *entry1 = (const tracehot_entry *)item1;
+	const tracehot_entry *entry2 = (const tracehot_entry *)item2;
+	if (entry1->hits != entry2->hits)
+		return (entry1->hits > entry2->hits) ? -1 : 1;
+	return (entry1->pc < entry2->pc) ? -1 : (entry1->pc > entry2->pc);
+}
+
+static void execute_tracehot(running_machine *machine, int ref, int params, const char *param[])
+{
+	UINT64 maxresults = 20, startpc = 0, endpc = ~(UINT64)0;
+	UINT64 total = 0, lastcycles = 0;
+	UINT32 size = 4096, used = 0, index;
+	bintrace_reader *reader;
+	bintrace_entry entry;
+	tracehot_entry *table;
+	offs_t lastpc = 0;
+	int havelast = FALSE;
+	device_t *cpu;
+
+	/* validate parameters */
+	if (params > 1 && !debug_command_parameter_number(machine, param[1], &maxresults))
+		return;
+	if (params > 2 && !debug_command_parameter_number(machine, param[2], &startpc))
+		return;
+	if (params > 3 && !debug_command_parameter_number(machine, param[3], &endpc))
+		return;
+	if ((reader = open_binary_trace(machine, param[0], &cpu)) == NULL)
+		return;
+
+	/* count hits per PC, charging each instruction the cycles up to the next one */
+	table = auto_alloc_array_clear(machine, tracehot_entry, size);
+	while (bintrace_reader_next(reader, &entry))
+	{
+		if (entry.type != BINTRACE_ENTRY_INSTRUCTION)
+			continue;
+		if (havelast)
+			tracehot_find(table, size, lastpc)->cycles += entry.cycles - lastcycles;
+		havelast = (entry.pc >= startpc && entry.pc <= endpc);
+		if (!havelast)
+			continue;
+		lastpc = entry.pc;
+		lastcycles = entry.cycles;
+
+		tracehot_entry *hot = tracehot_find(table, size, entry.pc);
+		if (hot->hits++ == 0 && ++used > size / 2)
+		{
+			/* grow the table once it is half full */
+			tracehot_entry *oldtable = table;
+			table = auto_alloc_array_clear(machine, tracehot_entry, size * 2);
+			for (index = 0; index < size; index++)
+				if (oldtable[index].used)
+					*tracehot_find(table, size * 2, oldtable[index].pc) = oldtable[index];
+			auto_free(machine, oldtable);
+			size *= 2;
+		}
+		total++;
+	}
+	bintrace_reader_close(reader);
+
+	/* pack the used slots together and sort by hits */
+	for (index = used = 0; index < size; index++)
+		if (table[index].used)
+			table[used++] = table[index];
+	qsort(table, used, sizeof(table[0]), tracehot_compare);
+
+	int logaddrchars = cpu->debug()->logaddrchars();
+	debug_console_printf(machine, "%*s %12s %7s %14s\n", logaddrchars, "PC", "Hits", "Percent", "Cycles");
+	for (index = 0; index < used && index < maxresults; index++)
+		debug_console_printf(machine, "%0*X %12" I64FMT "u %6.2f%% %14" I64FMT "u\n", logaddrchars, table[index].pc,
+			table[index].hits, 100.0 * (double)table[index].hits / (double)total, table[index].cycles);
+	debug_console_printf(machine, "%" I64FMT "u instructions at %d distinct PCs\n", total, used);
+	auto_free(machine, table);
+}
+
+
+/*-------------------------------------------------
+    execute_heatmap - execute the heatmap
+    commands
+-------------------------------------------------*/
+
+static void execute_heatmap(running_machine *machine, int ref, int params, const char *param[])
+{
+	const address_space *space;
+	UINT64 address, length, linesize = 16;
+
+	/* CPU is implicit */
+	if (!debug_command_parameter_cpu_space(machine, NULL, ref, &space))
+		return;
+
+	/* turning it off? */
+	if (mame_stricmp(param[0], "off") == 0)
+	{
+		space->cpu->debug()->heatmap_stop(*space);
+		debug_console_printf(machine, "Stopped heatmap of CPU '%s' %s space\n", space->cpu->tag(), space->name);
+		return;
+	}
+
+	/* validate parameters */
+	if (params < 2)
+	{
+		debug_console_printf(machine, "Expected an address and a length\n");
+		return;
+	}
+	if (!debug_command_parameter_number(machine, param[0], &address))
+		return;
+	if (!debug_command_parameter_number(machine, param[1], &length))
+		return;
+	if (!debug_command_parameter_number(machine, param[2], &linesize))
+		return;
+
+	/* do it */
+	if (!space->cpu->debug()->heatmap_track(*space, address, length, linesize))
+	{
+		debug_console_printf(machine, "Invalid line size or range too large for the line size\n");
+		return;
+	}
+	debug_console_printf(machine, "Now counting accesses to CPU '%s' %s space in %d-byte lines\n", space->cpu->tag(), space->name, (int)linesize);
+}
+
+
+/*-------------------------------------------------
+    execute_heatmapclear - execute the heatmap
+    clear command
+-------------------------------------------------*/
+
+static void execute_heatmapclear(running_machine *machine, int ref, int params, const char *param[])
+{
+	device_t *cpu;
+
+	/* validate parameters */
+	if (!debug_command_parameter_cpu(machine, (params > 0) ? param[0] : NULL, &cpu))
+		return;
+
+	cpu->debug()->heatmap_clear();
+	debug_console_printf(machine, "Cleared heatmaps of CPU '%s'\n", cpu->tag());
+}
+
+
+/*-------------------------------------------------
+    execute_heatmapsave - execute the heatmap
+    save command
+-------------------------------------------------*/
+
+static void execute_heatmapsave(running_machine *machine, int ref, int params, const char *param[])
+{
+	const char *filename = param[0];
+	UINT64 frames = 0;
+	device_t *cpu;
+
+	/* validate parameters */
+	if (!debug_command_parameter_number(machine, param[1], &frames))
+		return;
+	if (!debug_command_parameter_cpu(machine, (params > 2) ? param[2] : NULL, &cpu))
+		return;
+
+	/* turning it off? */
+	if (mame_stricmp(filename, "off") == 0)
+	{
+		cpu->debug()->heatmap_save(NULL, 0);
+		debug_console_printf(machine, "Stopped saving heatmap windows of CPU '%s'\n", cpu->tag());
+		return;
+	}
+
+	/* make sure there is something to save */
+	bool any = false;
+	for (int spacenum = 0; spacenum < ADDRESS_SPACES; spacenum++)
+		if (cpu->debug()->heatmap_enabled(spacenum))
+			any = true;
+	if (!any)
+	{
+		debug_console_printf(machine, "No heatmaps active on CPU '%s'\n", cpu->tag());
+		return;
+	}
+
+	/* do it */
+	if (!cpu->debug()->heatmap_save(filename, frames))
+	{
+		debug_console_printf(machine, "Error opening file '%s'\n", filename);
+		return;
+	}
+	if (frames == 0)
+		debug_console_printf(machine, "Heatmaps of CPU '%s' saved to %s\n", cpu->tag(), filename);
+	else
+		debug_console_printf(machine, "Saving heatmaps of CPU '%s' to %s every %d frames\n", cpu->tag(), filename, (int)frames);
+}
+
+
+/*-------------------------------------------------
+    execute_profile - execute the profile command
+-------------------------------------------------*/
+
+static void execute_profile(running_machine *machine, int ref, int params, const char *param[])
+{
+	const char *filename = param[0];
+	UINT64 interval = 64, stacks = 0;
+	device_t *cpu;
+
+	/* validate parameters */
+	if (!debug_command_parameter_cpu(machine, (params > 1) ? param[1] : NULL, &cpu))
+		return;
+	if (!debug_command_parameter_number(machine, param[2], &interval))
+		return;
+	if (!debug_command_parameter_number(machine, param[3], &stacks))
+		return;
+
+	/* turning it off? */
+	if (mame_stricmp(filename, "off") == 0)
+	{
+		cpu->debug()->profile(NULL);
+		debug_console_printf(machine, "Stopped profiling CPU '%s'\n", cpu->tag());
+		return;
+	}
+
+	/* do it */
+	if (!cpu->debug()->profile(filename, interval, stacks != 0))
+	{
+		debug_console_printf(machine, "Error opening file '%s'\n", filename);
+		return;
+	}
+	debug_console_printf(machine, "Profiling CPU '%s' every %d instructions to file %s\n", cpu->tag(), (int)MAX(interval, 1), filename);
+}
+
+
+/*-------------------------------------------------
+    execute_coverage - execute the coverage
+    command
+-------------------------------------------------*/
+
+static void execute_coverage(running_machine *machine, int ref, int params, const char *param[])
+{
+	const char *filename = param[0];
+	device_t *cpu;
+
+	/* validate parameters */
+	if (!debug_command_parameter_cpu(machine, (params > 1) ? param[1] : NULL, &cpu))
+		return;
+
+	/* turning it off? */
+	if (mame_stricmp(filename, "off") == 0)
+	{
+		cpu->debug()->coverage(NULL);
+		debug_console_printf(machine, "Stopped recording coverage of CPU '%s'\n", cpu->tag());
+		return;
+	}
+
+	/* do it */
+	if (!cpu->debug()->coverage(filename))
+	{
+		debug_console_printf(machine, "Error opening file '%s'\n", filename);
+		return;
+	}
+	debug_console_printf(machine, "Recording coverage of CPU '%s' to file %s\n", cpu->tag(), filename);
+}
+
+
 /*-------------------------------------------------
     execute_history - execute the history command
 -------------------------------------------------*/
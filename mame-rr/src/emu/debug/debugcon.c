@@ -59,6 +59,7 @@ struct _debug_command
 
 static text_buffer *console_textbuf;
 static text_buffer *errorlog_textbuf;
+static astring *console_capture;
 
 static debug_command *commandlist;
 
@@ -479,6 +480,8 @@ void CLIB_DECL debug_console_printf(running_machine *machine, const char *format
 	va_end(arg);
 
 	text_buffer_print(console_textbuf, buffer);
+	if (console_capture != NULL)
+		console_capture->cat(buffer);
 
 	/* force an update of any console views */
 	machine->m_debug_view->update_all(DVT_CONSOLE);
@@ -497,6 +500,8 @@ void CLIB_DECL debug_console_vprintf(running_machine *machine, const char *forma
 
 	buffer.vprintf(format, args);
 	text_buffer_print(console_textbuf, buffer);
+	if (console_capture != NULL)
+		console_capture->cat(buffer);
 
 	/* force an update of any console views */
 	machine->m_debug_view->update_all(DVT_CONSOLE);
@@ -519,12 +524,26 @@ void CLIB_DECL debug_console_printf_wrap(running_machine *machine, int wrapcol,
 	va_end(arg);
 
 	text_buffer_print_wrap(console_textbuf, buffer, wrapcol);
+	if (console_capture != NULL)
+		console_capture->cat(buffer);
 
 	/* force an update of any console views */
 	machine->m_debug_view->update_all(DVT_CONSOLE);
 }
 
 
+/*-------------------------------------------------
+    debug_console_capture - additionally append
+    everything printed to the console to the
+    given string, or stop doing so if NULL
+-------------------------------------------------*/
+
+void debug_console_capture(astring *string)
+{
+	console_capture = string;
+}
+
+
 /*-------------------------------------------------
     debug_console_get_textbuf - return a pointer
     to the console text buffer
@@ -45,6 +45,7 @@
 #include "debugcon.h"
 #include "express.h"
 #include "debugvw.h"
+#include "debugsrv.h"
 #include "debugger.h"
 #include "debugint/debugint.h"
 #include "uiinput.h"
@@ -924,6 +925,14 @@ static void debug_cpu_exit(running_machine &machine)
 	/* free the global symbol table */
 	if (global != NULL && global->symtable != NULL)
 		symtable_free(global->symtable);
+
+	/* write out any profiles and coverage still being collected */
+	for (device_t *device = machine.m_devicelist.first(); device != NULL; device = device->next())
+		if (device->debug() != NULL)
+		{
+			device->debug()->profile(NULL);
+			device->debug()->coverage(NULL);
+		}
 }
 
 
@@ -935,7 +944,14 @@ static void on_vblank(screen_device &device, void *param, bool vblank_state)
 {
 	/* just set a global flag to be consumed later */
 	if (vblank_state)
+	{
 		device.machine->debugcpu_data->vblank_occurred = TRUE;
+
+		/* let any heatmaps close out their frame windows */
+		for (device_t *scan = device.machine->m_devicelist.first(); scan != NULL; scan = scan->next())
+			if (scan->debug() != NULL)
+				scan->debug()->heatmap_frame();
+	}
 }
 
 
@@ -1571,14 +1587,27 @@ device_debug::device_debug(device_t &device, symbol_table *globalsyms)
 	  m_endexectime(attotime_zero),
 	  m_pc_history_index(0),
 	  m_bplist(NULL),
+	  m_bpindex(NULL),
 	  m_trace(NULL),
+	  m_bintrace(NULL),
+	  m_bintrace_numregs(0),
+	  m_bintrace_frame(0),
+	  m_profiler(NULL),
+	  m_profile_file(NULL),
+	  m_coverage(NULL),
+	  m_coverage_file(NULL),
 	  m_hotspots(NULL),
 	  m_hotspot_count(0),
 	  m_hotspot_threshhold(0),
+	  m_heatmap_file(NULL),
+	  m_heatmap_window(0),
+	  m_heatmap_window_start(0),
 	  m_comments(NULL)
 {
 	memset(m_pc_history, 0, sizeof(m_pc_history));
 	memset(m_wplist, 0, sizeof(m_wplist));
+	memset(m_wpindex, 0, sizeof(m_wpindex));
+	memset(m_heatmap, 0, sizeof(m_heatmap));
 
 	// find out which interfaces we have to work with
 	device.interface(m_exec);
@@ -1636,6 +1665,10 @@ device_debug::~device_debug()
 	// free breakpoints and watchpoints
 	breakpoint_clear_all();
 	watchpoint_clear_all();
+
+	// close any heatmap window file
+	if (m_heatmap_file != NULL)
+		fclose(m_heatmap_file);
 }
 
 
@@ -1777,6 +1810,14 @@ void device_debug::instruction_hook(offs_t curpc)
 	// are we tracing?
 	if (m_trace != NULL)
 		m_trace->update(curpc);
+	if (m_bintrace != NULL)
+		trace_binary_update(curpc);
+
+	// are we profiling?
+	if (m_profiler != NULL)
+		cpu_profiler_instruction(m_profiler, curpc);
+	if (m_coverage != NULL)
+		cpu_coverage_mark(m_coverage, curpc);
 
 	// per-instruction hook?
 	if (global->execution_state != EXECUTION_STATE_STOPPED && (m_flags & DEBUG_FLAG_HOOKED) != 0 && (*m_instrhook)(m_device, curpc))
@@ -1853,7 +1894,9 @@ void device_debug::instruction_hook(offs_t curpc)
 
 			// clear the memory modified flag and wait
 			global->memory_modified = FALSE;
-			if (m_device.machine->debug_flags & DEBUG_FLAG_OSD_ENABLED)
+			if (m_device.machine->debug_flags & DEBUG_FLAG_SERVER)
+				debug_server_wait_for_debugger(&m_device, firststop);
+			else if (m_device.machine->debug_flags & DEBUG_FLAG_OSD_ENABLED)
 				osd_wait_for_debugger(&m_device, firststop);
 			else if (m_device.machine->debug_flags & DEBUG_FLAG_ENABLED)
 				debugint_wait_for_debugger(&m_device, firststop);
@@ -1902,6 +1945,10 @@ void device_debug::memory_read_hook(const address_space &space, offs_t address,
 	// check hotspots
 	if (m_hotspots != NULL)
 		hotspot_check(space, address);
+
+	// count the access in the heatmap
+	if (m_heatmap[space.spacenum] != NULL)
+		heatmap_count(space, address, mem_mask, false);
 }
 
 
@@ -1914,6 +1961,10 @@ void device_debug::memory_read_hook(const address_space &space, offs_t address,
 void device_debug::memory_write_hook(const address_space &space, offs_t address, UINT64 data, UINT64 mem_mask)
 {
 	watchpoint_check(space, WATCHPOINT_WRITE, address, data, mem_mask);
+
+	// count the access in the heatmap
+	if (m_heatmap[space.spacenum] != NULL)
+		heatmap_count(space, address, mem_mask, true);
 }
 
 
@@ -2388,6 +2439,251 @@ void device_debug::hotspot_track(int numspots, int threshhold)
 }
 
 
+//-------------------------------------------------
+//  heatmap_current_frame - return the frame
+//  number used to label heatmap windows
+//-------------------------------------------------
+
+static UINT64 heatmap_current_frame(running_machine *machine)
+{
+	screen_device *screen = machine->primary_screen;
+	return (screen != NULL) ? screen->frame_number() : 0;
+}
+
+
+//-------------------------------------------------
+//  heatmap_track - start counting reads and
+//  writes to a range of an address space, one
+//  counter per line of linebytes bytes
+//-------------------------------------------------
+
+bool device_debug::heatmap_track(const address_space &space, offs_t address, offs_t length, int linebytes)
+{
+	// the line size must be a power of two
+	int lineshift = 0;
+	while ((1 << lineshift) < linebytes)
+		lineshift++;
+	if (length == 0 || (1 << lineshift) != linebytes || lineshift > 16)
+		return false;
+
+	// convert to a line-aligned byte range and size the page directory
+	offs_t start = (memory_address_to_byte(&space, address) & space.bytemask) & ~((1 << lineshift) - 1);
+	offs_t end = memory_address_to_byte_end(&space, address + length - 1) & space.bytemask;
+	if (end < start)
+		return false;
+	UINT64 numpages = ((UINT64)(end - start) >> (lineshift + HEATMAP_PAGE_SHIFT)) + 1;
+	if (numpages > HEATMAP_MAX_PAGES)
+		return false;
+
+	// throw away any existing map and build the new one
+	heatmap_stop(space);
+	heatmap *map = auto_alloc(m_device.machine, heatmap);
+	map->m_start = start;
+	map->m_end = end;
+	map->m_lineshift = lineshift;
+	map->m_numpages = numpages;
+	map->m_page = auto_alloc_array_clear(m_device.machine, heatmap_page *, numpages);
+	m_heatmap[space.spacenum] = map;
+	if (m_heatmap_file == NULL)
+		m_heatmap_window_start = heatmap_current_frame(m_device.machine);
+
+	// route this space through the watchpoint handlers
+	watchpoint_update_flags(space);
+	return true;
+}
+
+
+//-------------------------------------------------
+//  heatmap_stop - stop counting accesses to an
+//  address space and free the counters
+//-------------------------------------------------
+
+void device_debug::heatmap_stop(const address_space &space)
+{
+	heatmap *map = m_heatmap[space.spacenum];
+	if (map == NULL)
+		return;
+
+	for (UINT32 pagenum = 0; pagenum < map->m_numpages; pagenum++)
+		auto_free(m_device.machine, map->m_page[pagenum]);
+	auto_free(m_device.machine, map->m_page);
+	auto_free(m_device.machine, map);
+	m_heatmap[space.spacenum] = NULL;
+
+	// stop saving windows once the last map is gone
+	bool any = false;
+	for (int spacenum = 0; spacenum < ADDRESS_SPACES; spacenum++)
+		if (m_heatmap[spacenum] != NULL)
+			any = true;
+	if (!any)
+		heatmap_save(NULL, 0);
+
+	// drop back to the direct handlers if nothing else needs them
+	watchpoint_update_flags(space);
+}
+
+
+//-------------------------------------------------
+//  heatmap_clear - zero the counters of every
+//  heatmap on this device
+//-------------------------------------------------
+
+void device_debug::heatmap_clear()
+{
+	for (int spacenum = 0; spacenum < ADDRESS_SPACES; spacenum++)
+	{
+		heatmap *map = m_heatmap[spacenum];
+		if (map != NULL)
+			for (UINT32 pagenum = 0; pagenum < map->m_numpages; pagenum++)
+				if (map->m_page[pagenum] != NULL)
+					memset(map->m_page[pagenum], 0, sizeof(*map->m_page[pagenum]));
+	}
+	m_heatmap_window_start = heatmap_current_frame(m_device.machine);
+}
+
+
+//-------------------------------------------------
+//  heatmap_lookup - fetch the counts for the line
+//  containing a byte address; returns false if
+//  the address is not being tracked
+//-------------------------------------------------
+
+bool device_debug::heatmap_lookup(int spacenum, offs_t address, UINT32 &reads, UINT32 &writes) const
+{
+	const heatmap *map = m_heatmap[spacenum];
+	reads = writes = 0;
+	if (map == NULL || address < map->m_start || address > map->m_end)
+		return false;
+
+	offs_t line = (address - map->m_start) >> map->m_lineshift;
+	const heatmap_page *page = map->m_page[line >> HEATMAP_PAGE_SHIFT];
+	if (page != NULL)
+	{
+		reads = page->m_reads[line & ((1 << HEATMAP_PAGE_SHIFT) - 1)];
+		writes = page->m_writes[line & ((1 << HEATMAP_PAGE_SHIFT) - 1)];
+	}
+	return true;
+}
+
+
+//-------------------------------------------------
+//  heatmap_save - write the heatmaps to a file;
+//  with a non-zero frame count, keep the file
+//  open and append a window (then clear) every
+//  that many frames instead
+//-------------------------------------------------
+
+bool device_debug::heatmap_save(const char *filename, UINT32 frames)
+{
+	// close out any existing window file
+	if (m_heatmap_file != NULL)
+		fclose(m_heatmap_file);
+	m_heatmap_file = NULL;
+	m_heatmap_window = 0;
+	if (filename == NULL)
+		return true;
+
+	FILE *file = fopen(filename, "w");
+	if (file == NULL)
+		return false;
+
+	// one-shot dump of everything counted so far
+	UINT64 frame = heatmap_current_frame(m_device.machine);
+	if (frames == 0)
+	{
+		heatmap_write(*file, m_heatmap_window_start, frame);
+		fclose(file);
+		return true;
+	}
+
+	// start a fresh window from the current frame
+	m_heatmap_file = file;
+	m_heatmap_window = frames;
+	heatmap_clear();
+	return true;
+}
+
+
+//-------------------------------------------------
+//  heatmap_frame - called at VBLANK to close out
+//  the current window when it is full
+//-------------------------------------------------
+
+void device_debug::heatmap_frame()
+{
+	if (m_heatmap_file == NULL)
+		return;
+
+	UINT64 frame = heatmap_current_frame(m_device.machine);
+	if (frame - m_heatmap_window_start < m_heatmap_window)
+		return;
+
+	heatmap_write(*m_heatmap_file, m_heatmap_window_start, frame - 1);
+	fflush(m_heatmap_file);
+	heatmap_clear();
+}
+
+
+//-------------------------------------------------
+//  profile - start or stop sampling the PC every
+//  interval instructions; the folded profile is
+//  written to the file when sampling stops
+//-------------------------------------------------
+
+bool device_debug::profile(const char *filename, UINT32 interval, bool callstacks)
+{
+	// finish off any existing profile
+	if (m_profiler != NULL)
+	{
+		cpu_profiler_write(m_profiler, m_profile_file, logaddrchars());
+		fclose(m_profile_file);
+		cpu_profiler_free(m_profiler);
+	}
+	m_profiler = NULL;
+	m_profile_file = NULL;
+
+	// start a new one if we have a filename
+	if (filename != NULL)
+	{
+		m_profile_file = fopen(filename, "w");
+		if (m_profile_file == NULL)
+			return false;
+		m_profiler = cpu_profiler_alloc(m_device.machine, interval, callstacks && m_disasm != NULL, profile_dasm, profile_opcode, this);
+	}
+	return true;
+}
+
+
+//-------------------------------------------------
+//  coverage - start or stop marking every
+//  executed address; the addresses are written
+//  to the file when marking stops
+//-------------------------------------------------
+
+bool device_debug::coverage(const char *filename)
+{
+	// finish off any existing bitmap
+	if (m_coverage != NULL)
+	{
+		cpu_coverage_write(m_coverage, m_coverage_file, logaddrchars());
+		fclose(m_coverage_file);
+		cpu_coverage_free(m_coverage);
+	}
+	m_coverage = NULL;
+	m_coverage_file = NULL;
+
+	// start a new one if we have a filename
+	if (filename != NULL)
+	{
+		m_coverage_file = fopen(filename, "w");
+		if (m_coverage_file == NULL)
+			return false;
+		m_coverage = cpu_coverage_alloc(m_device.machine);
+	}
+	return true;
+}
+
+
 //-------------------------------------------------
 //  history_pc - return an entry from the PC
 //  history
@@ -2419,6 +2715,46 @@ void device_debug::trace(FILE *file, bool trace_over, const char *action)
 }
 
 
+//-------------------------------------------------
+//  trace_binary - start or stop a compact binary
+//  trace of a given device; a NULL filename
+//  stops tracing
+//-------------------------------------------------
+
+bool device_debug::trace_binary(const char *filename, int numregs, const char *const *regnames)
+{
+	// close any existing trace
+	if (m_bintrace != NULL)
+		bintrace_writer_close(m_bintrace);
+	m_bintrace = NULL;
+	m_bintrace_numregs = 0;
+
+	if (filename == NULL)
+		return true;
+	if (m_memory == NULL || m_disasm == NULL || m_exec == NULL)
+		return false;
+
+	// resolve the register names against our state entries
+	const char *names[BINTRACE_MAX_REGS];
+	for (int regnum = 0; regnum < numregs && m_bintrace_numregs < BINTRACE_MAX_REGS; regnum++)
+	{
+		const device_state_entry *entry;
+		for (entry = (m_state != NULL) ? m_state->state_first() : NULL; entry != NULL; entry = entry->next())
+			if (mame_stricmp(entry->symbol(), regnames[regnum]) == 0)
+				break;
+		if (entry == NULL)
+			return false;
+		names[m_bintrace_numregs] = entry->symbol();
+		m_bintrace_reg[m_bintrace_numregs++] = entry->index();
+	}
+
+	// open the file; the frame is noted on the first instruction
+	m_bintrace = bintrace_writer_open(m_device.machine, filename, m_device.tag(), max_opcode_bytes(), m_bintrace_numregs, names);
+	m_bintrace_frame = ~(UINT64)0;
+	return (m_bintrace != NULL);
+}
+
+
 //-------------------------------------------------
 //  trace_printf - output data into the given
 //  device's tracefile, if tracing
@@ -2446,8 +2782,8 @@ void device_debug::compute_debug_flags()
 	running_machine *machine = m_device.machine;
 	debugcpu_private *global = machine->debugcpu_data;
 
-	// clear out global flags by default, keep DEBUG_FLAG_OSD_ENABLED
-	machine->debug_flags &= DEBUG_FLAG_OSD_ENABLED;
+	// clear out global flags by default, keep DEBUG_FLAG_OSD_ENABLED and DEBUG_FLAG_SERVER
+	machine->debug_flags &= DEBUG_FLAG_OSD_ENABLED | DEBUG_FLAG_SERVER;
 	machine->debug_flags |= DEBUG_FLAG_ENABLED;
 
 	// if we are ignoring this CPU, or if events are pending, we're done
@@ -2463,8 +2799,8 @@ void device_debug::compute_debug_flags()
 	if ((m_flags & (DEBUG_FLAG_HISTORY | DEBUG_FLAG_HOOKED | DEBUG_FLAG_STEPPING_ANY | DEBUG_FLAG_STOP_PC | DEBUG_FLAG_LIVE_BP)) != 0)
 		machine->debug_flags |= DEBUG_FLAG_CALL_HOOK;
 
-	// also call if we are tracing
-	if (m_trace != NULL)
+	// also call if we are tracing or profiling
+	if (m_trace != NULL || m_bintrace != NULL || m_profiler != NULL || m_coverage != NULL)
 		machine->debug_flags |= DEBUG_FLAG_CALL_HOOK;
 
 	// if we are stopping at a particular time and that time is within the current timeslice, we need to be called
@@ -2514,14 +2850,11 @@ void device_debug::prepare_for_step_overout(offs_t pc)
 
 void device_debug::breakpoint_update_flags()
 {
-	// see if there are any enabled breakpoints
+	// rebuild the lookup index; it only exists if there are enabled breakpoints
+	breakpoint_index_rebuild();
 	m_flags &= ~DEBUG_FLAG_LIVE_BP;
-	for (breakpoint *bp = m_bplist; bp != NULL; bp = bp->m_next)
-		if (bp->m_enabled)
-		{
-			m_flags |= DEBUG_FLAG_LIVE_BP;
-			break;
-		}
+	if (m_bpindex != NULL)
+		m_flags |= DEBUG_FLAG_LIVE_BP;
 
 	// push the flags out globally
 	debugcpu_private *global = m_device.machine->debugcpu_data;
@@ -2537,8 +2870,10 @@ void device_debug::breakpoint_update_flags()
 
 void device_debug::breakpoint_check(offs_t pc)
 {
-	// see if we match
-	for (breakpoint *bp = m_bplist; bp != NULL; bp = bp->m_next)
+	// only the breakpoints hashed to this PC can match
+	for (breakpoint **bucket = m_bpindex->m_bucket[bp_hash(pc)]; *bucket != NULL; bucket++)
+	{
+		breakpoint *bp = *bucket;
 		if (bp->hit(pc))
 		{
 			// halt in the debugger by default
@@ -2554,6 +2889,7 @@ void device_debug::breakpoint_check(offs_t pc)
 				debug_console_printf(m_device.machine, "Stopped at breakpoint %X\n", bp->m_index);
 			break;
 		}
+	}
 }
 
 
@@ -2569,8 +2905,15 @@ void device_debug::watchpoint_update_flags(const address_space &space)
 	if (m_hotspots != NULL)
 		enableread = true;
 
-	// see if there are any enabled breakpoints
+	// heatmaps need to see everything in their space
 	bool enablewrite = false;
+	if (m_heatmap[space.spacenum] != NULL)
+		enableread = enablewrite = true;
+
+	// rebuild the lookup index for this space
+	watchpoint_index_rebuild(space);
+
+	// see if there are any enabled breakpoints
 	for (watchpoint *wp = m_wplist[space.spacenum]; wp != NULL; wp = wp->m_next)
 		if (wp->m_enabled)
 		{
@@ -2631,8 +2974,11 @@ void device_debug::watchpoint_check(const address_space &space, int type, offs_t
 	if (type & WATCHPOINT_WRITE)
 		global->wpdata = value_to_write;
 
-	// see if we match
-	for (watchpoint *wp = m_wplist[space.spacenum]; wp != NULL; wp = wp->m_next)
+	// only the watchpoints indexed under the page of the access can match
+	watchpoint **bucket = (m_wpindex[space.spacenum] != NULL) ? m_wpindex[space.spacenum]->m_bucket[wp_hash(address)] : NULL;
+	for ( ; bucket != NULL && *bucket != NULL; bucket++)
+	{
+		watchpoint *wp = *bucket;
 		if (wp->hit(type, address, size))
 		{
 			// halt in the debugger by default
@@ -2667,11 +3013,136 @@ void device_debug::watchpoint_check(const address_space &space, int type, offs_t
 			}
 			break;
 		}
+	}
 
 	global->within_instruction_hook = FALSE;
 }
 
 
+//-------------------------------------------------
+//  breakpoint_index_rebuild - rebuild the hash
+//  of enabled breakpoints by PC
+//-------------------------------------------------
+
+void device_debug::breakpoint_index_rebuild()
+{
+	// free the old index
+	if (m_bpindex != NULL)
+	{
+		auto_free(m_device.machine, m_bpindex->m_pool);
+		auto_free(m_device.machine, m_bpindex);
+		m_bpindex = NULL;
+	}
+
+	// count the enabled breakpoints per bucket
+	int count[BP_HASH_SIZE] = { 0 };
+	int total = 0;
+	for (breakpoint *bp = m_bplist; bp != NULL; bp = bp->m_next)
+		if (bp->m_enabled)
+		{
+			count[bp_hash(bp->m_address)]++;
+			total++;
+		}
+	if (total == 0)
+		return;
+
+	// carve the pool into NULL-terminated lists; empty buckets share the final NULL
+	m_bpindex = auto_alloc(m_device.machine, breakpoint_index);
+	m_bpindex->m_pool = auto_alloc_array_clear(m_device.machine, breakpoint *, total * 2 + 1);
+	breakpoint **next = m_bpindex->m_pool;
+	for (int bucket = 0; bucket < BP_HASH_SIZE; bucket++)
+	{
+		m_bpindex->m_bucket[bucket] = (count[bucket] != 0) ? next : &m_bpindex->m_pool[total * 2];
+		if (count[bucket] != 0)
+			next += count[bucket] + 1;
+		count[bucket] = 0;
+	}
+
+	// fill in list order, so the first match is the same as walking the list
+	for (breakpoint *bp = m_bplist; bp != NULL; bp = bp->m_next)
+		if (bp->m_enabled)
+		{
+			int bucket = bp_hash(bp->m_address);
+			m_bpindex->m_bucket[bucket][count[bucket]++] = bp;
+		}
+}
+
+
+//-------------------------------------------------
+//  watchpoint_index_rebuild - rebuild the hash
+//  of enabled watchpoints by page for a space
+//-------------------------------------------------
+
+void device_debug::watchpoint_index_rebuild(const address_space &space)
+{
+	watchpoint_index *&index = m_wpindex[space.spacenum];
+
+	// free the old index
+	if (index != NULL)
+	{
+		auto_free(m_device.machine, index->m_pool);
+		auto_free(m_device.machine, index);
+		index = NULL;
+	}
+
+	// two passes: the first counts the entries per bucket, the second fills them in
+	int count[WP_HASH_SIZE] = { 0 };
+	watchpoint *last[WP_HASH_SIZE];
+	int total = 0;
+	for (int pass = 0; pass < 2; pass++)
+	{
+		memset(last, 0, sizeof(last));
+		for (watchpoint *wp = m_wplist[space.spacenum]; wp != NULL; wp = wp->m_next)
+		{
+			if (!wp->m_enabled || wp->m_length == 0)
+				continue;
+
+			// accesses are up to 8 bytes and are looked up by the page of their first byte,
+			// so index from 7 bytes before the start; anything that wraps goes everywhere
+			offs_t first = wp->m_address - 7, lastbyte = wp->m_address + wp->m_length - 1;
+			offs_t numpages = (lastbyte >> WP_PAGE_SHIFT) - (first >> WP_PAGE_SHIFT) + 1;
+			if (wp->m_address < 7 || lastbyte < wp->m_address || numpages >= WP_HASH_SIZE)
+			{
+				first = 0;
+				numpages = WP_HASH_SIZE;
+			}
+
+			// add to each bucket once, even if several pages hash to it
+			for (offs_t page = 0; page < numpages; page++)
+			{
+				int bucket = (numpages == WP_HASH_SIZE) ? page : wp_hash(first + (page << WP_PAGE_SHIFT));
+				if (last[bucket] == wp)
+					continue;
+				last[bucket] = wp;
+				if (pass == 0)
+				{
+					count[bucket]++;
+					total++;
+				}
+				else
+					index->m_bucket[bucket][count[bucket]++] = wp;
+			}
+		}
+		if (total == 0)
+			return;
+
+		// after counting, carve the pool into NULL-terminated lists
+		if (pass == 0)
+		{
+			index = auto_alloc(m_device.machine, watchpoint_index);
+			index->m_pool = auto_alloc_array_clear(m_device.machine, watchpoint *, total + WP_HASH_SIZE);
+			watchpoint **next = index->m_pool;
+			for (int bucket = 0; bucket < WP_HASH_SIZE; bucket++)
+			{
+				index->m_bucket[bucket] = next;
+				next += count[bucket] + 1;
+				count[bucket] = 0;
+			}
+		}
+	}
+}
+
+
 //-------------------------------------------------
 //  hotspot_check - check for hotspots on a
 //  memory read access
@@ -2717,6 +3188,114 @@ void device_debug::hotspot_check(const address_space &space, offs_t address)
 }
 
 
+//-------------------------------------------------
+//  heatmap_count - bump the read or write counter
+//  for the line holding an access
+//-------------------------------------------------
+
+void device_debug::heatmap_count(const address_space &space, offs_t address, UINT64 mem_mask, bool write)
+{
+	// the debugger's own peeks don't count
+	if (space.machine->debugcpu_data->debugger_access)
+		return;
+
+	// point at the first byte the access actually touches
+	if (mem_mask != 0)
+	{
+		int bus_size = space.dbits / 8;
+		int address_offset = 0, size = 0;
+		for ( ; address_offset < bus_size && (mem_mask & 0xff) == 0; mem_mask >>= 8)
+			address_offset++;
+		for ( ; mem_mask != 0; mem_mask >>= 8)
+			size++;
+		if (space.endianness == ENDIANNESS_LITTLE)
+			address += address_offset;
+		else
+			address += bus_size - size - address_offset;
+	}
+
+	heatmap &map = *m_heatmap[space.spacenum];
+	if (address < map.m_start || address > map.m_end)
+		return;
+
+	// find the page, allocating it on first touch
+	offs_t line = (address - map.m_start) >> map.m_lineshift;
+	heatmap_page *&page = map.m_page[line >> HEATMAP_PAGE_SHIFT];
+	if (page == NULL)
+		page = auto_alloc_clear(m_device.machine, heatmap_page);
+
+	// saturate rather than wrap
+	UINT32 &count = write ? page->m_writes[line & ((1 << HEATMAP_PAGE_SHIFT) - 1)] : page->m_reads[line & ((1 << HEATMAP_PAGE_SHIFT) - 1)];
+	if (count != ~(UINT32)0)
+		count++;
+}
+
+
+//-------------------------------------------------
+//  heatmap_write - write the non-zero lines of
+//  every heatmap as one frame window
+//-------------------------------------------------
+
+void device_debug::heatmap_write(FILE &file, UINT64 firstframe, UINT64 lastframe)
+{
+	for (int spacenum = 0; spacenum < ADDRESS_SPACES; spacenum++)
+	{
+		const heatmap *map = m_heatmap[spacenum];
+		if (map == NULL)
+			continue;
+
+		const address_space *space = m_memory->space(spacenum);
+		fprintf(&file, "# cpu '%s' space '%s' frames %" I64FMT "u-%" I64FMT "u linesize %d\n", m_device.tag(), space->name, firstframe, lastframe, 1 << map->m_lineshift);
+		for (UINT32 pagenum = 0; pagenum < map->m_numpages; pagenum++)
+		{
+			const heatmap_page *page = map->m_page[pagenum];
+			if (page == NULL)
+				continue;
+			for (int index = 0; index < (1 << HEATMAP_PAGE_SHIFT); index++)
+				if (page->m_reads[index] != 0 || page->m_writes[index] != 0)
+				{
+					offs_t byte = map->m_start + ((((offs_t)pagenum << HEATMAP_PAGE_SHIFT) + index) << map->m_lineshift);
+					fprintf(&file, "%0*X %u %u\n", space->logaddrchars, memory_byte_to_address(space, byte), page->m_reads[index], page->m_writes[index]);
+				}
+		}
+		fprintf(&file, "\n");
+	}
+}
+
+
+//-------------------------------------------------
+//  profile_dasm - disassembler callback used by
+//  the profiler to follow calls and returns
+//-------------------------------------------------
+
+UINT32 device_debug::profile_dasm(void *param, offs_t pc)
+{
+	device_debug *debug = reinterpret_cast<device_debug *>(param);
+	astring buffer;
+	return debug->dasm_wrapped(buffer, pc);
+}
+
+
+//-------------------------------------------------
+//  profile_opcode - fetch the first few opcode
+//  bytes so the profiler can spot banked or
+//  rewritten code
+//-------------------------------------------------
+
+UINT32 device_debug::profile_opcode(void *param, offs_t pc)
+{
+	device_debug *debug = reinterpret_cast<device_debug *>(param);
+	const address_space *space = debug->m_memory->space(AS_PROGRAM);
+	offs_t pcbyte = memory_address_to_byte(space, pc) & space->bytemask;
+	int numbytes = MIN(debug->max_opcode_bytes(), 4);
+	UINT32 result = 0;
+
+	for (int bytenum = 0; bytenum < numbytes; bytenum++)
+		result = (result << 8) | debug_read_opcode(space, pcbyte + bytenum, 1, FALSE);
+	return result;
+}
+
+
 //-------------------------------------------------
 //  dasm_wrapped - wraps calls to the disassembler
 //  by fetching the opcode bytes to a temporary
@@ -2746,6 +3325,42 @@ UINT32 device_debug::dasm_wrapped(astring &buffer, offs_t pc)
 }
 
 
+//-------------------------------------------------
+//  trace_binary_update - record an instruction
+//  in the binary trace
+//-------------------------------------------------
+
+void device_debug::trace_binary_update(offs_t pc)
+{
+	// note frame changes
+	screen_device *screen = m_device.machine->primary_screen;
+	UINT64 frame = (screen != NULL) ? screen->frame_number() : 0;
+	if (frame != m_bintrace_frame)
+	{
+		bintrace_writer_frame(m_bintrace, frame);
+		m_bintrace_frame = frame;
+	}
+
+	// fetch the opcode bytes the same way dasm_wrapped does
+	const address_space *space = m_memory->space(AS_PROGRAM);
+	offs_t pcbyte = memory_address_to_byte(space, pc) & space->bytemask;
+	UINT8 opbuf[BINTRACE_MAX_OPBYTES], argbuf[BINTRACE_MAX_OPBYTES];
+	int maxbytes = MIN(max_opcode_bytes(), BINTRACE_MAX_OPBYTES);
+	for (int numbytes = 0; numbytes < maxbytes; numbytes++)
+	{
+		opbuf[numbytes] = debug_read_opcode(space, pcbyte + numbytes, 1, FALSE);
+		argbuf[numbytes] = debug_read_opcode(space, pcbyte + numbytes, 1, TRUE);
+	}
+
+	// fetch the registers
+	UINT64 regs[BINTRACE_MAX_REGS];
+	for (int regnum = 0; regnum < m_bintrace_numregs; regnum++)
+		regs[regnum] = m_state->state(m_bintrace_reg[regnum]);
+
+	bintrace_writer_instruction(m_bintrace, pc, m_exec->total_cycles(), opbuf, argbuf, regs);
+}
+
+
 //-------------------------------------------------
 //  get_current_pc - getter callback for a device's
 //  current instruction pointer
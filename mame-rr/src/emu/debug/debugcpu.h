@@ -43,6 +43,8 @@
 #define __DEBUGCPU_H__
 
 #include "express.h"
+#include "bintrace.h"
+#include "cpuprof.h"
 
 
 //**************************************************************************
@@ -204,6 +206,15 @@ public:
 	bool hotspot_tracking_enabled() const { return (m_hotspots != NULL); }
 	void hotspot_track(int numspots, int threshhold);
 
+	// memory heatmaps
+	bool heatmap_enabled(int spacenum) const { return (m_heatmap[spacenum] != NULL); }
+	bool heatmap_track(const address_space &space, offs_t address, offs_t length, int linebytes);
+	void heatmap_stop(const address_space &space);
+	void heatmap_clear();
+	bool heatmap_lookup(int spacenum, offs_t address, UINT32 &reads, UINT32 &writes) const;
+	bool heatmap_save(const char *filename, UINT32 frames);
+	void heatmap_frame();
+
 	// history
 	offs_t history_pc(int index) const;
 
@@ -211,6 +222,14 @@ public:
 	void trace(FILE *file, bool trace_over, const char *action);
 	void trace_printf(const char *fmt, ...);
 	void trace_flush() { if (m_trace != NULL) m_trace->flush(); }
+	bool trace_binary(const char *filename, int numregs = 0, const char *const *regnames = NULL);
+	bool trace_binary_enabled() const { return (m_bintrace != NULL); }
+
+	// profiling and coverage
+	bool profile(const char *filename, UINT32 interval = 64, bool callstacks = false);
+	bool profile_enabled() const { return (m_profiler != NULL); }
+	bool coverage(const char *filename);
+	bool coverage_enabled() const { return (m_coverage != NULL); }
 
 	void reset_transient_flag() { m_flags &= ~DEBUG_FLAG_TRANSIENT; }
 
@@ -221,13 +240,20 @@ private:
 	void compute_debug_flags();
 	void prepare_for_step_overout(offs_t pc);
 	UINT32 dasm_wrapped(astring &buffer, offs_t pc);
+	void trace_binary_update(offs_t pc);
+	static UINT32 profile_dasm(void *param, offs_t pc);
+	static UINT32 profile_opcode(void *param, offs_t pc);
 
 	// breakpoint and watchpoint helpers
 	void breakpoint_update_flags();
 	void breakpoint_check(offs_t pc);
 	void watchpoint_update_flags(const address_space &space);
 	void watchpoint_check(const address_space &space, int type, offs_t address, UINT64 value_to_write, UINT64 mem_mask);
+	void breakpoint_index_rebuild();
+	void watchpoint_index_rebuild(const address_space &space);
 	void hotspot_check(const address_space &space, offs_t address);
+	void heatmap_count(const address_space &space, offs_t address, UINT64 mem_mask, bool write);
+	void heatmap_write(FILE &file, UINT64 firstframe, UINT64 lastframe);
 
 	// symbol get/set callbacks
 	static UINT64 get_current_pc(void *globalref, void *ref);
@@ -272,6 +298,29 @@ private:
 	breakpoint *			m_bplist;					// list of breakpoints
 	watchpoint *			m_wplist[ADDRESS_SPACES];	// watchpoint lists for each address space
 
+	// breakpoint and watchpoint lookup; each bucket is a NULL-terminated list of the
+	// enabled points that might match, kept in the same order as the lists above
+	static const int BP_HASH_SIZE = 1024;				// buckets, hashed by PC
+	static const int WP_HASH_SIZE = 256;				// buckets, hashed by page
+	static const int WP_PAGE_SHIFT = 8;					// size of a watchpoint page
+
+	struct breakpoint_index
+	{
+		breakpoint **		m_bucket[BP_HASH_SIZE];		// candidate lists
+		breakpoint **		m_pool;						// storage for the lists
+	};
+	breakpoint_index *		m_bpindex;					// breakpoint index, or NULL if none are enabled
+
+	struct watchpoint_index
+	{
+		watchpoint **		m_bucket[WP_HASH_SIZE];		// candidate lists
+		watchpoint **		m_pool;						// storage for the lists
+	};
+	watchpoint_index *		m_wpindex[ADDRESS_SPACES];	// watchpoint index per address space
+
+	static int bp_hash(offs_t pc) { return (pc ^ (pc >> 10)) & (BP_HASH_SIZE - 1); }
+	static int wp_hash(offs_t address) { offs_t page = address >> WP_PAGE_SHIFT; return (page ^ (page >> 8)) & (WP_HASH_SIZE - 1); }
+
 	// tracing
 	class tracer
 	{
@@ -299,6 +348,18 @@ private:
 	};
 	tracer *				m_trace;					// tracer state
 
+	// binary tracing
+	bintrace_writer *		m_bintrace;					// binary trace writer
+	int						m_bintrace_reg[BINTRACE_MAX_REGS]; // state indexes of the traced registers
+	int						m_bintrace_numregs;			// number of traced registers
+	UINT64					m_bintrace_frame;			// last frame noted in the binary trace
+
+	// profiling and coverage; the results are written when they are turned off
+	cpu_profiler *			m_profiler;					// sampling profiler
+	FILE *					m_profile_file;				// file receiving the profile
+	cpu_coverage *			m_coverage;					// executed address bitmap
+	FILE *					m_coverage_file;			// file receiving the coverage
+
 	// hotspots
 	struct hotspot_entry
 	{
@@ -311,6 +372,29 @@ private:
 	int						m_hotspot_count;			// number of hotspots
 	int						m_hotspot_threshhold;		// threshhold for the number of hits to print
 
+	// memory heatmaps; counters are kept per line of 2^m_lineshift bytes, in pages
+	// that are only allocated once something inside them is touched
+	static const int HEATMAP_PAGE_SHIFT = 8;			// log2 of lines per counter page
+	static const int HEATMAP_MAX_PAGES = 65536;		// largest page directory we will allocate
+
+	struct heatmap_page
+	{
+		UINT32				m_reads[1 << HEATMAP_PAGE_SHIFT];	// read counts per line
+		UINT32				m_writes[1 << HEATMAP_PAGE_SHIFT];	// write counts per line
+	};
+	struct heatmap
+	{
+		offs_t				m_start;					// first byte tracked (line aligned)
+		offs_t				m_end;						// last byte tracked
+		UINT8				m_lineshift;				// log2 of bytes per line
+		UINT32				m_numpages;					// number of entries in m_page
+		heatmap_page **		m_page;						// counter pages, or NULL if untouched
+	};
+	heatmap *				m_heatmap[ADDRESS_SPACES];	// heatmap per address space
+	FILE *					m_heatmap_file;				// file receiving frame windows
+	UINT32					m_heatmap_window;			// frames per window
+	UINT64					m_heatmap_window_start;		// first frame of the current window
+
 	// internal flag values
 	static const UINT32 DEBUG_FLAG_OBSERVING		= 0x00000001;		// observing this CPU
 	static const UINT32 DEBUG_FLAG_HISTORY			= 0x00000002;		// tracking this CPU's history
@@ -131,6 +131,11 @@ static const help_item static_help_list[] =
 		"  trace {<filename>|OFF}[,<cpu>[,<action>]] -- trace the given CPU to a file (defaults to active CPU)\n"
 		"  traceover {<filename>|OFF}[,<cpu>[,<action>]] -- trace the given CPU to a file, but skip subroutines (defaults to active CPU)\n"
 		"  traceflush -- flushes all open trace files\n"
+		"  tracebin {<filename>|OFF}[,<cpu>[,<reg>[,...]]] -- trace the given CPU to a compact binary file\n"
+		"  tracedasm <tracefile>,<outfile>[,<startpc>[,<endpc>]] -- disassembles a binary trace to a text file\n"
+		"  tracehot <tracefile>[,<count>[,<startpc>[,<endpc>]]] -- lists the most executed PCs in a binary trace\n"
+		"  profile {<filename>|OFF}[,<cpu>[,<interval>[,<stacks>]]] -- samples the given CPU's PC into a folded profile\n"
+		"  coverage {<filename>|OFF}[,<cpu>] -- records every address the given CPU executes\n"
 	},
 	{
 		"breakpoints",
@@ -158,6 +163,9 @@ static const help_item static_help_list[] =
 		"  wpenable [<wpnum>] -- enables a given watchpoint or all if no <wpnum> specified\n"
 		"  wplist -- lists all the watchpoints\n"
 		"  hotspot [<cpu>,[<depth>[,<hits>]]] -- attempt to find hotspots\n"
+		"  heatmap[{d|i}] {<address>,<length>[,<linesize>]|off} -- counts reads/writes per line of memory\n"
+		"  heatmapclear [<cpu>] -- zeroes the heatmap counters\n"
+		"  heatmapsave {<filename>|off}[,<frames>[,<cpu>]] -- saves the heatmap counts to <filename>\n"
 	},
 	{
 		"expressions",
@@ -216,6 +224,11 @@ static const help_item static_help_list[] =
 		"  cheatnextf <condition>[,<comparisonvalue>] -- continue cheat search comparing with the the first value\n"
 		"  cheatlist [<filename>] -- show the list of cheat search matches or save them to <filename>\n"
 		"  cheatundo -- undo the last cheat search (state only)\n"
+		"  rsinit [<size>[,<signed>[,<cpu>]]] -- start a RAM search over all of the CPU's RAM\n"
+		"  rsupdate -- take a new snapshot and count the values that changed\n"
+		"  rsnext <condition>[,<value>[,<param>]] -- narrow down the RAM search\n"
+		"  rschanges <condition>,<count> -- narrow down the RAM search by change count\n"
+		"  rslist [<max>[,<first>]] -- show the RAM search results\n"
 	},
 	{
 		"do",
@@ -745,6 +758,106 @@ static const help_item static_help_list[] =
 		"\n"
 		"Flushes all open trace files.\n"
 	},
+	{
+		"tracebin",
+		"\n"
+		"  tracebin {<filename>|OFF}[,<cpu>[,<reg>[,...]]]\n"
+		"\n"
+		"Starts or stops a binary trace of the execution of the specified <cpu>. If <cpu> is omitted, "
+		"the currently active CPU is specified. Each instruction is recorded with its PC, its opcode "
+		"bytes, the cycle count and the values of up to 16 registers named by the <reg> parameters; "
+		"frame boundaries are recorded as well. The file is compressed in the background, so it is far "
+		"smaller and much cheaper to write than a trace made with the trace command. Use tracedasm and "
+		"tracehot to look at it afterwards. To disable tracing, substitute the keyword 'off' for "
+		"<filename>.\n"
+		"\n"
+		"Examples:\n"
+		"\n"
+		"tracebin joust.trb\n"
+		"  Begin tracing the currently active CPU to joust.trb.\n"
+		"\n"
+		"tracebin sf2.trb,0,d0,a7\n"
+		"  Begin tracing CPU #0 to sf2.trb, recording the D0 and A7 registers with each instruction.\n"
+		"\n"
+		"tracebin off,0\n"
+		"  Turn off binary tracing on CPU #0.\n"
+	},
+	{
+		"tracedasm",
+		"\n"
+		"  tracedasm <tracefile>,<outfile>[,<startpc>[,<endpc>]]\n"
+		"\n"
+		"Disassembles the binary trace <tracefile> made with tracebin into the text file <outfile>. "
+		"The disassembly uses the opcode bytes stored in the trace, so it is correct even if the code "
+		"has changed since. Only instructions between <startpc> and <endpc> are written if those are "
+		"given. The trace must have been recorded from a CPU of the current machine.\n"
+		"\n"
+		"Examples:\n"
+		"\n"
+		"tracedasm joust.trb,joust.txt\n"
+		"  Disassemble all of joust.trb to joust.txt.\n"
+		"\n"
+		"tracedasm joust.trb,joust.txt,d000,dfff\n"
+		"  Disassemble only the instructions from d000 to dfff.\n"
+	},
+	{
+		"tracehot",
+		"\n"
+		"  tracehot <tracefile>[,<count>[,<startpc>[,<endpc>]]]\n"
+		"\n"
+		"Reads the binary trace <tracefile> made with tracebin and lists the <count> most frequently "
+		"executed PCs, along with the number of cycles spent on each. <count> defaults to 20. Only PCs "
+		"between <startpc> and <endpc> are counted if those are given.\n"
+		"\n"
+		"Examples:\n"
+		"\n"
+		"tracehot joust.trb\n"
+		"  List the 20 most executed PCs in joust.trb.\n"
+		"\n"
+		"tracehot joust.trb,50,d000,dfff\n"
+		"  List the 50 most executed PCs from d000 to dfff.\n"
+	},
+	{
+		"profile",
+		"\n"
+		"  profile {<filename>|OFF}[,<cpu>[,<interval>[,<stacks>]]]\n"
+		"\n"
+		"Samples the PC of <cpu>, which defaults to the active CPU, every <interval> instructions "
+		"(64 by default). If <stacks> is non-zero, calls and returns are followed using the "
+		"disassembler's step over/out information so each sample is charged to its call stack; "
+		"otherwise the profile is flat. When profiling is turned off, or MAME exits, the samples are "
+		"written to <filename> in folded stack format, one 'entry;entry;pc count' line per distinct "
+		"stack, which flamegraph.pl and most profile viewers accept.\n"
+		"\n"
+		"Examples:\n"
+		"\n"
+		"profile joust.folded\n"
+		"  Samples the active CPU every 64 instructions.\n"
+		"\n"
+		"profile joust.folded,0,1,1\n"
+		"  Samples every instruction of CPU 0 along with its call stack.\n"
+		"\n"
+		"profile off\n"
+		"  Stops profiling the active CPU and writes the file.\n"
+	},
+	{
+		"coverage",
+		"\n"
+		"  coverage {<filename>|OFF}[,<cpu>]\n"
+		"\n"
+		"Marks every address <cpu>, which defaults to the active CPU, executes an instruction from. "
+		"When coverage is turned off, or MAME exits, the addresses are written to <filename> one per "
+		"line in ascending order, so the coverage of two runs (for instance two playbacks of different "
+		"movies) can be compared with diff.\n"
+		"\n"
+		"Examples:\n"
+		"\n"
+		"coverage run1.cov\n"
+		"  Starts recording the active CPU's coverage.\n"
+		"\n"
+		"coverage off\n"
+		"  Stops recording and writes run1.cov.\n"
+	},
 	{
 		"bpset",
 		"\n"
@@ -970,6 +1083,58 @@ static const help_item static_help_list[] =
 		"  Looks for hotspots on CPU 1 using a search buffer of 64 entries, reporting any entries which "
 		"end up with 1000 or more hits.\n"
 	},
+	{
+		"heatmap",
+		"\n"
+		"  heatmap[{d|i}] {<address>,<length>[,<linesize>]|off}\n"
+		"\n"
+		"The heatmap/heatmapd/heatmapi commands count every read and write the current CPU makes to "
+		"<length> bytes of program, data or I/O space starting at <address>. One pair of counters is kept "
+		"per <linesize> bytes; <linesize> must be a power of two and defaults to 16. Counter pages are "
+		"only allocated once something inside them is touched, so large ranges are cheap if they are "
+		"mostly idle. While a heatmap is active the space goes through the same slow path as "
+		"watchpoints; it costs nothing once turned off. Passing 'off' stops counting and frees the "
+		"counters. Memory windows can colour their contents by these counts.\n"
+		"\n"
+		"Examples:\n"
+		"\n"
+		"heatmap c000,2000\n"
+		"  Counts accesses to the 8k of program space at c000, one pair of counters per 16 bytes.\n"
+		"\n"
+		"heatmapd 0,100,1\n"
+		"  Counts accesses to each of the first 256 bytes of data space separately.\n"
+		"\n"
+		"heatmap off\n"
+		"  Stops counting program space accesses.\n"
+	},
+	{
+		"heatmapclear",
+		"\n"
+		"  heatmapclear [<cpu>]\n"
+		"\n"
+		"The heatmapclear command zeroes every heatmap counter on <cpu>, which defaults to the current "
+		"CPU, without stopping the counting.\n"
+	},
+	{
+		"heatmapsave",
+		"\n"
+		"  heatmapsave {<filename>|off}[,<frames>[,<cpu>]]\n"
+		"\n"
+		"The heatmapsave command writes the heatmaps of <cpu>, which defaults to the current CPU, to "
+		"<filename> as text: a header per address space giving the frames covered, then one line per "
+		"touched line of memory holding its address, read count and write count. Without <frames> the "
+		"counts so far are written once. With <frames>, the file is kept open and a new window is "
+		"appended and the counters cleared every <frames> frames, until 'heatmapsave off' or the "
+		"heatmap is turned off.\n"
+		"\n"
+		"Examples:\n"
+		"\n"
+		"heatmapsave ram.txt\n"
+		"  Saves the current counts to ram.txt.\n"
+		"\n"
+		"heatmapsave ram.txt,60\n"
+		"  Writes one window per 60 frames to ram.txt.\n"
+	},
 	{
 		"map",
 		"\n"
@@ -1192,6 +1357,81 @@ static const help_item static_help_list[] =
 		"\n"
 		"cheatundo\n"
 		"  Undo the last search (state only).\n"
+	},
+	{
+		"rsinit",
+		"\n"
+		"  rsinit [<size>[,<signed>[,<cpu>]]]\n"
+		"\n"
+		"The rsinit command takes a snapshot of all the RAM in the program space of <cpu> and makes "
+		"every aligned value of <size> bytes (1, 2 or 4; default 1) a candidate. If <signed> is non-zero "
+		"the values are treated as signed. Unlike cheatinit, the search works on snapshots and keeps its "
+		"candidates in a bitmap, so it stays fast on large RAM areas.\n"
+		"\n"
+		"Examples:\n"
+		"\n"
+		"rsinit\n"
+		"  Start a search for unsigned bytes in the current CPU's RAM.\n"
+		"\n"
+		"rsinit 2,1\n"
+		"  Start a search for signed words.\n"
+	},
+	{
+		"rsupdate",
+		"\n"
+		"  rsupdate\n"
+		"\n"
+		"Takes a new snapshot and increments the change count of every value that differs from the "
+		"last snapshot. Searches do this implicitly; call it in between to count changes.\n"
+	},
+	{
+		"rsnext",
+		"\n"
+		"  rsnext <condition>[,<value>[,<param>]]\n"
+		"\n"
+		"Takes a new snapshot and keeps only the values for which <condition> holds. Without <value>, "
+		"each value is compared against its value at the last search; otherwise against <value>.\n"
+		"Possible <condition>:\n"
+		"  lt [<], gt [>], le [<=], ge [>=], eq [==], ne [!=]\n"
+		"  diffby -- the values differ by <param>\n"
+		"  modulo [mod] -- the value modulo <param> equals <value>\n"
+		"\n"
+		"Examples:\n"
+		"\n"
+		"rsnext lt\n"
+		"  Keep the values that decreased since the last search.\n"
+		"\n"
+		"rsnext eq,3\n"
+		"  Keep the values that are now 3.\n"
+		"\n"
+		"rsnext diffby,,1\n"
+		"  Keep the values that changed by exactly 1.\n"
+	},
+	{
+		"rschanges",
+		"\n"
+		"  rschanges <condition>,<count>\n"
+		"\n"
+		"Keeps only the values whose change count satisfies <condition> against <count>. The conditions "
+		"are the same as for rsnext.\n"
+		"\n"
+		"Examples:\n"
+		"\n"
+		"rschanges eq,0\n"
+		"  Keep the values that never changed.\n"
+	},
+	{
+		"rslist",
+		"\n"
+		"  rslist [<max>[,<first>]]\n"
+		"\n"
+		"Shows up to <max> (default 100) of the remaining values, starting at result number <first>, "
+		"with their current and previous values and change counts.\n"
+		"\n"
+		"Examples:\n"
+		"\n"
+		"rslist\n"
+		"  Show the first 100 results.\n"
 	}
 };
 
@@ -0,0 +1,541 @@
+/*********************************************************************
+
+    debugsrv.c
+
+    Headless debugger access over a local socket.
+
+    Copyright Nicola Salmoria and the MAME Team.
+    Visit http://mamedev.org for licensing and usage restrictions.
+
+**********************************************************************
+
+    The protocol is line based. Each request is a single line; lines
+    starting with '.' are requests handled here, anything else is run
+    as a debugger console command. Each response is any number of
+    data lines followed by a line reading "OK" or "ERROR <reason>":
+
+        - <text>        a line of console output
+        = <text>        a line of structured data
+
+    Requests:
+
+        .status
+            "= running", or "= stopped <cpu> <pc>"
+
+        .read <cpu> <space> <address> <length>
+            one "= " line with the bytes in hex; <space> is program,
+            data or io (or p/d/i); logical addresses are translated;
+            <address> and <length> are debugger expressions
+
+        .regs [<cpu>]
+            one "= <name> <value>" line per register, value in hex
+
+        .quit
+            close the connection
+
+    While nobody is connected, or nothing has been sent, the emulation
+    is not held up; whenever execution stops, "* stopped <cpu> <pc>" is
+    sent to the client unprompted.
+
+*********************************************************************/
+
+#include "emu.h"
+#include "debugsrv.h"
+#include "debugcon.h"
+#include "debugcpu.h"
+#include "express.h"
+#include "debugger.h"
+#include <ctype.h>
+
+
+
+/***************************************************************************
+    CONSTANTS
+***************************************************************************/
+
+#define MAX_LINE_LENGTH		4096
+#define MAX_READ_LENGTH		(1024 * 1024)
+
+
+
+/***************************************************************************
+    TYPE DEFINITIONS
+***************************************************************************/
+
+typedef struct _debug_server debug_server;
+struct _debug_server
+{
+	running_machine *	machine;						/* owning machine */
+	osd_socket *		listener;						/* listening socket */
+	osd_socket *		client;							/* connected client, or NULL */
+	char				line[MAX_LINE_LENGTH];			/* partial request line */
+	int					linelen;						/* bytes in line */
+	int					overflow;						/* TRUE if the current line is too long */
+	int					within_poll;					/* TRUE while handling requests */
+};
+
+
+
+/***************************************************************************
+    LOCAL VARIABLES
+***************************************************************************/
+
+static debug_server *server;
+
+
+
+/***************************************************************************
+    FUNCTION PROTOTYPES
+***************************************************************************/
+
+static void debug_server_exit(running_machine &machine);
+static int server_poll(running_machine *machine);
+static void server_execute(running_machine *machine, char *line, astring &response);
+static void server_read_memory(running_machine *machine, int params, char **param, astring &response);
+static void server_registers(running_machine *machine, int params, char **param, astring &response);
+static device_t *server_find_cpu(running_machine *machine, const char *tag);
+static void server_send(const astring &response);
+static void server_disconnect(void);
+
+
+
+/***************************************************************************
+    INITIALIZATION
+***************************************************************************/
+
+/*-------------------------------------------------
+    debug_server_init - start listening for a
+    client on the given port
+-------------------------------------------------*/
+
+void debug_server_init(running_machine *machine, int port)
+{
+	osd_socket *listener = osd_socket_listen(port);
+
+	/* with nobody able to connect, a stopped CPU could never be resumed */
+	if (listener == NULL)
+		fatalerror("Unable to listen for debugger clients on port %d", port);
+	mame_printf_info("Listening for debugger clients on port %d\n", port);
+
+	server = global_alloc_clear(debug_server);
+	server->machine = machine;
+	server->listener = listener;
+
+	machine->add_notifier(MACHINE_NOTIFY_EXIT, debug_server_exit);
+}
+
+
+/*-------------------------------------------------
+    debug_server_exit - close the sockets
+-------------------------------------------------*/
+
+static void debug_server_exit(running_machine &machine)
+{
+	if (server != NULL)
+	{
+		server_disconnect();
+		osd_socket_close(server->listener);
+		global_free(server);
+		server = NULL;
+	}
+}
+
+
+
+/***************************************************************************
+    EXECUTION HOOKS
+***************************************************************************/
+
+/*-------------------------------------------------
+    debug_server_wait_for_debugger - handle
+    requests while execution is stopped, sleeping
+    briefly if there was nothing to do
+-------------------------------------------------*/
+
+void debug_server_wait_for_debugger(device_t *device, int firststop)
+{
+	/* with no server, nobody could ever resume us, so just carry on */
+	if (server == NULL)
+	{
+		device->debug()->go();
+		return;
+	}
+
+	/* tell the client where we stopped */
+	if (firststop && server->client != NULL)
+	{
+		astring response;
+		response.printf("* stopped %s %X\n", device->tag(), (int)cpu_get_pc(device));
+		server_send(response);
+	}
+
+	if (!server_poll(device->machine))
+		osd_sleep(osd_ticks_per_second() / 1000);
+}
+
+
+/*-------------------------------------------------
+    debug_server_update_during_game - handle
+    any pending requests without blocking
+-------------------------------------------------*/
+
+void debug_server_update_during_game(running_machine *machine)
+{
+	if (server != NULL && !debug_cpu_is_stopped(machine) && machine->phase() == MACHINE_PHASE_RUNNING)
+		server_poll(machine);
+}
+
+
+
+/***************************************************************************
+    CONNECTION HANDLING
+***************************************************************************/
+
+/*-------------------------------------------------
+    server_poll - accept a client and execute any
+    complete request lines; returns TRUE if
+    anything happened
+-------------------------------------------------*/
+
+static int server_poll(running_machine *machine)
+{
+	int wasstopped = debug_cpu_is_stopped(machine);
+	int didwork = FALSE;
+
+	/* commands can refresh the display, which lands us back here */
+	if (server->within_poll)
+		return FALSE;
+	server->within_poll = TRUE;
+
+	/* pick up a new client if we don't have one */
+	if (server->client == NULL)
+	{
+		server->client = osd_socket_accept(server->listener);
+		if (server->client != NULL)
+		{
+			astring response;
+			server->linelen = 0;
+			server->overflow = FALSE;
+			response.printf("* hello %s\n", machine->gamedrv->name);
+			server_send(response);
+			didwork = TRUE;
+		}
+	}
+
+	/* handle what has arrived, stopping if a command resumed execution */
+	while (server->client != NULL && !(wasstopped && !debug_cpu_is_stopped(machine)))
+	{
+		char *eol = (char *)memchr(server->line, '\n', server->linelen);
+		UINT32 actual;
+
+		/* read more if there is no complete line yet */
+		if (eol == NULL)
+		{
+			if (server->linelen == MAX_LINE_LENGTH)
+			{
+				server->linelen = 0;
+				server->overflow = TRUE;
+			}
+			if (osd_socket_read(server->client, &server->line[server->linelen], MAX_LINE_LENGTH - server->linelen, &actual) != FILERR_NONE)
+			{
+				server_disconnect();
+				break;
+			}
+			if (actual == 0)
+				break;
+			server->linelen += actual;
+			didwork = TRUE;
+			continue;
+		}
+
+		/* pull the line out of the buffer */
+		*eol = 0;
+		if (eol > server->line && eol[-1] == '\r')
+			eol[-1] = 0;
+
+		/* execute it and send the response */
+		{
+			char request[MAX_LINE_LENGTH];
+			int consumed = eol + 1 - server->line;
+			astring response;
+
+			strcpy(request, server->line);
+			memmove(server->line, eol + 1, server->linelen - consumed);
+			server->linelen -= consumed;
+
+			if (server->overflow)
+			{
+				response.cpy("ERROR line too long\n");
+				server->overflow = FALSE;
+			}
+			else
+				server_execute(machine, request, response);
+			if (server->client != NULL)
+				server_send(response);
+		}
+		didwork = TRUE;
+	}
+
+	server->within_poll = FALSE;
+	return didwork;
+}
+
+
+/*-------------------------------------------------
+    server_send - send a response to the client
+-------------------------------------------------*/
+
+static void server_send(const astring &response)
+{
+	if (server->client != NULL && osd_socket_write(server->client, response.cstr(), response.len()) != FILERR_NONE)
+		server_disconnect();
+}
+
+
+/*-------------------------------------------------
+    server_disconnect - drop the current client
+-------------------------------------------------*/
+
+static void server_disconnect(void)
+{
+	if (server->client != NULL)
+		osd_socket_close(server->client);
+	server->client = NULL;
+	server->linelen = 0;
+}
+
+
+
+/***************************************************************************
+    REQUESTS
+***************************************************************************/
+
+/*-------------------------------------------------
+    server_execute - execute a single request
+    line and build the response
+-------------------------------------------------*/
+
+static void server_execute(running_machine *machine, char *line, astring &response)
+{
+	char *param[8];
+	int params = 0;
+	char *p;
+
+	/* skip leading spaces; ignore blank lines */
+	while (isspace((UINT8)*line))
+		line++;
+	if (*line == 0)
+	{
+		response.cpy("OK\n");
+		return;
+	}
+
+	/* anything not starting with a dot is a console command */
+	if (*line != '.')
+	{
+		astring output;
+		CMDERR result;
+		int start;
+
+		debug_console_capture(&output);
+		result = debug_console_execute_command(machine, line, FALSE);
+		debug_console_capture(NULL);
+
+		/* prefix each line of output */
+		for (start = 0; start < output.len(); )
+		{
+			int end = output.chr(start, '\n');
+			if (end == -1)
+				end = output.len();
+			response.cat("- ").catsubstr(output, start, end - start).cat("\n");
+			start = end + 1;
+		}
+
+		if (result == CMDERR_NONE)
+			response.cat("OK\n");
+		else
+			response.catprintf("ERROR %s\n", debug_cmderr_to_string(result));
+		return;
+	}
+
+	/* split the request into space-separated words */
+	for (p = line + 1; *p != 0 && params < ARRAY_LENGTH(param); )
+	{
+		param[params++] = p;
+		while (*p != 0 && !isspace((UINT8)*p))
+			p++;
+		if (*p != 0)
+			*p++ = 0;
+		while (isspace((UINT8)*p))
+			p++;
+	}
+	if (params == 0)
+	{
+		response.cpy("ERROR missing request\n");
+		return;
+	}
+
+	/* status */
+	if (strcmp(param[0], "status") == 0)
+	{
+		device_t *cpu = debug_cpu_get_visible_cpu(machine);
+		if (debug_cpu_is_stopped(machine) && cpu != NULL)
+			response.printf("= stopped %s %X\nOK\n", cpu->tag(), (int)cpu_get_pc(cpu));
+		else
+			response.cpy("= running\nOK\n");
+	}
+
+	/* memory reads */
+	else if (strcmp(param[0], "read") == 0)
+		server_read_memory(machine, params - 1, &param[1], response);
+
+	/* register reads */
+	else if (strcmp(param[0], "regs") == 0)
+		server_registers(machine, params - 1, &param[1], response);
+
+	/* disconnect */
+	else if (strcmp(param[0], "quit") == 0)
+	{
+		astring goodbye("OK\n");
+		server_send(goodbye);
+		server_disconnect();
+	}
+
+	else
+		response.printf("ERROR unknown request '%s'\n", param[0]);
+}
+
+
+/*-------------------------------------------------
+    server_read_memory - handle .read
+-------------------------------------------------*/
+
+static void server_read_memory(running_machine *machine, int params, char **param, astring &response)
+{
+	static const char hexdigits[] = "0123456789abcdef";
+	const address_space *space;
+	UINT64 address, length;
+	device_t *cpu;
+	char *hex;
+	int spacenum;
+	offs_t offset;
+	UINT32 index;
+	int bytenum;
+
+	if (params != 4)
+	{
+		response.cpy("ERROR expected <cpu> <space> <address> <length>\n");
+		return;
+	}
+
+	/* find the CPU and space */
+	cpu = server_find_cpu(machine, param[0]);
+	if (cpu == NULL)
+	{
+		response.printf("ERROR unknown cpu '%s'\n", param[0]);
+		return;
+	}
+	if (strcmp(param[1], "program") == 0 || strcmp(param[1], "p") == 0)
+		spacenum = ADDRESS_SPACE_PROGRAM;
+	else if (strcmp(param[1], "data") == 0 || strcmp(param[1], "d") == 0)
+		spacenum = ADDRESS_SPACE_DATA;
+	else if (strcmp(param[1], "io") == 0 || strcmp(param[1], "i") == 0)
+		spacenum = ADDRESS_SPACE_IO;
+	else
+	{
+		response.printf("ERROR unknown space '%s'\n", param[1]);
+		return;
+	}
+	space = cpu_get_address_space(cpu, spacenum);
+	if (space == NULL)
+	{
+		response.printf("ERROR %s has no %s space\n", cpu->tag(), param[1]);
+		return;
+	}
+
+	/* evaluate the address and length */
+	if (expression_evaluate(param[2], debug_cpu_get_global_symtable(machine), &debug_expression_callbacks, machine, &address) != EXPRERR_NONE ||
+		expression_evaluate(param[3], debug_cpu_get_global_symtable(machine), &debug_expression_callbacks, machine, &length) != EXPRERR_NONE)
+	{
+		response.cpy("ERROR invalid address or length\n");
+		return;
+	}
+	if (length > MAX_READ_LENGTH)
+	{
+		response.printf("ERROR length is limited to %d bytes\n", MAX_READ_LENGTH);
+		return;
+	}
+
+	/* convert everything in one go */
+	hex = global_alloc_array(char, length * 2 + 1);
+	offset = memory_address_to_byte(space, address);
+	for (index = 0; index < length; )
+	{
+		/* aligned dwords never straddle a page, so each is translated and read once;
+           I/O ports are left to byte reads, since a wider access can have side effects */
+		if (spacenum != ADDRESS_SPACE_IO && ((offset + index) & 3) == 0 && length - index >= 4)
+		{
+			UINT32 data = debug_read_dword(space, offset + index, TRUE);
+			for (bytenum = 0; bytenum < 4; bytenum++, index++)
+			{
+				UINT8 byte = data >> (8 * ((space->endianness == ENDIANNESS_LITTLE) ? bytenum : 3 - bytenum));
+				hex[index * 2 + 0] = hexdigits[byte >> 4];
+				hex[index * 2 + 1] = hexdigits[byte & 15];
+			}
+		}
+		else
+		{
+			UINT8 data = debug_read_byte(space, offset + index, TRUE);
+			hex[index * 2 + 0] = hexdigits[data >> 4];
+			hex[index * 2 + 1] = hexdigits[data & 15];
+			index++;
+		}
+	}
+	hex[length * 2] = 0;
+
+	response.cpy("= ").cat(hex).cat("\nOK\n");
+	global_free(hex);
+}
+
+
+/*-------------------------------------------------
+    server_registers - handle .regs
+-------------------------------------------------*/
+
+static void server_registers(running_machine *machine, int params, char **param, astring &response)
+{
+	device_state_interface *state;
+	device_t *cpu;
+
+	cpu = server_find_cpu(machine, (params > 0) ? param[0] : NULL);
+	if (cpu == NULL || !cpu->interface(state))
+	{
+		response.printf("ERROR unknown cpu '%s'\n", (params > 0) ? param[0] : "");
+		return;
+	}
+
+	response.reset();
+	for (const device_state_entry *entry = state->state_first(); entry != NULL; entry = entry->next())
+		if (entry->visible())
+			response.catprintf("= %s %" I64FMT "X\n", entry->symbol(), state->state(entry->index()));
+	response.cat("OK\n");
+}
+
+
+/*-------------------------------------------------
+    server_find_cpu - find a CPU by tag, or the
+    visible CPU if no tag is given
+-------------------------------------------------*/
+
+static device_t *server_find_cpu(running_machine *machine, const char *tag)
+{
+	device_t *device;
+
+	if (tag == NULL || strcmp(tag, ".") == 0)
+		return debug_cpu_get_visible_cpu(machine);
+
+	for (device = machine->m_devicelist.first(); device != NULL; device = device->next())
+		if (mame_stricmp(device->tag(), tag) == 0 && device->debug() != NULL)
+			return device;
+	return NULL;
+}
@@ -0,0 +1,31 @@
+/***************************************************************************
+
+    debugsrv.h
+
+    Headless debugger access over a local socket.
+
+    Copyright Nicola Salmoria and the MAME Team.
+    Visit http://mamedev.org for licensing and usage restrictions.
+
+***************************************************************************/
+
+#pragma once
+
+#ifndef __DEBUGSRV_H__
+#define __DEBUGSRV_H__
+
+
+/***************************************************************************
+    FUNCTION PROTOTYPES
+***************************************************************************/
+
+/* initialization */
+void debug_server_init(running_machine *machine, int port);
+
+/* called repeatedly while execution is stopped */
+void debug_server_wait_for_debugger(device_t *device, int firststop);
+
+/* called once per frame while running */
+void debug_server_update_during_game(running_machine *machine);
+
+#endif
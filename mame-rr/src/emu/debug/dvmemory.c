@@ -126,6 +126,7 @@ debug_view_memory::debug_view_memory(running_machine &machine, debug_view_osd_up
 	  m_reverse_view(false),
 	  m_ascii_view(true),
 	  m_no_translation(false),
+	  m_heatmap_view(false),
 	  m_maxaddr(0),
 	  m_bytes_per_row(16),
 	  m_byte_offset(0)
@@ -236,6 +237,19 @@ void debug_view_memory::view_update()
 	// get positional data
 	const memory_view_pos &posdata = s_memory_pos_table[m_bytes_per_chunk];
 
+	// for heatmap colouring, find the busiest visible chunk to scale against
+	bool heatmap = (m_heatmap_view && source.m_space != NULL && source.m_space->cpu->debug() != NULL &&
+					source.m_space->cpu->debug()->heatmap_enabled(source.m_space->spacenum));
+	UINT64 heatmax = 0;
+	if (heatmap)
+		for (UINT32 effrow = m_topleft.y; effrow < m_topleft.y + m_visible.y && effrow < m_total.y; effrow++)
+			for (int chunknum = 0; chunknum < m_chunks_per_row; chunknum++)
+			{
+				UINT32 reads, writes;
+				heat(m_bytes_per_chunk, m_byte_offset + effrow * m_bytes_per_row + chunknum * m_bytes_per_chunk, reads, writes);
+				heatmax = MAX(heatmax, (UINT64)reads + writes);
+			}
+
 	// loop over visible rows
 	for (UINT32 row = 0; row < m_visible.y; row++)
 	{
@@ -280,13 +294,29 @@ void debug_view_memory::view_update()
 
 				UINT64 chunkdata;
 				bool ismapped = read(m_bytes_per_chunk, addrbyte + chunknum * m_bytes_per_chunk, chunkdata);
+
+				// busy chunks get a yellow background, others that were touched a grey one; writes show in red
+				UINT8 heatattrib = 0;
+				if (heatmap)
+				{
+					UINT32 reads, writes;
+					heat(m_bytes_per_chunk, addrbyte + chunknum * m_bytes_per_chunk, reads, writes);
+					if (reads != 0 || writes != 0)
+						heatattrib = (((UINT64)reads + writes) * 4 >= heatmax) ? DCA_CURRENT : DCA_ANCILLARY;
+					if (writes != 0)
+						heatattrib |= DCA_CHANGED;
+				}
+
 				dest = destrow + m_section[1].m_pos + 1 + chunkindex * posdata.m_spacing;
 				for (int ch = 0; ch < posdata.m_spacing; ch++, dest++)
 					if (dest >= destmin && dest < destmax)
 					{
 						UINT8 shift = posdata.m_shift[ch];
 						if (shift < 64)
+						{
 							dest->byte = ismapped ? "0123456789ABCDEF"[(chunkdata >> shift) & 0x0f] : '*';
+							dest->attrib |= heatattrib;
+						}
 					}
 			}
 
@@ -800,6 +830,34 @@ void debug_view_memory::set_ascii(bool ascii)
 }
 
 
+//-------------------------------------------------
+//  heat - fetch the heatmap counts for a chunk,
+//  taking the busiest byte within it
+//-------------------------------------------------
+
+void debug_view_memory::heat(UINT8 size, offs_t offs, UINT32 &reads, UINT32 &writes)
+{
+	const debug_view_memory_source &source = downcast<const debug_view_memory_source &>(*m_source);
+	const device_debug &debug = *source.m_space->cpu->debug();
+
+	reads = writes = 0;
+	for (offs_t byte = offs; byte < offs + size; byte++)
+	{
+		// the counters are kept by physical address
+		offs_t physbyte = byte;
+		if (!m_no_translation && !source.m_memintf->translate(source.m_space->spacenum, TRANSLATE_READ_DEBUG, physbyte))
+			continue;
+
+		UINT32 bytereads, bytewrites;
+		if (debug.heatmap_lookup(source.m_space->spacenum, physbyte & source.m_space->bytemask, bytereads, bytewrites))
+		{
+			reads = MAX(reads, bytereads);
+			writes = MAX(writes, bytewrites);
+		}
+	}
+}
+
+
 //-------------------------------------------------
 //  set_physical - specify true if the memory view
 //  should display physical addresses versus
@@ -813,3 +871,18 @@ void debug_view_memory::set_physical(bool physical)
 	m_recompute = m_update_pending = true;
 	end_update_and_set_cursor_pos(pos);
 }
+
+
+//-------------------------------------------------
+//  set_heatmap - specify true if the memory view
+//  should be coloured by the access counts of
+//  the debugger's heatmap for its space
+//-------------------------------------------------
+
+void debug_view_memory::set_heatmap(bool heatmap)
+{
+	begin_update();
+	m_heatmap_view = heatmap;
+	m_update_pending = true;
+	end_update();
+}
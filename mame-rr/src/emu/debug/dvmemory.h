@@ -87,6 +87,7 @@ public:
 	bool reverse() const { return m_reverse_view; }
 	bool ascii() const { return m_ascii_view; }
 	bool physical() const { return m_no_translation; }
+	bool heatmap() const { return m_heatmap_view; }
 
 	// setters
 	void set_expression(const char *expression);
@@ -95,6 +96,7 @@ public:
 	void set_reverse(bool reverse);
 	void set_ascii(bool reverse);
 	void set_physical(bool physical);
+	void set_heatmap(bool heatmap);
 
 protected:
 	// view overrides
@@ -124,6 +126,7 @@ private:
 	// memory access
 	bool read(UINT8 size, offs_t offs, UINT64 &data);
 	void write(UINT8 size, offs_t offs, UINT64 data);
+	void heat(UINT8 size, offs_t offs, UINT32 &reads, UINT32 &writes);
 
 	// internal state
 	debug_view_expression m_expression;			// expression describing the start address
@@ -132,6 +135,7 @@ private:
 	bool				m_reverse_view;			// reverse-endian view?
 	bool				m_ascii_view;			// display ASCII characters?
 	bool				m_no_translation;		// don't run addresses through the cpu translation hook
+	bool				m_heatmap_view;			// colour data by the debugger's access heatmap?
 	offs_t				m_maxaddr;				// (derived) maximum address to display
 	UINT32				m_bytes_per_row;		// (derived) number of bytes displayed per line
 	UINT32				m_byte_offset;			// (derived) offset of starting visible byte
@@ -148,6 +148,24 @@ enum
 };
 
 
+/* compiled_op.opcode values beyond the TVL_* operators, which are used as-is */
+enum
+{
+	COP_NUMBER = TVL_EXECUTEFUNC + 1,						/* push a constant */
+	COP_SYMBOL,												/* push a symbol, resolved when popped */
+	COP_END													/* pop the final result */
+};
+
+
+/* kinds of values tracked while compiling */
+enum
+{
+	CKIND_NUMBER,
+	CKIND_SYMBOL,
+	CKIND_MEMORY
+};
+
+
 
 /***************************************************************************
     TYPE DEFINITIONS
@@ -202,6 +220,30 @@ struct _expression_string
 };
 
 
+/* a single step of a compiled expression */
+typedef struct _compiled_op compiled_op;
+struct _compiled_op
+{
+	UINT8					opcode;							/* TVL_* or COP_* */
+	UINT8					space;							/* memory space for TVL_MEMORYAT */
+	UINT8					size;							/* memory access size in bytes for TVL_MEMORYAT */
+	UINT8					params;							/* parameter count for TVL_EXECUTEFUNC */
+	UINT32					offset;							/* offset reported on divide by zero */
+	UINT64					value;							/* value for COP_NUMBER */
+	symbol_entry *			symbol;							/* symbol for COP_SYMBOL and TVL_EXECUTEFUNC */
+	const char *			name;							/* memory name for TVL_MEMORYAT */
+};
+
+
+/* an entry on the stack of a compiled expression */
+typedef struct _compiled_slot compiled_slot;
+struct _compiled_slot
+{
+	UINT64					value;							/* value, or address for a memory lval */
+	const compiled_op *		lval;							/* symbol or memory op to resolve, or NULL for a plain value */
+};
+
+
 /* typedef struct _parsed_expression parsed_expression -- defined in express.h */
 struct _parsed_expression
 {
@@ -214,6 +256,7 @@ struct _parsed_expression
 	parse_token				token[MAX_TOKENS];				/* array of tokens */
 	int						token_stack_ptr;				/* stack poointer */
 	parse_token				token_stack[MAX_STACK_DEPTH];	/* token stack */
+	compiled_op *			program;						/* compiled form, or NULL if it couldn't be compiled */
 };
 
 
@@ -1673,6 +1716,425 @@ static EXPRERR execute_tokens(parsed_expression *expr, UINT64 *result)
 
 
 
+/***************************************************************************
+    COMPILED EXECUTION
+***************************************************************************/
+
+/*-------------------------------------------------
+    compiled_get - fetch the value of a stack
+    slot, resolving symbols and memory just as
+    pop_token_rval does
+-------------------------------------------------*/
+
+INLINE UINT64 compiled_get(parsed_expression *expr, const compiled_slot *slot)
+{
+	const compiled_op *op = slot->lval;
+
+	if (op == NULL)
+		return slot->value;
+	if (op->opcode == COP_SYMBOL)
+	{
+		symbol_entry *symbol = op->symbol;
+		if (symbol->type == SMT_REGISTER)
+			return (*symbol->info.reg.getter)(symbol->table->globalref, symbol->ref);
+		return symbol->info.gen.value;
+	}
+	if (expr->callbacks.read != NULL)
+		return (*expr->callbacks.read)(expr->cbparam, op->name, op->space, slot->value, op->size);
+	return 0;
+}
+
+
+/*-------------------------------------------------
+    compiled_set - store to an lval stack slot
+-------------------------------------------------*/
+
+INLINE void compiled_set(parsed_expression *expr, const compiled_slot *slot, UINT64 value)
+{
+	const compiled_op *op = slot->lval;
+
+	if (op->opcode == COP_SYMBOL)
+	{
+		symbol_entry *symbol = op->symbol;
+		(*symbol->info.reg.setter)(symbol->table->globalref, symbol->ref, value);
+	}
+	else if (expr->callbacks.write != NULL)
+		(*expr->callbacks.write)(expr->cbparam, op->name, op->space, slot->value, op->size, value);
+}
+
+
+/*-------------------------------------------------
+    execute_compiled - execute a compiled
+    expression; all checks that don't depend on
+    values were done when compiling
+-------------------------------------------------*/
+
+static EXPRERR execute_compiled(parsed_expression *expr, const compiled_op *op, UINT64 *result)
+{
+	compiled_slot stack[MAX_STACK_DEPTH];
+	compiled_slot *sp = stack;
+	UINT64 funcparams[MAX_FUNCTION_PARAMS];
+	UINT64 left, right;
+	int paramnum;
+
+/* helpers for the common shapes: operands are popped right first, like execute_tokens does */
+#define UNARY(expr_)		left = compiled_get(expr, &sp[-1]); sp[-1].value = (expr_); sp[-1].lval = NULL; break
+#define BINARY(expr_)		right = compiled_get(expr, --sp); left = compiled_get(expr, &sp[-1]); sp[-1].value = (expr_); sp[-1].lval = NULL; break
+#define INCDEC(pre, post)	left = compiled_get(expr, &sp[-1]); compiled_set(expr, &sp[-1], left + (post)); sp[-1].value = left + (pre); sp[-1].lval = NULL; break
+#define ASSIGNOP(oper)		right = compiled_get(expr, --sp); left = compiled_get(expr, &sp[-1]) oper right; compiled_set(expr, &sp[-1], left); sp[-1].value = left; sp[-1].lval = NULL; break
+
+	for ( ; ; op++)
+		switch (op->opcode)
+		{
+			case COP_NUMBER:
+				sp->value = op->value;
+				sp->lval = NULL;
+				sp++;
+				break;
+
+			case COP_SYMBOL:
+				sp->lval = op;
+				sp++;
+				break;
+
+			case COP_END:
+				*result = compiled_get(expr, --sp);
+				return EXPRERR_NONE;
+
+			case TVL_PREINCREMENT:		INCDEC(1, 1);
+			case TVL_PREDECREMENT:		INCDEC(-1, -1);
+			case TVL_POSTINCREMENT:		INCDEC(0, 1);
+			case TVL_POSTDECREMENT:		INCDEC(0, -1);
+
+			case TVL_COMPLEMENT:		UNARY(!left);
+			case TVL_NOT:				UNARY(~left);
+			case TVL_UPLUS:				UNARY(left);
+			case TVL_UMINUS:			UNARY(-left);
+
+			case TVL_MULTIPLY:			BINARY(left * right);
+			case TVL_ADD:				BINARY(left + right);
+			case TVL_SUBTRACT:			BINARY(left - right);
+			case TVL_LSHIFT:			BINARY(left << right);
+			case TVL_RSHIFT:			BINARY(left >> right);
+			case TVL_LESS:				BINARY(left < right);
+			case TVL_LESSOREQUAL:		BINARY(left <= right);
+			case TVL_GREATER:			BINARY(left > right);
+			case TVL_GREATEROREQUAL:	BINARY(left >= right);
+			case TVL_EQUAL:				BINARY(left == right);
+			case TVL_NOTEQUAL:			BINARY(left != right);
+			case TVL_BAND:				BINARY(left & right);
+			case TVL_BXOR:				BINARY(left ^ right);
+			case TVL_BOR:				BINARY(left | right);
+			case TVL_LAND:				BINARY(left && right);
+			case TVL_LOR:				BINARY(left || right);
+			case TVL_COMMA:				BINARY(right);
+
+			case TVL_DIVIDE:
+				right = compiled_get(expr, --sp);
+				left = compiled_get(expr, &sp[-1]);
+				if (right == 0) return MAKE_EXPRERR_DIVIDE_BY_ZERO(op->offset);
+				sp[-1].value = left / right;
+				sp[-1].lval = NULL;
+				break;
+
+			case TVL_MODULO:
+				right = compiled_get(expr, --sp);
+				left = compiled_get(expr, &sp[-1]);
+				if (right == 0) return MAKE_EXPRERR_DIVIDE_BY_ZERO(op->offset);
+				sp[-1].value = left % right;
+				sp[-1].lval = NULL;
+				break;
+
+			case TVL_ASSIGN:
+				right = compiled_get(expr, --sp);
+				compiled_set(expr, &sp[-1], right);
+				sp[-1].value = right;
+				sp[-1].lval = NULL;
+				break;
+
+			case TVL_ASSIGNMULTIPLY:	ASSIGNOP(*);
+			case TVL_ASSIGNADD:			ASSIGNOP(+);
+			case TVL_ASSIGNSUBTRACT:	ASSIGNOP(-);
+			case TVL_ASSIGNLSHIFT:		ASSIGNOP(<<);
+			case TVL_ASSIGNRSHIFT:		ASSIGNOP(>>);
+			case TVL_ASSIGNBAND:		ASSIGNOP(&);
+			case TVL_ASSIGNBXOR:		ASSIGNOP(^);
+			case TVL_ASSIGNBOR:			ASSIGNOP(|);
+
+			case TVL_ASSIGNDIVIDE:
+			case TVL_ASSIGNMODULO:
+				right = compiled_get(expr, --sp);
+				left = compiled_get(expr, &sp[-1]);
+				if (right == 0) return MAKE_EXPRERR_DIVIDE_BY_ZERO(op->offset);
+				left = (op->opcode == TVL_ASSIGNDIVIDE) ? (left / right) : (left % right);
+				compiled_set(expr, &sp[-1], left);
+				sp[-1].value = left;
+				sp[-1].lval = NULL;
+				break;
+
+			case TVL_MEMORYAT:
+				sp[-1].value = compiled_get(expr, &sp[-1]);
+				sp[-1].lval = op;
+				break;
+
+			case TVL_EXECUTEFUNC:
+				for (paramnum = op->params - 1; paramnum >= 0; paramnum--)
+					funcparams[paramnum] = compiled_get(expr, --sp);
+				sp[-1].value = (*op->symbol->info.func.execute)(op->symbol->table->globalref, op->symbol->ref, op->params, funcparams);
+				sp[-1].lval = NULL;
+				break;
+		}
+
+#undef UNARY
+#undef BINARY
+#undef INCDEC
+#undef ASSIGNOP
+}
+
+
+
+/***************************************************************************
+    EXPRESSION COMPILATION
+***************************************************************************/
+
+/* a value on the simulated stack while compiling */
+typedef struct _compile_entry compile_entry;
+struct _compile_entry
+{
+	UINT8					kind;							/* CKIND_* */
+	UINT32					offset;							/* offset the interpreter would carry */
+	symbol_entry *			symbol;							/* symbol for CKIND_SYMBOL */
+};
+
+
+/*-------------------------------------------------
+    compile_is_rval/compile_is_lval - static
+    versions of the pop_token_rval and
+    pop_token_lval checks
+-------------------------------------------------*/
+
+INLINE int compile_is_rval(const compile_entry *entry)
+{
+	if (entry->kind == CKIND_SYMBOL)
+		return (entry->symbol != NULL && (entry->symbol->type == SMT_REGISTER || entry->symbol->type == SMT_VALUE));
+	return TRUE;
+}
+
+INLINE int compile_is_lval(const compile_entry *entry)
+{
+	if (entry->kind == CKIND_SYMBOL)
+		return (entry->symbol != NULL && entry->symbol->type == SMT_REGISTER && entry->symbol->info.reg.setter != NULL);
+	return (entry->kind == CKIND_MEMORY);
+}
+
+
+/*-------------------------------------------------
+    compile_tokens - translate the postfix tokens
+    into a compiled program; anything that would
+    fail in execute_tokens regardless of values
+    leaves the expression uncompiled so that the
+    interpreter reports the error exactly as
+    before
+-------------------------------------------------*/
+
+static void compile_tokens(parsed_expression *expr)
+{
+	compiled_op program[MAX_TOKENS + 1];
+	compile_entry stack[MAX_STACK_DEPTH];
+	int depth = 0, count = 0;
+	int tokindex;
+
+	for (tokindex = 0; expr->token[tokindex].type != TOK_END; tokindex++)
+	{
+		parse_token *token = &expr->token[tokindex];
+		compiled_op *op = &program[count];
+		compile_entry left, right;
+		int unary = FALSE, binary = FALSE;
+		UINT32 resultoffset = 0;
+
+		memset(op, 0, sizeof(*op));
+		memset(&left, 0, sizeof(left));
+		memset(&right, 0, sizeof(right));
+
+		/* operands and constants push new values */
+		if (token->type == TOK_NUMBER || token->type == TOK_SYMBOL)
+		{
+			if (depth >= MAX_STACK_DEPTH)
+				return;
+			stack[depth].kind = (token->type == TOK_NUMBER) ? CKIND_NUMBER : CKIND_SYMBOL;
+			stack[depth].offset = token->offset;
+			stack[depth].symbol = (token->type == TOK_SYMBOL) ? (symbol_entry *)token->value.p : NULL;
+			depth++;
+
+			op->opcode = (token->type == TOK_NUMBER) ? COP_NUMBER : COP_SYMBOL;
+			op->value = token->value.i;
+			op->symbol = stack[depth - 1].symbol;
+			count++;
+			continue;
+		}
+
+		/* strings can never be used as values */
+		if (token->type != TOK_OPERATOR)
+			return;
+
+		op->opcode = token->value.i;
+		switch (token->value.i)
+		{
+			case TVL_PREINCREMENT:
+			case TVL_PREDECREMENT:
+			case TVL_POSTINCREMENT:
+			case TVL_POSTDECREMENT:
+				if (depth < 1 || !compile_is_lval(&stack[depth - 1]))
+					return;
+				left = stack[--depth];
+				resultoffset = left.offset;
+				break;
+
+			case TVL_COMPLEMENT:
+			case TVL_NOT:
+			case TVL_UPLUS:
+			case TVL_UMINUS:
+				if (depth < 1 || !compile_is_rval(&stack[depth - 1]))
+					return;
+				left = stack[--depth];
+				resultoffset = left.offset;
+				unary = TRUE;
+				break;
+
+			case TVL_MULTIPLY:
+			case TVL_DIVIDE:
+			case TVL_MODULO:
+			case TVL_ADD:
+			case TVL_SUBTRACT:
+			case TVL_LSHIFT:
+			case TVL_RSHIFT:
+			case TVL_LESS:
+			case TVL_LESSOREQUAL:
+			case TVL_GREATER:
+			case TVL_GREATEROREQUAL:
+			case TVL_EQUAL:
+			case TVL_NOTEQUAL:
+			case TVL_BAND:
+			case TVL_BXOR:
+			case TVL_BOR:
+			case TVL_LAND:
+			case TVL_LOR:
+				if (depth < 2 || !compile_is_rval(&stack[depth - 1]) || !compile_is_rval(&stack[depth - 2]))
+					return;
+				right = stack[--depth];
+				left = stack[--depth];
+				resultoffset = MIN(left.offset, right.offset);
+				op->offset = right.offset;
+				binary = TRUE;
+				break;
+
+			case TVL_ASSIGN:
+			case TVL_ASSIGNMULTIPLY:
+			case TVL_ASSIGNDIVIDE:
+			case TVL_ASSIGNMODULO:
+			case TVL_ASSIGNADD:
+			case TVL_ASSIGNSUBTRACT:
+			case TVL_ASSIGNLSHIFT:
+			case TVL_ASSIGNRSHIFT:
+			case TVL_ASSIGNBAND:
+			case TVL_ASSIGNBXOR:
+			case TVL_ASSIGNBOR:
+				if (depth < 2 || !compile_is_rval(&stack[depth - 1]) || !compile_is_lval(&stack[depth - 2]))
+					return;
+				right = stack[--depth];
+				left = stack[--depth];
+				resultoffset = (token->value.i == TVL_ASSIGN) ? right.offset : MIN(left.offset, right.offset);
+				op->offset = right.offset;
+				break;
+
+			case TVL_COMMA:
+				/* commas separating function parameters are no-ops */
+				if (token->info & TIN_FUNCTION)
+					continue;
+				if (depth < 2 || !compile_is_rval(&stack[depth - 1]) || !compile_is_rval(&stack[depth - 2]))
+					return;
+				right = stack[--depth];
+				left = stack[--depth];
+				resultoffset = right.offset;
+				break;
+
+			case TVL_MEMORYAT:
+				if (depth < 1 || !compile_is_rval(&stack[depth - 1]))
+					return;
+				depth--;
+				op->space = (token->info & TIN_MEMORY_SPACE_MASK) >> TIN_MEMORY_SPACE_SHIFT;
+				op->size = 1 << ((token->info & TIN_MEMORY_SIZE_MASK) >> TIN_MEMORY_SIZE_SHIFT);
+				op->name = get_expression_string(expr, (token->info & TIN_MEMORY_INDEX_MASK) >> TIN_MEMORY_INDEX_SHIFT);
+				stack[depth].kind = CKIND_MEMORY;
+				stack[depth].offset = 0;
+				stack[depth++].symbol = NULL;
+				count++;
+				continue;
+
+			case TVL_EXECUTEFUNC:
+				/* parameters are everything above the function symbol */
+				while (op->params < MAX_FUNCTION_PARAMS)
+				{
+					compile_entry *peek = (depth > op->params) ? &stack[depth - op->params - 1] : NULL;
+					if (peek == NULL)
+						return;
+					if (peek->kind == CKIND_SYMBOL && peek->symbol != NULL && peek->symbol->type == SMT_FUNCTION)
+						break;
+					if (!compile_is_rval(peek))
+						return;
+					op->params++;
+				}
+				if (op->params == MAX_FUNCTION_PARAMS)
+					return;
+				op->symbol = stack[depth - op->params - 1].symbol;
+				if (op->params < op->symbol->info.func.minparams || op->params > op->symbol->info.func.maxparams)
+					return;
+
+				/* the result replaces the function symbol */
+				depth -= op->params + 1;
+				resultoffset = token->offset;
+				break;
+
+			default:
+				return;
+		}
+
+		/* everything else leaves a plain number */
+		stack[depth].kind = CKIND_NUMBER;
+		stack[depth].offset = resultoffset;
+		stack[depth++].symbol = NULL;
+		count++;
+
+		/* fold operators on constants, leaving division by zero for run time */
+		if ((unary && count >= 2 && program[count - 2].opcode == COP_NUMBER) ||
+			(binary && count >= 3 && program[count - 2].opcode == COP_NUMBER && program[count - 3].opcode == COP_NUMBER &&
+			 !((op->opcode == TVL_DIVIDE || op->opcode == TVL_MODULO) && program[count - 2].value == 0)))
+		{
+			UINT64 value;
+
+			program[count].opcode = COP_END;
+			count -= unary ? 2 : 3;
+			execute_compiled(expr, &program[count], &value);
+			program[count].opcode = COP_NUMBER;
+			program[count].value = value;
+			count++;
+		}
+	}
+
+	/* the result must be the only thing left */
+	if (depth != 1 || !compile_is_rval(&stack[0]))
+		return;
+	memset(&program[count], 0, sizeof(program[count]));
+	program[count++].opcode = COP_END;
+
+	/* keep the program; if there is no memory, the interpreter still works */
+	expr->program = (compiled_op *)osd_malloc(count * sizeof(program[0]));
+	if (expr->program != NULL)
+		memcpy(expr->program, program, count * sizeof(program[0]));
+}
+
+
+
 /***************************************************************************
     MISC HELPERS
 ***************************************************************************/
@@ -1828,8 +2290,9 @@ EXPRERR expression_parse(const char *expression, const symbol_table *table, cons
 		goto cleanup;
 	}
 
-	/* copy the final expression and return */
+	/* copy the final expression, compile it and return */
 	**result = temp_expression;
+	compile_tokens(*result);
 	return EXPRERR_NONE;
 
 cleanup:
@@ -1845,11 +2308,32 @@ cleanup:
 
 EXPRERR expression_execute(parsed_expression *expr, UINT64 *result)
 {
+	/* use the compiled form if there is one */
+	if (expr->program != NULL)
+		return execute_compiled(expr, expr->program, result);
+
 	/* execute the expression to get the result */
 	return execute_tokens(expr, result);
 }
 
 
+/*-------------------------------------------------
+    expression_uncompile - discard the compiled
+    form so the expression runs through the
+    token interpreter; returns TRUE if there was
+    a compiled form to discard
+-------------------------------------------------*/
+
+int expression_uncompile(parsed_expression *expr)
+{
+	if (expr->program == NULL)
+		return FALSE;
+	osd_free(expr->program);
+	expr->program = NULL;
+	return TRUE;
+}
+
+
 /*-------------------------------------------------
     expression_free - free a previously
     allocated parsed expression
@@ -1860,6 +2344,8 @@ void expression_free(parsed_expression *expr)
 	if (expr != NULL)
 	{
 		free_expression_strings(expr);
+		if (expr->program != NULL)
+			osd_free(expr->program);
 		osd_free(expr);
 	}
 }
@@ -1876,6 +2362,141 @@ const char *expression_original_string(parsed_expression *expr)
 }
 
 
+/*-------------------------------------------------
+    expression_get_constant_store - determine
+    whether an expression does nothing but store
+    a constant, or a constant merged with some
+    bits of the old value, into a single fixed
+    memory location; returns TRUE and fills in
+    the store if so
+-------------------------------------------------*/
+
+int expression_get_constant_store(parsed_expression *expr, expression_constant_store *store)
+{
+	/* each stack slot is a constant, the target, or (old & keep) | value */
+	enum { SLOT_CONST, SLOT_TARGET, SLOT_OLD };
+	struct { int kind; UINT64 keep, value; } stack[MAX_STACK_DEPTH];
+	const compiled_op *target = NULL;
+	const compiled_op *op;
+	UINT64 sizemask = 0, address = 0;
+	int depth = 0, stored = FALSE;
+
+	if (expr->program == NULL)
+		return FALSE;
+
+	for (op = expr->program; op->opcode != COP_END; op++)
+	{
+		/* nothing may follow the store */
+		if (stored)
+			return FALSE;
+
+		switch (op->opcode)
+		{
+			case COP_NUMBER:
+				if (depth == MAX_STACK_DEPTH)
+					return FALSE;
+				stack[depth].kind = SLOT_CONST;
+				stack[depth++].value = op->value;
+				break;
+
+			case TVL_MEMORYAT:
+				/* only one location, at a constant address */
+				if (depth < 1 || stack[depth - 1].kind != SLOT_CONST)
+					return FALSE;
+				if (target == NULL)
+				{
+					target = op;
+					address = stack[depth - 1].value;
+					sizemask = (op->size == 8) ? ~(UINT64)0 : (((UINT64)1 << (8 * op->size)) - 1);
+				}
+				else if (op->space != target->space || op->size != target->size || stack[depth - 1].value != address ||
+						 (op->name != target->name && (op->name == NULL || target->name == NULL || strcmp(op->name, target->name) != 0)))
+					return FALSE;
+				stack[depth - 1].kind = SLOT_TARGET;
+				break;
+
+			case TVL_BAND:
+			case TVL_BOR:
+			{
+				UINT64 keep, value, constant;
+				int slot;
+
+				if (depth < 2)
+					return FALSE;
+
+				/* reading the target gives the old value unchanged */
+				for (slot = depth - 2; slot < depth; slot++)
+					if (stack[slot].kind == SLOT_TARGET)
+					{
+						stack[slot].kind = SLOT_OLD;
+						stack[slot].keep = sizemask;
+						stack[slot].value = 0;
+					}
+
+				/* exactly one side must be constant */
+				if (stack[depth - 1].kind == SLOT_CONST && stack[depth - 2].kind == SLOT_OLD)
+				{
+					constant = stack[depth - 1].value;
+					keep = stack[depth - 2].keep;
+					value = stack[depth - 2].value;
+				}
+				else if (stack[depth - 2].kind == SLOT_CONST && stack[depth - 1].kind == SLOT_OLD)
+				{
+					constant = stack[depth - 2].value;
+					keep = stack[depth - 1].keep;
+					value = stack[depth - 1].value;
+				}
+				else
+					return FALSE;
+
+				if (op->opcode == TVL_BAND)
+					keep &= constant, value &= constant;
+				else
+					keep &= ~constant, value |= constant;
+
+				depth--;
+				stack[depth - 1].kind = SLOT_OLD;
+				stack[depth - 1].keep = keep;
+				stack[depth - 1].value = value;
+				break;
+			}
+
+			case TVL_ASSIGN:
+			case TVL_ASSIGNBAND:
+			case TVL_ASSIGNBOR:
+				if (depth != 2 || stack[0].kind != SLOT_TARGET || stack[1].kind == SLOT_TARGET)
+					return FALSE;
+				if (op->opcode != TVL_ASSIGN && stack[1].kind != SLOT_CONST)
+					return FALSE;
+
+				store->keepmask = (stack[1].kind == SLOT_OLD) ? stack[1].keep : 0;
+				store->value = stack[1].value;
+				if (op->opcode == TVL_ASSIGNBAND)
+					store->keepmask = store->value, store->value = 0;
+				else if (op->opcode == TVL_ASSIGNBOR)
+					store->keepmask = ~store->value;
+				stored = TRUE;
+				depth = 1;
+				break;
+
+			default:
+				return FALSE;
+		}
+	}
+
+	if (!stored)
+		return FALSE;
+
+	store->name = target->name;
+	store->space = target->space;
+	store->address = address;
+	store->size = target->size;
+	store->keepmask &= sizemask;
+	store->value &= sizemask;
+	return TRUE;
+}
+
+
 
 /***************************************************************************
     ERROR HANDLING
@@ -166,6 +166,19 @@ struct _symbol_entry
 typedef struct _parsed_expression parsed_expression;
 
 
+/* describes an expression that only stores a constant into one memory location */
+typedef struct _expression_constant_store expression_constant_store;
+struct _expression_constant_store
+{
+	const char *	name;						/* memory name, or NULL for the default */
+	int				space;						/* EXPSPACE_* of the target */
+	UINT32			address;					/* address of the target */
+	int				size;						/* access size in bytes */
+	UINT64			keepmask;					/* bits of the old value that are kept */
+	UINT64			value;						/* bits ORed in after masking */
+};
+
+
 
 /***************************************************************************
     FUNCTION PROTOTYPES
@@ -175,8 +188,10 @@ typedef struct _parsed_expression parsed_expression;
 EXPRERR 					expression_evaluate(const char *expression, const symbol_table *table, const express_callbacks *callbacks, void *cbparam, UINT64 *result);
 EXPRERR 					expression_parse(const char *expression, const symbol_table *table, const express_callbacks *callbacks, void *cbparam, parsed_expression **result);
 EXPRERR 					expression_execute(parsed_expression *expr, UINT64 *result);
+int							expression_uncompile(parsed_expression *expr);
 void						expression_free(parsed_expression *expr);
 const char *				expression_original_string(parsed_expression *expr);
+int							expression_get_constant_store(parsed_expression *expr, expression_constant_store *store);
 const char *				exprerr_to_string(EXPRERR error);
 
 /* symbol table manipulation */
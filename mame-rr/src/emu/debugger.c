@@ -10,6 +10,7 @@
 *********************************************************************/
 
 #include "emu.h"
+#include "emuopts.h"
 #include "debugger.h"
 #include "debug/debugcpu.h"
 #include "debug/debugcmd.h"
@@ -17,6 +18,7 @@
 #include "debug/debugcon.h"
 #include "debug/express.h"
 #include "debug/debugvw.h"
+#include "debug/debugsrv.h"
 #include "debugint/debugint.h"
 #include <ctype.h>
 
@@ -74,6 +76,10 @@ void debugger_init(running_machine *machine)
 		debug_console_init(machine);
 		debug_comment_init(machine);
 
+		/* start listening if the debugger is driven remotely */
+		if (machine->debug_flags & DEBUG_FLAG_SERVER)
+			debug_server_init(machine, options_get_int(machine->options(), OPTION_DEBUGSERVER));
+
 		/* always initialize the internal render debugger */
 		debugint_init(machine);
 
@@ -574,9 +574,9 @@ void drawgfx_transpen(bitmap_t *dest, const rectangle *cliprect, const gfx_eleme
 
 	/* render based on dest bitmap depth */
 	if (dest->bpp == 16)
-		DRAWGFX_CORE(UINT16, PIXEL_OP_REMAP_TRANSPEN, NO_PRIORITY);
+		DRAWGFX_ROW_CORE(UINT16, PIXEL_OP_REMAP_TRANSPEN, ROW_OP_REMAP_TRANSPEN, NO_PRIORITY);
 	else
-		DRAWGFX_CORE(UINT32, PIXEL_OP_REMAP_TRANSPEN, NO_PRIORITY);
+		DRAWGFX_ROW_CORE(UINT32, PIXEL_OP_REMAP_TRANSPEN, ROW_OP_REMAP_TRANSPEN, NO_PRIORITY);
 }
 
 
@@ -605,9 +605,9 @@ void drawgfx_transpen_raw(bitmap_t *dest, const rectangle *cliprect, const gfx_e
 
 	/* render based on dest bitmap depth */
 	if (dest->bpp == 16)
-		DRAWGFX_CORE(UINT16, PIXEL_OP_REBASE_TRANSPEN, NO_PRIORITY);
+		DRAWGFX_ROW_CORE(UINT16, PIXEL_OP_REBASE_TRANSPEN, ROW_OP_REBASE_TRANSPEN, NO_PRIORITY);
 	else
-		DRAWGFX_CORE(UINT32, PIXEL_OP_REBASE_TRANSPEN, NO_PRIORITY);
+		DRAWGFX_ROW_CORE(UINT32, PIXEL_OP_REBASE_TRANSPEN, ROW_OP_REBASE_TRANSPEN, NO_PRIORITY);
 }
 
 
@@ -659,9 +659,9 @@ void drawgfx_transmask(bitmap_t *dest, const rectangle *cliprect, const gfx_elem
 
 	/* render based on dest bitmap depth */
 	if (dest->bpp == 16)
-		DRAWGFX_CORE(UINT16, PIXEL_OP_REMAP_TRANSMASK, NO_PRIORITY);
+		DRAWGFX_ROW_CORE(UINT16, PIXEL_OP_REMAP_TRANSMASK, ROW_OP_REMAP_TRANSMASK, NO_PRIORITY);
 	else
-		DRAWGFX_CORE(UINT32, PIXEL_OP_REMAP_TRANSMASK, NO_PRIORITY);
+		DRAWGFX_ROW_CORE(UINT32, PIXEL_OP_REMAP_TRANSMASK, ROW_OP_REMAP_TRANSMASK, NO_PRIORITY);
 }
 
 
@@ -832,9 +832,9 @@ void drawgfxzoom_transpen(bitmap_t *dest, const rectangle *cliprect, const gfx_e
 
 	/* render based on dest bitmap depth */
 	if (dest->bpp == 16)
-		DRAWGFXZOOM_CORE(UINT16, PIXEL_OP_REMAP_TRANSPEN, NO_PRIORITY);
+		DRAWGFXZOOM_ROW_CORE(UINT16, PIXEL_OP_REMAP_TRANSPEN, ROW_OP_REMAP_TRANSPEN, NO_PRIORITY);
 	else
-		DRAWGFXZOOM_CORE(UINT32, PIXEL_OP_REMAP_TRANSPEN, NO_PRIORITY);
+		DRAWGFXZOOM_ROW_CORE(UINT32, PIXEL_OP_REMAP_TRANSPEN, ROW_OP_REMAP_TRANSPEN, NO_PRIORITY);
 }
 
 
@@ -870,9 +870,9 @@ void drawgfxzoom_transpen_raw(bitmap_t *dest, const rectangle *cliprect, const g
 
 	/* render based on dest bitmap depth */
 	if (dest->bpp == 16)
-		DRAWGFXZOOM_CORE(UINT16, PIXEL_OP_REBASE_TRANSPEN, NO_PRIORITY);
+		DRAWGFXZOOM_ROW_CORE(UINT16, PIXEL_OP_REBASE_TRANSPEN, ROW_OP_REBASE_TRANSPEN, NO_PRIORITY);
 	else
-		DRAWGFXZOOM_CORE(UINT32, PIXEL_OP_REBASE_TRANSPEN, NO_PRIORITY);
+		DRAWGFXZOOM_ROW_CORE(UINT32, PIXEL_OP_REBASE_TRANSPEN, ROW_OP_REBASE_TRANSPEN, NO_PRIORITY);
 }
 
 
@@ -931,9 +931,9 @@ void drawgfxzoom_transmask(bitmap_t *dest, const rectangle *cliprect, const gfx_
 
 	/* render based on dest bitmap depth */
 	if (dest->bpp == 16)
-		DRAWGFXZOOM_CORE(UINT16, PIXEL_OP_REMAP_TRANSMASK, NO_PRIORITY);
+		DRAWGFXZOOM_ROW_CORE(UINT16, PIXEL_OP_REMAP_TRANSMASK, ROW_OP_REMAP_TRANSMASK, NO_PRIORITY);
 	else
-		DRAWGFXZOOM_CORE(UINT32, PIXEL_OP_REMAP_TRANSMASK, NO_PRIORITY);
+		DRAWGFXZOOM_ROW_CORE(UINT32, PIXEL_OP_REMAP_TRANSMASK, ROW_OP_REMAP_TRANSMASK, NO_PRIORITY);
 }
 
 
@@ -1110,9 +1110,9 @@ void pdrawgfx_transpen(bitmap_t *dest, const rectangle *cliprect, const gfx_elem
 
 	/* render based on dest bitmap depth */
 	if (dest->bpp == 16)
-		DRAWGFX_CORE(UINT16, PIXEL_OP_REMAP_TRANSPEN_PRIORITY, UINT8);
+		DRAWGFX_ROW_CORE(UINT16, PIXEL_OP_REMAP_TRANSPEN_PRIORITY, ROW_OP_REMAP_TRANSPEN_PRIORITY, UINT8);
 	else
-		DRAWGFX_CORE(UINT32, PIXEL_OP_REMAP_TRANSPEN_PRIORITY, UINT8);
+		DRAWGFX_ROW_CORE(UINT32, PIXEL_OP_REMAP_TRANSPEN_PRIORITY, ROW_OP_REMAP_TRANSPEN_PRIORITY, UINT8);
 }
 
 
@@ -1142,9 +1142,9 @@ void pdrawgfx_transpen_raw(bitmap_t *dest, const rectangle *cliprect, const gfx_
 
 	/* render based on dest bitmap depth */
 	if (dest->bpp == 16)
-		DRAWGFX_CORE(UINT16, PIXEL_OP_REBASE_TRANSPEN_PRIORITY, UINT8);
+		DRAWGFX_ROW_CORE(UINT16, PIXEL_OP_REBASE_TRANSPEN_PRIORITY, ROW_OP_REBASE_TRANSPEN_PRIORITY, UINT8);
 	else
-		DRAWGFX_CORE(UINT32, PIXEL_OP_REBASE_TRANSPEN_PRIORITY, UINT8);
+		DRAWGFX_ROW_CORE(UINT32, PIXEL_OP_REBASE_TRANSPEN_PRIORITY, ROW_OP_REBASE_TRANSPEN_PRIORITY, UINT8);
 }
 
 
@@ -1198,9 +1198,9 @@ void pdrawgfx_transmask(bitmap_t *dest, const rectangle *cliprect, const gfx_ele
 
 	/* render based on dest bitmap depth */
 	if (dest->bpp == 16)
-		DRAWGFX_CORE(UINT16, PIXEL_OP_REMAP_TRANSMASK_PRIORITY, UINT8);
+		DRAWGFX_ROW_CORE(UINT16, PIXEL_OP_REMAP_TRANSMASK_PRIORITY, ROW_OP_REMAP_TRANSMASK_PRIORITY, UINT8);
 	else
-		DRAWGFX_CORE(UINT32, PIXEL_OP_REMAP_TRANSMASK_PRIORITY, UINT8);
+		DRAWGFX_ROW_CORE(UINT32, PIXEL_OP_REMAP_TRANSMASK_PRIORITY, ROW_OP_REMAP_TRANSMASK_PRIORITY, UINT8);
 }
 
 
@@ -1384,9 +1384,9 @@ void pdrawgfxzoom_transpen(bitmap_t *dest, const rectangle *cliprect, const gfx_
 
 	/* render based on dest bitmap depth */
 	if (dest->bpp == 16)
-		DRAWGFXZOOM_CORE(UINT16, PIXEL_OP_REMAP_TRANSPEN_PRIORITY, UINT8);
+		DRAWGFXZOOM_ROW_CORE(UINT16, PIXEL_OP_REMAP_TRANSPEN_PRIORITY, ROW_OP_REMAP_TRANSPEN_PRIORITY, UINT8);
 	else
-		DRAWGFXZOOM_CORE(UINT32, PIXEL_OP_REMAP_TRANSPEN_PRIORITY, UINT8);
+		DRAWGFXZOOM_ROW_CORE(UINT32, PIXEL_OP_REMAP_TRANSPEN_PRIORITY, ROW_OP_REMAP_TRANSPEN_PRIORITY, UINT8);
 }
 
 
@@ -1425,9 +1425,9 @@ void pdrawgfxzoom_transpen_raw(bitmap_t *dest, const rectangle *cliprect, const
 
 	/* render based on dest bitmap depth */
 	if (dest->bpp == 16)
-		DRAWGFXZOOM_CORE(UINT16, PIXEL_OP_REBASE_TRANSPEN_PRIORITY, UINT8);
+		DRAWGFXZOOM_ROW_CORE(UINT16, PIXEL_OP_REBASE_TRANSPEN_PRIORITY, ROW_OP_REBASE_TRANSPEN_PRIORITY, UINT8);
 	else
-		DRAWGFXZOOM_CORE(UINT32, PIXEL_OP_REBASE_TRANSPEN_PRIORITY, UINT8);
+		DRAWGFXZOOM_ROW_CORE(UINT32, PIXEL_OP_REBASE_TRANSPEN_PRIORITY, ROW_OP_REBASE_TRANSPEN_PRIORITY, UINT8);
 }
 
 
@@ -1490,9 +1490,9 @@ void pdrawgfxzoom_transmask(bitmap_t *dest, const rectangle *cliprect, const gfx
 
 	/* render based on dest bitmap depth */
 	if (dest->bpp == 16)
-		DRAWGFXZOOM_CORE(UINT16, PIXEL_OP_REMAP_TRANSMASK_PRIORITY, UINT8);
+		DRAWGFXZOOM_ROW_CORE(UINT16, PIXEL_OP_REMAP_TRANSMASK_PRIORITY, ROW_OP_REMAP_TRANSMASK_PRIORITY, UINT8);
 	else
-		DRAWGFXZOOM_CORE(UINT32, PIXEL_OP_REMAP_TRANSMASK_PRIORITY, UINT8);
+		DRAWGFXZOOM_ROW_CORE(UINT32, PIXEL_OP_REMAP_TRANSMASK_PRIORITY, ROW_OP_REMAP_TRANSMASK_PRIORITY, UINT8);
 }
 
 
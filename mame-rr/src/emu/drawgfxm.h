@@ -29,6 +29,11 @@
     macros are written, leaving behind just the cases we are
     interested in.
 
+    DRAWGFX_ROW_CORE and DRAWGFXZOOM_ROW_CORE additionally take one of
+    the ROW_OP* macros, which can claim a whole row of 8bpp source data
+    for a vectorized kernel; DRAWGFX_CORE and DRAWGFXZOOM_CORE are the
+    same cores with ROW_OP_NONE.
+
     The general approach for using these macros is:
 
     my_drawing_function(params)
@@ -348,6 +353,325 @@ while (0)																			\
 
 
 
+/***************************************************************************
+    ROW OPERATIONS
+***************************************************************************/
+
+/*
+    The ROW_OP* macros give the DRAWGFX_ROW_CORE and DRAWGFXZOOM_ROW_CORE
+    macros a way to hand a whole row of 8bpp source data to a vectorized
+    kernel. Each one takes the target pixel type, the priority type, the
+    first DEST and PRIORITY pixels of the row, the SOURCE row, the 16.16
+    source X position SRCX of the first pixel, the 16.16 step DX between
+    pixels, and the COUNT of pixels. It returns TRUE if it drew the row,
+    or FALSE if the caller should draw it with the matching PIXEL_OP.
+
+    The kernels are selected at compile time by specializing the
+    drawgfx_row template on the target pixel type, the priority type
+    and the operation; anything without a specialization compiles down
+    to the PIXEL_OP path. Each kernel must match its PIXEL_OP exactly.
+*/
+
+/* operations that have row kernels */
+enum
+{
+	DRAWGFX_ROW_REMAP_TRANSPEN,
+	DRAWGFX_ROW_REMAP_TRANSMASK,
+	DRAWGFX_ROW_REBASE_TRANSPEN
+};
+
+
+/*-------------------------------------------------
+    ROW_OP_NONE - no row kernel; always use the
+    PIXEL_OP
+-------------------------------------------------*/
+
+#define ROW_OP_NONE(PIXEL_TYPE, PRIORITY_TYPE, DEST, PRIORITY, SOURCE, SRCX, DX, COUNT)	\
+	(FALSE)
+
+
+/*-------------------------------------------------
+    ROW_OP_REMAP_TRANSPEN - row kernel matching
+    PIXEL_OP_REMAP_TRANSPEN
+-------------------------------------------------*/
+
+#define ROW_OP_REMAP_TRANSPEN(PIXEL_TYPE, PRIORITY_TYPE, DEST, PRIORITY, SOURCE, SRCX, DX, COUNT)	\
+	(drawgfx_row<PIXEL_TYPE, PRIORITY_TYPE, DRAWGFX_ROW_REMAP_TRANSPEN>::draw(DEST, PRIORITY, SOURCE, SRCX, DX, COUNT, paldata, 0, transpen, 0))
+
+#define ROW_OP_REMAP_TRANSPEN_PRIORITY(PIXEL_TYPE, PRIORITY_TYPE, DEST, PRIORITY, SOURCE, SRCX, DX, COUNT)	\
+	(drawgfx_row<PIXEL_TYPE, PRIORITY_TYPE, DRAWGFX_ROW_REMAP_TRANSPEN>::draw(DEST, PRIORITY, SOURCE, SRCX, DX, COUNT, paldata, 0, transpen, pmask))
+
+
+/*-------------------------------------------------
+    ROW_OP_REBASE_TRANSPEN - row kernel matching
+    PIXEL_OP_REBASE_TRANSPEN
+-------------------------------------------------*/
+
+#define ROW_OP_REBASE_TRANSPEN(PIXEL_TYPE, PRIORITY_TYPE, DEST, PRIORITY, SOURCE, SRCX, DX, COUNT)	\
+	(drawgfx_row<PIXEL_TYPE, PRIORITY_TYPE, DRAWGFX_ROW_REBASE_TRANSPEN>::draw(DEST, PRIORITY, SOURCE, SRCX, DX, COUNT, NULL, color, transpen, 0))
+
+#define ROW_OP_REBASE_TRANSPEN_PRIORITY(PIXEL_TYPE, PRIORITY_TYPE, DEST, PRIORITY, SOURCE, SRCX, DX, COUNT)	\
+	(drawgfx_row<PIXEL_TYPE, PRIORITY_TYPE, DRAWGFX_ROW_REBASE_TRANSPEN>::draw(DEST, PRIORITY, SOURCE, SRCX, DX, COUNT, NULL, color, transpen, pmask))
+
+
+/*-------------------------------------------------
+    ROW_OP_REMAP_TRANSMASK - row kernel matching
+    PIXEL_OP_REMAP_TRANSMASK
+-------------------------------------------------*/
+
+#define ROW_OP_REMAP_TRANSMASK(PIXEL_TYPE, PRIORITY_TYPE, DEST, PRIORITY, SOURCE, SRCX, DX, COUNT)	\
+	(drawgfx_row<PIXEL_TYPE, PRIORITY_TYPE, DRAWGFX_ROW_REMAP_TRANSMASK>::draw(DEST, PRIORITY, SOURCE, SRCX, DX, COUNT, paldata, 0, transmask, 0))
+
+#define ROW_OP_REMAP_TRANSMASK_PRIORITY(PIXEL_TYPE, PRIORITY_TYPE, DEST, PRIORITY, SOURCE, SRCX, DX, COUNT)	\
+	(drawgfx_row<PIXEL_TYPE, PRIORITY_TYPE, DRAWGFX_ROW_REMAP_TRANSMASK>::draw(DEST, PRIORITY, SOURCE, SRCX, DX, COUNT, paldata, 0, transmask, pmask))
+
+
+/*-------------------------------------------------
+    drawgfx_row - generic template; there is no
+    kernel, so the PIXEL_OP draws the row
+-------------------------------------------------*/
+
+template<typename _PixelType, typename _PriorityType, int _RowOp>
+struct drawgfx_row
+{
+	static inline int ATTR_FORCE_INLINE draw(_PixelType *dest, _PriorityType *pri, const UINT8 *src, INT32 srcx, INT32 dx, UINT32 count,
+			const pen_t *paldata, UINT32 color, UINT32 trans, UINT32 pmask)
+	{
+		return FALSE;
+	}
+};
+
+
+/* use SSE2 on 64-bit implementations, where it can be assumed */
+#if (defined(__SSE2__) && defined(PTR64))
+
+#include <emmintrin.h>
+
+/*-------------------------------------------------
+    drawgfx_sse2_bit_test - return 0xff in each
+    byte whose low 5 bits select a set bit in
+    'mask', matching (mask >> (x & 31)) & 1
+-------------------------------------------------*/
+
+INLINE __m128i drawgfx_sse2_bit_test(__m128i pens, UINT32 mask)
+{
+	const __m128i one = _mm_set1_epi8(1);
+	__m128i index = _mm_and_si128(pens, _mm_set1_epi8(0x1f));
+	__m128i byte = _mm_and_si128(_mm_srli_epi16(index, 3), _mm_set1_epi8(3));
+	__m128i bit = _mm_and_si128(index, _mm_set1_epi8(7));
+	__m128i bitval = one;
+	__m128i maskbyte, sel;
+
+	/* build 1 << (index & 7) by doubling */
+	sel = _mm_cmpeq_epi8(_mm_and_si128(bit, one), one);
+	bitval = _mm_add_epi8(bitval, _mm_and_si128(bitval, sel));
+	sel = _mm_cmpeq_epi8(_mm_and_si128(bit, _mm_set1_epi8(2)), _mm_set1_epi8(2));
+	bitval = _mm_add_epi8(bitval, _mm_and_si128(bitval, sel));
+	bitval = _mm_add_epi8(bitval, _mm_and_si128(bitval, sel));
+	sel = _mm_cmpeq_epi8(_mm_and_si128(bit, _mm_set1_epi8(4)), _mm_set1_epi8(4));
+	bitval = _mm_add_epi8(bitval, _mm_and_si128(bitval, sel));
+	bitval = _mm_add_epi8(bitval, _mm_and_si128(bitval, sel));
+	bitval = _mm_add_epi8(bitval, _mm_and_si128(bitval, sel));
+	bitval = _mm_add_epi8(bitval, _mm_and_si128(bitval, sel));
+
+	/* pick the byte of the mask that holds the bit */
+	maskbyte = _mm_and_si128(_mm_cmpeq_epi8(byte, _mm_setzero_si128()), _mm_set1_epi8(mask));
+	maskbyte = _mm_or_si128(maskbyte, _mm_and_si128(_mm_cmpeq_epi8(byte, one), _mm_set1_epi8(mask >> 8)));
+	maskbyte = _mm_or_si128(maskbyte, _mm_and_si128(_mm_cmpeq_epi8(byte, _mm_set1_epi8(2)), _mm_set1_epi8(mask >> 16)));
+	maskbyte = _mm_or_si128(maskbyte, _mm_and_si128(_mm_cmpeq_epi8(byte, _mm_set1_epi8(3)), _mm_set1_epi8(mask >> 24)));
+
+	return _mm_cmpeq_epi8(_mm_and_si128(maskbyte, bitval), bitval);
+}
+
+
+/*-------------------------------------------------
+    drawgfx_sse2_reverse - reverse the order of
+    the bytes in a vector
+-------------------------------------------------*/
+
+INLINE __m128i drawgfx_sse2_reverse(__m128i pens)
+{
+	pens = _mm_shuffle_epi32(pens, _MM_SHUFFLE(0,1,2,3));
+	pens = _mm_shufflelo_epi16(pens, _MM_SHUFFLE(2,3,0,1));
+	pens = _mm_shufflehi_epi16(pens, _MM_SHUFFLE(2,3,0,1));
+	return _mm_or_si128(_mm_slli_epi16(pens, 8), _mm_srli_epi16(pens, 8));
+}
+
+
+/*-------------------------------------------------
+    drawgfx_sse2_merge - store 'value' to 'dest'
+    in the lanes selected by 'mask'
+-------------------------------------------------*/
+
+INLINE void drawgfx_sse2_merge(void *dest, __m128i value, __m128i mask)
+{
+	__m128i old = _mm_loadu_si128((const __m128i *)dest);
+	_mm_storeu_si128((__m128i *)dest, _mm_or_si128(_mm_and_si128(mask, value), _mm_andnot_si128(mask, old)));
+}
+
+
+/*-------------------------------------------------
+    drawgfx_row_sse2 - SSE2 row kernel for 16bpp
+    and 32bpp targets with no priority or an 8bpp
+    priority bitmap; works 16 pixels at a time,
+    overlapping the last block with the one
+    before it when the count is not a multiple
+    of 16
+-------------------------------------------------*/
+
+#define DRAWGFX_ROW_MAX_GATHER		512		/* widest zoomed row we gather */
+
+template<typename _PixelType, typename _PriorityType, int _RowOp>
+struct drawgfx_row_sse2
+{
+	static inline int ATTR_FORCE_INLINE draw(_PixelType *dest, _PriorityType *pri, const UINT8 *src, INT32 srcx, INT32 dx, UINT32 count,
+			const pen_t *paldata, UINT32 color, UINT32 trans, UINT32 pmask)
+	{
+		static const UINT8 lanemask[32] =
+		{
+			0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+			0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff
+		};
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i transvec = _mm_set1_epi8(trans);
+		const UINT8 *base = src + (srcx >> 16);
+		UINT8 rowpens[DRAWGFX_ROW_MAX_GATHER];
+		UINT8 flippens[16];
+		UINT32 x, i;
+
+		/* short rows aren't worth it */
+		if (count < 16)
+			return FALSE;
+
+		/* gather the pens of a zoomed row up front, so the blocks can load them directly; */
+		/* this only pays off when the pixels need no per-pen lookup afterwards */
+		if (dx != 0x10000 && dx != -0x10000)
+		{
+			if (_RowOp != DRAWGFX_ROW_REBASE_TRANSPEN || count > DRAWGFX_ROW_MAX_GATHER)
+				return FALSE;
+			for (i = 0; i < count; i++, srcx += dx)
+				rowpens[i] = src[srcx >> 16];
+			base = rowpens;
+			dx = 0x10000;
+		}
+
+		for (x = 0; x < count; x += 16)
+		{
+			const UINT8 *pens;
+			__m128i srcvec, drawvec;
+			UINT32 drawbits, skip = 0;
+
+			/* back the last block up so it ends on the last pixel, and skip the lanes already drawn */
+			if (x + 16 > count)
+			{
+				skip = x + 16 - count;
+				x = count - 16;
+			}
+
+			/* fetch 16 source pens; flipped ones are reversed into a buffer for the lookups */
+			if (dx > 0)
+			{
+				pens = base + x;
+				srcvec = _mm_loadu_si128((const __m128i *)pens);
+			}
+			else
+			{
+				pens = flippens;
+				srcvec = drawgfx_sse2_reverse(_mm_loadu_si128((const __m128i *)(base - x - 15)));
+				_mm_storeu_si128((__m128i *)flippens, srcvec);
+			}
+
+			/* find the opaque pixels */
+			if (_RowOp == DRAWGFX_ROW_REMAP_TRANSMASK)
+				drawvec = _mm_cmpeq_epi8(drawgfx_sse2_bit_test(srcvec, trans), zero);
+			else if (trans > 0xff)
+				drawvec = _mm_cmpeq_epi8(zero, zero);
+			else
+				drawvec = _mm_cmpeq_epi8(_mm_cmpeq_epi8(srcvec, transvec), zero);
+			if (skip != 0)
+				drawvec = _mm_and_si128(drawvec, _mm_loadu_si128((const __m128i *)&lanemask[16 - skip]));
+			if (_mm_movemask_epi8(drawvec) == 0)
+				continue;
+
+			/* opaque pixels claim the priority bitmap, but only draw where the mask allows */
+			if (PRIORITY_VALID(_PriorityType))
+			{
+				__m128i privec = _mm_loadu_si128((const __m128i *)&pri[x]);
+				__m128i blocked = drawgfx_sse2_bit_test(privec, pmask);
+				_mm_storeu_si128((__m128i *)&pri[x], _mm_or_si128(_mm_andnot_si128(drawvec, privec), _mm_and_si128(drawvec, _mm_set1_epi8(31))));
+				drawvec = _mm_andnot_si128(blocked, drawvec);
+			}
+			drawbits = _mm_movemask_epi8(drawvec);
+			if (drawbits == 0)
+				continue;
+
+			/* remapped pens need a lookup each; walk just the set bits of partial blocks */
+			if (_RowOp != DRAWGFX_ROW_REBASE_TRANSPEN)
+			{
+				if (drawbits == 0xffff)
+					for (i = 0; i < 16; i++)
+						dest[x + i] = paldata[pens[i]];
+				else
+					while (drawbits != 0)
+					{
+						i = 31 - count_leading_zeros(drawbits);
+						dest[x + i] = paldata[pens[i]];
+						drawbits &= ~(1 << i);
+					}
+			}
+
+			/* rebased pens are built in vectors and merged under the mask */
+			else if (sizeof(_PixelType) == 2)
+			{
+				__m128i colorvec = _mm_set1_epi16(color);
+				__m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(srcvec, zero), colorvec);
+				__m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(srcvec, zero), colorvec);
+
+				drawgfx_sse2_merge(&dest[x + 0], lo, _mm_unpacklo_epi8(drawvec, drawvec));
+				drawgfx_sse2_merge(&dest[x + 8], hi, _mm_unpackhi_epi8(drawvec, drawvec));
+			}
+			else
+			{
+				__m128i masklo = _mm_unpacklo_epi8(drawvec, drawvec);
+				__m128i maskhi = _mm_unpackhi_epi8(drawvec, drawvec);
+				__m128i colorvec = _mm_set1_epi32(color);
+				__m128i lo = _mm_unpacklo_epi8(srcvec, zero);
+				__m128i hi = _mm_unpackhi_epi8(srcvec, zero);
+				__m128i val0 = _mm_add_epi32(_mm_unpacklo_epi16(lo, zero), colorvec);
+				__m128i val1 = _mm_add_epi32(_mm_unpackhi_epi16(lo, zero), colorvec);
+				__m128i val2 = _mm_add_epi32(_mm_unpacklo_epi16(hi, zero), colorvec);
+				__m128i val3 = _mm_add_epi32(_mm_unpackhi_epi16(hi, zero), colorvec);
+
+				drawgfx_sse2_merge(&dest[x + 0], val0, _mm_unpacklo_epi16(masklo, masklo));
+				drawgfx_sse2_merge(&dest[x + 4], val1, _mm_unpackhi_epi16(masklo, masklo));
+				drawgfx_sse2_merge(&dest[x + 8], val2, _mm_unpacklo_epi16(maskhi, maskhi));
+				drawgfx_sse2_merge(&dest[x + 12], val3, _mm_unpackhi_epi16(maskhi, maskhi));
+			}
+		}
+		return TRUE;
+	}
+};
+
+
+/*-------------------------------------------------
+    drawgfx_row specializations - use the SSE2
+    kernel where it measures faster than the
+    PIXEL_OP: every operation with a priority
+    bitmap, where whole blocks are rejected at
+    once, and the rebase operation without one;
+    plain remapping is bound by the palette
+    lookups and stays on the PIXEL_OP path
+-------------------------------------------------*/
+
+template<int _RowOp> struct drawgfx_row<UINT16, UINT8, _RowOp> : public drawgfx_row_sse2<UINT16, UINT8, _RowOp> { };
+template<int _RowOp> struct drawgfx_row<UINT32, UINT8, _RowOp> : public drawgfx_row_sse2<UINT32, UINT8, _RowOp> { };
+template<> struct drawgfx_row<UINT16, NO_PRIORITY, DRAWGFX_ROW_REBASE_TRANSPEN> : public drawgfx_row_sse2<UINT16, NO_PRIORITY, DRAWGFX_ROW_REBASE_TRANSPEN> { };
+template<> struct drawgfx_row<UINT32, NO_PRIORITY, DRAWGFX_ROW_REBASE_TRANSPEN> : public drawgfx_row_sse2<UINT32, NO_PRIORITY, DRAWGFX_ROW_REBASE_TRANSPEN> { };
+
+#endif
+
+
+
 /***************************************************************************
     BASIC DRAWGFX CORE
 ***************************************************************************/
@@ -368,7 +692,7 @@ while (0)																			\
 */
 
 
-#define DRAWGFX_CORE(PIXEL_TYPE, PIXEL_OP, PRIORITY_TYPE)								\
+#define DRAWGFX_ROW_CORE(PIXEL_TYPE, PIXEL_OP, ROW_OP, PRIORITY_TYPE)					\
 do {																					\
 	profiler_mark_start(PROFILER_DRAWGFX);												\
 	do {																				\
@@ -464,6 +788,10 @@ do {																					\
 					const UINT8 *srcptr = srcdata;										\
 					srcdata += dy;														\
 																						\
+					/* hand the row to a kernel if there is one */						\
+					if (ROW_OP(PIXEL_TYPE, PRIORITY_TYPE, destptr, priptr, srcptr, 0, 0x10000, destendx + 1 - destx)) \
+						continue;														\
+																						\
 					/* iterate over unrolled blocks of 4 */								\
 					for (curx = 0; curx < numblocks; curx++)							\
 					{																	\
@@ -499,6 +827,10 @@ do {																					\
 					const UINT8 *srcptr = srcdata;										\
 					srcdata += dy;														\
 																						\
+					/* hand the row to a kernel if there is one */						\
+					if (ROW_OP(PIXEL_TYPE, PRIORITY_TYPE, destptr, priptr, srcptr, 0, -0x10000, destendx + 1 - destx)) \
+						continue;														\
+																						\
 					/* iterate over unrolled blocks of 4 */								\
 					for (curx = 0; curx < numblocks; curx++)							\
 					{																	\
@@ -616,6 +948,10 @@ do {																					\
 	profiler_mark_end();														\
 } while (0)
 
+/* the same, with no row kernel */
+#define DRAWGFX_CORE(PIXEL_TYPE, PIXEL_OP, PRIORITY_TYPE)								\
+	DRAWGFX_ROW_CORE(PIXEL_TYPE, PIXEL_OP, ROW_OP_NONE, PRIORITY_TYPE)
+
 
 
 /***************************************************************************
@@ -640,7 +976,7 @@ do {																					\
 */
 
 
-#define DRAWGFXZOOM_CORE(PIXEL_TYPE, PIXEL_OP, PRIORITY_TYPE)							\
+#define DRAWGFXZOOM_ROW_CORE(PIXEL_TYPE, PIXEL_OP, ROW_OP, PRIORITY_TYPE)				\
 do {																					\
 	profiler_mark_start(PROFILER_DRAWGFX);													\
 	do {																				\
@@ -747,6 +1083,10 @@ do {																					\
 				INT32 cursrcx = srcx;													\
 				srcy += dy;																\
 																						\
+				/* hand the row to a kernel if there is one */							\
+				if (ROW_OP(PIXEL_TYPE, PRIORITY_TYPE, destptr, priptr, srcptr, cursrcx, dx, destendx + 1 - destx)) \
+					continue;															\
+																						\
 				/* iterate over unrolled blocks of 4 */									\
 				for (curx = 0; curx < numblocks; curx++)								\
 				{																		\
@@ -800,6 +1140,10 @@ do {																					\
 	profiler_mark_end();														\
 } while (0)
 
+/* the same, with no row kernel */
+#define DRAWGFXZOOM_CORE(PIXEL_TYPE, PIXEL_OP, PRIORITY_TYPE)							\
+	DRAWGFXZOOM_ROW_CORE(PIXEL_TYPE, PIXEL_OP, ROW_OP_NONE, PRIORITY_TYPE)
+
 
 
 /***************************************************************************
@@ -79,6 +79,7 @@ EMUOBJS = \
 	$(EMUOBJ)/mconfig.o \
 	$(EMUOBJ)/memory.o \
 	$(EMUOBJ)/output.o \
+	$(EMUOBJ)/ramsearch.o \
 	$(EMUOBJ)/render.o \
 	$(EMUOBJ)/rendfont.o \
 	$(EMUOBJ)/rendlay.o \
@@ -99,11 +100,14 @@ EMUOBJS = \
 	$(EMUOBJ)/validity.o \
 	$(EMUOBJ)/video.o \
 	$(EMUOBJ)/watchdog.o \
+	$(EMUOBJ)/debug/bintrace.o \
+	$(EMUOBJ)/debug/cpuprof.o \
 	$(EMUOBJ)/debug/debugcmd.o \
 	$(EMUOBJ)/debug/debugcmt.o \
 	$(EMUOBJ)/debug/debugcon.o \
 	$(EMUOBJ)/debug/debugcpu.o \
 	$(EMUOBJ)/debug/debughlp.o \
+	$(EMUOBJ)/debug/debugsrv.o \
 	$(EMUOBJ)/debug/debugvw.o \
 	$(EMUOBJ)/debug/dvdisasm.o \
 	$(EMUOBJ)/debug/dvmemory.o \
@@ -212,6 +216,7 @@ EMUMACHINEOBJS = \
 EMUVIDEOOBJS = \
 	$(EMUVIDEO)/generic.o \
 	$(EMUVIDEO)/hd63484.o \
+	$(EMUVIDEO)/layerjob.o \
 	$(EMUVIDEO)/mc6845.o \
 	$(EMUVIDEO)/pc_vga.o \
 	$(EMUVIDEO)/pc_video.o \
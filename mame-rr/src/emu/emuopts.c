@@ -79,6 +79,7 @@ const options_entry mame_core_options[] =
 	{ "frameskip;fs(0-10)",          "0",         0,                 "set frameskip to fixed value, 0-10 (autoframeskip must be disabled)" },
 	{ "seconds_to_run;str",          "0",         0,                 "number of emulated seconds to run before automatically exiting" },
 	{ "throttle",                    "1",         OPTION_BOOLEAN,    "enable throttling to keep game running in sync with real time" },
+	{ "rendering",                   "1",         OPTION_BOOLEAN,    "draw the screens each frame; disable to skip all drawing not needed for movies, snapshots or scripts" },
 	{ "sleep",                       "1",         OPTION_BOOLEAN,    "enable sleeping, which gives time back to other applications when idle" },
 	{ "speed(0.01-100)",             "1.0",       0,                 "controls the speed of gameplay, relative to realtime; smaller numbers are slower" },
 	{ "refreshspeed;rs",             "0",         OPTION_BOOLEAN,    "automatically adjusts the speed of gameplay to keep the refresh rate lower than the screen" },
@@ -157,6 +158,8 @@ const options_entry mame_core_options[] =
 	{ "debug;d",                     "0",         OPTION_BOOLEAN,    "enable/disable debugger" },
 	{ "debugscript",                 NULL,        0,                 "script for debugger" },
 	{ "debug_internal;di",           "0",         OPTION_BOOLEAN,    "use the internal debugger for debugging" },
+	{ "debugserver",                 "0",         0,                 "run the debugger without a GUI, driven from this local TCP port (0 = off)" },
+	{ "profilelog",                  NULL,        0,                 "write per-frame profiler timings and counters to this CSV file (profiling builds only)" },
 
 	/* misc options */
 	{ NULL,                          NULL,        OPTION_HEADER,     "CORE MISC OPTIONS" },
@@ -82,6 +82,7 @@
 #define OPTION_FRAMESKIP			"frameskip"
 #define OPTION_SECONDS_TO_RUN		"seconds_to_run"
 #define OPTION_THROTTLE				"throttle"
+#define OPTION_RENDERING			"rendering"
 #define OPTION_SLEEP				"sleep"
 #define OPTION_SPEED				"speed"
 #define OPTION_REFRESHSPEED			"refreshspeed"
@@ -147,6 +148,8 @@
 #define OPTION_DEBUG				"debug"
 #define OPTION_DEBUG_INTERNAL		"debug_internal"
 #define OPTION_DEBUGSCRIPT			"debugscript"
+#define OPTION_DEBUGSERVER			"debugserver"
+#define OPTION_PROFILELOG			"profilelog"
 #define OPTION_UPDATEINPAUSE		"update_in_pause"
 
 /* core misc options */
@@ -208,6 +208,19 @@ struct _device_field_info
 };
 
 
+/* precomputed per-frame information about a field, stored contiguously */
+typedef struct _frame_field_info frame_field_info;
+struct _frame_field_info
+{
+	const input_field_config *	field;				/* pointer to the input field referenced */
+	const input_condition *		condition;			/* condition to check, or NULL if always true */
+	analog_field_state *		analog;				/* pointer to live analog data if this is an analog field */
+	const input_seq *			seq;				/* resolved standard sequence */
+	input_port_value			mask;				/* mask of the field within the port */
+	UINT8						vblank;				/* is this an IPT_VBLANK field? */
+};
+
+
 /* internal live state of an input field */
 struct _input_field_state
 {
@@ -232,6 +245,10 @@ struct _input_port_state
 	input_port_value			digital;			/* current value from all digital inputs */
 	input_port_value			vblank;				/* value of all IPT_VBLANK bits */
 	input_port_value			outputvalue;		/* current value for outputs */
+	frame_field_info *			framefields;		/* per-frame info for all fields, in list order */
+	frame_field_info **			vblankfields;		/* per-frame info for just the IPT_VBLANK fields */
+	int							numframefields;		/* number of entries in framefields */
+	int							numvblankfields;	/* number of entries in vblankfields */
 };
 
 
@@ -262,6 +279,9 @@ struct _input_port_private
 	attotime					last_frame_time;	/* time of the last frame callback */
 	attoseconds_t				last_delta_nsec;	/* nanoseconds that passed since the previous callback */
 
+	/* precomputed field tables */
+	UINT8						framefields_dirty;	/* set when the resolved sequences need refreshing */
+
 	/* playback/record information */
 	FILE *						record_file;		/* recording file (NULL if not recording) */
 	FILE *						playback_file;		/* playback file (NULL if not recording) */
@@ -793,6 +813,7 @@ static INT32 apply_analog_settings(INT32 current, analog_field_state *analog);
 static void init_port_types(running_machine *machine);
 static void init_port_state(running_machine *machine);
 static void init_autoselect_devices(const ioport_list &portlist, int type1, int type2, int type3, const char *option, const char *ananame);
+static void init_frame_fields(running_machine *machine);
 static device_field_info *init_field_device_info(const input_field_config *field,const char *device_name);
 static analog_field_state *init_field_analog_state(const input_field_config *field);
 
@@ -801,7 +822,8 @@ static void frame_update_callback(running_machine &machine);
 static void frame_update(running_machine *machine);
 static void frame_update_digital_joysticks(running_machine *machine);
 static void frame_update_analog_field(running_machine *machine, analog_field_state *analog);
-static int frame_get_digital_field_state(const input_field_config *field, int mouse_down);
+static void frame_refresh_field_seqs(running_machine *machine);
+static int frame_get_digital_field_state(const frame_field_info *info, int mouse_down);
 
 /* port configuration helpers */
 static void port_config_detokenize(ioport_list &portlist, const input_port_token *ipt, char *errorbuf, int errorbuflen);
@@ -1193,6 +1215,7 @@ void input_field_set_user_settings(const input_field_config *field, const input_
 		else
 			field->state->seq[seqtype] = settings->seq[seqtype];
 	}
+	field->port->machine->input_port_data->framefields_dirty = TRUE;
 
 	/* if there's a list of settings or we're an adjuster, copy the current value */
 	if (field->settinglist != NULL || field->type == IPT_ADJUSTER)
@@ -2137,6 +2160,63 @@ static void init_port_state(running_machine *machine)
 					input_device_set_joystick_map(machine, -1, (field->flags & FIELD_FLAG_ROTATED) ? joystick_map_4way_diagonal : joystick_map_4way_sticky);
 					break;
 				}
+
+	/* build the tables walked each frame */
+	init_frame_fields(machine);
+}
+
+
+/*-------------------------------------------------
+    init_frame_fields - build the contiguous
+    per-frame field tables for all ports
+-------------------------------------------------*/
+
+static void init_frame_fields(running_machine *machine)
+{
+	input_port_private *portdata = machine->input_port_data;
+	frame_field_info **vblankinfo;
+	frame_field_info *info;
+	const input_field_config *field;
+	const input_port_config *port;
+	int numfields = 0, numvblank = 0;
+
+	/* count the fields across every port */
+	for (port = machine->m_portlist.first(); port != NULL; port = port->next())
+		for (field = port->fieldlist; field != NULL; field = field->next)
+		{
+			numfields++;
+			if (field->type == IPT_VBLANK)
+				numvblank++;
+		}
+
+	/* allocate one block for everything */
+	info = auto_alloc_array_clear(machine, frame_field_info, MAX(numfields, 1));
+	vblankinfo = auto_alloc_array_clear(machine, frame_field_info *, MAX(numvblank, 1));
+
+	/* carve it up per port */
+	for (port = machine->m_portlist.first(); port != NULL; port = port->next())
+	{
+		port->state->framefields = info;
+		port->state->vblankfields = vblankinfo;
+
+		for (field = port->fieldlist; field != NULL; field = field->next)
+		{
+			info->field = field;
+			info->condition = (field->condition.condition == PORTCOND_ALWAYS) ? NULL : &field->condition;
+			info->analog = field->state->analog;
+			info->mask = field->mask;
+			info->vblank = (field->type == IPT_VBLANK);
+			if (info->vblank)
+				*vblankinfo++ = info;
+			info++;
+		}
+
+		port->state->numframefields = info - port->state->framefields;
+		port->state->numvblankfields = vblankinfo - port->state->vblankfields;
+	}
+
+	/* sequences are resolved lazily, after the configuration is loaded */
+	portdata->framefields_dirty = TRUE;
 }
 
 
@@ -2488,6 +2568,7 @@ static void frame_update(running_machine *machine)
 	input_port_private *portdata = machine->input_port_data;
 	const input_field_config *mouse_field = NULL;
 	int ui_visible = ui_is_menu_active();
+	int playing;
 	attotime curtime = timer_get_time(machine);
 	const input_port_config *port;
 	render_target *mouse_target;
@@ -2518,57 +2599,94 @@ profiler_mark_start(PROFILER_INPUT);
 	portdata->last_delta_nsec = attotime_to_attoseconds(attotime_sub(curtime, portdata->last_frame_time)) / ATTOSECONDS_PER_NANOSECOND;
 	portdata->last_frame_time = curtime;
 
-	/* update the digital joysticks */
-	frame_update_digital_joysticks(machine);
+	/* during playback the movie supplies the default, digital and analog values */
+	/* of every port, so there is no point polling the live inputs */
+	playing = (portdata->playback_file != NULL);
+	if (!playing)
+	{
+		/* update the digital joysticks */
+		frame_update_digital_joysticks(machine);
 
-	/* compute default values for all the ports */
-	input_port_update_defaults(machine);
+		/* compute default values for all the ports */
+		input_port_update_defaults(machine);
 
-	/* perform the mouse hit test */
-	mouse_target = ui_input_find_mouse(machine, &mouse_target_x, &mouse_target_y, &mouse_button);
-	if (mouse_button && mouse_target)
-	{
-		const char *tag = NULL;
-		input_port_value mask;
-		if (render_target_map_point_input(mouse_target, mouse_target_x, mouse_target_y, &tag, &mask, NULL, NULL))
-			mouse_field = input_field_by_tag_and_mask(machine->m_portlist, tag, mask);
+		/* perform the mouse hit test */
+		mouse_target = ui_input_find_mouse(machine, &mouse_target_x, &mouse_target_y, &mouse_button);
+		if (mouse_button && mouse_target)
+		{
+			const char *tag = NULL;
+			input_port_value mask;
+			if (render_target_map_point_input(mouse_target, mouse_target_x, mouse_target_y, &tag, &mask, NULL, NULL))
+				mouse_field = input_field_by_tag_and_mask(machine->m_portlist, tag, mask);
+		}
+
+		/* re-resolve the sequences if the configuration changed */
+		if (portdata->framefields_dirty)
+			frame_refresh_field_seqs(machine);
 	}
 
+	/* let Lua scripts act once per frame, before any port is resolved */
+	CallRegisteredLuaFunctions(LUACALL_BEFOREEMULATION);
+
 	/* loop over all input ports */
 	for (port = machine->m_portlist.first(); port != NULL; port = port->next())
 	{
-		const input_field_config *field;
-		device_field_info *device_field;
-		input_port_value newvalue;
+		input_port_state *portstate = port->state;
+		int fieldnum;
 
 		/* start with 0 values for the digital and VBLANK bits */
-		port->state->digital = 0;
-		port->state->vblank = 0;
+		portstate->digital = 0;
+		portstate->vblank = 0;
+
+		/* when playing back, only the VBLANK bits are not in the movie */
+		if (playing)
+		{
+			for (fieldnum = 0; fieldnum < portstate->numvblankfields; fieldnum++)
+			{
+				const frame_field_info *info = portstate->vblankfields[fieldnum];
+				if (info->condition == NULL || input_condition_true(machine, info->condition))
+					portstate->vblank ^= info->mask;
+			}
+
+			/* handle playback */
+			playback_port(port);
+			continue;
+		}
 
 		/* now loop back and modify based on the inputs */
-		for (field = port->fieldlist; field != NULL; field = field->next)
-			if (input_condition_true(port->machine, &field->condition))
+		for (fieldnum = 0; fieldnum < portstate->numframefields; fieldnum++)
+		{
+			const frame_field_info *info = &portstate->framefields[fieldnum];
+
+			if (info->condition == NULL || input_condition_true(machine, info->condition))
 			{
 				/* accumulate VBLANK bits */
-				if (field->type == IPT_VBLANK)
-					port->state->vblank ^= field->mask;
+				if (info->vblank)
+					portstate->vblank ^= info->mask;
 
 				/* handle analog inputs */
-				else if (field->state->analog != NULL)
-					frame_update_analog_field(machine, field->state->analog);
+				else if (info->analog != NULL)
+					frame_update_analog_field(machine, info->analog);
 
 				/* handle non-analog types, but only when the UI isn't visible */
-				else if (!ui_visible && frame_get_digital_field_state(field, field == mouse_field))
-					port->state->digital |= field->mask;
+				else if (!ui_visible && frame_get_digital_field_state(info, info->field == mouse_field))
+					portstate->digital |= info->mask;
 			}
+		}
 
 		/* hook for MESS's natural keyboard support */
-		input_port_update_hook(machine, port, &port->state->digital);
+		input_port_update_hook(machine, port, &portstate->digital);
+	}
+
+	/* apply any Lua joypad input for this frame on top of the playback */
+	MAME_LuaReadJoypad();
+
+	/* record the final values and notify devices */
+	for (port = machine->m_portlist.first(); port != NULL; port = port->next())
+	{
+		device_field_info *device_field;
+		input_port_value newvalue;
 
-		/* handle playback/record */
-		playback_port(port);
-		CallRegisteredLuaFunctions(LUACALL_BEFOREEMULATION);
-		MAME_LuaReadJoypad();
 		record_port(port);
 
 		/* call device line changed handlers */
@@ -2824,14 +2942,37 @@ static void frame_update_analog_field(running_machine *machine, analog_field_sta
 }
 
 
+/*-------------------------------------------------
+    frame_refresh_field_seqs - resolve the
+    standard sequence of every field after the
+    configuration changed
+-------------------------------------------------*/
+
+static void frame_refresh_field_seqs(running_machine *machine)
+{
+	const input_port_config *port;
+	int fieldnum;
+
+	for (port = machine->m_portlist.first(); port != NULL; port = port->next())
+		for (fieldnum = 0; fieldnum < port->state->numframefields; fieldnum++)
+		{
+			frame_field_info *info = &port->state->framefields[fieldnum];
+			info->seq = input_field_seq(info->field, SEQ_TYPE_STANDARD);
+		}
+
+	machine->input_port_data->framefields_dirty = FALSE;
+}
+
+
 /*-------------------------------------------------
     frame_get_digital_field_state - get the state
     of a digital field
 -------------------------------------------------*/
 
-static int frame_get_digital_field_state(const input_field_config *field, int mouse_down)
+static int frame_get_digital_field_state(const frame_field_info *info, int mouse_down)
 {
-	int curstate = mouse_down || input_seq_pressed(field->port->machine, input_field_seq(field, SEQ_TYPE_STANDARD));
+	const input_field_config *field = info->field;
+	int curstate = mouse_down || input_seq_pressed(field->port->machine, info->seq);
 	int changed = FALSE;
 
 	/* if the state changed, look for switch down/switch up */
@@ -4131,6 +4272,7 @@ static int load_game_config(running_machine *machine, xml_data_node *portnode, i
 					for (seqtype = 0; seqtype < ARRAY_LENGTH(field->state->seq); seqtype++)
 						if (input_seq_get_1(&newseq[seqtype]) != INPUT_CODE_INVALID)
 							field->state->seq[seqtype] = newseq[seqtype];
+					machine->input_port_data->framefields_dirty = TRUE;
 
 					/* for non-analog fields, fetch the value */
 					if (field->state->analog == NULL)
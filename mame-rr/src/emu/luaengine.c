@@ -3,12 +3,18 @@
 #include <malloc.h>
 #include <ctype.h>
 #include <algorithm>
+#include <new>
 #include <vector>
 #include <string>
+#include <map>
 
 using std::min;
 using std::max;
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #ifdef __linux
 #include <unistd.h>
 #include <sys/types.h>
@@ -19,7 +25,9 @@ extern "C" {
 	#include <lua.h>
 	#include <lauxlib.h>
 	#include <lualib.h>
+#ifndef MAME_LUAJIT
 	#include <lstate.h>
+#endif
 }
 
 #include "emu.h"
@@ -27,6 +35,7 @@ extern "C" {
 #include "memory.h"
 #include "uiinput.h"
 #include "luasav.h"
+#include "ramsearch.h"
 #ifdef WIN32
 #include <direct.h>
 #include <windows.h>
@@ -95,11 +104,22 @@ static int transparencyModifier = 255;
 static short lua_joypads[0x0100];
 static UINT8 lua_joypads_used;
 
+// Input queued ahead of time by joypad.plan(), one state per field per frame
+// (0 = leave alone, 1 = pressed, 2 = unpressed) so it can be applied without
+// calling into Lua every frame.
+static const input_field_config **lua_plan_fields = NULL;
+static int lua_plan_numfields = 0;
+static UINT8 *lua_plan = NULL;
+static UINT32 lua_plan_frames = 0;	// frames stored
+static UINT32 lua_plan_next = 0;	// next frame to apply
+static UINT32 lua_plan_alloc = 0;	// frames allocated
+
 static UINT8 gui_enabled = TRUE;
 static enum { GUI_USED_SINCE_LAST_DISPLAY, GUI_USED_SINCE_LAST_FRAME, GUI_CLEAR } gui_used = GUI_CLEAR;
 static UINT8          * gui_data = NULL;
 static bitmap_t       * gui_bitmap = NULL;
 static render_texture * gui_texture = NULL;
+static rectangle        gui_dirty = { 0, -1, 0, -1 };	// area drawn to since the last clear (inclusive)
 
 // Protects Lua calls from going nuts.
 // We set this to a big number like 1000 and decrement it
@@ -130,13 +150,106 @@ static std::string empty_driver("empty");
 static bool is_init = false;
 static bool run_it_once = false;
 
+// Lua profiler (debug.profile_start/stop/report)
+// Every entry point from the emulator into Lua gets a slot; time spent there
+// is only measured while profiling, so the cost when disabled is one branch.
+enum
+{
+	LUAPROF_FRAMEADVANCE = LUACALL_COUNT,
+	LUAPROF_GUI,
+	LUAPROF_MEMORY,
+	LUAPROF_COUNT
+};
+
+static const char* luaProfileNames [] =
+{
+	"registerbefore",
+	"registerafter",
+	"registerexit",
+	"registerstart",
+	"hotkey 1",
+	"hotkey 2",
+	"hotkey 3",
+	"hotkey 4",
+	"hotkey 5",
+	"frameadvance",
+	"gui.register",
+	"registerwrite",
+};
+
+struct lua_profile_slot
+{
+	UINT32      calls;
+	osd_ticks_t ticks;
+	osd_ticks_t maxticks;
+	INT64       heapgrowth;      // bytes the Lua heap grew during calls
+	INT64       heapfreed;       // bytes the collector released during calls
+};
+
+struct lua_profile_line
+{
+	UINT32      samples;
+	osd_ticks_t ticks;
+};
+
+struct lua_profile_mark
+{
+	osd_ticks_t start;
+	INT64       heap;
+};
+
+static int luaProfiling = FALSE;
+static int luaProfileOverlay = FALSE;
+static int luaWatchdog = TRUE;
+static osd_ticks_t luaProfileLastSample;
+static lua_profile_slot luaProfile[LUAPROF_COUNT];
+static std::map<std::string, lua_profile_line> luaProfileLines;
+
+// instructions between profiler samples, and between runaway script checks
+#define LUA_PROFILE_INTERVAL   1000
+#define LUA_WATCHDOG_INTERVAL  10000
+
+static INT64 lua_heapbytes(lua_State *L) {
+	return (INT64)lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
+}
+
+static inline void lua_profile_begin(lua_State *L, lua_profile_mark *mark) {
+	mark->start = 0;
+	if (!luaProfiling)
+		return;
+	mark->heap = lua_heapbytes(L);
+	mark->start = luaProfileLastSample = osd_ticks();
+}
+
+static inline void lua_profile_end(lua_State *L, lua_profile_mark *mark, int slot) {
+	// skip calls which started (or stopped) profiling part way through
+	if (!luaProfiling || mark->start == 0)
+		return;
+
+	lua_profile_slot &prof = luaProfile[slot];
+	osd_ticks_t elapsed = osd_ticks() - mark->start;
+	INT64 heapdelta = lua_heapbytes(L) - mark->heap;
+
+	prof.calls++;
+	prof.ticks += elapsed;
+	if (elapsed > prof.maxticks)
+		prof.maxticks = elapsed;
+	if (heapdelta > 0)
+		prof.heapgrowth += heapdelta;
+	else
+		prof.heapfreed -= heapdelta;
+}
+
 /**
  * Resets emulator speed / pause states after script exit.
  * (Actually, MAME doesn't do any of these. They were very annoying.)
  */
+static void joypad_plan_free(bool fields);
+
 static void MAME_LuaOnStop() {
 	luaRunning = FALSE;
 	lua_joypads_used = 0;
+	joypad_plan_free(false);
 	gui_used = GUI_CLEAR;
 }
 
@@ -215,8 +328,12 @@ void MAME_LuaWriteInform() {
 			lua_settable(LUA, 4);
 			lua_pop(LUA, 2);
 
+			lua_profile_mark mark;
+
 			numTries = 1000;
+			lua_profile_begin(LUA, &mark);
 			res = lua_pcall(LUA, 0, 0, 0);
+			lua_profile_end(LUA, &mark, LUAPROF_MEMORY);
 			if (res) {
 				const char *err = lua_tostring(LUA, -1);
 				
@@ -320,6 +437,33 @@ static int mame_speedmode(lua_State *L) {
 }
 
 
+// mame.setrendering(boolean render)
+//
+//   Turns drawing of the screens on or off. With it off, emulation
+//   carries on but frames are skipped, except while a movie is being
+//   recorded, when a snapshot is taken, or when a script reads the
+//   screen. Skipped frames are not throttled, so the game runs as fast
+//   as it can.
+//
+//   gui.getpixel() and gui.gdscreenshot() return nil for a frame that
+//   wasn't drawn, and make sure the following frame is; a script that
+//   reads the screen every frame therefore gets nil once, and real
+//   pixels from then on, one frame behind the point it started reading.
+static int mame_setrendering(lua_State *L) {
+	video_set_rendering(lua_toboolean(L,1));
+	return 0;
+}
+
+
+// boolean mame.getrendering()
+//
+//   Returns whether the screens are being drawn (see mame.setrendering).
+static int mame_getrendering(lua_State *L) {
+	lua_pushboolean(L, video_get_rendering());
+	return 1;
+}
+
+
 // mame.frameadvance()
 //
 //  Executes a frame advance. Occurs by yielding the coroutine, then re-running
@@ -417,6 +561,10 @@ static void toCStringConverter(lua_State* L, int i, char*& ptr, int& remaining)
 		case LUA_TSTRING: APPENDPRINT "%s",lua_tostring(L,i) END break;
 		case LUA_TNUMBER: APPENDPRINT "%.12g",lua_tonumber(L,i) END break;
 		case LUA_TFUNCTION: 
+#ifdef MAME_LUAJIT
+			// LuaJIT doesn't expose its prototypes, so there are no parameter names to show
+			goto defcase;
+#else
 			if((L->base + i-1)->value.gc->cl.c.isC)
 			{
 				//lua_CFunction func = lua_tocfunction(L, i);
@@ -441,6 +589,7 @@ static void toCStringConverter(lua_State* L, int i, char*& ptr, int& remaining)
 				APPENDPRINT ")" END
 			}
 			break;
+#endif
 defcase:default: APPENDPRINT "%s:%p",luaL_typename(L,i),lua_topointer(L,i) END break;
 		case LUA_TTABLE:
 		{
@@ -854,6 +1003,80 @@ static int memory_readbyterange(lua_State *L) {
 	return 1;
 }
 
+// Plain C entry points for LuaJIT's FFI. Calls through ffi.C skip the
+// Lua stack entirely and can be compiled into traces, which makes a big
+// difference for bots that scan memory every frame. There is no way to
+// raise a Lua error from here, so reads without a game just return 0.
+//
+//   local ffi = require("ffi")
+//   ffi.cdef(memory.cdef)
+//   local value = ffi.C.MAME_LuaReadByte(0xff0000)
+static const address_space *ffi_program_space()
+{
+	if (machine == NULL || empty_driver.compare(machine->basename()) == 0)
+		return NULL;
+	return cpu_get_address_space(machine->firstcpu, ADDRESS_SPACE_PROGRAM);
+}
+
+extern "C" {
+
+LUA_FFI_EXPORT UINT8 MAME_LuaReadByte(UINT32 address)
+{
+	const address_space *space = ffi_program_space();
+	return (space != NULL) ? memory_read_byte(space, address) : 0;
+}
+
+LUA_FFI_EXPORT INT8 MAME_LuaReadByteSigned(UINT32 address)
+{
+	return (INT8)MAME_LuaReadByte(address);
+}
+
+LUA_FFI_EXPORT UINT16 MAME_LuaReadWord(UINT32 address)
+{
+	const address_space *space = ffi_program_space();
+	return (space != NULL) ? custom_read_word(space, address) : 0;
+}
+
+LUA_FFI_EXPORT INT16 MAME_LuaReadWordSigned(UINT32 address)
+{
+	return (INT16)MAME_LuaReadWord(address);
+}
+
+LUA_FFI_EXPORT UINT32 MAME_LuaReadDword(UINT32 address)
+{
+	const address_space *space = ffi_program_space();
+	return (space != NULL) ? custom_read_dword(space, address) : 0;
+}
+
+LUA_FFI_EXPORT INT32 MAME_LuaReadDwordSigned(UINT32 address)
+{
+	return (INT32)MAME_LuaReadDword(address);
+}
+
+LUA_FFI_EXPORT UINT32 MAME_LuaReadByteRange(UINT32 address, UINT8 *dest, UINT32 length)
+{
+	const address_space *space = ffi_program_space();
+	UINT32 n;
+
+	if (space == NULL || dest == NULL)
+		return 0;
+	for (n = 0; n < length; n++)
+		dest[n] = memory_read_byte(space, address + n);
+	return length;
+}
+
+}
+
+// the declarations a script hands to ffi.cdef; keep in sync with the above
+static const char ffi_memory_cdef[] =
+	"uint8_t MAME_LuaReadByte(uint32_t address);\n"
+	"int8_t MAME_LuaReadByteSigned(uint32_t address);\n"
+	"uint16_t MAME_LuaReadWord(uint32_t address);\n"
+	"int16_t MAME_LuaReadWordSigned(uint32_t address);\n"
+	"uint32_t MAME_LuaReadDword(uint32_t address);\n"
+	"int32_t MAME_LuaReadDwordSigned(uint32_t address);\n"
+	"uint32_t MAME_LuaReadByteRange(uint32_t address, uint8_t *dest, uint32_t length);\n";
+
 void custom_write_word(const address_space *space, offs_t address, UINT16 data) {
 	// if this is a misaligned write, just write two bytes
 	if ((address & 1) != 0) {
@@ -945,6 +1168,116 @@ static int memory_registerwrite(lua_State *L) {
 }
 
 
+// the RAM search used by the ramsearch library; it belongs to the
+// running machine and is dropped along with it
+static ramsearch_state *luaRamSearch = NULL;
+
+static ramsearch_state *ramsearch_get(lua_State *L, bool needreset) {
+	if (empty_driver.compare(machine->basename()) == 0) luaL_error(L, "no game loaded");
+	if (luaRamSearch == NULL)
+		luaRamSearch = ramsearch_alloc(machine);
+	if (needreset && ramsearch_get_space(luaRamSearch) == NULL)
+		luaL_error(L, "ramsearch.reset must be called first");
+	return luaRamSearch;
+}
+
+static int ramsearch_checkcompare(lua_State *L, int i) {
+	int compare = ramsearch_compare_from_string(luaL_checkstring(L, i));
+	if (compare < 0)
+		luaL_error(L, "unknown comparison \"%s\"", lua_tostring(L, i));
+	return compare;
+}
+
+// int ramsearch.reset([int size = 1 [, bool signed = false [, bool aligned = true]]])
+//
+//  Takes a snapshot of the main CPU's RAM and makes every value of the
+//  given size (1, 2 or 4 bytes) a candidate. Returns the candidate count.
+static int ramsearch_lua_reset(lua_State *L) {
+	ramsearch_state *search = ramsearch_get(L, false);
+	int size = luaL_optinteger(L, 1, 1);
+	bool is_signed = lua_toboolean(L, 2) != 0;
+	bool aligned = lua_isnoneornil(L, 3) || lua_toboolean(L, 3);
+
+	if (size != 1 && size != 2 && size != 4)
+		luaL_error(L, "size must be 1, 2 or 4");
+	lua_pushinteger(L, ramsearch_reset(search, cpu_get_address_space(machine->firstcpu, ADDRESS_SPACE_PROGRAM), size, is_signed, aligned));
+	return 1;
+}
+
+// ramsearch.update()
+//
+//  Takes a new snapshot and counts the values that changed. Call it
+//  every frame if you intend to search on the change counts.
+static int ramsearch_lua_update(lua_State *L) {
+	ramsearch_update(ramsearch_get(L, true));
+	return 0;
+}
+
+// int ramsearch.search(string compare [, int value [, int param]])
+//
+//  Keeps the candidates whose current value compares true against the
+//  given value, or against their value at the last search if it is nil.
+//  compare is one of < > <= >= == ~= != diffby modulo; diffby and modulo
+//  take their distance or divisor in param. Returns the candidate count.
+static int ramsearch_lua_search(lua_State *L) {
+	ramsearch_state *search = ramsearch_get(L, true);
+	int compare = ramsearch_checkcompare(L, 1);
+	int target = lua_isnoneornil(L, 2) ? RAMSEARCH_PREVIOUS : RAMSEARCH_SPECIFIC;
+	INT64 operand = (target == RAMSEARCH_SPECIFIC) ? (INT64)luaL_checknumber(L, 2) : 0;
+	INT64 param = (INT64)luaL_optnumber(L, 3, 0);
+
+	lua_pushinteger(L, ramsearch_search(search, compare, target, operand, param));
+	return 1;
+}
+
+// int ramsearch.changes(string compare, int count)
+//
+//  Keeps the candidates whose change count compares true against count.
+static int ramsearch_lua_changes(lua_State *L) {
+	ramsearch_state *search = ramsearch_get(L, true);
+	int compare = ramsearch_checkcompare(L, 1);
+	INT64 operand = (INT64)luaL_checknumber(L, 2);
+	INT64 param = (INT64)luaL_optnumber(L, 3, 0);
+
+	lua_pushinteger(L, ramsearch_search(search, compare, RAMSEARCH_CHANGES, operand, param));
+	return 1;
+}
+
+// int ramsearch.count()
+static int ramsearch_lua_count(lua_State *L) {
+	lua_pushinteger(L, ramsearch_count(ramsearch_get(L, true)));
+	return 1;
+}
+
+// table ramsearch.results([int max = 1000 [, int first = 0]])
+//
+//  Returns an array of {address=, value=, previous=, changes=} tables
+//  for up to max candidates, skipping the first 'first' of them.
+static int ramsearch_lua_results(lua_State *L) {
+	ramsearch_state *search = ramsearch_get(L, true);
+	int maxresults = luaL_optinteger(L, 1, 1000);
+	int first = luaL_optinteger(L, 2, 0);
+	std::vector<ramsearch_result> results(max(maxresults, 0) + 1);
+	UINT32 found = ramsearch_results(search, max(first, 0), &results[0], max(maxresults, 0));
+
+	lua_createtable(L, found, 0);
+	for (UINT32 i = 0; i < found; i++)
+	{
+		lua_createtable(L, 0, 4);
+		lua_pushnumber(L, results[i].address);
+		lua_setfield(L, -2, "address");
+		lua_pushnumber(L, (lua_Number)results[i].value);
+		lua_setfield(L, -2, "value");
+		lua_pushnumber(L, (lua_Number)results[i].previous);
+		lua_setfield(L, -2, "previous");
+		lua_pushinteger(L, results[i].changes);
+		lua_setfield(L, -2, "changes");
+		lua_rawseti(L, -2, i + 1);
+	}
+	return 1;
+}
+
+
 // table joypad.read()
 //
 //  Reads the joypads as inputted by the user.
@@ -1047,6 +1380,116 @@ static int joypad_set(lua_State *L) {
 }
 
 
+// Returns the name of a field if joypad.set/joypad.plan can drive it.
+static const char *joypad_plan_field_name(const input_field_config *field) {
+	const char *name = input_field_name(field);
+
+	if (name != NULL &&
+#ifdef MESS
+		(field->category == 0 || input_category_active(machine, field->category)) &&
+#endif // MESS
+		((field->type == IPT_OTHER && field->name != NULL) || input_type_group(machine, field->type, field->player) != IPG_INVALID))
+		return name;
+	return NULL;
+}
+
+// Releases the queued frames, and the field table too if asked.
+static void joypad_plan_free(bool fields) {
+	if (lua_plan != NULL)
+		free(lua_plan);
+	lua_plan = NULL;
+	lua_plan_frames = lua_plan_next = lua_plan_alloc = 0;
+
+	if (fields) {
+		if (lua_plan_fields != NULL)
+			free(lua_plan_fields);
+		lua_plan_fields = NULL;
+		lua_plan_numfields = 0;
+	}
+}
+
+// joypad.plan([table frames])
+//
+//   Queues one table of buttons per frame, in the same form
+//   joypad.set takes, to be applied on the following frames
+//   without calling back into Lua. A non-table entry leaves
+//   that frame alone. joypad.set still wins for the frame it
+//   is called on. joypad.plan(false) drops whatever is queued.
+//   Returns the number of frames still queued.
+static int joypad_plan(lua_State *L) {
+	const input_port_config *port;
+	const input_field_config *field;
+	UINT32 count, frame;
+	int f;
+
+	if (lua_gettop(L) == 0) {
+		lua_pushinteger(L, lua_plan_frames - lua_plan_next);
+		return 1;
+	}
+	if (!lua_toboolean(L,1)) {
+		joypad_plan_free(false);
+		lua_pushinteger(L, 0);
+		return 1;
+	}
+	luaL_checktype(L,1,LUA_TTABLE);
+
+	// build the field table once; conditions are checked when a frame is applied
+	if (lua_plan_fields == NULL) {
+		for (port = machine->m_portlist.first(); port != NULL; port = port->next())
+			for (field = port->fieldlist; field != NULL; field = field->next)
+				if (joypad_plan_field_name(field) != NULL)
+					lua_plan_numfields++;
+
+		lua_plan_fields = (const input_field_config **)malloc(MAX(lua_plan_numfields, 1) * sizeof(*lua_plan_fields));
+		f = 0;
+		for (port = machine->m_portlist.first(); port != NULL; port = port->next())
+			for (field = port->fieldlist; field != NULL; field = field->next)
+				if (joypad_plan_field_name(field) != NULL)
+					lua_plan_fields[f++] = field;
+	}
+
+	// drop the frames already applied
+	if (lua_plan_next > 0) {
+		memmove(lua_plan, lua_plan + lua_plan_next * lua_plan_numfields, (lua_plan_frames - lua_plan_next) * lua_plan_numfields);
+		lua_plan_frames -= lua_plan_next;
+		lua_plan_next = 0;
+	}
+
+	// make room for the new frames
+	count = lua_objlen(L,1);
+	if (lua_plan_frames + count > lua_plan_alloc) {
+		UINT32 newalloc = MAX(lua_plan_alloc * 2, lua_plan_frames + count);
+		UINT8 *newplan = (UINT8 *)malloc(MAX(newalloc * lua_plan_numfields, 1));
+
+		if (lua_plan != NULL) {
+			memcpy(newplan, lua_plan, lua_plan_frames * lua_plan_numfields);
+			free(lua_plan);
+		}
+		lua_plan = newplan;
+		lua_plan_alloc = newalloc;
+	}
+
+	for (frame = 1; frame <= count; frame++) {
+		UINT8 *state = lua_plan + lua_plan_frames * lua_plan_numfields;
+
+		memset(state, 0, lua_plan_numfields);
+		lua_rawgeti(L, 1, frame);
+		if (lua_istable(L,-1))
+			for (f = 0; f < lua_plan_numfields; f++) {
+				lua_getfield(L, -1, joypad_plan_field_name(lua_plan_fields[f]));
+				if (!lua_isnil(L,-1))
+					state[f] = lua_toboolean(L,-1) ? 1 : 2;
+				lua_pop(L,1);
+			}
+		lua_pop(L,1);
+		lua_plan_frames++;
+	}
+
+	lua_pushinteger(L, lua_plan_frames - lua_plan_next);
+	return 1;
+}
+
+
 void luasav_save(const char *fullname) {
 	LuaSaveData saveData;
 	char luaSaveFilename[512];
@@ -1322,7 +1765,7 @@ static int movie_stop(lua_State *L) {
 
 // Common code by the gui library: make sure the screen array is ready
 static void gui_prepare() {
-	int x,y;
+	int y;
 
 	LUA_SCREEN_WIDTH  = machine->primary_screen->visible_area().max_x - machine->primary_screen->visible_area().min_x + 1;
 	LUA_SCREEN_HEIGHT = machine->primary_screen->visible_area().max_y - machine->primary_screen->visible_area().min_y + 1;
@@ -1337,21 +1780,48 @@ static void gui_prepare() {
 
 		old_screen_width  = LUA_SCREEN_WIDTH;
 		old_screen_height = LUA_SCREEN_HEIGHT;
+
+		gui_dirty.min_x = gui_dirty.min_y = 0;
+		gui_dirty.max_x = gui_dirty.max_y = -1;
 	}
 
+	// only the area drawn to since the last clear can be non-transparent
 	if (gui_used != GUI_USED_SINCE_LAST_DISPLAY) {
-		for (y = 0; y < LUA_SCREEN_HEIGHT; y++) {
-			for (x=0; x < LUA_SCREEN_WIDTH; x++) {
-				if (gui_data[(y*LUA_SCREEN_WIDTH+x)*4+3] != 0)
-					gui_data[(y*LUA_SCREEN_WIDTH+x)*4+3] = 0;
-			}
-		}
+		for (y = gui_dirty.min_y; y <= gui_dirty.max_y; y++)
+			memset(&gui_data[(y*LUA_SCREEN_WIDTH+gui_dirty.min_x)*4], 0, (gui_dirty.max_x - gui_dirty.min_x + 1) * 4);
+		gui_dirty.min_x = gui_dirty.min_y = 0;
+		gui_dirty.max_x = gui_dirty.max_y = -1;
 	}
-//		if (gui_used != GUI_USED_SINCE_LAST_DISPLAY) /* mz: 10% slower on my system */
-//			memset(gui_data,0,LUA_SCREEN_WIDTH * LUA_SCREEN_HEIGHT * 4);
 	gui_used = GUI_USED_SINCE_LAST_DISPLAY;
 }
 
+// grow the dirty area to cover the given rect (clipped to the lua canvas)
+static void gui_mark_dirty(int x1, int y1, int x2, int y2) {
+	if (x1 < 0)
+		x1 = 0;
+	if (y1 < 0)
+		y1 = 0;
+	if (x2 >= LUA_SCREEN_WIDTH)
+		x2 = LUA_SCREEN_WIDTH - 1;
+	if (y2 >= LUA_SCREEN_HEIGHT)
+		y2 = LUA_SCREEN_HEIGHT - 1;
+	if (x1 > x2 || y1 > y2)
+		return;
+
+	if (gui_dirty.min_x > gui_dirty.max_x) {
+		gui_dirty.min_x = x1;
+		gui_dirty.min_y = y1;
+		gui_dirty.max_x = x2;
+		gui_dirty.max_y = y2;
+	}
+	else {
+		gui_dirty.min_x = min(gui_dirty.min_x, x1);
+		gui_dirty.min_y = min(gui_dirty.min_y, y1);
+		gui_dirty.max_x = max(gui_dirty.max_x, x2);
+		gui_dirty.max_y = max(gui_dirty.max_y, y2);
+	}
+}
+
 
 // pixform for lua graphics
 #define BUILD_PIXEL_ARGB8888(A,R,G,B) (((int) (A) << 24) | ((int) (R) << 16) | ((int) (G) << 8) | (int) (B))
@@ -1396,6 +1866,51 @@ static inline void blend32(UINT32 *dstPixel, UINT32 colour)
 	}
 }
 
+// blend a single colour over a horizontal run of pixels
+// (same results as calling blend32 on each of them)
+static void blend32_span(UINT32 *dst, int count, UINT32 colour)
+{
+	int a = LUA_PIXEL_A(colour);
+
+	if (a == 255) {
+		while (count--)
+			*dst++ = colour;
+		return;
+	}
+
+#ifdef __SSE2__
+	// blending into a transparent pixel yields the colour itself, so the
+	// general formula covers both cases of blend32; with these value ranges
+	// the float quotients truncate to exactly the integer ones
+	if (a != 0) {
+		const __m128i mask = _mm_set1_epi32(0xff);
+		const __m128i alpha = _mm_set1_epi32(a);
+		const __m128 inv_alpha = _mm_set1_ps((float)(255 - a));
+		const __m128 src_b = _mm_set1_ps((float)(LUA_PIXEL_B(colour) * a));
+		const __m128 src_g = _mm_set1_ps((float)(LUA_PIXEL_G(colour) * a));
+		const __m128 src_r = _mm_set1_ps((float)(LUA_PIXEL_R(colour) * a));
+		const __m128 f128 = _mm_set1_ps(128.0f);
+		const __m128 f255 = _mm_set1_ps(255.0f);
+
+		for ( ; count >= 4; count -= 4, dst += 4) {
+			__m128i pix = _mm_loadu_si128((const __m128i *)dst);
+			__m128 a_dst = _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_div_ps(_mm_add_ps(_mm_mul_ps(inv_alpha, _mm_cvtepi32_ps(_mm_srli_epi32(pix, 24))), f128), f255)));
+			__m128i a_new = _mm_add_epi32(_mm_cvttps_epi32(a_dst), alpha);
+			__m128 a_newf = _mm_cvtepi32_ps(a_new);
+			__m128 half = _mm_cvtepi32_ps(_mm_srli_epi32(a_new, 1));
+			__m128i b = _mm_cvttps_epi32(_mm_div_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(pix, mask)), a_dst), src_b), half), a_newf));
+			__m128i g = _mm_cvttps_epi32(_mm_div_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(pix, 8), mask)), a_dst), src_g), half), a_newf));
+			__m128i r = _mm_cvttps_epi32(_mm_div_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(pix, 16), mask)), a_dst), src_r), half), a_newf));
+			pix = _mm_or_si128(_mm_or_si128(b, _mm_slli_epi32(g, 8)), _mm_or_si128(_mm_slli_epi32(r, 16), _mm_slli_epi32(a_new, 24)));
+			_mm_storeu_si128((__m128i *)dst, pix);
+		}
+	}
+#endif
+
+	while (count--)
+		blend32(dst++, colour);
+}
+
 // check if a pixel is in the lua canvas
 static inline UINT8 gui_check_boundary(int x, int y) {
 	return !(x < 0 || x >= LUA_SCREEN_WIDTH || y < 0 || y >= LUA_SCREEN_HEIGHT);
@@ -1434,6 +1949,9 @@ static void gui_drawline_internal(int x1, int y1, int x2, int y2, UINT8 lastPixe
 	signed char ix;
 	signed char iy;
 
+	// the extra pixels at error == 0 may step one past the end points
+	gui_mark_dirty(min(x1, x2) - 1, min(y1, y2) - 1, max(x1, x2) + 1, max(y1, y2) + 1);
+
 	if (xtemp == 0 && ytemp == 0) {
 		gui_drawpixel_internal(x1, y1, colour);
 		return;
@@ -1597,7 +2115,7 @@ static void gui_drawcircle_internal(int x0, int y0, int radius, UINT32 colour) {
 // draw fill rect on gui_data
 static void gui_fillbox_internal(int x1, int y1, int x2, int y2, UINT32 colour) {
 
-	int ix, iy;
+	int iy;
 
 	if (x1 > x2) 
 		swap(int, x1, x2);
@@ -1614,11 +2132,25 @@ static void gui_fillbox_internal(int x1, int y1, int x2, int y2, UINT32 colour)
 
 	//gui_prepare();
 
-	for (iy = y1; iy <= y2; iy++) {
-		for (ix = x1; ix <= x2; ix++) {
-			gui_drawpixel_fast(ix, iy, colour);
-		}
-	}
+	if (x1 > x2)
+		return;
+	gui_mark_dirty(x1, y1, x2, y2);
+
+	for (iy = y1; iy <= y2; iy++)
+		blend32_span((UINT32*) &gui_data[(iy*LUA_SCREEN_WIDTH+x1)*4], x2 - x1 + 1, colour);
+}
+
+// draw an outlined and filled rect on gui_data
+static void gui_drawfilledbox_internal(int x1, int y1, int x2, int y2, UINT32 fillcolor, UINT32 outlinecolor) {
+
+	if (x1 > x2)
+		swap(int, x1, x2);
+	if (y1 > y2)
+		swap(int, y1, y2);
+
+	gui_drawbox_internal(x1, y1, x2, y2, outlinecolor);
+	if ((x2 - x1) >= 2 && (y2 - y1) >= 2)
+		gui_fillbox_internal(x1+1, y1+1, x2-1, y2-1, fillcolor);
 }
 
 /*
@@ -1843,6 +2375,7 @@ static int gui_drawpixel(lua_State *L) {
 
 	gui_prepare();
 
+	gui_mark_dirty(x, y, x, y);
 	gui_drawpixel_internal(x, y, colour);
 
 	return 0;
@@ -1881,16 +2414,9 @@ static int gui_drawbox(lua_State *L) {
 	fillcolor = gui_optcolour(L,5,LUA_BUILD_PIXEL(63, 255, 255, 255));
 	outlinecolor = gui_optcolour(L,6,LUA_BUILD_PIXEL(255, LUA_PIXEL_R(fillcolor), LUA_PIXEL_G(fillcolor), LUA_PIXEL_B(fillcolor)));
 
-	if (x1 > x2)
-		swap(int, x1, x2);
-	if (y1 > y2)
-		swap(int, y1, y2);
-
 	gui_prepare();
 
-	gui_drawbox_internal(x1, y1, x2, y2, outlinecolor);
-	if ((x2 - x1) >= 2 && (y2 - y1) >= 2)
-		gui_fillbox_internal(x1+1, y1+1, x2-1, y2-1, fillcolor);
+	gui_drawfilledbox_internal(x1, y1, x2, y2, fillcolor, outlinecolor);
 
 	return 0;
 }
@@ -1962,6 +2488,14 @@ static int gui_getpixel(lua_State *L) {
 	int x = luaL_checkinteger(L, 1);
 	int y = luaL_checkinteger(L, 2);
 
+	// keep the screen coming even if rendering is off, and don't hand out stale pixels
+	video_request_render();
+	if (!video_is_screen_current() && !video_get_rendering())
+	{
+		lua_pushnil(L);
+		return 1;
+	}
+
 	if(!gui_check_boundary(x,y))
 	{
 		lua_pushinteger(L, 0);
@@ -2037,10 +2571,20 @@ static int gui_gdscreenshot(lua_State *L) {
 	int width = LUA_SCREEN_WIDTH;
 	int height = LUA_SCREEN_HEIGHT;
 
-	int size = 11 + width * height * 4;
-	char* str = (char*)malloc(size+1);
+	int size;
+	char* str;
 	unsigned char* ptr;
 
+	// keep the screen coming even if rendering is off, and don't hand out stale pixels
+	video_request_render();
+	if (!video_is_screen_current() && !video_get_rendering())
+	{
+		lua_pushnil(L);
+		return 1;
+	}
+
+	size = 11 + width * height * 4;
+	str = (char*)malloc(size+1);
 	str[size] = 0;
 	ptr = (unsigned char*)str;
 
@@ -2296,6 +2840,7 @@ static void PutTextInternal (const char *str, int len, short x, short y, int col
 		if((unsigned int)(c-32) >= 96)
 			continue;
 		Cur_Glyph = (const unsigned char*)&Small_Font_Data + (c-32)*7*4;
+		gui_mark_dirty(x-1, y, x+3, y+7);
 
 		for(y2 = 0; y2 < 8; y2++)
 		{
@@ -2522,6 +3067,8 @@ static int gui_gdoverlay(lua_State *L) {
 
 	gui_prepare();
 
+	gui_mark_dirty(xStartDst, yStartDst, xStartDst+width-1, yStartDst+height-1);
+
 	pix = (const UINT8*)(&ptr[yStartSrc*pitch + (xStartSrc*(trueColor?4:1))]);
 	bytesToNextLine = pitch - (width * (trueColor?4:1));
 	if (trueColor)
@@ -2541,6 +3088,264 @@ static int gui_gdoverlay(lua_State *L) {
 }
 
 
+// Retained draw lists
+//
+//  A draw list collects primitives whose colours have already been parsed,
+//  so a script can build (or just update) many of them with few calls into C
+//  and rasterize them all at once with dl:draw(). The list lives across frames
+//  until it is cleared or collected.
+enum { DRAWLIST_PIXEL, DRAWLIST_LINE, DRAWLIST_BOX, DRAWLIST_TEXT };
+
+struct gui_drawlist_item
+{
+	UINT8  type;           // DRAWLIST_*
+	UINT8  flag;           // lines: draw the first pixel
+	int    x1, y1, x2, y2;
+	UINT32 colour;         // fill colour for boxes
+	UINT32 colour2;        // outline colour for boxes and text
+	int    text;           // index into strings for text items
+};
+
+struct gui_drawlist
+{
+	std::vector<gui_drawlist_item> items;
+	std::vector<std::string> strings;
+};
+
+static const char *drawListMeta = "MAME.DrawList";
+
+static gui_drawlist *gui_checkdrawlist(lua_State *L, int offset) {
+	return (gui_drawlist *) luaL_checkudata(L, offset, drawListMeta);
+}
+
+// appends an item to a draw list
+static void gui_drawlist_add(gui_drawlist *list, UINT8 type, int x1, int y1, int x2, int y2, UINT32 colour, UINT32 colour2) {
+	gui_drawlist_item item;
+	item.type = type;
+	item.flag = TRUE;
+	item.x1 = x1;
+	item.y1 = y1;
+	item.x2 = x2;
+	item.y2 = y2;
+	item.colour = colour;
+	item.colour2 = colour2;
+	item.text = -1;
+	list->items.push_back(item);
+}
+
+// appends an item and returns its (1-based) index to lua
+static int gui_drawlist_push(lua_State *L, gui_drawlist *list, UINT8 type, int x1, int y1, int x2, int y2, UINT32 colour, UINT32 colour2) {
+	gui_drawlist_add(list, type, x1, y1, x2, y2, colour, colour2);
+	lua_pushinteger(L, list->items.size());
+	return 1;
+}
+
+// reads a flat array of coordinates, 'stride' numbers per primitive
+static void gui_drawlist_pusharray(lua_State *L, gui_drawlist *list, UINT8 type, int stride, UINT32 colour, UINT32 colour2) {
+	int count, i, j;
+	int c[4];
+
+	luaL_checktype(L, 2, LUA_TTABLE);
+	count = lua_objlen(L, 2) / stride;
+	list->items.reserve(list->items.size() + count);
+	for (i = 0; i < count; i++) {
+		for (j = 0; j < stride; j++) {
+			lua_rawgeti(L, 2, i * stride + j + 1);
+			c[j] = lua_tointeger(L, -1);
+			lua_pop(L, 1);
+		}
+		if (stride == 2) {
+			c[2] = c[0];
+			c[3] = c[1];
+		}
+		gui_drawlist_add(list, type, c[0], c[1], c[2], c[3], colour, colour2);
+	}
+}
+
+// object gui.drawlist()
+static int gui_drawlist_create(lua_State *L) {
+	void *mem = lua_newuserdata(L, sizeof(gui_drawlist));
+	new (mem) gui_drawlist;
+	luaL_getmetatable(L, drawListMeta);
+	lua_setmetatable(L, -2);
+	return 1;
+}
+
+static int drawlist_gc(lua_State *L) {
+	gui_drawlist *list = gui_checkdrawlist(L, 1);
+	list->~gui_drawlist();
+	return 0;
+}
+
+// int dl:pixel(x, y, colour)
+static int drawlist_pixel(lua_State *L) {
+	gui_drawlist *list = gui_checkdrawlist(L, 1);
+	int x = luaL_checkinteger(L, 2);
+	int y = luaL_checkinteger(L, 3);
+	return gui_drawlist_push(L, list, DRAWLIST_PIXEL, x, y, x, y, gui_getcolour(L, 4), 0);
+}
+
+// int dl:line(x1, y1, x2, y2, colour, skipFirst)
+static int drawlist_line(lua_State *L) {
+	gui_drawlist *list = gui_checkdrawlist(L, 1);
+	int x1 = luaL_checkinteger(L, 2);
+	int y1 = luaL_checkinteger(L, 3);
+	int x2 = luaL_checkinteger(L, 4);
+	int y2 = luaL_checkinteger(L, 5);
+	UINT32 colour = gui_optcolour(L, 6, LUA_BUILD_PIXEL(255, 255, 255, 255));
+	gui_drawlist_push(L, list, DRAWLIST_LINE, x1, y1, x2, y2, colour, 0);
+	list->items.back().flag = !lua_toboolean(L, 7);
+	return 1;
+}
+
+// int dl:box(x1, y1, x2, y2, fillcolor, outlinecolor)
+static int drawlist_box(lua_State *L) {
+	gui_drawlist *list = gui_checkdrawlist(L, 1);
+	int x1 = luaL_checkinteger(L, 2);
+	int y1 = luaL_checkinteger(L, 3);
+	int x2 = luaL_checkinteger(L, 4);
+	int y2 = luaL_checkinteger(L, 5);
+	UINT32 fillcolor = gui_optcolour(L, 6, LUA_BUILD_PIXEL(63, 255, 255, 255));
+	UINT32 outlinecolor = gui_optcolour(L, 7, LUA_BUILD_PIXEL(255, LUA_PIXEL_R(fillcolor), LUA_PIXEL_G(fillcolor), LUA_PIXEL_B(fillcolor)));
+	return gui_drawlist_push(L, list, DRAWLIST_BOX, x1, y1, x2, y2, fillcolor, outlinecolor);
+}
+
+// int dl:text(x, y, msg, color="white", outline="black")
+static int drawlist_text(lua_State *L) {
+	gui_drawlist *list = gui_checkdrawlist(L, 1);
+	int x = luaL_checkinteger(L, 2);
+	int y = luaL_checkinteger(L, 3);
+	const char *msg = luaL_checkstring(L, 4);
+	UINT32 colour = gui_optcolour(L, 5, LUA_BUILD_PIXEL(255, 255, 255, 255));
+	UINT32 borderColour = gui_optcolour(L, 6, LUA_BUILD_PIXEL(255, 0, 0, 0));
+	gui_drawlist_push(L, list, DRAWLIST_TEXT, x, y, x, y, colour, borderColour);
+	list->items.back().text = list->strings.size();
+	list->strings.push_back(msg);
+	return 1;
+}
+
+// dl:pixels({x, y, x, y, ...}, colour)
+static int drawlist_pixels(lua_State *L) {
+	gui_drawlist *list = gui_checkdrawlist(L, 1);
+	gui_drawlist_pusharray(L, list, DRAWLIST_PIXEL, 2, gui_optcolour(L, 3, LUA_BUILD_PIXEL(255, 255, 255, 255)), 0);
+	return 0;
+}
+
+// dl:lines({x1, y1, x2, y2, ...}, colour)
+static int drawlist_lines(lua_State *L) {
+	gui_drawlist *list = gui_checkdrawlist(L, 1);
+	gui_drawlist_pusharray(L, list, DRAWLIST_LINE, 4, gui_optcolour(L, 3, LUA_BUILD_PIXEL(255, 255, 255, 255)), 0);
+	return 0;
+}
+
+// dl:boxes({x1, y1, x2, y2, ...}, fillcolor, outlinecolor)
+static int drawlist_boxes(lua_State *L) {
+	gui_drawlist *list = gui_checkdrawlist(L, 1);
+	UINT32 fillcolor = gui_optcolour(L, 3, LUA_BUILD_PIXEL(63, 255, 255, 255));
+	UINT32 outlinecolor = gui_optcolour(L, 4, LUA_BUILD_PIXEL(255, LUA_PIXEL_R(fillcolor), LUA_PIXEL_G(fillcolor), LUA_PIXEL_B(fillcolor)));
+	gui_drawlist_pusharray(L, list, DRAWLIST_BOX, 4, fillcolor, outlinecolor);
+	return 0;
+}
+
+// dl:move(int index, x1, y1[, x2, y2])
+//
+//  Changes the position of a retained item without rebuilding the list.
+//  Items given only a new x1/y1 keep their size.
+static int drawlist_move(lua_State *L) {
+	gui_drawlist *list = gui_checkdrawlist(L, 1);
+	int index = luaL_checkinteger(L, 2);
+	int x1 = luaL_checkinteger(L, 3);
+	int y1 = luaL_checkinteger(L, 4);
+
+	if (index < 1 || index > (int)list->items.size())
+		luaL_error(L, "drawlist index %d out of range", index);
+
+	gui_drawlist_item &item = list->items[index - 1];
+	if (lua_gettop(L) >= 6) {
+		item.x2 = luaL_checkinteger(L, 5);
+		item.y2 = luaL_checkinteger(L, 6);
+	}
+	else {
+		item.x2 += x1 - item.x1;
+		item.y2 += y1 - item.y1;
+	}
+	item.x1 = x1;
+	item.y1 = y1;
+	return 0;
+}
+
+// dl:clear()
+static int drawlist_clear(lua_State *L) {
+	gui_drawlist *list = gui_checkdrawlist(L, 1);
+	list->items.clear();
+	list->strings.clear();
+	return 0;
+}
+
+// int dl:count()
+static int drawlist_count(lua_State *L) {
+	gui_drawlist *list = gui_checkdrawlist(L, 1);
+	lua_pushinteger(L, list->items.size());
+	return 1;
+}
+
+// dl:draw([dx=0, dy=0])
+//
+//  Rasterizes every item in the list, offset by (dx, dy), in the order
+//  they were added.
+static int drawlist_draw(lua_State *L) {
+	gui_drawlist *list = gui_checkdrawlist(L, 1);
+	int dx = luaL_optinteger(L, 2, 0);
+	int dy = luaL_optinteger(L, 3, 0);
+	std::vector<gui_drawlist_item>::const_iterator it;
+
+	if (list->items.empty())
+		return 0;
+
+	gui_prepare();
+
+	for (it = list->items.begin(); it != list->items.end(); ++it) {
+		int x1 = it->x1 + dx, y1 = it->y1 + dy;
+		int x2 = it->x2 + dx, y2 = it->y2 + dy;
+
+		switch (it->type) {
+		case DRAWLIST_PIXEL:
+			gui_mark_dirty(x1, y1, x1, y1);
+			gui_drawpixel_internal(x1, y1, it->colour);
+			break;
+		case DRAWLIST_LINE:
+			gui_drawline_internal(x2, y2, x1, y1, it->flag, it->colour);
+			break;
+		case DRAWLIST_BOX:
+			gui_drawfilledbox_internal(x1, y1, x2, y2, it->colour, it->colour2);
+			break;
+		case DRAWLIST_TEXT:
+			{
+				const std::string &str = list->strings[it->text];
+				PutTextInternal(str.c_str(), str.length(), x1, y1, it->colour, it->colour2);
+			}
+			break;
+		}
+	}
+	return 0;
+}
+
+static const struct luaL_reg drawlist_methods[] = {
+	{"pixel", drawlist_pixel},
+	{"line", drawlist_line},
+	{"box", drawlist_box},
+	{"text", drawlist_text},
+	{"pixels", drawlist_pixels},
+	{"lines", drawlist_lines},
+	{"boxes", drawlist_boxes},
+	{"move", drawlist_move},
+	{"clear", drawlist_clear},
+	{"count", drawlist_count},
+	{"draw", drawlist_draw},
+	{NULL,NULL}
+};
+
+
 // function gui.register(function f)
 //
 //  This function will be called just before a graphical update.
@@ -3176,7 +3981,186 @@ static int bitbit(lua_State *L)
 
 
 // The function called periodically to ensure Lua doesn't run amok.
+static void MAME_LuaHookFunction(lua_State *L, lua_Debug *dbg);
+
+// Installs the instruction count hooks the profiler and the watchdog need.
+// The watchdog only ever runs on the frame advance thread; the profiler
+// samples every state that runs script code.
+static void lua_profile_sethooks() {
+	lua_State *thread;
+
+	if (!LUA)
+		return;
+
+	lua_getfield(LUA, LUA_REGISTRYINDEX, frameAdvanceThread);
+	thread = lua_tothread(LUA, -1);
+	lua_pop(LUA, 1);
+
+	if (luaProfiling) {
+		lua_sethook(LUA, MAME_LuaHookFunction, LUA_MASKCOUNT, LUA_PROFILE_INTERVAL);
+		if (thread)
+			lua_sethook(thread, MAME_LuaHookFunction, LUA_MASKCOUNT, LUA_PROFILE_INTERVAL);
+	}
+	else {
+		lua_sethook(LUA, NULL, 0, 0);
+		if (thread && luaWatchdog)
+			lua_sethook(thread, MAME_LuaHookFunction, LUA_MASKCOUNT, LUA_WATCHDOG_INTERVAL);
+		else if (thread)
+			lua_sethook(thread, NULL, 0, 0);
+	}
+}
+
+// charges the time since the previous sample to the line being executed
+static void lua_profile_sample(lua_State *L, lua_Debug *dbg) {
+	osd_ticks_t now = osd_ticks();
+	char location[LUA_IDSIZE + 16];
+
+	if (lua_getinfo(L, "Sl", dbg) && dbg->currentline > 0)
+		sprintf(location, "%s:%d", dbg->short_src, dbg->currentline);
+	else
+		strcpy(location, "[C]");
+
+	lua_profile_line &line = luaProfileLines[location];
+	line.samples++;
+	line.ticks += now - luaProfileLastSample;
+	luaProfileLastSample = now;
+}
+
+static double lua_profile_ms(osd_ticks_t ticks) {
+	return (double)ticks * 1000.0 / (double)osd_ticks_per_second();
+}
+
+static bool lua_profile_compare(const std::pair<std::string, lua_profile_line> &a, const std::pair<std::string, lua_profile_line> &b) {
+	return a.second.ticks > b.second.ticks;
+}
+
+// sends a line of the profile report wherever print() output goes
+static void lua_profile_print(const char *str)
+{
+	if(info_print)
+		info_print(info_uid, str);
+	else
+		puts(str);
+}
+
+// shows the per-callback timings on top of the game screen
+static void lua_profile_drawoverlay() {
+	char buffer[128];
+	int slot, y = 2;
+
+	gui_prepare();
+
+	for (slot = 0; slot < LUAPROF_COUNT; slot++) {
+		const lua_profile_slot &prof = luaProfile[slot];
+		if (prof.calls == 0)
+			continue;
+		sprintf(buffer, "%-14s %8.3fms avg %8.3fms max", luaProfileNames[slot], lua_profile_ms(prof.ticks) / prof.calls, lua_profile_ms(prof.maxticks));
+		PutTextInternal(buffer, strlen(buffer), 2, y, LUA_BUILD_PIXEL(255, 255, 255, 255), LUA_BUILD_PIXEL(255, 0, 0, 0));
+		y += 8;
+	}
+	sprintf(buffer, "lua heap %dKB", lua_gc(LUA, LUA_GCCOUNT, 0));
+	PutTextInternal(buffer, strlen(buffer), 2, y, LUA_BUILD_PIXEL(255, 255, 255, 255), LUA_BUILD_PIXEL(255, 0, 0, 0));
+}
+
+// debug.profile_start([bool overlay=false])
+//
+//  Clears all profile data and starts timing callbacks and sampling
+//  script lines. With overlay set, a summary is drawn every frame.
+static int debug_profile_start(lua_State *L) {
+	luaProfileOverlay = lua_toboolean(L, 1);
+	memset(luaProfile, 0, sizeof(luaProfile));
+	luaProfileLines.clear();
+	luaProfiling = TRUE;
+	lua_profile_sethooks();
+	return 0;
+}
+
+// debug.profile_stop()
+//
+//  Stops collecting profile data; the results stay available to report().
+static int debug_profile_stop(lua_State *L) {
+	luaProfiling = FALSE;
+	lua_profile_sethooks();
+	return 0;
+}
+
+// table debug.profile_report([bool print=false])
+//
+//  Returns { heapkb, callbacks = { name = { calls, ms, maxms, allockb, freedkb } },
+//  lines = { { location, samples, ms }, ... } } with lines sorted by time spent.
+//  With print set, a summary is also printed to the Lua console.
+static int debug_profile_report(lua_State *L) {
+	std::vector<std::pair<std::string, lua_profile_line> > lines(luaProfileLines.begin(), luaProfileLines.end());
+	int doprint = lua_toboolean(L, 1);
+	char buffer[256];
+	int slot;
+	size_t i;
+
+	std::sort(lines.begin(), lines.end(), lua_profile_compare);
+
+	lua_newtable(L);
+	lua_pushinteger(L, lua_gc(L, LUA_GCCOUNT, 0));
+	lua_setfield(L, -2, "heapkb");
+
+	lua_newtable(L);
+	for (slot = 0; slot < LUAPROF_COUNT; slot++) {
+		const lua_profile_slot &prof = luaProfile[slot];
+		if (prof.calls == 0)
+			continue;
+
+		lua_newtable(L);
+		lua_pushinteger(L, prof.calls);
+		lua_setfield(L, -2, "calls");
+		lua_pushnumber(L, lua_profile_ms(prof.ticks));
+		lua_setfield(L, -2, "ms");
+		lua_pushnumber(L, lua_profile_ms(prof.maxticks));
+		lua_setfield(L, -2, "maxms");
+		lua_pushnumber(L, (double)prof.heapgrowth / 1024.0);
+		lua_setfield(L, -2, "allockb");
+		lua_pushnumber(L, (double)prof.heapfreed / 1024.0);
+		lua_setfield(L, -2, "freedkb");
+		lua_setfield(L, -2, luaProfileNames[slot]);
+
+		if (doprint) {
+			sprintf(buffer, "%-14s %8u calls %10.3fms total %8.3fms max %10.1fKB alloc %10.1fKB freed",
+				luaProfileNames[slot], prof.calls, lua_profile_ms(prof.ticks), lua_profile_ms(prof.maxticks),
+				(double)prof.heapgrowth / 1024.0, (double)prof.heapfreed / 1024.0);
+			lua_profile_print(buffer);
+		}
+	}
+	lua_setfield(L, -2, "callbacks");
+
+	lua_newtable(L);
+	for (i = 0; i < lines.size(); i++) {
+		lua_newtable(L);
+		lua_pushstring(L, lines[i].first.c_str());
+		lua_setfield(L, -2, "location");
+		lua_pushinteger(L, lines[i].second.samples);
+		lua_setfield(L, -2, "samples");
+		lua_pushnumber(L, lua_profile_ms(lines[i].second.ticks));
+		lua_setfield(L, -2, "ms");
+		lua_rawseti(L, -2, i + 1);
+
+		if (doprint && i < 20) {
+			snprintf(buffer, sizeof(buffer), "%10.3fms %8u samples  %s", lua_profile_ms(lines[i].second.ticks), lines[i].second.samples, lines[i].first.c_str());
+			lua_profile_print(buffer);
+		}
+	}
+	lua_setfield(L, -2, "lines");
+	return 1;
+}
+
 static void MAME_LuaHookFunction(lua_State *L, lua_Debug *dbg) {
+	static int hookCalls = 0;
+
+	if (luaProfiling) {
+		lua_profile_sample(L, dbg);
+
+		// the profiler hooks more often than the watchdog needs to check
+		if (L == LUA || !luaWatchdog || (++hookCalls % (LUA_WATCHDOG_INTERVAL / LUA_PROFILE_INTERVAL)) != 0)
+			return;
+	}
+
 	if (numTries-- == 0) {
 
 		int kill = 0;
@@ -3210,15 +4194,24 @@ static void MAME_LuaHookFunction(lua_State *L, lua_Debug *dbg) {
 			MAME_LuaOnStop();
 		}
 
-		// else, kill the debug hook.
-		lua_sethook(L, NULL, 0, 0);
+		// else, kill the debug hook (unless the profiler still needs it).
+		luaWatchdog = FALSE;
+		if (!luaProfiling)
+			lua_sethook(L, NULL, 0, 0);
 	}
 }
 
 
 void HandleCallbackError(lua_State* L)
 {
+#ifdef MAME_LUAJIT
+	// LuaJIT keeps its state private; any active frame means we were
+	// called from script code, which is running inside a protected call.
+	lua_Debug ar;
+	if(lua_getstack(L, 0, &ar))
+#else
 	if(L->errfunc || L->errorJmp)
+#endif
 		luaL_error(L, "%s", lua_tostring(L,-1));
 	else {
 		lua_pushnil(LUA);
@@ -3247,8 +4240,12 @@ void CallExitFunction() {
 
 	if (lua_isfunction(LUA, -1))
 	{
+		lua_profile_mark mark;
+
 		chdir(luaCWD);
+		lua_profile_begin(LUA, &mark);
 		errorcode = lua_pcall(LUA, 0, 0, 0);
+		lua_profile_end(LUA, &mark, LUACALL_BEFOREEXIT);
 		_getcwd(luaCWD, _MAX_PATH);
 	}
 
@@ -3273,7 +4270,11 @@ void CallRegisteredLuaFunctions(int calltype)
 
 	if (lua_isfunction(LUA, -1))
 	{
+		lua_profile_mark mark;
+
+		lua_profile_begin(LUA, &mark);
 		errorcode = lua_pcall(LUA, 0, 0, 0);
+		lua_profile_end(LUA, &mark, calltype);
 		if (errorcode)
 			HandleCallbackError(LUA);
 	}
@@ -3292,6 +4293,8 @@ static const struct luaL_reg mamelib [] = {
 	{"parentname", mame_parentname},
 	{"sourcename", mame_sourcename},
 	{"speedmode", mame_speedmode},
+	{"setrendering", mame_setrendering},
+	{"getrendering", mame_getrendering},
 	{"frameadvance", mame_frameadvance},
 	{"pause", mame_pause},
 	{"unpause", mame_unpause},
@@ -3344,6 +4347,7 @@ static const struct luaL_reg joypadlib[] = {
 	{"getdown", joypad_getdown},
 	{"getup", joypad_getup},
 	{"set", joypad_set},
+	{"plan", joypad_plan},
 	// alternative names
 	{"read", joypad_get},
 	{"readdown", joypad_getdown},
@@ -3390,6 +4394,7 @@ static const struct luaL_reg guilib[] = {
 	{"gdoverlay", gui_gdoverlay},
 	{"getpixel", gui_getpixel},
 	{"clearuncommitted", gui_clearuncommitted},
+	{"drawlist", gui_drawlist_create},
 	// alternative names
 	{"drawtext", gui_text},
 	{"drawbox", gui_drawbox},
@@ -3405,6 +4410,23 @@ static const struct luaL_reg guilib[] = {
 	{NULL,NULL}
 };
 
+static const struct luaL_reg debuglib[] = {
+	{"profile_start", debug_profile_start},
+	{"profile_stop", debug_profile_stop},
+	{"profile_report", debug_profile_report},
+	{NULL,NULL}
+};
+
+static const struct luaL_reg ramsearchlib[] = {
+	{"reset", ramsearch_lua_reset},
+	{"update", ramsearch_lua_update},
+	{"search", ramsearch_lua_search},
+	{"changes", ramsearch_lua_changes},
+	{"count", ramsearch_lua_count},
+	{"results", ramsearch_lua_results},
+	{NULL,NULL}
+};
+
 static const struct luaL_reg inputlib[] = {
 	{"get", input_getcurrentinputstatus},
 	{"registerhotkey", input_registerhotkey},
@@ -3417,6 +4439,7 @@ static const struct luaL_reg inputlib[] = {
 
 void MAME_LuaFrameBoundary(running_machine &machine_ptr) {
 	lua_State *thread;
+	lua_profile_mark mark;
 	int result;
 
 	if (machine != &machine_ptr)
@@ -3438,7 +4461,9 @@ void MAME_LuaFrameBoundary(running_machine &machine_ptr) {
 
 	numTries = 1000;
 	chdir(luaCWD);
+	lua_profile_begin(LUA, &mark);
 	result = lua_resume(thread, 0);
+	lua_profile_end(LUA, &mark, LUAPROF_FRAMEADVANCE);
 	_getcwd(luaCWD, _MAX_PATH);
 	
 	if (result == LUA_YIELD) {
@@ -3511,12 +4536,32 @@ int MAME_LoadLuaCode(const char *filename) {
 		luaL_register(LUA, "emu", mamelib);
 		luaL_register(LUA, "mame", mamelib);
 		luaL_register(LUA, "memory", memorylib);
+		lua_pushstring(LUA, ffi_memory_cdef);
+		lua_setfield(LUA, -2, "cdef");
 		luaL_register(LUA, "joypad", joypadlib);
 		luaL_register(LUA, "savestate", savestatelib);
 		luaL_register(LUA, "movie", movielib);
 		luaL_register(LUA, "gui", guilib);
+		luaL_newmetatable(LUA, drawListMeta);
+		lua_pushvalue(LUA, -1);
+		lua_setfield(LUA, -2, "__index");
+		lua_pushcfunction(LUA, drawlist_gc);
+		lua_setfield(LUA, -2, "__gc");
+		lua_pushcfunction(LUA, drawlist_count);
+		lua_setfield(LUA, -2, "__len");
+		luaL_register(LUA, NULL, drawlist_methods);
 		luaL_register(LUA, "input", inputlib);
+		luaL_register(LUA, "ramsearch", ramsearchlib);
+#ifdef MAME_LUAJIT
+		// LuaJIT already opened its own LuaBitOp, which the trace compiler
+		// turns into native instructions; only fall back on ours without it
+		lua_getglobal(LUA, "bit");
+		if (lua_isnil(LUA, -1))
+			luaL_register(LUA, "bit", bit_funcs);
+#else
 		luaL_register(LUA, "bit", bit_funcs); // LuaBitOp library
+#endif
+		luaL_register(LUA, "debug", debuglib); // adds to the standard debug library
 		lua_settop(LUA, 0); // clean the stack, because each call to luaL_register leaves a table on top
 
 		// register a few utility functions outside of libraries (in the global namespace)
@@ -3526,9 +4571,20 @@ int MAME_LoadLuaCode(const char *filename) {
 		lua_register(LUA, "copytable", copytable);
 
 		// old bit operation functions
+#ifdef MAME_LUAJIT
+		lua_getglobal(LUA, "bit");
+		lua_getfield(LUA, -1, "band");
+		lua_setglobal(LUA, "AND");
+		lua_getfield(LUA, -1, "bor");
+		lua_setglobal(LUA, "OR");
+		lua_getfield(LUA, -1, "bxor");
+		lua_setglobal(LUA, "XOR");
+		lua_pop(LUA, 1);
+#else
 		lua_register(LUA, "AND", bit_band);
 		lua_register(LUA, "OR", bit_bor);
 		lua_register(LUA, "XOR", bit_bxor);
+#endif
 		lua_register(LUA, "SHIFT", bit_bshift_emulua);
 		lua_register(LUA, "BIT", bitbit);
 
@@ -3596,7 +4652,8 @@ int MAME_LoadLuaCode(const char *filename) {
 		MAME_LuaFrameBoundary(*machine);
 
 	// Set up our protection hook to be executed once every 10,000 bytecode instructions.
-	lua_sethook(thread, MAME_LuaHookFunction, LUA_MASKCOUNT, 10000);
+	luaWatchdog = TRUE;
+	lua_profile_sethooks();
 
 	// We're done.
 	return 1;
@@ -3633,6 +4690,7 @@ void MAME_LuaStop() {
 
 	lua_close(LUA); // this invokes our garbage collectors for us
 	LUA = NULL;
+	luaProfiling = FALSE;
 	MAME_LuaOnStop();
 }
 
@@ -3675,6 +4733,27 @@ UINT32 MAME_LuaReadJoypad() {
 	if (!MAME_LuaRunning())
 		return 1;
 
+	// planned input goes first so joypad.set can override it
+	if (lua_plan_next < lua_plan_frames) {
+		const UINT8 *state = lua_plan + lua_plan_next * lua_plan_numfields;
+		int f;
+
+		for (f = 0; f < lua_plan_numfields; f++)
+			if (state[f] != 0 && input_condition_true(machine, &lua_plan_fields[f]->condition)) {
+				const input_field_config *field = lua_plan_fields[f];
+
+				if (state[f] == 1)
+					set_port_digital(field->port, get_port_digital(field->port) | field->mask);
+				else
+					set_port_digital(field->port, get_port_digital(field->port) & (~field->mask));
+			}
+
+		if (++lua_plan_next == lua_plan_frames)
+			lua_plan_next = lua_plan_frames = 0;
+		if (!lua_joypads_used)
+			return 0;
+	}
+
 	if (lua_joypads_used) {
 		// Update the values of all the inputs
 		unsigned int i = 0;
@@ -3733,9 +4812,13 @@ void MAME_LuaGui() {
 	if (lua_isfunction(LUA, -1)) {
 		int ret;
 
+		lua_profile_mark mark;
+
 		// We call it now
 		numTries = 1000;
+		lua_profile_begin(LUA, &mark);
 		ret = lua_pcall(LUA, 0, 0, 0);
+		lua_profile_end(LUA, &mark, LUAPROF_GUI);
 		if (ret != 0) {
 #ifdef WIN32
 			MessageBoxA(win_window_list->hwnd, lua_tostring(LUA, -1), "Lua Error in GUI function", MB_OK);
@@ -3752,14 +4835,29 @@ void MAME_LuaGui() {
 	// And wreak the stack
 	lua_settop(LUA, 0);
 
+	if (luaProfiling && luaProfileOverlay)
+		lua_profile_drawoverlay();
+
 	if (gui_used == GUI_CLEAR || !gui_enabled)
 		return;
 
 	gui_used = GUI_USED_SINCE_LAST_FRAME;
 
+	// nothing landed on the canvas, so there is nothing to composite
+	if (gui_dirty.min_x > gui_dirty.max_x)
+		return;
+
+	// only hand the drawn area to the renderer (source bounds are exclusive)
+	rectangle bounds;
+	bounds.min_x = gui_dirty.min_x;
+	bounds.min_y = gui_dirty.min_y;
+	bounds.max_x = gui_dirty.max_x + 1;
+	bounds.max_y = gui_dirty.max_y + 1;
+	render_texture_set_bitmap(gui_texture, gui_bitmap, &bounds, TEXFORMAT_ARGB32, NULL);
+
 	render_screen_add_quad(machine->primary_screen,
-	                       0.0f, 0.0f,
-	                       1.0f, 1.0f,
+	                       (float)bounds.min_x / LUA_SCREEN_WIDTH, (float)bounds.min_y / LUA_SCREEN_HEIGHT,
+	                       (float)bounds.max_x / LUA_SCREEN_WIDTH, (float)bounds.max_y / LUA_SCREEN_HEIGHT,
 	                       MAKE_ARGB(0xff, 0xff, 0xff, 0xff),
 	                       gui_texture, PRIMFLAG_BLENDMODE(BLENDMODE_ALPHA));
 }
@@ -3936,6 +5034,9 @@ static void on_vblank(screen_device &screen, void *param, bool vblank_state)
 
 void lua_exit(running_machine &machine)
 {
+	// the RAM search was allocated from the machine and goes with it
+	luaRamSearch = NULL;
+
 	// free bitmaps and textures for the GUI
 	if (gui_texture != NULL)
 		render_texture_free(gui_texture);
@@ -3944,6 +5045,9 @@ void lua_exit(running_machine &machine)
 	if (gui_bitmap != NULL)
 		bitmap_free(gui_bitmap);
 	gui_bitmap = NULL;
+
+	// the planned input refers to this machine's ports
+	joypad_plan_free(true);
 	
 	old_screen_width  = 0;
 	old_screen_height = 0;
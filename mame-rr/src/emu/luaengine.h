@@ -37,6 +37,23 @@ void MAME_LuaGui();
 
 void MAME_LuaWriteInform();
 
+// memory readers exported for LuaJIT's FFI (see memory.cdef)
+#if defined(MAME_LUAJIT) && defined(_WIN32)
+#define LUA_FFI_EXPORT __declspec(dllexport)
+#else
+#define LUA_FFI_EXPORT
+#endif
+
+extern "C" {
+LUA_FFI_EXPORT UINT8 MAME_LuaReadByte(UINT32 address);
+LUA_FFI_EXPORT INT8 MAME_LuaReadByteSigned(UINT32 address);
+LUA_FFI_EXPORT UINT16 MAME_LuaReadWord(UINT32 address);
+LUA_FFI_EXPORT INT16 MAME_LuaReadWordSigned(UINT32 address);
+LUA_FFI_EXPORT UINT32 MAME_LuaReadDword(UINT32 address);
+LUA_FFI_EXPORT INT32 MAME_LuaReadDwordSigned(UINT32 address);
+LUA_FFI_EXPORT UINT32 MAME_LuaReadByteRange(UINT32 address, UINT8 *dest, UINT32 length);
+}
+
 void MAME_LuaClearGui();
 void MAME_LuaEnableGui(UINT8 enabled);
 
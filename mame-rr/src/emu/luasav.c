@@ -14,7 +14,9 @@ extern "C" {
 #include "lua.h"
 #include "lauxlib.h"
 #include "lualib.h"
+#ifndef MAME_LUAJIT
 #include "lstate.h"
+#endif
 }
 #include "emu.h"
 #include "luaengine.h"
@@ -643,8 +645,13 @@ void CallRegisteredLuaLoadFunctions(const char *savestateNumber, const LuaSaveDa
 			// (e.g. the registered save function returned some huge tables)
 			// check the number of parameters the registered load function expects
 			// and don't bother loading the parameters it wouldn't receive anyway
+#ifdef MAME_LUAJIT
+			// LuaJIT doesn't expose the function's prototype, so load everything
+			int numParamsExpected = -1;
+#else
 			int numParamsExpected = (L->top - 1)->value.gc->cl.l.p->numparams; // NOTE: if this line crashes, that means your Lua headers are out of sync with your Lua lib
 			if(numParamsExpected) numParamsExpected--; // minus one for the savestate number we always pass in
+#endif
 
 			int prevGarbage = lua_gc(L, LUA_GCCOUNT, 0);
 
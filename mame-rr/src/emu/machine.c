@@ -215,7 +215,9 @@ running_machine::running_machine(const game_driver &driver, const machine_config
 		}
 
 	// fetch core options
-	if (options_get_bool(&m_options, OPTION_DEBUG))
+	if (options_get_int(&m_options, OPTION_DEBUGSERVER) != 0)
+		debug_flags = DEBUG_FLAG_ENABLED | DEBUG_FLAG_CALL_HOOK | DEBUG_FLAG_SERVER;
+	else if (options_get_bool(&m_options, OPTION_DEBUG))
 		debug_flags = (DEBUG_FLAG_ENABLED | DEBUG_FLAG_CALL_HOOK) | (options_get_bool(&m_options, OPTION_DEBUG_INTERNAL) ? 0 : DEBUG_FLAG_OSD_ENABLED);
 }
 
@@ -333,6 +335,7 @@ void running_machine::start()
 	crosshair_init(this);
 
 	sound_init(this);
+	profiler_init(this);
 
 	// initialize the debugger
 	if ((debug_flags & DEBUG_FLAG_ENABLED) != 0)
@@ -362,6 +365,8 @@ void running_machine::start()
 	lua_init(this);
 	extern void Update_RAM_Search(running_machine &machine);
 	add_notifier(MACHINE_NOTIFY_FRAME, Update_RAM_Search);
+	extern void Exit_RAM_Search(running_machine &machine);
+	add_notifier(MACHINE_NOTIFY_EXIT, Exit_RAM_Search);
 
 	// disallow save state registrations starting here
 	state_save_allow_registration(this, false);
@@ -103,6 +103,7 @@ const int DEBUG_FLAG_WPW_PROGRAM	= 0x00000100;		// watchpoints are enabled for P
 const int DEBUG_FLAG_WPW_DATA		= 0x00000200;		// watchpoints are enabled for DATA memory writes
 const int DEBUG_FLAG_WPW_IO			= 0x00000400;		// watchpoints are enabled for IO memory writes
 const int DEBUG_FLAG_OSD_ENABLED	= 0x00001000;		// The OSD debugger is enabled
+const int DEBUG_FLAG_SERVER			= 0x00002000;		// the debugger is driven over a socket
 
 
 
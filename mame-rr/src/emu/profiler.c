@@ -10,6 +10,7 @@
 ***************************************************************************/
 
 #include "emu.h"
+#include "emuopts.h"
 #include "profiler.h"
 
 
@@ -33,6 +34,100 @@ struct _profile_string
 
 profiler_state global_profiler;
 
+static const profile_string names[] =
+{
+	{ PROFILER_DRC_COMPILE,      "DRC Compilation" },
+	{ PROFILER_MEMREAD,          "Memory Read" },
+	{ PROFILER_MEMWRITE,         "Memory Write" },
+	{ PROFILER_VIDEO,            "Video Update" },
+	{ PROFILER_DRAWGFX,          "drawgfx" },
+	{ PROFILER_COPYBITMAP,       "copybitmap" },
+	{ PROFILER_TILEMAP_DRAW,     "Tilemap Draw" },
+	{ PROFILER_TILEMAP_DRAW_ROZ, "Tilemap ROZ Draw" },
+	{ PROFILER_TILEMAP_UPDATE,   "Tilemap Update" },
+	{ PROFILER_BLIT,             "OSD Blitting" },
+	{ PROFILER_POLY_WAIT,        "Poly Wait" },
+	{ PROFILER_SOUND,            "Sound Generation" },
+	{ PROFILER_TIMER_CALLBACK,   "Timer Callbacks" },
+	{ PROFILER_INPUT,            "Input Processing" },
+	{ PROFILER_MOVIE_REC,        "Movie Recording" },
+	{ PROFILER_LOGERROR,         "Error Logging" },
+	{ PROFILER_EXTRA,            "Unaccounted/Overhead" },
+	{ PROFILER_USER1,            "User 1" },
+	{ PROFILER_USER2,            "User 2" },
+	{ PROFILER_USER3,            "User 3" },
+	{ PROFILER_USER4,            "User 4" },
+	{ PROFILER_USER5,            "User 5" },
+	{ PROFILER_USER6,            "User 6" },
+	{ PROFILER_USER7,            "User 7" },
+	{ PROFILER_USER8,            "User 8" },
+	{ PROFILER_PROFILER,         "Profiler" },
+	{ PROFILER_IDLE,             "Idle" }
+};
+
+
+
+/***************************************************************************
+    FUNCTION PROTOTYPES
+***************************************************************************/
+
+static void profiler_advance(void);
+static void profiler_log_frame(running_machine &machine);
+static void profiler_exit(running_machine &machine);
+
+
+
+/***************************************************************************
+    INITIALIZATION
+***************************************************************************/
+
+/*-------------------------------------------------
+    profiler_init - open the per-frame log if one
+    was requested; profiling stays on for as long
+    as the log is open
+-------------------------------------------------*/
+
+void profiler_init(running_machine *machine)
+{
+	const char *filename = options_get_string(machine->options(), OPTION_PROFILELOG);
+
+	if (filename == NULL || filename[0] == 0)
+		return;
+
+#ifndef MAME_PROFILER
+	mame_printf_warning("Ignoring -%s; this is not a profiling build\n", OPTION_PROFILELOG);
+	return;
+#endif
+
+	global_profiler.logfile = fopen(filename, "w");
+	if (global_profiler.logfile == NULL)
+	{
+		mame_printf_error("Unable to open profiler log '%s'\n", filename);
+		return;
+	}
+	global_profiler.logframe = 0;
+	global_profiler.logstart = osd_ticks();
+	global_profiler.logstartprofile = get_profile_ticks();
+	fprintf(global_profiler.logfile, "frame,kind,name,value\n");
+
+	profiler_start();
+	machine->add_notifier(MACHINE_NOTIFY_FRAME, profiler_log_frame);
+	machine->add_notifier(MACHINE_NOTIFY_EXIT, profiler_exit);
+}
+
+
+/*-------------------------------------------------
+    profiler_exit - close the per-frame log
+-------------------------------------------------*/
+
+static void profiler_exit(running_machine &machine)
+{
+	if (global_profiler.logfile != NULL)
+		fclose(global_profiler.logfile);
+	global_profiler.logfile = NULL;
+	profiler_stop();
+}
+
 
 
 /***************************************************************************
@@ -105,6 +200,38 @@ void _profiler_mark_end(void)
 }
 
 
+/*-------------------------------------------------
+    profiler_type_name - return the name of a
+    non-device profiler entry
+-------------------------------------------------*/
+
+static const char *profiler_type_name(int type)
+{
+	int nameindex;
+
+	for (nameindex = 0; nameindex < ARRAY_LENGTH(names); nameindex++)
+		if (names[nameindex].type == type)
+			return names[nameindex].string;
+	return "";
+}
+
+
+/*-------------------------------------------------
+    profiler_advance - advance to the next dataset
+    and reset it to 0
+-------------------------------------------------*/
+
+static void profiler_advance(void)
+{
+	global_profiler.dataindex = (global_profiler.dataindex + 1) % ARRAY_LENGTH(global_profiler.data);
+	memset(&global_profiler.data[global_profiler.dataindex], 0, sizeof(global_profiler.data[global_profiler.dataindex]));
+
+	/* we are ready once we have wrapped around */
+	if (global_profiler.dataindex == 0)
+		global_profiler.dataready = TRUE;
+}
+
+
 /*-------------------------------------------------
     _profiler_get_text - return the current text
     in an astring
@@ -112,35 +239,6 @@ void _profiler_mark_end(void)
 
 astring &_profiler_get_text(running_machine *machine, astring &string)
 {
-	static const profile_string names[] =
-	{
-		{ PROFILER_DRC_COMPILE,      "DRC Compilation" },
-		{ PROFILER_MEMREAD,          "Memory Read" },
-		{ PROFILER_MEMWRITE,         "Memory Write" },
-		{ PROFILER_VIDEO,            "Video Update" },
-		{ PROFILER_DRAWGFX,          "drawgfx" },
-		{ PROFILER_COPYBITMAP,       "copybitmap" },
-		{ PROFILER_TILEMAP_DRAW,     "Tilemap Draw" },
-		{ PROFILER_TILEMAP_DRAW_ROZ, "Tilemap ROZ Draw" },
-		{ PROFILER_TILEMAP_UPDATE,   "Tilemap Update" },
-		{ PROFILER_BLIT,             "OSD Blitting" },
-		{ PROFILER_SOUND,            "Sound Generation" },
-		{ PROFILER_TIMER_CALLBACK,   "Timer Callbacks" },
-		{ PROFILER_INPUT,            "Input Processing" },
-		{ PROFILER_MOVIE_REC,        "Movie Recording" },
-		{ PROFILER_LOGERROR,         "Error Logging" },
-		{ PROFILER_EXTRA,            "Unaccounted/Overhead" },
-		{ PROFILER_USER1,            "User 1" },
-		{ PROFILER_USER2,            "User 2" },
-		{ PROFILER_USER3,            "User 3" },
-		{ PROFILER_USER4,            "User 4" },
-		{ PROFILER_USER5,            "User 5" },
-		{ PROFILER_USER6,            "User 6" },
-		{ PROFILER_USER7,            "User 7" },
-		{ PROFILER_USER8,            "User 8" },
-		{ PROFILER_PROFILER,         "Profiler" },
-		{ PROFILER_IDLE,             "Idle" }
-	};
 	UINT64 computed, normalize, total;
 	int curtype, curmem, switches;
 
@@ -175,8 +273,6 @@ astring &_profiler_get_text(running_machine *machine, astring &string)
 		/* if we have non-zero data and we're ready to display, do it */
 		if (global_profiler.dataready && computed != 0)
 		{
-			int nameindex;
-
 			/* start with the un-normalized percentage */
 			string.catprintf("%02d%% ", (int)((computed * 100 + total/2) / total));
 
@@ -188,12 +284,7 @@ astring &_profiler_get_text(running_machine *machine, astring &string)
 			if (curtype >= PROFILER_DEVICE_FIRST && curtype <= PROFILER_DEVICE_MAX)
 				string.catprintf("'%s'", machine->m_devicelist.find(curtype - PROFILER_DEVICE_FIRST)->tag());
 			else
-				for (nameindex = 0; nameindex < ARRAY_LENGTH(names); nameindex++)
-					if (names[nameindex].type == curtype)
-					{
-						string.cat(names[nameindex].string);
-						break;
-					}
+				string.cat(profiler_type_name(curtype));
 
 			/* followed by a carriage return */
 			string.cat("\n");
@@ -209,16 +300,133 @@ astring &_profiler_get_text(running_machine *machine, astring &string)
 		string.catprintf("%d CPU switches\n", switches / (int) ARRAY_LENGTH(global_profiler.data));
 	}
 
-	/* advance to the next dataset and reset it to 0 */
-	global_profiler.dataindex = (global_profiler.dataindex + 1) % ARRAY_LENGTH(global_profiler.data);
-	memset(&global_profiler.data[global_profiler.dataindex], 0, sizeof(global_profiler.data[global_profiler.dataindex]));
+	/* followed by the per-frame average of each counter */
+	if (global_profiler.dataready)
+		for (curtype = 0; curtype < global_profiler.counters; curtype++)
+		{
+			INT64 sum = 0;
+			for (curmem = 0; curmem < ARRAY_LENGTH(global_profiler.data); curmem++)
+				sum += global_profiler.data[curmem].counter[curtype];
+			if (sum != 0)
+				string.catprintf("%d %s: %s\n", (int)(sum / ARRAY_LENGTH(global_profiler.data)),
+						global_profiler.counter[curtype].group, global_profiler.counter[curtype].name);
+		}
 
-	/* we are ready once we have wrapped around */
-	if (global_profiler.dataindex == 0)
-		global_profiler.dataready = TRUE;
+	/* the per-frame log does its own advancing when it is active */
+	if (global_profiler.logfile == NULL)
+		profiler_advance();
 
 out:
 	profiler_mark_end();
 
 	return string;
 }
+
+
+/*-------------------------------------------------
+    profiler_log_frame - write the frame that just
+    finished to the log, one "frame,kind,name,value"
+    row per non-zero entry; times are in
+    microseconds
+-------------------------------------------------*/
+
+static void profiler_log_frame(running_machine &machine)
+{
+	profiler_data *data = &global_profiler.data[global_profiler.dataindex];
+	FILE *file = global_profiler.logfile;
+	INT64 elapsed = osd_ticks() - global_profiler.logstart;
+	INT64 elapsedprofile = get_profile_ticks() - global_profiler.logstartprofile;
+	double scale;
+	int curtype;
+
+	if (file == NULL)
+		return;
+
+	/* profile ticks may be a raw cycle counter, so calibrate them against osd_ticks as we go */
+	if (elapsed <= 0 || elapsedprofile <= 0)
+		scale = 1000000.0 / (double)osd_ticks_per_second();
+	else
+		scale = 1000000.0 * (double)elapsed / ((double)elapsedprofile * (double)osd_ticks_per_second());
+
+	/* timings, with devices named by their tag */
+	for (curtype = 0; curtype < PROFILER_TOTAL; curtype++)
+		if (data->duration[curtype] != 0)
+		{
+			if (curtype >= PROFILER_DEVICE_FIRST && curtype <= PROFILER_DEVICE_MAX)
+				fprintf(file, "%" I64FMT "u,time,'%s',%.1f\n", global_profiler.logframe,
+						machine.m_devicelist.find(curtype - PROFILER_DEVICE_FIRST)->tag(), (double)data->duration[curtype] * scale);
+			else
+				fprintf(file, "%" I64FMT "u,time,%s,%.1f\n", global_profiler.logframe,
+						profiler_type_name(curtype), (double)data->duration[curtype] * scale);
+		}
+	if (data->context_switches != 0)
+		fprintf(file, "%" I64FMT "u,count,CPU switches,%d\n", global_profiler.logframe, data->context_switches);
+
+	/* counters */
+	for (curtype = 0; curtype < global_profiler.counters; curtype++)
+		if (data->counter[curtype] != 0)
+			fprintf(file, "%" I64FMT "u,count,%s: %s,%d\n", global_profiler.logframe,
+					global_profiler.counter[curtype].group, global_profiler.counter[curtype].name, data->counter[curtype]);
+
+	global_profiler.logframe++;
+	profiler_advance();
+}
+
+
+
+/***************************************************************************
+    COUNTERS
+***************************************************************************/
+
+/*-------------------------------------------------
+    _profiler_counter_register - find or create a
+    named counter; the strings must stay valid
+    for the life of the program
+-------------------------------------------------*/
+
+int _profiler_counter_register(const char *group, const char *name)
+{
+	int index;
+
+	/* counters outlive machines, so find an existing one first */
+	for (index = 0; index < global_profiler.counters; index++)
+		if (strcmp(global_profiler.counter[index].group, group) == 0 && strcmp(global_profiler.counter[index].name, name) == 0)
+			return index;
+
+	/* when we run out, everything else shares the last slot */
+	if (global_profiler.counters == PROFILER_MAX_COUNTERS)
+	{
+		global_profiler.counter[PROFILER_MAX_COUNTERS - 1].group = "Profiler";
+		global_profiler.counter[PROFILER_MAX_COUNTERS - 1].name = "overflowed counters";
+		return PROFILER_MAX_COUNTERS - 1;
+	}
+
+	global_profiler.counter[index].group = group;
+	global_profiler.counter[index].name = name;
+	return global_profiler.counters++;
+}
+
+
+/*-------------------------------------------------
+    _profiler_counter_add - add to a counter for
+    the current frame
+-------------------------------------------------*/
+
+void _profiler_counter_add(int index, INT32 value)
+{
+	atomic_add32(&global_profiler.data[global_profiler.dataindex].counter[index], value);
+}
+
+
+/*-------------------------------------------------
+    _profiler_counter_max - raise a counter for the
+    current frame to at least the given value
+-------------------------------------------------*/
+
+void _profiler_counter_max(int index, INT32 value)
+{
+	INT32 *counter = &global_profiler.data[global_profiler.dataindex].counter[index];
+
+	if (*counter < value)
+		*counter = value;
+}
@@ -17,6 +17,14 @@
 
     the profiler handles a FILO list so calls may be nested.
 
+    Drivers can also keep named per-frame counters alongside the timings;
+    register them once (e.g. in VIDEO_START) and add to them as you go:
+    tri_counter = profiler_counter_register("Model 2", "triangles");
+    profiler_counter_add(tri_counter, 1);
+
+    Counters are summed per frame and shown after the timings; adding to
+    a counter is safe from work queue threads.
+
 ***************************************************************************/
 
 #pragma once
@@ -45,6 +53,7 @@ enum
 	PROFILER_TILEMAP_DRAW_ROZ,
 	PROFILER_TILEMAP_UPDATE,
 	PROFILER_BLIT,
+	PROFILER_POLY_WAIT,	/* waiting on poly.c work queues */
 	PROFILER_SOUND,
 	PROFILER_TIMER_CALLBACK,
 	PROFILER_INPUT,		/* input.c and inptport.c */
@@ -68,6 +77,9 @@ enum
 	PROFILER_TOTAL
 };
 
+/* maximum number of named counters */
+#define PROFILER_MAX_COUNTERS	64
+
 
 
 /***************************************************************************
@@ -87,6 +99,15 @@ struct _profiler_data
 {
 	UINT32			context_switches;	/* number of context switches seen */
 	osd_ticks_t		duration[PROFILER_TOTAL]; /* duration spent in each entry */
+	INT32			counter[PROFILER_MAX_COUNTERS]; /* value of each counter */
+};
+
+
+typedef struct _profiler_counter_name profiler_counter_name;
+struct _profiler_counter_name
+{
+	const char *	group;				/* group, usually the driver or subsystem */
+	const char *	name;				/* name within the group */
 };
 
 
@@ -99,6 +120,12 @@ struct _profiler_state
 	UINT8			dataready;			/* are we to display the data yet? */
 	profiler_filo_entry filo[16];		/* array of FILO entries */
 	profiler_data	data[16];			/* array of data */
+	int				counters;			/* number of registered counters */
+	profiler_counter_name counter[PROFILER_MAX_COUNTERS]; /* counter names */
+	FILE *			logfile;			/* per-frame log, if any */
+	UINT64			logframe;			/* frame number for the log */
+	osd_ticks_t		logstart;			/* osd_ticks() when the log was opened */
+	osd_ticks_t		logstartprofile;	/* get_profile_ticks() when the log was opened */
 };
 
 
@@ -119,9 +146,12 @@ extern profiler_state global_profiler;
 
 #define profiler_mark_start(x)	do { if (global_profiler.enabled) _profiler_mark_start(x); } while (0)
 #define profiler_mark_end()		do { if (global_profiler.enabled) _profiler_mark_end(); } while (0)
-#define profiler_start()		do { global_profiler.enabled = TRUE; global_profiler.filoindex = global_profiler.dataindex = global_profiler.dataready = 0; } while (0)
-#define profiler_stop()			do { global_profiler.enabled = FALSE; } while (0)
+#define profiler_start()		do { if (!global_profiler.enabled) { global_profiler.enabled = TRUE; global_profiler.filoindex = global_profiler.dataindex = global_profiler.dataready = 0; } } while (0)
+#define profiler_stop()			do { global_profiler.enabled = (global_profiler.logfile != NULL); } while (0)
 #define profiler_get_text(x,s)	_profiler_get_text(x, s)
+#define profiler_counter_register(g,n)	_profiler_counter_register(g, n)
+#define profiler_counter_add(x,v)	do { if (global_profiler.enabled) _profiler_counter_add(x, v); } while (0)
+#define profiler_counter_max(x,v)	do { if (global_profiler.enabled) _profiler_counter_max(x, v); } while (0)
 
 #else
 
@@ -130,6 +160,9 @@ extern profiler_state global_profiler;
 #define profiler_start()		do { } while (0)
 #define profiler_stop()			do { } while (0)
 #define profiler_get_text(x,s)	(s).reset()
+#define profiler_counter_register(g,n)	(0)
+#define profiler_counter_add(x,v)	do { } while (0)
+#define profiler_counter_max(x,v)	do { } while (0)
 
 #endif
 
@@ -139,6 +172,9 @@ extern profiler_state global_profiler;
     FUNCTION PROTOTYPES
 ***************************************************************************/
 
+/* open the per-frame log if one was requested */
+void profiler_init(running_machine *machine);
+
 
 /* ----- core functions (do not call directly; use macros) ----- */
 
@@ -151,5 +187,14 @@ void _profiler_mark_end(void);
 /* return the current text in an astring */
 astring &_profiler_get_text(running_machine *machine, astring &string);
 
+/* find or create a named counter and return its index */
+int _profiler_counter_register(const char *group, const char *name);
+
+/* add to a counter for the current frame */
+void _profiler_counter_add(int index, INT32 value);
+
+/* raise a counter for the current frame to at least the given value */
+void _profiler_counter_max(int index, INT32 value);
+
 
 #endif	/* __PROFILER_H__ */
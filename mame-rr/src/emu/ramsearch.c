@@ -0,0 +1,889 @@
+/***************************************************************************
+
+    ramsearch.c
+
+    UI-independent RAM search engine.
+
+****************************************************************************
+
+    The search works on snapshots rather than on live memory. Each RAM
+    region of the space is copied into one contiguous buffer (undoing the
+    host byte swizzle of wide buses), so a value is always a couple of
+    loads away instead of a trip through the memory handlers.
+
+    Three snapshots are kept: the values at the last search ("previous"),
+    at the last update ("current") and a scratch buffer the next update
+    is captured into. Every byte of the buffers has one bit in a candidate
+    bitmap; eliminating a value clears its bit. Words of the bitmap that
+    are already empty are skipped whole, so later searches only touch the
+    survivors.
+
+    Byte searches against the previous values or a constant run 16 values
+    at a time when SSE2 is available; everything else goes through the
+    scalar path one candidate at a time.
+
+    A second bitmap holds the candidates saved by ramsearch_checkpoint.
+    Undo swaps the two, so undoing twice redoes.
+
+***************************************************************************/
+
+#include "emu.h"
+#include "ramsearch.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+
+
+/***************************************************************************
+    CONSTANTS
+***************************************************************************/
+
+/* extra bytes after each buffer, so that wide reads past the end are safe */
+#define BUFFER_PAD			16
+
+
+
+/***************************************************************************
+    TYPE DEFINITIONS
+***************************************************************************/
+
+/* a contiguous range of RAM in the searched space */
+typedef struct _ramsearch_region ramsearch_region;
+struct _ramsearch_region
+{
+	offs_t				start;			/* first byte address */
+	UINT32				length;			/* length in bytes */
+	UINT32				offset;			/* offset of the first byte in the snapshot buffers */
+};
+
+
+struct _ramsearch_state
+{
+	running_machine *	machine;		/* owning machine */
+	const address_space *space;			/* space being searched */
+	int					size;			/* size of each value in bytes (1, 2 or 4) */
+	int					is_signed;		/* are the values signed? */
+
+	ramsearch_region *	region;			/* array of regions */
+	int					regions;		/* number of regions */
+
+	UINT32				total;			/* total bytes covered by the regions */
+	UINT32				alloc;			/* bytes allocated per snapshot buffer */
+	UINT8 *				prev;			/* values at the last search or reset */
+	UINT8 *				cur;			/* values at the last update */
+	UINT8 *				next;			/* scratch buffer for the next update */
+	UINT16 *			changes;		/* per-value change counts */
+	UINT32 *			bitmap;			/* one bit per byte: still a candidate? */
+	UINT32 *			undo;			/* bitmap saved by the last checkpoint */
+	UINT32				candidates;		/* number of bits set in the bitmap */
+};
+
+
+
+/***************************************************************************
+    INLINE FUNCTIONS
+***************************************************************************/
+
+/*-------------------------------------------------
+    count_bits - return the number of set bits
+    in a 32-bit value
+-------------------------------------------------*/
+
+INLINE UINT32 count_bits(UINT32 value)
+{
+	value = value - ((value >> 1) & 0x55555555);
+	value = (value & 0x33333333) + ((value >> 2) & 0x33333333);
+	return (((value + (value >> 4)) & 0x0f0f0f0f) * 0x01010101) >> 24;
+}
+
+
+/*-------------------------------------------------
+    lowest_bit - return the index of the lowest
+    set bit of a non-zero value
+-------------------------------------------------*/
+
+INLINE int lowest_bit(UINT32 value)
+{
+	return 31 - count_leading_zeros(value & (0 - value));
+}
+
+
+/*-------------------------------------------------
+    read_value - assemble the value that starts
+    at the given index of a snapshot buffer
+-------------------------------------------------*/
+
+INLINE INT64 read_value(const ramsearch_state *search, const UINT8 *buffer, UINT32 index)
+{
+	const UINT8 *data = &buffer[index];
+	UINT32 value;
+
+	switch (search->size)
+	{
+		case 1:
+			return search->is_signed ? (INT64)(INT8)data[0] : (INT64)data[0];
+
+		case 2:
+			if (search->space->endianness == ENDIANNESS_LITTLE)
+				value = data[0] | (data[1] << 8);
+			else
+				value = data[1] | (data[0] << 8);
+			return search->is_signed ? (INT64)(INT16)value : (INT64)value;
+
+		default:
+			if (search->space->endianness == ENDIANNESS_LITTLE)
+				value = data[0] | (data[1] << 8) | (data[2] << 16) | (data[3] << 24);
+			else
+				value = data[3] | (data[2] << 8) | (data[1] << 16) | (data[0] << 24);
+			return search->is_signed ? (INT64)(INT32)value : (INT64)value;
+	}
+}
+
+
+/*-------------------------------------------------
+    compare_values - apply a comparison operator
+-------------------------------------------------*/
+
+INLINE int compare_values(int compare, INT64 value, INT64 operand, INT64 param)
+{
+	switch (compare)
+	{
+		case RAMSEARCH_LESS:			return (value < operand);
+		case RAMSEARCH_GREATER:			return (value > operand);
+		case RAMSEARCH_LESS_EQUAL:		return (value <= operand);
+		case RAMSEARCH_GREATER_EQUAL:	return (value >= operand);
+		case RAMSEARCH_EQUAL:			return (value == operand);
+		case RAMSEARCH_NOT_EQUAL:		return (value != operand);
+		case RAMSEARCH_DIFFERENT_BY:	return (value - operand == param || operand - value == param);
+		case RAMSEARCH_MODULO:			return (param != 0 && value % param == operand);
+	}
+	return FALSE;
+}
+
+
+
+/***************************************************************************
+    SNAPSHOTS
+***************************************************************************/
+
+/*-------------------------------------------------
+    capture_region - copy one region into a
+    snapshot buffer in address order
+-------------------------------------------------*/
+
+static void capture_region(const ramsearch_state *search, const ramsearch_region *region, UINT8 *dest)
+{
+	const address_space *space = search->space;
+	offs_t xormask = (space->endianness == ENDIANNESS_NATIVE) ? 0 : (space->dbits / 8 - 1);
+	UINT8 *base = NULL;
+	UINT32 index;
+
+	/* RAM that sits in a single bank can be copied straight out of it; banks
+       may be switched at any time, so look the pointer up on every capture */
+	if ((region->start & xormask) == 0 && (region->length & xormask) == 0)
+	{
+		base = (UINT8 *)memory_get_read_ptr(space, region->start);
+		if (base != NULL && (UINT8 *)memory_get_read_ptr(space, region->start + region->length - 1) != base + region->length - 1)
+			base = NULL;
+	}
+
+	if (base != NULL && xormask == 0)
+		memcpy(dest, base, region->length);
+	else if (base != NULL)
+	{
+		for (index = 0; index < region->length; index++)
+			dest[index] = base[index ^ xormask];
+	}
+
+	/* anything else goes through the handlers */
+	else
+	{
+		for (index = 0; index < region->length; index++)
+			dest[index] = memory_read_byte(space, region->start + index);
+	}
+}
+
+
+/*-------------------------------------------------
+    capture - take a full snapshot
+-------------------------------------------------*/
+
+static void capture(const ramsearch_state *search, UINT8 *dest)
+{
+	int regnum;
+
+	for (regnum = 0; regnum < search->regions; regnum++)
+		capture_region(search, &search->region[regnum], dest + search->region[regnum].offset);
+}
+
+
+/*-------------------------------------------------
+    recount - recompute the number of candidates
+-------------------------------------------------*/
+
+static UINT32 recount(ramsearch_state *search)
+{
+	UINT32 words = search->alloc / 32;
+	UINT32 count = 0;
+	UINT32 word;
+
+	for (word = 0; word < words; word++)
+		if (search->bitmap[word] != 0)
+			count += count_bits(search->bitmap[word]);
+	search->candidates = count;
+	return count;
+}
+
+
+/*-------------------------------------------------
+    find_regions - build the list of RAM regions
+    in the space; returns the number of bytes
+    they cover
+-------------------------------------------------*/
+
+static UINT32 find_regions(ramsearch_state *search)
+{
+	const address_space *space = search->space;
+	const address_map_entry *entry, *scan;
+	UINT32 total = 0;
+	int count = 0;
+
+	/* count the entries so we can size the region array */
+	for (entry = space->map->entrylist; entry != NULL; entry = entry->next)
+		count++;
+	if (search->region != NULL)
+		auto_free(search->machine, search->region);
+	search->region = auto_alloc_array_clear(search->machine, ramsearch_region, count + 1);
+	search->regions = 0;
+
+	for (entry = space->map->entrylist; entry != NULL; entry = entry->next)
+	{
+		ramsearch_region *region = &search->region[search->regions];
+		int shared = FALSE;
+
+		/* only writeable RAM is interesting */
+		if (entry->write.type != AMH_RAM)
+			continue;
+
+		/* shared RAM appears once, under its first entry */
+		if (entry->share != NULL)
+			for (scan = space->map->entrylist; scan != entry; scan = scan->next)
+				if (scan->write.type == AMH_RAM && scan->share != NULL && strcmp(scan->share, entry->share) == 0)
+					shared = TRUE;
+		if (shared)
+			continue;
+
+		region->start = memory_address_to_byte(space, entry->addrstart) & space->bytemask;
+		region->length = (memory_address_to_byte_end(space, entry->addrend) & space->bytemask) - region->start + 1;
+		region->offset = total;
+		total += region->length;
+		search->regions++;
+	}
+	return total;
+}
+
+
+/*-------------------------------------------------
+    find_index - find the snapshot index of a
+    byte address; returns FALSE if it is not in
+    any region
+-------------------------------------------------*/
+
+static int find_index(const ramsearch_state *search, offs_t address, UINT32 *index)
+{
+	int regnum;
+
+	for (regnum = 0; regnum < search->regions; regnum++)
+	{
+		const ramsearch_region *region = &search->region[regnum];
+
+		if (address >= region->start && address - region->start < region->length)
+		{
+			*index = region->offset + (address - region->start);
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+
+/*-------------------------------------------------
+    widen_bits - make every byte of each
+    candidate value a candidate itself
+-------------------------------------------------*/
+
+static void widen_bits(const ramsearch_state *search, UINT32 *bitmap)
+{
+	UINT32 word = search->alloc / 32;
+	int shift;
+
+	/* go from the top down, so the word below is still unchanged when we borrow from it */
+	while (word-- > 0)
+	{
+		UINT32 bits = bitmap[word];
+
+		for (shift = 1; shift < search->size; shift++)
+			bits |= (bitmap[word] << shift) | ((word > 0) ? (bitmap[word - 1] >> (32 - shift)) : 0);
+		bitmap[word] = bits;
+	}
+}
+
+
+/*-------------------------------------------------
+    clear_unfit - clear the bits of values that
+    run past the end of their region or are not
+    aligned, if asked
+-------------------------------------------------*/
+
+static void clear_unfit(const ramsearch_state *search, UINT32 *bitmap, int aligned)
+{
+	int regnum;
+
+	for (regnum = 0; regnum < search->regions; regnum++)
+	{
+		const ramsearch_region *region = &search->region[regnum];
+		UINT32 index;
+
+		for (index = 0; index < region->length; index++)
+			if (index + search->size > region->length || (aligned && ((region->start + index) % search->size) != 0))
+			{
+				UINT32 bit = region->offset + index;
+				bitmap[bit / 32] &= ~(1 << (bit % 32));
+			}
+	}
+}
+
+
+
+/***************************************************************************
+    CORE IMPLEMENTATION
+***************************************************************************/
+
+/*-------------------------------------------------
+    ramsearch_alloc - allocate a new search
+-------------------------------------------------*/
+
+ramsearch_state *ramsearch_alloc(running_machine *machine)
+{
+	ramsearch_state *search = auto_alloc_clear(machine, ramsearch_state);
+
+	search->machine = machine;
+	search->size = 1;
+	return search;
+}
+
+
+/*-------------------------------------------------
+    ramsearch_free - free a search
+-------------------------------------------------*/
+
+void ramsearch_free(ramsearch_state *search)
+{
+	running_machine *machine = search->machine;
+
+	if (search->region != NULL)
+		auto_free(machine, search->region);
+	if (search->prev != NULL)
+	{
+		auto_free(machine, search->prev);
+		auto_free(machine, search->cur);
+		auto_free(machine, search->next);
+		auto_free(machine, search->changes);
+		auto_free(machine, search->bitmap);
+		auto_free(machine, search->undo);
+	}
+	auto_free(machine, search);
+}
+
+
+/*-------------------------------------------------
+    ramsearch_reset - snapshot RAM and make every
+    value a candidate
+-------------------------------------------------*/
+
+UINT32 ramsearch_reset(ramsearch_state *search, const address_space *space, int size, int is_signed, int aligned)
+{
+	running_machine *machine = search->machine;
+	UINT32 alloc;
+	int regnum;
+
+	search->space = space;
+	search->size = (size == 2 || size == 4) ? size : 1;
+	search->is_signed = is_signed;
+
+	/* round the buffers up to whole bitmap words, which also covers the 16-byte SIMD chunks */
+	search->total = find_regions(search);
+	alloc = (search->total + 31) & ~31;
+	if (alloc > search->alloc || search->prev == NULL)
+	{
+		if (search->prev != NULL)
+		{
+			auto_free(machine, search->prev);
+			auto_free(machine, search->cur);
+			auto_free(machine, search->next);
+			auto_free(machine, search->changes);
+			auto_free(machine, search->bitmap);
+			auto_free(machine, search->undo);
+		}
+		search->prev = auto_alloc_array_clear(machine, UINT8, alloc + BUFFER_PAD);
+		search->cur = auto_alloc_array_clear(machine, UINT8, alloc + BUFFER_PAD);
+		search->next = auto_alloc_array_clear(machine, UINT8, alloc + BUFFER_PAD);
+		search->changes = auto_alloc_array(machine, UINT16, alloc);
+		search->bitmap = auto_alloc_array(machine, UINT32, alloc / 32);
+		search->undo = auto_alloc_array_clear(machine, UINT32, alloc / 32);
+		search->alloc = alloc;
+	}
+
+	/* take the first snapshot */
+	capture(search, search->cur);
+	memcpy(search->prev, search->cur, search->alloc);
+	memset(search->changes, 0, search->alloc * sizeof(search->changes[0]));
+	memset(search->bitmap, 0, search->alloc / 8);
+
+	/* every value that fits in its region (and is aligned, if asked) is a candidate */
+	for (regnum = 0; regnum < search->regions; regnum++)
+	{
+		const ramsearch_region *region = &search->region[regnum];
+		UINT32 index;
+
+		if (region->length < search->size)
+			continue;
+		for (index = 0; index <= region->length - search->size; index++)
+			if (!aligned || ((region->start + index) % search->size) == 0)
+			{
+				UINT32 bit = region->offset + index;
+				search->bitmap[bit / 32] |= 1 << (bit % 32);
+			}
+	}
+	return recount(search);
+}
+
+
+/*-------------------------------------------------
+    ramsearch_update - take a new snapshot and
+    count the values that changed
+-------------------------------------------------*/
+
+void ramsearch_update(ramsearch_state *search)
+{
+	UINT32 words = search->alloc / 32;
+	UINT32 word;
+	UINT8 *temp;
+
+	if (search->space == NULL)
+		return;
+	capture(search, search->next);
+
+	for (word = 0; word < words; word++)
+	{
+		UINT32 bits = search->bitmap[word];
+
+		if (bits == 0)
+			continue;
+
+#ifdef __SSE2__
+		/* byte values: count 16 at a time, candidates or not */
+		if (search->size == 1)
+		{
+			const __m128i one = _mm_set1_epi16(1);
+			int half;
+
+			for (half = 0; half < 2; half++)
+				if ((bits >> (half * 16)) & 0xffff)
+				{
+					UINT32 base = word * 32 + half * 16;
+					__m128i same = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)&search->cur[base]), _mm_loadu_si128((const __m128i *)&search->next[base]));
+					__m128i *count = (__m128i *)&search->changes[base];
+					__m128i lo = _mm_andnot_si128(_mm_unpacklo_epi8(same, same), one);
+					__m128i hi = _mm_andnot_si128(_mm_unpackhi_epi8(same, same), one);
+					_mm_storeu_si128(&count[0], _mm_adds_epu16(_mm_loadu_si128(&count[0]), lo));
+					_mm_storeu_si128(&count[1], _mm_adds_epu16(_mm_loadu_si128(&count[1]), hi));
+				}
+			continue;
+		}
+#endif
+
+		/* otherwise walk the candidates */
+		while (bits != 0)
+		{
+			int bit = lowest_bit(bits);
+			UINT32 index = word * 32 + bit;
+
+			bits &= bits - 1;
+			if (memcmp(&search->cur[index], &search->next[index], search->size) != 0 && search->changes[index] != 0xffff)
+				search->changes[index]++;
+		}
+	}
+
+	/* the new snapshot becomes the current one */
+	temp = search->cur;
+	search->cur = search->next;
+	search->next = temp;
+}
+
+
+/*-------------------------------------------------
+    search_bytes_simd - the 16-wide kernel for
+    byte searches; returns FALSE if the search
+    is not one it can handle
+-------------------------------------------------*/
+
+#ifdef __SSE2__
+static int search_bytes_simd(ramsearch_state *search, int compare, int target, INT64 operand)
+{
+	UINT32 words = search->alloc / 32;
+	__m128i bias, constant;
+	UINT32 word;
+
+	/* only the plain relational operators, and constants that fit in a byte */
+	if (search->size != 1 || compare > RAMSEARCH_NOT_EQUAL)
+		return FALSE;
+	if (target == RAMSEARCH_SPECIFIC)
+	{
+		if (search->is_signed ? (operand < -128 || operand > 127) : (operand < 0 || operand > 255))
+			return FALSE;
+	}
+	else if (target != RAMSEARCH_PREVIOUS)
+		return FALSE;
+
+	/* SSE2 only compares signed bytes; flip the top bit of unsigned ones to match */
+	bias = _mm_set1_epi8(search->is_signed ? 0x00 : (char)0x80);
+	constant = _mm_xor_si128(_mm_set1_epi8((char)operand), bias);
+
+	for (word = 0; word < words; word++)
+	{
+		UINT32 bits = search->bitmap[word];
+		int half;
+
+		if (bits == 0)
+			continue;
+
+		for (half = 0; half < 2; half++)
+		{
+			UINT32 live = (bits >> (half * 16)) & 0xffff;
+			UINT32 base = word * 32 + half * 16;
+			__m128i value, other, result;
+			UINT32 keep;
+
+			if (live == 0)
+				continue;
+
+			value = _mm_xor_si128(_mm_loadu_si128((const __m128i *)&search->cur[base]), bias);
+			if (target == RAMSEARCH_PREVIOUS)
+				other = _mm_xor_si128(_mm_loadu_si128((const __m128i *)&search->prev[base]), bias);
+			else
+				other = constant;
+
+			switch (compare)
+			{
+				case RAMSEARCH_LESS:			result = _mm_cmplt_epi8(value, other);	keep = _mm_movemask_epi8(result);			break;
+				case RAMSEARCH_GREATER:			result = _mm_cmpgt_epi8(value, other);	keep = _mm_movemask_epi8(result);			break;
+				case RAMSEARCH_LESS_EQUAL:		result = _mm_cmpgt_epi8(value, other);	keep = ~_mm_movemask_epi8(result) & 0xffff;	break;
+				case RAMSEARCH_GREATER_EQUAL:	result = _mm_cmplt_epi8(value, other);	keep = ~_mm_movemask_epi8(result) & 0xffff;	break;
+				case RAMSEARCH_EQUAL:			result = _mm_cmpeq_epi8(value, other);	keep = _mm_movemask_epi8(result);			break;
+				default:						result = _mm_cmpeq_epi8(value, other);	keep = ~_mm_movemask_epi8(result) & 0xffff;	break;
+			}
+			bits &= ~((live & ~keep) << (half * 16));
+		}
+		search->bitmap[word] = bits;
+	}
+	return TRUE;
+}
+#endif
+
+
+/*-------------------------------------------------
+    ramsearch_search - take a new snapshot and
+    eliminate the candidates that fail the
+    comparison
+-------------------------------------------------*/
+
+UINT32 ramsearch_search(ramsearch_state *search, int compare, int target, INT64 operand, INT64 param)
+{
+	UINT32 words = search->alloc / 32;
+	UINT32 word;
+
+	if (search->space == NULL)
+		return 0;
+	ramsearch_update(search);
+
+#ifdef __SSE2__
+	if (!search_bytes_simd(search, compare, target, operand))
+#endif
+	{
+		int regnum = 0;
+
+		for (word = 0; word < words; word++)
+		{
+			UINT32 bits = search->bitmap[word];
+			UINT32 remaining = bits;
+
+			while (bits != 0)
+			{
+				int bit = lowest_bit(bits);
+				UINT32 index = word * 32 + bit;
+				INT64 value, other;
+
+				bits &= bits - 1;
+				if (target == RAMSEARCH_CHANGES)
+					value = search->changes[index];
+				else if (target == RAMSEARCH_ADDRESS)
+				{
+					/* candidates come in buffer order, so the region only moves forward */
+					while (index >= search->region[regnum].offset + search->region[regnum].length)
+						regnum++;
+					value = search->region[regnum].start + (index - search->region[regnum].offset);
+				}
+				else
+					value = read_value(search, search->cur, index);
+				other = (target == RAMSEARCH_PREVIOUS) ? read_value(search, search->prev, index) : operand;
+
+				if (!compare_values(compare, value, other, param))
+					remaining &= ~(1 << bit);
+			}
+			search->bitmap[word] = remaining;
+		}
+	}
+
+	/* the values at this search are the "previous" ones for the next */
+	memcpy(search->prev, search->cur, search->alloc);
+	return recount(search);
+}
+
+
+/*-------------------------------------------------
+    ramsearch_eliminate - drop the candidate at
+    a byte address
+-------------------------------------------------*/
+
+UINT32 ramsearch_eliminate(ramsearch_state *search, offs_t address)
+{
+	UINT32 index;
+
+	if (search->space != NULL && find_index(search, address, &index) && (search->bitmap[index / 32] & (1 << (index % 32))) != 0)
+	{
+		search->bitmap[index / 32] &= ~(1 << (index % 32));
+		search->candidates--;
+	}
+	return search->candidates;
+}
+
+
+/*-------------------------------------------------
+    ramsearch_checkpoint - remember the current
+    candidates for a later undo
+-------------------------------------------------*/
+
+void ramsearch_checkpoint(ramsearch_state *search)
+{
+	if (search->space != NULL)
+		memcpy(search->undo, search->bitmap, search->alloc / 8);
+}
+
+
+/*-------------------------------------------------
+    ramsearch_undo - swap the candidates with the
+    ones from the last checkpoint
+-------------------------------------------------*/
+
+UINT32 ramsearch_undo(ramsearch_state *search)
+{
+	UINT32 *temp;
+
+	if (search->space == NULL)
+		return 0;
+	temp = search->bitmap;
+	search->bitmap = search->undo;
+	search->undo = temp;
+	return recount(search);
+}
+
+
+/*-------------------------------------------------
+    ramsearch_set_format - change how the values
+    are read without starting over
+-------------------------------------------------*/
+
+UINT32 ramsearch_set_format(ramsearch_state *search, int size, int is_signed, int aligned)
+{
+	if (search->space == NULL)
+	{
+		search->size = (size == 2 || size == 4) ? size : 1;
+		search->is_signed = is_signed;
+		return 0;
+	}
+
+	/* every byte of a surviving value survives, so going down in size keeps them all */
+	widen_bits(search, search->bitmap);
+	widen_bits(search, search->undo);
+	search->size = (size == 2 || size == 4) ? size : 1;
+	search->is_signed = is_signed;
+
+	/* then a value that no longer fits can't be a candidate, nor come back on undo */
+	clear_unfit(search, search->bitmap, aligned);
+	clear_unfit(search, search->undo, aligned);
+	return recount(search);
+}
+
+
+/*-------------------------------------------------
+    ramsearch_clear_changes - zero the change
+    counts
+-------------------------------------------------*/
+
+void ramsearch_clear_changes(ramsearch_state *search)
+{
+	if (search->space != NULL)
+		memset(search->changes, 0, search->alloc * sizeof(search->changes[0]));
+}
+
+
+/*-------------------------------------------------
+    ramsearch_count - return the number of
+    remaining candidates
+-------------------------------------------------*/
+
+UINT32 ramsearch_count(ramsearch_state *search)
+{
+	return search->candidates;
+}
+
+
+/*-------------------------------------------------
+    ramsearch_results - fetch a range of the
+    remaining candidates
+-------------------------------------------------*/
+
+UINT32 ramsearch_results(ramsearch_state *search, UINT32 first, ramsearch_result *results, UINT32 maxresults)
+{
+	UINT32 words = search->alloc / 32;
+	UINT32 found = 0;
+	UINT32 word;
+	int regnum = 0;
+
+	for (word = 0; word < words && found < maxresults; word++)
+	{
+		UINT32 bits = search->bitmap[word];
+		UINT32 count;
+
+		if (bits == 0)
+			continue;
+
+		/* skip whole words until we reach the first requested result */
+		count = count_bits(bits);
+		if (first >= count)
+		{
+			first -= count;
+			continue;
+		}
+
+		while (bits != 0 && found < maxresults)
+		{
+			UINT32 index = word * 32 + lowest_bit(bits);
+			ramsearch_result *result;
+
+			bits &= bits - 1;
+			if (first > 0)
+			{
+				first--;
+				continue;
+			}
+
+			/* candidates come in buffer order, so the region only moves forward */
+			while (index >= search->region[regnum].offset + search->region[regnum].length)
+				regnum++;
+
+			result = &results[found++];
+			result->address = search->region[regnum].start + (index - search->region[regnum].offset);
+			result->value = read_value(search, search->cur, index);
+			result->previous = read_value(search, search->prev, index);
+			result->changes = search->changes[index];
+		}
+	}
+	return found;
+}
+
+
+/*-------------------------------------------------
+    ramsearch_result_matches - apply a search to
+    a single result without eliminating anything
+-------------------------------------------------*/
+
+int ramsearch_result_matches(const ramsearch_result *result, int compare, int target, INT64 operand, INT64 param)
+{
+	INT64 value, other;
+
+	if (target == RAMSEARCH_CHANGES)
+		value = result->changes;
+	else if (target == RAMSEARCH_ADDRESS)
+		value = result->address;
+	else
+		value = result->value;
+	other = (target == RAMSEARCH_PREVIOUS) ? result->previous : operand;
+	return compare_values(compare, value, other, param);
+}
+
+
+/*-------------------------------------------------
+    ramsearch_get_space - return the space being
+    searched
+-------------------------------------------------*/
+
+const address_space *ramsearch_get_space(ramsearch_state *search)
+{
+	return search->space;
+}
+
+
+/*-------------------------------------------------
+    ramsearch_contains - is a byte address in
+    one of the searched regions?
+-------------------------------------------------*/
+
+int ramsearch_contains(ramsearch_state *search, offs_t address)
+{
+	UINT32 index;
+
+	return (search->space != NULL && find_index(search, address, &index));
+}
+
+
+/*-------------------------------------------------
+    ramsearch_compare_from_string - parse the name
+    of a comparison operator
+-------------------------------------------------*/
+
+int ramsearch_compare_from_string(const char *string)
+{
+	static const struct
+	{
+		const char *	name;
+		int				compare;
+	} names[] =
+	{
+		{ "<",		RAMSEARCH_LESS },
+		{ "lt",		RAMSEARCH_LESS },
+		{ ">",		RAMSEARCH_GREATER },
+		{ "gt",		RAMSEARCH_GREATER },
+		{ "<=",		RAMSEARCH_LESS_EQUAL },
+		{ "le",		RAMSEARCH_LESS_EQUAL },
+		{ ">=",		RAMSEARCH_GREATER_EQUAL },
+		{ "ge",		RAMSEARCH_GREATER_EQUAL },
+		{ "==",		RAMSEARCH_EQUAL },
+		{ "eq",		RAMSEARCH_EQUAL },
+		{ "!=",		RAMSEARCH_NOT_EQUAL },
+		{ "~=",		RAMSEARCH_NOT_EQUAL },
+		{ "ne",		RAMSEARCH_NOT_EQUAL },
+		{ "diffby",	RAMSEARCH_DIFFERENT_BY },
+		{ "modulo",	RAMSEARCH_MODULO },
+		{ "mod",	RAMSEARCH_MODULO }
+	};
+	int index;
+
+	for (index = 0; index < ARRAY_LENGTH(names); index++)
+		if (strcmp(string, names[index].name) == 0)
+			return names[index].compare;
+	return -1;
+}
@@ -0,0 +1,117 @@
+/***************************************************************************
+
+    ramsearch.h
+
+    UI-independent RAM search engine.
+
+***************************************************************************/
+
+#pragma once
+
+#ifndef __RAMSEARCH_H__
+#define __RAMSEARCH_H__
+
+
+/***************************************************************************
+    CONSTANTS
+***************************************************************************/
+
+/* comparison operators */
+enum
+{
+	RAMSEARCH_LESS = 0,					/* value < operand */
+	RAMSEARCH_GREATER,					/* value > operand */
+	RAMSEARCH_LESS_EQUAL,				/* value <= operand */
+	RAMSEARCH_GREATER_EQUAL,			/* value >= operand */
+	RAMSEARCH_EQUAL,					/* value == operand */
+	RAMSEARCH_NOT_EQUAL,				/* value != operand */
+	RAMSEARCH_DIFFERENT_BY,				/* value and operand differ by param */
+	RAMSEARCH_MODULO,					/* value % param == operand */
+	RAMSEARCH_COMPARE_COUNT
+};
+
+/* what the current values are compared against */
+enum
+{
+	RAMSEARCH_PREVIOUS = 0,				/* the values at the last search or reset */
+	RAMSEARCH_SPECIFIC,					/* a constant */
+	RAMSEARCH_CHANGES,					/* the change count, against a constant */
+	RAMSEARCH_ADDRESS,					/* the byte address, against a constant */
+	RAMSEARCH_TARGET_COUNT
+};
+
+
+
+/***************************************************************************
+    TYPE DEFINITIONS
+***************************************************************************/
+
+typedef struct _ramsearch_state ramsearch_state;
+
+
+/* a single surviving candidate */
+typedef struct _ramsearch_result ramsearch_result;
+struct _ramsearch_result
+{
+	offs_t				address;		/* byte address of the value */
+	INT64				value;			/* value at the last update */
+	INT64				previous;		/* value at the last search or reset */
+	UINT16				changes;		/* number of updates that saw it change */
+};
+
+
+
+/***************************************************************************
+    FUNCTION PROTOTYPES
+***************************************************************************/
+
+/* allocate a new search; it lives as long as the machine */
+ramsearch_state *ramsearch_alloc(running_machine *machine);
+
+/* free a search allocated above */
+void ramsearch_free(ramsearch_state *search);
+
+/* snapshot the RAM in the given space and make every value a candidate; returns the count */
+UINT32 ramsearch_reset(ramsearch_state *search, const address_space *space, int size, int is_signed, int aligned);
+
+/* take a new snapshot and bump the change counts; call once a frame to track changes */
+void ramsearch_update(ramsearch_state *search);
+
+/* update and drop every candidate that fails the comparison; returns the remaining count */
+UINT32 ramsearch_search(ramsearch_state *search, int compare, int target, INT64 operand, INT64 param);
+
+/* drop the candidate at a byte address, if there is one; returns the remaining count */
+UINT32 ramsearch_eliminate(ramsearch_state *search, offs_t address);
+
+/* remember the current candidates for ramsearch_undo */
+void ramsearch_checkpoint(ramsearch_state *search);
+
+/* swap the candidates with the remembered ones, so a second call redoes; returns the count */
+UINT32 ramsearch_undo(ramsearch_state *search);
+
+/* change the value size and signedness, keeping the candidates that still fit; returns the count */
+UINT32 ramsearch_set_format(ramsearch_state *search, int size, int is_signed, int aligned);
+
+/* zero every change count */
+void ramsearch_clear_changes(ramsearch_state *search);
+
+/* return the number of candidates left */
+UINT32 ramsearch_count(ramsearch_state *search);
+
+/* fill in up to maxresults candidates, skipping the first 'first'; returns the number filled */
+UINT32 ramsearch_results(ramsearch_state *search, UINT32 first, ramsearch_result *results, UINT32 maxresults);
+
+/* would a result survive the given search if it ran now? */
+int ramsearch_result_matches(const ramsearch_result *result, int compare, int target, INT64 operand, INT64 param);
+
+/* return the space being searched, or NULL before the first reset */
+const address_space *ramsearch_get_space(ramsearch_state *search);
+
+/* is a byte address inside one of the searched RAM regions? */
+int ramsearch_contains(ramsearch_state *search, offs_t address);
+
+/* parse a comparison operator name ("<", "lt", "diffby", ...); returns -1 if unknown */
+int ramsearch_compare_from_string(const char *string);
+
+
+#endif	/* __RAMSEARCH_H__ */
@@ -472,6 +472,7 @@ static DEVICE_START( c140 )
 	info->banking_type = intf->banking_type;
 
 	info->stream = stream_create(device,0,2,info->sample_rate,info,update_stereo);
+	stream_set_threadsafe(info->stream, STREAM_THREADSAFE_HEAVY);
 
 	info->pRom=*device->region();
 
@@ -112,6 +112,7 @@ static DEVICE_START( dac )
 	DAC_build_voltable(info);
 
 	info->channel = stream_create(device,0,1,device->clock() ? device->clock() : DEFAULT_SAMPLE_RATE,info,DAC_update);
+	stream_set_threadsafe(info->channel, STREAM_THREADSAFE_LIGHT);
 	info->output = 0;
 
 	state_save_register_device_item(device, 0, info->output);
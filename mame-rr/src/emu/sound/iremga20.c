@@ -249,6 +249,7 @@ static DEVICE_START( iremga20 )
 		chip->regs[i] = 0;
 
 	chip->stream = stream_create( device, 0, 2, device->clock()/4, chip, IremGA20_update );
+	stream_set_threadsafe( chip->stream, STREAM_THREADSAFE_HEAVY );
 
 	state_save_register_device_item_array(device, 0, chip->regs);
 	for (i = 0; i < 4; i++)
@@ -330,6 +330,7 @@ static DEVICE_START( k007232 )
 	for( i = 0; i < 0x10; i++ )  info->wreg[i] = 0;
 
 	info->stream = stream_create(device,0,2,device->clock()/128,info,KDAC_A_update);
+	stream_set_threadsafe(info->stream, STREAM_THREADSAFE_LIGHT);
 
 	KDAC_A_make_fncode(info);
 }
@@ -230,6 +230,7 @@ static DEVICE_START( k053260 )
 	ic->delta_table = auto_alloc_array( device->machine, UINT32, 0x1000 );
 
 	ic->channel = stream_create( device, 0, 2, rate, ic, k053260_update );
+	stream_set_threadsafe( ic->channel, STREAM_THREADSAFE_HEAVY );
 
 	InitDeltaTable( ic, rate, device->clock() );
 
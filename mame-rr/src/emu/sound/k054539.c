@@ -474,6 +474,7 @@ static void k054539_init_chip(running_device *device, k054539_state *info)
 		timer_pulse(device->machine, ATTOTIME_IN_HZ(480), info, 0, k054539_irq);
 
 	info->stream = stream_create(device, 0, 2, device->clock(), info, k054539_update);
+	stream_set_threadsafe(info->stream, STREAM_THREADSAFE_HEAVY);
 
 	state_save_register_device_item_array(device, 0, info->regs);
 	state_save_register_device_item_pointer(device, 0, info->ram,  0x4000);
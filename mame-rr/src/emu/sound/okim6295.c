@@ -173,6 +173,7 @@ void okim6295_device::device_start()
 	// create the stream
 	int divisor = m_config.m_pin7 ? 132 : 165;
 	m_stream = stream_create(this, 0, 1, clock() / divisor, this, static_stream_generate);
+	stream_set_threadsafe(m_stream, STREAM_THREADSAFE_HEAVY);
 
 	state_save_register_device_item(this, 0, m_command);
 	state_save_register_device_item(this, 0, m_bank_offs);
@@ -129,6 +129,7 @@ static DEVICE_START( qsound )
 			device->clock() / QSOUND_CLOCKDIV,
 			chip,
 			qsound_update );
+		stream_set_threadsafe(chip->stream, STREAM_THREADSAFE_HEAVY);
 	}
 
 	if (LOG_WAVE)
@@ -112,6 +112,7 @@ static DEVICE_START( segapcm )
 	spcm->bankmask = mask & (rom_mask >> spcm->bankshift);
 
 	spcm->stream = stream_create(device, 0, 2, device->clock() / 128, spcm, SEGAPCM_update);
+	stream_set_threadsafe(spcm->stream, STREAM_THREADSAFE_HEAVY);
 
 	state_save_register_device_item_array(device, 0, spcm->low);
 	state_save_register_device_item_pointer(device, 0, spcm->ram, 0x800);
@@ -348,6 +348,7 @@ static int SN76496_init(running_device *device, sn76496_state *R, int stereo)
 	int i;
 
 	R->Channel = stream_create(device,0,(stereo?2:1),sample_rate,R,SN76496Update);
+	stream_set_threadsafe(R->Channel, STREAM_THREADSAFE_LIGHT);
 
 	for (i = 0;i < 4;i++) R->Volume[i] = 0;
 
@@ -643,6 +643,7 @@ static DEVICE_START( upd7759 )
 
 	/* allocate a stream channel */
 	chip->channel = stream_create(device, 0, 1, device->clock()/4, chip, upd7759_update);
+	stream_set_threadsafe(chip->channel, STREAM_THREADSAFE_LIGHT);
 
 	/* compute the stepping rate based on the chip's clock speed */
 	chip->step = 4 * FRAC_ONE;
@@ -218,6 +218,7 @@ static DEVICE_START( x1_010 )
 
 	/* get stream channels */
 	info->stream = stream_create(device,0,2,info->rate,info,seta_update);
+	stream_set_threadsafe(info->stream, STREAM_THREADSAFE_HEAVY);
 }
 
 
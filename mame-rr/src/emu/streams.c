@@ -41,6 +41,22 @@
     These sample buffers can then be further resampled and passed to
     other streams, or output as desired.
 
+    During the periodic global update, streams which have no connected
+    inputs (leaf streams) cannot depend on any other stream, so they are
+    brought up to date first, in parallel on the work queue. Most sound
+    cores keep working state in file-scope variables shared by every
+    instance, so only leaf streams whose owners have called
+    stream_set_threadsafe are eligible; everything else is left to the
+    serial walk. Eligible streams belonging to the same device are grouped
+    into a single job and run in creation order, since they may share
+    state. A job is heavy if any of its streams was declared
+    STREAM_THREADSAFE_HEAVY; the work queue is only used when at least two
+    heavy jobs are present, and the light ones ride along with them.
+    Once the leaves are done, the normal sequential walk updates
+    everything else; the leaves are already current at that point, so the
+    final mix is computed in the same order and produces the same results
+    as a purely serial update.
+
 ***************************************************************************/
 
 #include "emu.h"
@@ -69,6 +85,9 @@
 #define FRAC_ONE						(1 << FRAC_BITS)
 #define FRAC_MASK						(FRAC_ONE - 1)
 
+/* minimum number of heavy leaf jobs before we go parallel */
+#define PARALLEL_MIN_HEAVY_JOBS			(2)
+
 
 
 /***************************************************************************
@@ -147,6 +166,11 @@ public:
 	/* callback information */
 	stream_update_func	callback;				/* callback function */
 	void *				param;					/* callback function parameter */
+
+	/* parallel update information */
+	UINT8				threadsafe;				/* TRUE if the callback may run alongside other devices */
+	sound_stream *		job_next;				/* next leaf stream in the same job */
+	INT32				job_sampindex;			/* target sample index for the parallel update */
 };
 
 
@@ -157,6 +181,14 @@ struct _streams_private
 	int					stream_index;			/* index of the current stream */
 	attoseconds_t		update_attoseconds;		/* attoseconds between global updates */
 	attotime			last_update;			/* last update time */
+
+	/* parallel update information */
+	osd_work_queue *	work_queue;				/* work queue for leaf stream jobs */
+	sound_stream **		job_list;				/* first leaf stream of each job */
+	int					job_count;				/* number of jobs */
+	int					job_alloc;				/* allocated size of the job list */
+	int					heavy_jobs;				/* number of jobs containing a heavy stream */
+	int					jobs_dirty;				/* TRUE if the stream graph changed */
 };
 
 
@@ -165,12 +197,16 @@ struct _streams_private
     FUNCTION PROTOTYPES
 ***************************************************************************/
 
+static void streams_exit(running_machine &machine);
 static STATE_POSTLOAD( stream_postload );
 static void allocate_resample_buffers(running_machine *machine, sound_stream *stream);
 static void allocate_output_buffers(running_machine *machine, sound_stream *stream);
 static void recompute_sample_rate_data(running_machine *machine, sound_stream *stream);
 static void generate_samples(sound_stream *stream, int samples);
 static stream_sample_t *generate_resampled_data(stream_input *input, UINT32 numsamples);
+static void rebuild_leaf_jobs(running_machine *machine);
+static void update_leaf_streams(running_machine *machine, attotime curtime);
+static void *leaf_job_callback(void *param, int threadid);
 
 
 
@@ -225,8 +261,13 @@ void streams_init(running_machine *machine)
 	strdata->stream_tailptr = &strdata->stream_head;
 	strdata->update_attoseconds = STREAMS_UPDATE_ATTOTIME.attoseconds;
 
+	/* allocate a queue for updating independent streams in parallel */
+	strdata->work_queue = osd_work_queue_alloc(WORK_QUEUE_FLAG_MULTI);
+	strdata->jobs_dirty = TRUE;
+
 	/* set the global pointer */
 	machine->streams_data = strdata;
+	machine->add_notifier(MACHINE_NOTIFY_EXIT, streams_exit);
 
 	/* register global states */
 	state_save_register_global(machine, strdata->last_update.seconds);
@@ -234,6 +275,21 @@ void streams_init(running_machine *machine)
 }
 
 
+/*-------------------------------------------------
+    streams_exit - clean up after ourselves
+-------------------------------------------------*/
+
+static void streams_exit(running_machine &machine)
+{
+	streams_private *strdata = machine.streams_data;
+
+	/* free the work queue */
+	if (strdata->work_queue != NULL)
+		osd_work_queue_free(strdata->work_queue);
+	strdata->work_queue = NULL;
+}
+
+
 /*-------------------------------------------------
     streams_update - update all the streams
     periodically
@@ -255,6 +311,10 @@ void streams_update(running_machine *machine)
 		second_tick = TRUE;
 	}
 
+	/* bring the independent leaf streams up to date first */
+	if (strdata->work_queue != NULL)
+		update_leaf_streams(machine, curtime);
+
 	/* iterate over all the streams */
 	for (stream = strdata->stream_head; stream != NULL; stream = stream->next)
 	{
@@ -394,6 +454,7 @@ sound_stream *stream_create(device_t *device, int inputs, int outputs, int sampl
 	/* hook us into the master stream list */
 	*strdata->stream_tailptr = stream;
 	strdata->stream_tailptr = &stream->next;
+	strdata->jobs_dirty = TRUE;
 
 	/* force an update to the sample rates; this will cause everything to be recomputed
        and will generate the initial resample buffers for our inputs */
@@ -490,12 +551,28 @@ void stream_set_input(sound_stream *stream, int index, sound_stream *input_strea
 	/* update the dependent info */
 	if (input->source != NULL)
 		input->source->dependents++;
+	stream->device->machine->streams_data->jobs_dirty = TRUE;
 
 	/* update sample rates now that we know the input */
 	recompute_sample_rate_data(stream->device->machine, stream);
 }
 
 
+/*-------------------------------------------------
+    stream_set_threadsafe - declare whether a
+    stream's callback touches only state owned by
+    its own device, so that it can be updated on
+    another thread alongside other devices, and
+    whether it does enough work to justify it
+-------------------------------------------------*/
+
+void stream_set_threadsafe(sound_stream *stream, int threadsafe)
+{
+	stream->threadsafe = threadsafe;
+	stream->device->machine->streams_data->jobs_dirty = TRUE;
+}
+
+
 /*-------------------------------------------------
     stream_update - force a stream to update to
     the current emulated time
@@ -1008,3 +1085,137 @@ static stream_sample_t *generate_resampled_data(stream_input *input, UINT32 nums
 
 	return input->resample;
 }
+
+
+
+/***************************************************************************
+    PARALLEL UPDATE
+***************************************************************************/
+
+/*-------------------------------------------------
+    rebuild_leaf_jobs - regroup all streams with
+    no connected inputs into one job per device
+-------------------------------------------------*/
+
+static void rebuild_leaf_jobs(running_machine *machine)
+{
+	streams_private *strdata = machine->streams_data;
+	sound_stream *stream;
+	int jobnum;
+
+	/* make sure the job list can hold one entry per stream */
+	if (strdata->job_alloc < strdata->stream_index)
+	{
+		auto_free(machine, strdata->job_list);
+		strdata->job_alloc = strdata->stream_index;
+		strdata->job_list = auto_alloc_array(machine, sound_stream *, strdata->job_alloc);
+	}
+	strdata->job_count = 0;
+	strdata->heavy_jobs = 0;
+
+	/* iterate over all the streams */
+	for (stream = strdata->stream_head; stream != NULL; stream = stream->next)
+	{
+		sound_stream **tailptr = NULL;
+		int inputnum;
+
+		/* skip anything that hasn't declared itself safe to run on another thread */
+		stream->job_next = NULL;
+		if (stream->threadsafe == STREAM_SERIAL)
+			continue;
+
+		/* skip anything which depends on another stream */
+		for (inputnum = 0; inputnum < stream->inputs; inputnum++)
+			if (stream->input[inputnum].source != NULL)
+				break;
+		if (inputnum < stream->inputs)
+			continue;
+
+		/* find the job for this device, if there is one */
+		for (jobnum = 0; jobnum < strdata->job_count; jobnum++)
+			if (strdata->job_list[jobnum]->device == stream->device)
+			{
+				for (tailptr = &strdata->job_list[jobnum]->job_next; *tailptr != NULL; tailptr = &(*tailptr)->job_next) ;
+				break;
+			}
+
+		/* append to the existing job or start a new one */
+		if (tailptr != NULL)
+			*tailptr = stream;
+		else
+			strdata->job_list[strdata->job_count++] = stream;
+	}
+
+	/* count the jobs with at least one heavy stream */
+	for (jobnum = 0; jobnum < strdata->job_count; jobnum++)
+	{
+		sound_stream *stream;
+
+		for (stream = strdata->job_list[jobnum]; stream != NULL; stream = stream->job_next)
+			if (stream->threadsafe == STREAM_THREADSAFE_HEAVY)
+			{
+				strdata->heavy_jobs++;
+				break;
+			}
+	}
+	strdata->jobs_dirty = FALSE;
+}
+
+
+/*-------------------------------------------------
+    update_leaf_streams - generate samples for all
+    leaf streams in parallel, if there are enough
+    heavy ones to make it worthwhile
+-------------------------------------------------*/
+
+static void update_leaf_streams(running_machine *machine, attotime curtime)
+{
+	streams_private *strdata = machine->streams_data;
+	int jobnum;
+
+	/* regroup if the stream graph has changed */
+	if (strdata->jobs_dirty)
+		rebuild_leaf_jobs(machine);
+
+	/* a lone heavy job gains nothing from a thread; let the serial walk do it */
+	if (strdata->heavy_jobs < PARALLEL_MIN_HEAVY_JOBS)
+		return;
+
+	/* compute the target position for each leaf */
+	for (jobnum = 0; jobnum < strdata->job_count; jobnum++)
+	{
+		sound_stream *stream;
+
+		for (stream = strdata->job_list[jobnum]; stream != NULL; stream = stream->job_next)
+		{
+			stream->job_sampindex = time_to_sampindex(strdata, stream, curtime);
+			assert(stream->output_sampindex - stream->output_base_sampindex >= 0);
+			assert(stream->job_sampindex - stream->output_base_sampindex <= stream->output_bufalloc);
+		}
+	}
+
+	/* fire a work item for each job and wait for them all */
+	profiler_mark_start(PROFILER_SOUND);
+	osd_work_item_queue_multiple(strdata->work_queue, leaf_job_callback, strdata->job_count, strdata->job_list, sizeof(strdata->job_list[0]), WORK_ITEM_FLAG_AUTO_RELEASE);
+	osd_work_queue_wait(strdata->work_queue, osd_ticks_per_second() * 10);
+	profiler_mark_end();
+}
+
+
+/*-------------------------------------------------
+    leaf_job_callback - work item callback which
+    updates all the leaf streams of one device
+-------------------------------------------------*/
+
+static void *leaf_job_callback(void *param, int threadid)
+{
+	sound_stream *stream;
+
+	/* update each stream in creation order; nothing here touches the profiler */
+	for (stream = *(sound_stream **)param; stream != NULL; stream = stream->job_next)
+	{
+		generate_samples(stream, stream->job_sampindex - stream->output_sampindex);
+		stream->output_sampindex = stream->job_sampindex;
+	}
+	return NULL;
+}
@@ -21,6 +21,14 @@
 #define STREAMS_UPDATE_FREQUENCY	(50)
 #define STREAMS_UPDATE_ATTOTIME		ATTOTIME_IN_HZ(STREAMS_UPDATE_FREQUENCY)
 
+/* values for stream_set_threadsafe */
+enum
+{
+	STREAM_SERIAL = 0,					/* callback must run on the main thread (default) */
+	STREAM_THREADSAFE_LIGHT,			/* reentrant, but too cheap to be worth a thread by itself */
+	STREAM_THREADSAFE_HEAVY				/* reentrant multi-voice FM/PCM synthesis */
+};
+
 
 
 /***************************************************************************
@@ -64,6 +72,9 @@ int stream_device_input_to_stream_input(device_t *device, int inputnum, sound_st
 /* configure a stream's input */
 void stream_set_input(sound_stream *stream, int index, sound_stream *input_stream, int output_index, float gain);
 
+/* declare that a stream's callback only touches its own device's state, and how costly it is */
+void stream_set_threadsafe(sound_stream *stream, int threadsafe);
+
 /* force a stream to update to the current emulated time */
 void stream_update(sound_stream *stream);
 
@@ -12,6 +12,10 @@
 #include "emu.h"
 #include "profiler.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 
 /***************************************************************************
     CONSTANTS
@@ -26,6 +30,16 @@
 /* maximum index in each array */
 #define MAX_PEN_TO_FLAGS				256
 
+/* number of run lists cached for each row of tiles; enough for two
+   layers drawn across a horizontal wrap */
+#define TILE_RUN_SLOTS					4
+
+/* key of a run list that needs rebuilding */
+#define TILE_RUN_INVALID				((UINT32)~0)
+
+/* scanline span where every pixel is drawn */
+#define SPAN_OPAQUE						((UINT32)~0)
+
 
 /***************************************************************************
     TYPE DEFINITIONS
@@ -49,6 +63,28 @@ typedef void (*blitmask_func)(void *dest, const UINT16 *source, const UINT8 *mas
 typedef void (*blitopaque_func)(void *dest, const UINT16 *source, int count, const pen_t *pens, UINT8 *pri, UINT32 pcode, UINT8 alpha);
 
 
+/* a run of adjacent tiles in one row that draw the same way */
+typedef struct _tile_run tile_run;
+struct _tile_run
+{
+	UINT16				startcol;			/* first column of the run */
+	UINT16				endcol;				/* column after the end of the run */
+	UINT8				trans;				/* WHOLLY_OPAQUE or MASKED */
+};
+
+
+/* cached run lists for one row of tiles */
+typedef struct _tile_run_cache tile_run_cache;
+struct _tile_run_cache
+{
+	UINT32				key[TILE_RUN_SLOTS];	/* mask/value each list was built for */
+	UINT16				startcol[TILE_RUN_SLOTS];	/* first column each list covers */
+	UINT16				endcol[TILE_RUN_SLOTS];	/* column after the last one each list covers */
+	UINT16				count[TILE_RUN_SLOTS];	/* number of runs in each list */
+	UINT8				lastslot;			/* most recently used slot */
+};
+
+
 /* blitting parameters for rendering */
 typedef struct _blit_parameters blit_parameters;
 struct _blit_parameters
@@ -118,6 +154,10 @@ struct _tilemap_t
 	bitmap_t *					flagsmap;			/* per-pixel flags */
 	UINT8 *						tileflags;			/* per-tile flags */
 	UINT8 *						pen_to_flags;		/* mapping of pens to flags */
+
+	/* cached transparency runs */
+	tile_run_cache *			runcache;			/* per-row run list state */
+	tile_run *					runs;				/* run lists, TILE_RUN_SLOTS per row */
 };
 
 
@@ -147,6 +187,7 @@ static void mappings_update(tilemap_t *tmap);
 /* tile rendering */
 static void pixmap_update(tilemap_t *tmap, const rectangle *cliprect);
 static void tile_update(tilemap_t *tmap, tilemap_logical_index logindex, UINT32 cached_col, UINT32 cached_row);
+static const tile_run *tile_row_runs(tilemap_t *tmap, UINT32 row, UINT32 startcol, UINT32 endcol, UINT8 mask, UINT8 value, int *count);
 static UINT8 tile_draw(tilemap_t *tmap, const UINT8 *pendata, UINT32 x0, UINT32 y0, UINT32 palette_base, UINT8 category, UINT8 group, UINT8 flags, UINT8 pen_mask);
 static UINT8 tile_apply_bitmask(tilemap_t *tmap, const UINT8 *maskdata, UINT32 x0, UINT32 y0, UINT8 category, UINT8 flags);
 
@@ -276,6 +317,37 @@ INLINE int gfx_elements_changed(tilemap_t *tmap)
 }
 
 
+/*-------------------------------------------------
+    invalidate_row_runs - throw away the cached
+    run lists for a row of tiles
+-------------------------------------------------*/
+
+INLINE void invalidate_row_runs(tilemap_t *tmap, UINT32 row)
+{
+	tile_run_cache *cache = &tmap->runcache[row];
+	int slot;
+
+	for (slot = 0; slot < TILE_RUN_SLOTS; slot++)
+		cache->key[slot] = TILE_RUN_INVALID;
+}
+
+
+/*-------------------------------------------------
+    mark_tileflags_dirty - mark every tile as
+    needing an update, along with all the cached
+    run lists
+-------------------------------------------------*/
+
+INLINE void mark_tileflags_dirty(tilemap_t *tmap)
+{
+	UINT32 row;
+
+	memset(tmap->tileflags, TILE_FLAG_DIRTY, tmap->max_logical_index);
+	for (row = 0; row < tmap->rows; row++)
+		invalidate_row_runs(tmap, row);
+}
+
+
 /***************************************************************************
     SYSTEM-WIDE MANAGEMENT
 ***************************************************************************/
@@ -388,6 +460,9 @@ static tilemap_t *tilemap_create_common(running_machine *machine, void *get_info
 	tmap->tileflags = auto_alloc_array(machine, UINT8, tmap->max_logical_index);
 	tmap->flagsmap = auto_bitmap_alloc(machine, tmap->width, tmap->height, BITMAP_FORMAT_INDEXED8);
 	tmap->pen_to_flags = auto_alloc_array_clear(machine, UINT8, MAX_PEN_TO_FLAGS * TILEMAP_NUM_GROUPS);
+	tmap->runcache = auto_alloc_array_clear(machine, tile_run_cache, rows);
+	tmap->runs = auto_alloc_array(machine, tile_run, rows * TILE_RUN_SLOTS * cols);
+	mark_tileflags_dirty(tmap);
 	for (group = 0; group < TILEMAP_NUM_GROUPS; group++)
 		tilemap_map_pens_to_layer(tmap, group, 0, 0, TILEMAP_PIXEL_LAYER0);
 
@@ -516,6 +591,7 @@ void tilemap_mark_tile_dirty(tilemap_t *tmap, tilemap_memory_index memindex)
 		{
 			tmap->tileflags[logindex] = TILE_FLAG_DIRTY;
 			tmap->all_tiles_clean = FALSE;
+			invalidate_row_runs(tmap, logindex / tmap->cols);
 		}
 	}
 }
@@ -831,7 +907,7 @@ profiler_mark_start(PROFILER_TILEMAP_DRAW);
 	/* if the whole map is dirty, mark it as such */
 	if (tmap->all_tiles_dirty || gfx_elements_changed(tmap))
 	{
-		memset(tmap->tileflags, TILE_FLAG_DIRTY, tmap->max_logical_index);
+		mark_tileflags_dirty(tmap);
 		tmap->all_tiles_dirty = FALSE;
 		tmap->gfx_used = 0;
 	}
@@ -1034,7 +1110,7 @@ void tilemap_draw_by_index(running_machine *machine, bitmap_t *dest, int number,
 	/* if the whole map is dirty, mark it as such */
 	if (tmap->all_tiles_dirty || gfx_elements_changed(tmap))
 	{
-		memset(tmap->tileflags, TILE_FLAG_DIRTY, tmap->max_logical_index);
+		mark_tileflags_dirty(tmap);
 		tmap->all_tiles_dirty = FALSE;
 		tmap->gfx_used = 0;
 	}
@@ -1164,6 +1240,8 @@ static void tilemap_dispose(tilemap_t *tmap)
 		}
 
 	/* free allocated memory */
+	auto_free(tmap->machine, tmap->runs);
+	auto_free(tmap->machine, tmap->runcache);
 	auto_free(tmap->machine, tmap->pen_to_flags);
 	auto_free(tmap->machine, tmap->tileflags);
 	auto_free(tmap->machine, tmap->flagsmap);
@@ -1294,7 +1372,7 @@ profiler_mark_start(PROFILER_TILEMAP_DRAW);
 	/* if the whole map is dirty, mark it as such */
 	if (tmap->all_tiles_dirty)
 	{
-		memset(tmap->tileflags, TILE_FLAG_DIRTY, tmap->max_logical_index);
+		mark_tileflags_dirty(tmap);
 		tmap->all_tiles_dirty = FALSE;
 		tmap->gfx_used = 0;
 	}
@@ -1346,6 +1424,9 @@ profiler_mark_start(PROFILER_TILEMAP_UPDATE);
 	if ((flags & (TILE_FORCE_LAYER0 | TILE_FORCE_LAYER1 | TILE_FORCE_LAYER2)) == 0 && tmap->tileinfo.mask_data != NULL)
 		tmap->tileflags[logindex] = tile_apply_bitmask(tmap, tmap->tileinfo.mask_data, x0, y0, tmap->tileinfo.category, flags);
 
+	/* the row's run lists no longer describe it */
+	invalidate_row_runs(tmap, row);
+
 	/* track which gfx have been used for this tilemap */
 	if (tmap->tileinfo.gfxnum != 0xff && (tmap->gfx_used & (1 << tmap->tileinfo.gfxnum)) == 0)
 	{
@@ -1510,6 +1591,82 @@ static UINT8 tile_apply_bitmask(tilemap_t *tmap, const UINT8 *maskdata, UINT32 x
 }
 
 
+/*-------------------------------------------------
+    tile_row_runs - return the runs of opaque and
+    masked tiles between startcol and endcol in a
+    row for the given mask and value, building the
+    list if the row has changed since it was last
+    asked for; only the tiles in that range are
+    brought up to date
+-------------------------------------------------*/
+
+static const tile_run *tile_row_runs(tilemap_t *tmap, UINT32 row, UINT32 startcol, UINT32 endcol, UINT8 mask, UINT8 value, int *count)
+{
+	tile_run_cache *cache = &tmap->runcache[row];
+	tilemap_logical_index logindex = row * tmap->cols;
+	const UINT8 *flagsrow = BITMAP_ADDR8(tmap->flagsmap, row * tmap->tileheight, 0);
+	trans_t prev_trans = WHOLLY_TRANSPARENT;
+	UINT32 key = (mask << 8) | value;
+	tile_run *runs;
+	int numruns = 0;
+	UINT32 col;
+	int slot;
+
+	/* if we have a list for this mask and value covering the range, use it */
+	for (slot = 0; slot < TILE_RUN_SLOTS; slot++)
+		if (cache->key[slot] == key && cache->startcol[slot] <= startcol && cache->endcol[slot] >= endcol)
+		{
+			cache->lastslot = slot;
+			*count = cache->count[slot];
+			return &tmap->runs[(row * TILE_RUN_SLOTS + slot) * tmap->cols];
+		}
+
+	/* bring the range up to date; this invalidates all the row's lists */
+	for (col = startcol; col < endcol; col++)
+		if (tmap->tileflags[logindex + col] == TILE_FLAG_DIRTY)
+			tile_update(tmap, logindex + col, col, row);
+
+	/* rebuild the slot after the one used most recently */
+	slot = (cache->lastslot + 1) % TILE_RUN_SLOTS;
+	runs = &tmap->runs[(row * TILE_RUN_SLOTS + slot) * tmap->cols];
+	for (col = startcol; col < endcol; col++)
+	{
+		trans_t cur_trans;
+
+		/* if the summary data is non-zero, we must draw masked */
+		if ((tmap->tileflags[logindex + col] & mask) != 0)
+			cur_trans = MASKED;
+
+		/* otherwise, our transparency state is constant across the tile; fetch it */
+		else
+			cur_trans = ((flagsrow[col * tmap->tilewidth] & mask) == value) ? WHOLLY_OPAQUE : WHOLLY_TRANSPARENT;
+
+		/* extend the current run, or start a new one */
+		if (cur_trans != WHOLLY_TRANSPARENT)
+		{
+			if (cur_trans == prev_trans)
+				runs[numruns - 1].endcol = col + 1;
+			else
+			{
+				runs[numruns].startcol = col;
+				runs[numruns].endcol = col + 1;
+				runs[numruns].trans = cur_trans;
+				numruns++;
+			}
+		}
+		prev_trans = cur_trans;
+	}
+
+	cache->key[slot] = key;
+	cache->startcol[slot] = startcol;
+	cache->endcol[slot] = endcol;
+	cache->count[slot] = numruns;
+	cache->lastslot = slot;
+	*count = numruns;
+	return runs;
+}
+
+
 
 /***************************************************************************
     DRAWING HELPERS
@@ -1623,8 +1780,8 @@ static void tilemap_draw_instance(tilemap_t *tmap, const blit_parameters *blit,
 	UINT8 *priority_baseaddr;
 	int dest_line_pitch_bytes = 0;
 	int dest_bytespp = 0;
-	int mincol, maxcol;
 	int x1, y1, x2, y2;
+	int startcol, endcol;
 	int y, nexty;
 
 	/* clip destination coordinates to the tilemap */
@@ -1657,9 +1814,9 @@ static void tilemap_draw_instance(tilemap_t *tmap, const blit_parameters *blit,
 	source_baseaddr = BITMAP_ADDR16(tmap->pixmap, y1, 0);
 	mask_baseaddr = BITMAP_ADDR8(tmap->flagsmap, y1, 0);
 
-	/* get start/stop columns, rounding outward */
-	mincol = x1 / tmap->tilewidth;
-	maxcol = (x2 + tmap->tilewidth - 1) / tmap->tilewidth;
+	/* only the columns we actually touch need to be up to date */
+	startcol = x1 / tmap->tilewidth;
+	endcol = (x2 + tmap->tilewidth - 1) / tmap->tilewidth;
 
 	/* set up row counter */
 	y = y1;
@@ -1670,87 +1827,60 @@ static void tilemap_draw_instance(tilemap_t *tmap, const blit_parameters *blit,
 	for (;;)
 	{
 		int row = y / tmap->tileheight;
-		trans_t prev_trans = WHOLLY_TRANSPARENT;
-		trans_t cur_trans;
-		int x_start = x1;
-		int column;
-
-		/* iterate across the applicable tilemap columns */
-		for (column = mincol; column <= maxcol; column++)
-		{
-			int x_end;
-
-			/* we don't actually render the last column; it is always just used for flushing */
-			if (column == maxcol)
-				cur_trans = WHOLLY_TRANSPARENT;
-
-			/* for other columns we look up the transparency information */
-			else
-			{
-				tilemap_logical_index logindex = row * tmap->cols + column;
-
-				/* if the current tile is dirty, fix it */
-				if (tmap->tileflags[logindex] == TILE_FLAG_DIRTY)
-					tile_update(tmap, logindex, column, row);
+		const tile_run *run;
+		int runnum, numruns;
 
-				/* if the current summary data is non-zero, we must draw masked */
-				if ((tmap->tileflags[logindex] & blit->mask) != 0)
-					cur_trans = MASKED;
+		/* fetch the runs of opaque and masked tiles in this row */
+		run = tile_row_runs(tmap, row, startcol, endcol, blit->mask, blit->value, &numruns);
 
-				/* otherwise, our transparency state is constant across the tile; fetch it */
-				else
-					cur_trans = ((mask_baseaddr[column * tmap->tilewidth] & blit->mask) == blit->value) ? WHOLLY_OPAQUE : WHOLLY_TRANSPARENT;
-			}
-
-			/* if the transparency state is the same as last time, don't render yet */
-			if (cur_trans == prev_trans)
+		/* iterate over the runs, which are in column order */
+		for (runnum = 0; runnum < numruns; runnum++, run++)
+		{
+			int x_start = MAX((int)(run->startcol * tmap->tilewidth), x1);
+			int x_end = MIN((int)(run->endcol * tmap->tilewidth), x2);
+			const UINT16 *source0;
+			void *dest0;
+			UINT8 *pmap0;
+			int cury;
+
+			/* skip runs to the left of the clip, and stop once we pass the right */
+			if (x_start >= x2)
+				break;
+			if (x_start >= x_end)
 				continue;
 
-			/* compute the end of this run, in pixels */
-			x_end = column * tmap->tilewidth;
-			x_end = MAX(x_end, x1);
-			x_end = MIN(x_end, x2);
+			/* compute the pointers */
+			source0 = source_baseaddr + x_start;
+			dest0 = (UINT8 *)dest_baseaddr + x_start * dest_bytespp;
+			pmap0 = priority_baseaddr + x_start;
 
-			/* if we're rendering something, compute the pointers */
-			if (prev_trans != WHOLLY_TRANSPARENT)
+			/* if we're opaque, use the opaque renderer */
+			if (run->trans == WHOLLY_OPAQUE)
 			{
-				const UINT16 *source0 = source_baseaddr + x_start;
-				void *dest0 = (UINT8 *)dest_baseaddr + x_start * dest_bytespp;
-				UINT8 *pmap0 = priority_baseaddr + x_start;
-				int cury;
-
-				/* if we were opaque, use the opaque renderer */
-				if (prev_trans == WHOLLY_OPAQUE)
+				for (cury = y; cury < nexty; cury++)
 				{
-					for (cury = y; cury < nexty; cury++)
-					{
-						(*blit->draw_opaque)(dest0, source0, x_end - x_start, tmap->machine->pens, pmap0, blit->tilemap_priority_code, blit->alpha);
+					(*blit->draw_opaque)(dest0, source0, x_end - x_start, tmap->machine->pens, pmap0, blit->tilemap_priority_code, blit->alpha);
 
-						dest0 = (UINT8 *)dest0 + dest_line_pitch_bytes;
-						source0 += tmap->pixmap->rowpixels;
-						pmap0 += priority_bitmap->rowpixels;
-					}
+					dest0 = (UINT8 *)dest0 + dest_line_pitch_bytes;
+					source0 += tmap->pixmap->rowpixels;
+					pmap0 += priority_bitmap->rowpixels;
 				}
+			}
 
-				/* otherwise use the masked renderer */
-				else
+			/* otherwise use the masked renderer */
+			else
+			{
+				const UINT8 *mask0 = mask_baseaddr + x_start;
+				for (cury = y; cury < nexty; cury++)
 				{
-					const UINT8 *mask0 = mask_baseaddr + x_start;
-					for (cury = y; cury < nexty; cury++)
-					{
-						(*blit->draw_masked)(dest0, source0, mask0, blit->mask, blit->value, x_end - x_start, tmap->machine->pens, pmap0, blit->tilemap_priority_code, blit->alpha);
+					(*blit->draw_masked)(dest0, source0, mask0, blit->mask, blit->value, x_end - x_start, tmap->machine->pens, pmap0, blit->tilemap_priority_code, blit->alpha);
 
-						dest0 = (UINT8 *)dest0 + dest_line_pitch_bytes;
-						source0 += tmap->pixmap->rowpixels;
-						mask0 += tmap->flagsmap->rowpixels;
-						pmap0 += priority_bitmap->rowpixels;
-					}
+					dest0 = (UINT8 *)dest0 + dest_line_pitch_bytes;
+					source0 += tmap->pixmap->rowpixels;
+					mask0 += tmap->flagsmap->rowpixels;
+					pmap0 += priority_bitmap->rowpixels;
 				}
 			}
-
-			/* the new start is the end */
-			x_start = x_end;
-			prev_trans = cur_trans;
 		}
 
 		/* if this was the last row, stop */
@@ -1973,6 +2103,106 @@ static void tilemap_draw_roz_core(tilemap_t *tmap, const blit_parameters *blit,
     SCANLINE RASTERIZERS
 ***************************************************************************/
 
+/*-------------------------------------------------
+    scanline_block_bits - return a bitmask of the
+    pixels in a block of up to 16 whose flags
+    match the mask and value
+-------------------------------------------------*/
+
+INLINE UINT32 scanline_block_bits(const UINT8 *maskptr, int mask, int value, int count)
+{
+	UINT32 bits = 0;
+	int i;
+
+#ifdef __SSE2__
+	/* full blocks are tested all at once */
+	if (count == 16)
+	{
+		__m128i flags = _mm_and_si128(_mm_loadu_si128((const __m128i *)maskptr), _mm_set1_epi8(mask));
+		return _mm_movemask_epi8(_mm_cmpeq_epi8(flags, _mm_set1_epi8(value)));
+	}
+#endif
+
+	for (i = 0; i < count; i++)
+		if ((maskptr[i] & mask) == value)
+			bits |= 1 << i;
+	return bits;
+}
+
+
+/*-------------------------------------------------
+    scanline_next_span - find the next pixels to
+    draw at or after *start, working in blocks of
+    16; returns 0 if there are none, SPAN_OPAQUE
+    if every pixel from *start to *end is drawn,
+    or else a bitmask of the pixels to draw in the
+    block at *start
+-------------------------------------------------*/
+
+INLINE UINT32 scanline_next_span(const UINT8 *maskptr, int mask, int value, int count, int *start, int *end)
+{
+	int i = *start;
+	UINT32 bits = 0;
+	int width = 0;
+
+	/* skip blocks with nothing to draw */
+	for ( ; i < count; i += 16)
+	{
+		width = MIN(count - i, 16);
+		bits = scanline_block_bits(&maskptr[i], mask, value, width);
+		if (bits != 0)
+			break;
+	}
+	if (i >= count)
+		return 0;
+	*start = i;
+
+	/* a block with holes is drawn on its own */
+	if (bits != (1 << width) - 1)
+	{
+		*end = i + width;
+		return bits;
+	}
+
+	/* otherwise take all the full blocks that follow it */
+	for (i += width; i < count; i += width)
+	{
+		width = MIN(count - i, 16);
+		if (scanline_block_bits(&maskptr[i], mask, value, width) != (1 << width) - 1)
+			break;
+	}
+	*end = i;
+	return SPAN_OPAQUE;
+}
+
+
+/*-------------------------------------------------
+    scanline_priority - apply the priority code
+    to a run of the priority bitmap
+-------------------------------------------------*/
+
+INLINE void scanline_priority(UINT8 *pri, int count, UINT32 pcode)
+{
+	int i = 0;
+
+#ifdef __SSE2__
+	const __m128i andvec = _mm_set1_epi8(pcode >> 8);
+	const __m128i orvec = _mm_set1_epi8(pcode);
+
+	/* 16 pixels at a time */
+	for ( ; i + 16 <= count; i += 16)
+	{
+		__m128i prival = _mm_loadu_si128((const __m128i *)&pri[i]);
+		_mm_storeu_si128((__m128i *)&pri[i], _mm_or_si128(_mm_and_si128(prival, andvec), orvec));
+	}
+#endif
+
+	/* then the rest */
+	for ( ; i < count; i++)
+		pri[i] = (pri[i] & (pcode >> 8)) | pcode;
+}
+
+
 /*-------------------------------------------------
     scanline_draw_opaque_null - draw to a NULL
     bitmap, setting priority only
@@ -1980,14 +2210,9 @@ static void tilemap_draw_roz_core(tilemap_t *tmap, const blit_parameters *blit,
 
 static void scanline_draw_opaque_null(void *dest, const UINT16 *source, int count, const pen_t *pens, UINT8 *pri, UINT32 pcode, UINT8 alpha)
 {
-	int i;
-
 	/* skip entirely if not changing priority */
 	if (pcode != 0xff00)
-	{
-		for (i = 0; i < count; i++)
-			pri[i] = (pri[i] & (pcode >> 8)) | pcode;
-	}
+		scanline_priority(pri, count, pcode);
 }
 
 
@@ -1998,14 +2223,24 @@ static void scanline_draw_opaque_null(void *dest, const UINT16 *source, int coun
 
 static void scanline_draw_masked_null(void *dest, const UINT16 *source, const UINT8 *maskptr, int mask, int value, int count, const pen_t *pens, UINT8 *pri, UINT32 pcode, UINT8 alpha)
 {
-	int i;
+	UINT32 bits;
+	int start, end, i;
 
 	/* skip entirely if not changing priority */
 	if (pcode != 0xff00)
 	{
-		for (i = 0; i < count; i++)
-			if ((maskptr[i] & mask) == value)
-				pri[i] = (pri[i] & (pcode >> 8)) | pcode;
+		for (start = 0; (bits = scanline_next_span(maskptr, mask, value, count, &start, &end)) != 0; start = end)
+		{
+			/* spans where every pixel matches are handled like opaque ones */
+			if (bits == SPAN_OPAQUE)
+				scanline_priority(&pri[start], end - start, pcode);
+			else
+			{
+				for (i = start; i < end; i++, bits >>= 1)
+					if (bits & 1)
+						pri[i] = (pri[i] & (pcode >> 8)) | pcode;
+			}
+		}
 	}
 }
 
@@ -2020,37 +2255,29 @@ static void scanline_draw_opaque_ind16(void *_dest, const UINT16 *source, int co
 {
 	UINT16 *dest = (UINT16 *)_dest;
 	int pal = pcode >> 16;
-	int i;
+	int i = 0;
 
 	/* special case for no palette offset */
 	if (pal == 0)
-	{
 		memcpy(dest, source, count * 2);
 
-		/* priority if necessary */
-		if (pcode != 0xff00)
-		{
-			for (i = 0; i < count; i++)
-				pri[i] = (pri[i] & (pcode >> 8)) | pcode;
-		}
-	}
-
-	/* priority case */
-	else if ((pcode & 0xffff) != 0xff00)
-	{
-		for (i = 0; i < count; i++)
-		{
-			dest[i] = source[i] + pal;
-			pri[i] = (pri[i] & (pcode >> 8)) | pcode;
-		}
-	}
-
-	/* no priority case */
+	/* otherwise add the offset */
 	else
 	{
-		for (i = 0; i < count; i++)
+#ifdef __SSE2__
+		const __m128i palvec = _mm_set1_epi16(pal);
+
+		/* 8 pixels at a time */
+		for ( ; i + 8 <= count; i += 8)
+			_mm_storeu_si128((__m128i *)&dest[i], _mm_add_epi16(_mm_loadu_si128((const __m128i *)&source[i]), palvec));
+#endif
+		for ( ; i < count; i++)
 			dest[i] = source[i] + pal;
 	}
+
+	/* priority if necessary */
+	if ((pcode & 0xffff) != 0xff00)
+		scanline_priority(pri, count, pcode);
 }
 
 
@@ -2061,27 +2288,35 @@ static void scanline_draw_opaque_ind16(void *_dest, const UINT16 *source, int co
 
 static void scanline_draw_masked_ind16(void *_dest, const UINT16 *source, const UINT8 *maskptr, int mask, int value, int count, const pen_t *pens, UINT8 *pri, UINT32 pcode, UINT8 alpha)
 {
-	UINT16 *dest = (UINT16 *)_dest;
 	int pal = pcode >> 16;
-	int i;
+	UINT16 *dest = (UINT16 *)_dest;
+	UINT32 bits;
+	int start, end, i;
 
-	/* priority case */
-	if ((pcode & 0xffff) != 0xff00)
+	for (start = 0; (bits = scanline_next_span(maskptr, mask, value, count, &start, &end)) != 0; start = end)
 	{
-		for (i = 0; i < count; i++)
-			if ((maskptr[i] & mask) == value)
-			{
-				dest[i] = source[i] + pal;
-				pri[i] = (pri[i] & (pcode >> 8)) | pcode;
-			}
-	}
+		/* spans where every pixel matches are drawn like opaque ones */
+		if (bits == SPAN_OPAQUE)
+			scanline_draw_opaque_ind16(&dest[start], &source[start], end - start, pens, &pri[start], pcode, alpha);
 
-	/* no priority case */
-	else
-	{
-		for (i = 0; i < count; i++)
-			if ((maskptr[i] & mask) == value)
-				dest[i] = source[i] + pal;
+		/* priority case */
+		else if ((pcode & 0xffff) != 0xff00)
+		{
+			for (i = start; i < end; i++, bits >>= 1)
+				if (bits & 1)
+				{
+					dest[i] = source[i] + pal;
+					pri[i] = (pri[i] & (pcode >> 8)) | pcode;
+				}
+		}
+
+		/* no priority case */
+		else
+		{
+			for (i = start; i < end; i++, bits >>= 1)
+				if (bits & 1)
+					dest[i] = source[i] + pal;
+		}
 	}
 }
 
@@ -2098,22 +2333,12 @@ static void scanline_draw_opaque_rgb16(void *_dest, const UINT16 *source, int co
 	UINT16 *dest = (UINT16 *)_dest;
 	int i;
 
-	/* priority case */
-	if ((pcode & 0xffff) != 0xff00)
-	{
-		for (i = 0; i < count; i++)
-		{
-			dest[i] = clut[source[i]];
-			pri[i] = (pri[i] & (pcode >> 8)) | pcode;
-		}
-	}
+	for (i = 0; i < count; i++)
+		dest[i] = clut[source[i]];
 
-	/* no priority case */
-	else
-	{
-		for (i = 0; i < count; i++)
-			dest[i] = clut[source[i]];
-	}
+	/* priority if necessary */
+	if ((pcode & 0xffff) != 0xff00)
+		scanline_priority(pri, count, pcode);
 }
 
 
@@ -2126,25 +2351,33 @@ static void scanline_draw_masked_rgb16(void *_dest, const UINT16 *source, const
 {
 	const pen_t *clut = &pens[pcode >> 16];
 	UINT16 *dest = (UINT16 *)_dest;
-	int i;
+	UINT32 bits;
+	int start, end, i;
 
-	/* priority case */
-	if ((pcode & 0xffff) != 0xff00)
+	for (start = 0; (bits = scanline_next_span(maskptr, mask, value, count, &start, &end)) != 0; start = end)
 	{
-		for (i = 0; i < count; i++)
-			if ((maskptr[i] & mask) == value)
-			{
-				dest[i] = clut[source[i]];
-				pri[i] = (pri[i] & (pcode >> 8)) | pcode;
-			}
-	}
+		/* spans where every pixel matches are drawn like opaque ones */
+		if (bits == SPAN_OPAQUE)
+			scanline_draw_opaque_rgb16(&dest[start], &source[start], end - start, pens, &pri[start], pcode, alpha);
 
-	/* no priority case */
-	else
-	{
-		for (i = 0; i < count; i++)
-			if ((maskptr[i] & mask) == value)
-				dest[i] = clut[source[i]];
+		/* priority case */
+		else if ((pcode & 0xffff) != 0xff00)
+		{
+			for (i = start; i < end; i++, bits >>= 1)
+				if (bits & 1)
+				{
+					dest[i] = clut[source[i]];
+					pri[i] = (pri[i] & (pcode >> 8)) | pcode;
+				}
+		}
+
+		/* no priority case */
+		else
+		{
+			for (i = start; i < end; i++, bits >>= 1)
+				if (bits & 1)
+					dest[i] = clut[source[i]];
+		}
 	}
 }
 
@@ -2160,22 +2393,12 @@ static void scanline_draw_opaque_rgb16_alpha(void *_dest, const UINT16 *source,
 	UINT16 *dest = (UINT16 *)_dest;
 	int i;
 
-	/* priority case */
-	if ((pcode & 0xffff) != 0xff00)
-	{
-		for (i = 0; i < count; i++)
-		{
-			dest[i] = alpha_blend_r16(dest[i], clut[source[i]], alpha);
-			pri[i] = (pri[i] & (pcode >> 8)) | pcode;
-		}
-	}
+	for (i = 0; i < count; i++)
+		dest[i] = alpha_blend_r16(dest[i], clut[source[i]], alpha);
 
-	/* no priority case */
-	else
-	{
-		for (i = 0; i < count; i++)
-			dest[i] = alpha_blend_r16(dest[i], clut[source[i]], alpha);
-	}
+	/* priority if necessary */
+	if ((pcode & 0xffff) != 0xff00)
+		scanline_priority(pri, count, pcode);
 }
 
 
@@ -2189,25 +2412,33 @@ static void scanline_draw_masked_rgb16_alpha(void *_dest, const UINT16 *source,
 {
 	const pen_t *clut = &pens[pcode >> 16];
 	UINT16 *dest = (UINT16 *)_dest;
-	int i;
+	UINT32 bits;
+	int start, end, i;
 
-	/* priority case */
-	if ((pcode & 0xffff) != 0xff00)
+	for (start = 0; (bits = scanline_next_span(maskptr, mask, value, count, &start, &end)) != 0; start = end)
 	{
-		for (i = 0; i < count; i++)
-			if ((maskptr[i] & mask) == value)
-			{
-				dest[i] = alpha_blend_r16(dest[i], clut[source[i]], alpha);
-				pri[i] = (pri[i] & (pcode >> 8)) | pcode;
-			}
-	}
+		/* spans where every pixel matches are drawn like opaque ones */
+		if (bits == SPAN_OPAQUE)
+			scanline_draw_opaque_rgb16_alpha(&dest[start], &source[start], end - start, pens, &pri[start], pcode, alpha);
 
-	/* no priority case */
-	else
-	{
-		for (i = 0; i < count; i++)
-			if ((maskptr[i] & mask) == value)
-				dest[i] = alpha_blend_r16(dest[i], clut[source[i]], alpha);
+		/* priority case */
+		else if ((pcode & 0xffff) != 0xff00)
+		{
+			for (i = start; i < end; i++, bits >>= 1)
+				if (bits & 1)
+				{
+					dest[i] = alpha_blend_r16(dest[i], clut[source[i]], alpha);
+					pri[i] = (pri[i] & (pcode >> 8)) | pcode;
+				}
+		}
+
+		/* no priority case */
+		else
+		{
+			for (i = start; i < end; i++, bits >>= 1)
+				if (bits & 1)
+					dest[i] = alpha_blend_r16(dest[i], clut[source[i]], alpha);
+		}
 	}
 }
 
@@ -2223,22 +2454,12 @@ static void scanline_draw_opaque_rgb32(void *_dest, const UINT16 *source, int co
 	UINT32 *dest = (UINT32 *)_dest;
 	int i;
 
-	/* priority case */
-	if ((pcode & 0xffff) != 0xff00)
-	{
-		for (i = 0; i < count; i++)
-		{
-			dest[i] = clut[source[i]];
-			pri[i] = (pri[i] & (pcode >> 8)) | pcode;
-		}
-	}
+	for (i = 0; i < count; i++)
+		dest[i] = clut[source[i]];
 
-	/* no priority case */
-	else
-	{
-		for (i = 0; i < count; i++)
-			dest[i] = clut[source[i]];
-	}
+	/* priority if necessary */
+	if ((pcode & 0xffff) != 0xff00)
+		scanline_priority(pri, count, pcode);
 }
 
 
@@ -2251,25 +2472,33 @@ static void scanline_draw_masked_rgb32(void *_dest, const UINT16 *source, const
 {
 	const pen_t *clut = &pens[pcode >> 16];
 	UINT32 *dest = (UINT32 *)_dest;
-	int i;
+	UINT32 bits;
+	int start, end, i;
 
-	/* priority case */
-	if ((pcode & 0xffff) != 0xff00)
+	for (start = 0; (bits = scanline_next_span(maskptr, mask, value, count, &start, &end)) != 0; start = end)
 	{
-		for (i = 0; i < count; i++)
-			if ((maskptr[i] & mask) == value)
-			{
-				dest[i] = clut[source[i]];
-				pri[i] = (pri[i] & (pcode >> 8)) | pcode;
-			}
-	}
+		/* spans where every pixel matches are drawn like opaque ones */
+		if (bits == SPAN_OPAQUE)
+			scanline_draw_opaque_rgb32(&dest[start], &source[start], end - start, pens, &pri[start], pcode, alpha);
 
-	/* no priority case */
-	else
-	{
-		for (i = 0; i < count; i++)
-			if ((maskptr[i] & mask) == value)
-				dest[i] = clut[source[i]];
+		/* priority case */
+		else if ((pcode & 0xffff) != 0xff00)
+		{
+			for (i = start; i < end; i++, bits >>= 1)
+				if (bits & 1)
+				{
+					dest[i] = clut[source[i]];
+					pri[i] = (pri[i] & (pcode >> 8)) | pcode;
+				}
+		}
+
+		/* no priority case */
+		else
+		{
+			for (i = start; i < end; i++, bits >>= 1)
+				if (bits & 1)
+					dest[i] = clut[source[i]];
+		}
 	}
 }
 
@@ -2285,22 +2514,12 @@ static void scanline_draw_opaque_rgb32_alpha(void *_dest, const UINT16 *source,
 	UINT32 *dest = (UINT32 *)_dest;
 	int i;
 
-	/* priority case */
-	if ((pcode & 0xffff) != 0xff00)
-	{
-		for (i = 0; i < count; i++)
-		{
-			dest[i] = alpha_blend_r32(dest[i], clut[source[i]], alpha);
-			pri[i] = (pri[i] & (pcode >> 8)) | pcode;
-		}
-	}
+	for (i = 0; i < count; i++)
+		dest[i] = alpha_blend_r32(dest[i], clut[source[i]], alpha);
 
-	/* no priority case */
-	else
-	{
-		for (i = 0; i < count; i++)
-			dest[i] = alpha_blend_r32(dest[i], clut[source[i]], alpha);
-	}
+	/* priority if necessary */
+	if ((pcode & 0xffff) != 0xff00)
+		scanline_priority(pri, count, pcode);
 }
 
 
@@ -2314,24 +2533,32 @@ static void scanline_draw_masked_rgb32_alpha(void *_dest, const UINT16 *source,
 {
 	const pen_t *clut = &pens[pcode >> 16];
 	UINT32 *dest = (UINT32 *)_dest;
-	int i;
+	UINT32 bits;
+	int start, end, i;
 
-	/* priority case */
-	if ((pcode & 0xffff) != 0xff00)
+	for (start = 0; (bits = scanline_next_span(maskptr, mask, value, count, &start, &end)) != 0; start = end)
 	{
-		for (i = 0; i < count; i++)
-			if ((maskptr[i] & mask) == value)
-			{
-				dest[i] = alpha_blend_r32(dest[i], clut[source[i]], alpha);
-				pri[i] = (pri[i] & (pcode >> 8)) | pcode;
-			}
-	}
+		/* spans where every pixel matches are drawn like opaque ones */
+		if (bits == SPAN_OPAQUE)
+			scanline_draw_opaque_rgb32_alpha(&dest[start], &source[start], end - start, pens, &pri[start], pcode, alpha);
 
-	/* no priority case */
-	else
-	{
-		for (i = 0; i < count; i++)
-			if ((maskptr[i] & mask) == value)
-				dest[i] = alpha_blend_r32(dest[i], clut[source[i]], alpha);
+		/* priority case */
+		else if ((pcode & 0xffff) != 0xff00)
+		{
+			for (i = start; i < end; i++, bits >>= 1)
+				if (bits & 1)
+				{
+					dest[i] = alpha_blend_r32(dest[i], clut[source[i]], alpha);
+					pri[i] = (pri[i] & (pcode >> 8)) | pcode;
+				}
+		}
+
+		/* no priority case */
+		else
+		{
+			for (i = start; i < end; i++, bits >>= 1)
+				if (bits & 1)
+					dest[i] = alpha_blend_r32(dest[i], clut[source[i]], alpha);
+		}
 	}
 }
@@ -43,6 +43,7 @@
 #include "png.h"
 #include "debugger.h"
 #include "debugint/debugint.h"
+#include "debug/debugsrv.h"
 #include "rendutil.h"
 #include "ui.h"
 #include "aviio.h"
@@ -112,6 +113,9 @@ struct _video_global
 	UINT8					frameskip_counter;		/* counter that counts through the frameskip steps */
 	INT8					frameskip_adjust;
 	UINT8					skipping_this_frame;	/* flag: TRUE if we are skipping the current frame */
+	UINT8					rendering;				/* flag: FALSE if we only draw frames someone asks for */
+	UINT8					render_requested;		/* flag: TRUE if the next frame must be drawn */
+	UINT8					screen_current;			/* flag: TRUE if the last finished frame was drawn */
 	osd_ticks_t				average_oversleep;		/* average number of ticks the OSD oversleeps */
 
 	/* snapshot stuff */
@@ -120,6 +124,7 @@ struct _video_global
 	UINT8					snap_native;			/* are we using native per-screen layouts? */
 	INT32					snap_width;				/* width of snapshots (0 == auto) */
 	INT32					snap_height;			/* height of snapshots (0 == auto) */
+	UINT8					snap_pending;			/* flag: TRUE if a snapshot is waiting for a drawn frame */
 
 	/* movie recording */
 	mame_file *				mngfile;				/* handle to the open movie file */
@@ -179,6 +184,7 @@ static void update_refresh_speed(running_machine *machine);
 
 /* screen snapshots */
 static void create_snapshot_bitmap(device_t *screen);
+static void save_active_screen_snapshots(running_machine *machine);
 static file_error mame_fopen_next(running_machine *machine, const char *pathoption, const char *extension, mame_file **file);
 
 /* movie recording */
@@ -249,6 +255,23 @@ INLINE int effective_throttle(running_machine *machine)
 }
 
 
+/*-------------------------------------------------
+    effective_rendering - return TRUE if the
+    coming frame needs to be drawn, accounting
+    for movies, snapshots and explicit requests
+-------------------------------------------------*/
+
+INLINE int effective_rendering(void)
+{
+	/* movies need every frame, and snapshots and scripts need the next one */
+	if (global.mngfile != NULL || global.avifile != NULL || global.snap_pending || global.render_requested)
+		return TRUE;
+
+	/* otherwise, it's up to the user */
+	return global.rendering;
+}
+
+
 /*-------------------------------------------------
     original_speed_setting - return the original
     speed setting
@@ -290,6 +313,7 @@ void video_init(running_machine *machine)
 	global.speed = original_speed_setting();
 	update_refresh_speed(machine);
 	global.throttle = options_get_bool(machine->options(), OPTION_THROTTLE);
+	global.rendering = options_get_bool(machine->options(), OPTION_RENDERING);
 	global.auto_frameskip = options_get_bool(machine->options(), OPTION_AUTOFRAMESKIP);
 	global.frameskip_level = options_get_int(machine->options(), OPTION_FRAMESKIP);
 	global.seconds_to_run = options_get_int(machine->options(), OPTION_SECONDS_TO_RUN);
@@ -458,6 +482,9 @@ void video_frame_update(running_machine *machine, int debug)
 	/* update the internal render debugger */
 	debugint_update_during_game(machine);
 
+	/* handle requests from a headless debugger client */
+	debug_server_update_during_game(machine);
+
 	/* if we're throttling, synchronize before rendering */
 	if (!debug && !skipped_it && effective_throttle(machine))
 		update_throttle(machine, current_time);
@@ -506,6 +533,9 @@ static int finish_screen_updates(running_machine *machine)
 {
 	bool anything_changed = false;
 
+	/* remember whether what's on screen will match this frame */
+	global.screen_current = !global.skipping_this_frame;
+
 	/* finish updating the screens */
 	for (screen_device *screen = screen_first(*machine); screen != NULL; screen = screen_next(screen))
 		screen->update_partial(screen->visible_area().max_y);
@@ -533,6 +563,13 @@ static int finish_screen_updates(running_machine *machine)
 	for (screen_device *screen = screen_first(*machine); screen != NULL; screen = screen_next(screen))
 		crosshair_render(*screen);
 
+	/* take any snapshot that was waiting for a drawn frame */
+	if (global.snap_pending && !global.skipping_this_frame)
+	{
+		global.snap_pending = FALSE;
+		save_active_screen_snapshots(machine);
+	}
+
 	return anything_changed;
 }
 
@@ -727,6 +764,52 @@ void video_set_fastforward(int _fastforward)
 }
 
 
+/*-------------------------------------------------
+    video_get_rendering - return whether screens
+    are being drawn
+-------------------------------------------------*/
+
+int video_get_rendering(void)
+{
+	return global.rendering;
+}
+
+
+/*-------------------------------------------------
+    video_set_rendering - turn drawing of the
+    screens on or off; while off, frames are
+    skipped as if by frameskip, except for drivers
+    flagged VIDEO_ALWAYS_UPDATE
+-------------------------------------------------*/
+
+void video_set_rendering(int rendering)
+{
+	global.rendering = rendering;
+}
+
+
+/*-------------------------------------------------
+    video_request_render - make sure the next
+    frame is drawn even if rendering is off
+-------------------------------------------------*/
+
+void video_request_render(void)
+{
+	global.render_requested = TRUE;
+}
+
+
+/*-------------------------------------------------
+    video_is_screen_current - return whether the
+    most recently finished frame was drawn
+-------------------------------------------------*/
+
+int video_is_screen_current(void)
+{
+	return global.screen_current;
+}
+
+
 /*-------------------------------------------------
     update_throttle - throttle to the game's
     natural speed
@@ -992,7 +1075,8 @@ static void update_frameskip(running_machine *machine)
 
 	/* increment the frameskip counter and determine if we will skip the next frame */
 	global.frameskip_counter = (global.frameskip_counter + 1) % FRAMESKIP_LEVELS;
-	global.skipping_this_frame = skiptable[effective_frameskip()][global.frameskip_counter];
+	global.skipping_this_frame = skiptable[effective_frameskip()][global.frameskip_counter] || !effective_rendering();
+	global.render_requested = FALSE;
 }
 
 
@@ -1160,12 +1244,29 @@ void screen_save_snapshot(running_machine *machine, device_t *screen, mame_file
 
 void video_save_active_screen_snapshots(running_machine *machine)
 {
-	mame_file *fp;
-
 	/* validate */
 	assert(machine != NULL);
 	assert(machine->config != NULL);
 
+	/* if this frame wasn't drawn because rendering is off, wait for one that is */
+	if (!global.rendering && global.skipping_this_frame)
+	{
+		global.snap_pending = TRUE;
+		return;
+	}
+	save_active_screen_snapshots(machine);
+}
+
+
+/*-------------------------------------------------
+    save_active_screen_snapshots - write out
+    snapshots of all active screens now
+-------------------------------------------------*/
+
+static void save_active_screen_snapshots(running_machine *machine)
+{
+	mame_file *fp;
+
 	/* if we're native, then write one snapshot per visible screen */
 	if (global.snap_native)
 	{
@@ -368,6 +368,16 @@ void video_set_throttle(int throttle);
 int video_get_fastforward(void);
 void video_set_fastforward(int fastforward);
 
+/* get/set whether screens are drawn at all */
+int video_get_rendering(void);
+void video_set_rendering(int rendering);
+
+/* make sure the next frame is drawn, even if rendering is off */
+void video_request_render(void);
+
+/* was the most recently finished frame drawn? */
+int video_is_screen_current(void);
+
 
 /* ----- snapshots ----- */
 
@@ -0,0 +1,143 @@
+/***************************************************************************
+
+    layerjob.c
+
+    Helper for rendering independent video layers in parallel.
+
+    Copyright Nicola Salmoria and the MAME Team.
+    Visit http://mamedev.org for licensing and usage restrictions.
+
+***************************************************************************/
+
+#include "emu.h"
+#include "layerjob.h"
+
+
+/***************************************************************************
+    TYPE DEFINITIONS
+***************************************************************************/
+
+/* a single queued layer */
+typedef struct _layer_job layer_job;
+struct _layer_job
+{
+	layer_render_func	render;					/* render callback */
+	void *				param;					/* callback parameter */
+	screen_device *		screen;					/* screen being updated */
+	rectangle			cliprect;				/* region being updated */
+};
+
+
+/* the full set of jobs */
+struct _layer_jobs
+{
+	osd_work_queue *	queue;					/* work queue */
+	layer_job *			job;					/* array of jobs */
+	int					job_count;				/* number of jobs allocated */
+	int					job_next;				/* index of the next job to add */
+};
+
+
+
+/***************************************************************************
+    IMPLEMENTATION
+***************************************************************************/
+
+/*-------------------------------------------------
+    layer_job_callback - render a single layer
+-------------------------------------------------*/
+
+static void *layer_job_callback(void *param, int threadid)
+{
+	layer_job *job = (layer_job *)param;
+
+	(*job->render)(job->screen, job->param, &job->cliprect, threadid);
+	return NULL;
+}
+
+
+/*-------------------------------------------------
+    layer_jobs_alloc - allocate a new set of
+    layer jobs
+-------------------------------------------------*/
+
+layer_jobs *layer_jobs_alloc(running_machine *machine, int maxjobs)
+{
+	layer_jobs *jobs;
+
+	/* allocate the object itself */
+	jobs = auto_alloc_clear(machine, layer_jobs);
+
+	/* allocate the jobs */
+	jobs->job_count = MAX(maxjobs, 1);
+	jobs->job = auto_alloc_array_clear(machine, layer_job, jobs->job_count);
+
+	/* create the work queue; a handful of items per frame doesn't justify spinning */
+	jobs->queue = osd_work_queue_alloc(WORK_QUEUE_FLAG_MULTI);
+	return jobs;
+}
+
+
+/*-------------------------------------------------
+    layer_jobs_free - free a set of layer jobs
+-------------------------------------------------*/
+
+void layer_jobs_free(layer_jobs *jobs)
+{
+	/* free the work queue */
+	if (jobs->queue != NULL)
+		osd_work_queue_free(jobs->queue);
+	jobs->queue = NULL;
+}
+
+
+/*-------------------------------------------------
+    layer_jobs_add - add a job to be rendered on
+    the next run
+-------------------------------------------------*/
+
+void layer_jobs_add(layer_jobs *jobs, layer_render_func render, void *param)
+{
+	layer_job *job;
+
+	assert(jobs->job_next < jobs->job_count);
+
+	job = &jobs->job[jobs->job_next++];
+	job->render = render;
+	job->param = param;
+}
+
+
+/*-------------------------------------------------
+    layer_jobs_run - render all pending jobs and
+    wait for them to complete
+-------------------------------------------------*/
+
+void layer_jobs_run(layer_jobs *jobs, screen_device *screen, const rectangle *cliprect)
+{
+	int jobnum;
+
+	/* fill in the region for everyone */
+	for (jobnum = 0; jobnum < jobs->job_next; jobnum++)
+	{
+		jobs->job[jobnum].screen = screen;
+		jobs->job[jobnum].cliprect = *cliprect;
+	}
+
+	/* hand everything to the queue at once and wait for it to drain */
+	if (jobs->queue != NULL && jobs->job_next > 1)
+	{
+		osd_work_item_queue_multiple(jobs->queue, layer_job_callback, jobs->job_next, &jobs->job[0], sizeof(jobs->job[0]), WORK_ITEM_FLAG_AUTO_RELEASE);
+		osd_work_queue_wait(jobs->queue, osd_ticks_per_second() * 100);
+	}
+
+	/* otherwise, just run the whole list now */
+	else
+	{
+		for (jobnum = 0; jobnum < jobs->job_next; jobnum++)
+			layer_job_callback(&jobs->job[jobnum], 0);
+	}
+
+	/* start fresh for the next update */
+	jobs->job_next = 0;
+}
@@ -0,0 +1,75 @@
+/***************************************************************************
+
+    layerjob.h
+
+    Helper for rendering independent video layers in parallel.
+
+    Copyright Nicola Salmoria and the MAME Team.
+    Visit http://mamedev.org for licensing and usage restrictions.
+
+****************************************************************************
+
+    Drivers that build each layer into its own temporary bitmap and
+    then mix them can hand the per-layer work to a layer_jobs object:
+
+        layer_jobs_add(jobs, render_fg, &fg_state);
+        layer_jobs_add(jobs, render_bg, &bg_state);
+        layer_jobs_run(jobs, screen, cliprect);
+        ... mix the layers in order ...
+
+    layer_jobs_run does not return until every job has finished, so the
+    mix that follows always sees complete layers. Jobs may run on any
+    thread and in any order, which means a job must only write to state
+    that belongs to it alone and must not touch anything the core updates
+    lazily; in particular, fetch tilemap pixmaps with tilemap_get_pixmap
+    before calling layer_jobs_run rather than from inside a job.
+
+    When there is only one job, no work queue, or the OSD layer has no
+    worker threads to give (such as on a single CPU system), the jobs
+    are simply run one after another on the calling thread.
+
+***************************************************************************/
+
+#pragma once
+
+#ifndef __LAYERJOB_H__
+#define __LAYERJOB_H__
+
+
+/***************************************************************************
+    TYPE DEFINITIONS
+***************************************************************************/
+
+/* opaque reference to a set of layer jobs */
+typedef struct _layer_jobs layer_jobs;
+
+
+/* callback routine to render one layer */
+typedef void (*layer_render_func)(screen_device *screen, void *param, const rectangle *cliprect, int threadid);
+
+
+
+/***************************************************************************
+    FUNCTION PROTOTYPES
+***************************************************************************/
+
+/* ----- initialization/teardown ----- */
+
+/* allocate a new set of layer jobs, holding up to maxjobs per run */
+layer_jobs *layer_jobs_alloc(running_machine *machine, int maxjobs);
+
+/* free a set of layer jobs */
+void layer_jobs_free(layer_jobs *jobs);
+
+
+
+/* ----- running jobs ----- */
+
+/* add a job to be rendered on the next run */
+void layer_jobs_add(layer_jobs *jobs, layer_render_func render, void *param);
+
+/* render all pending jobs and wait for them to complete */
+void layer_jobs_run(layer_jobs *jobs, screen_device *screen, const rectangle *cliprect);
+
+
+#endif	/* __LAYERJOB_H__ */
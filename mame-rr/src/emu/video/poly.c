@@ -7,6 +7,7 @@
 ***************************************************************************/
 
 #include "emu.h"
+#include "profiler.h"
 #include "poly.h"
 
 
@@ -33,6 +34,7 @@
 #define CACHE_LINE_SIZE					64			/* this is a general guess */
 #define TOTAL_BUCKETS					(512 / SCANLINES_PER_BUCKET)
 #define UNITS_PER_POLY					(100 / SCANLINES_PER_BUCKET)
+#define MAX_WAIT_REASONS				8			/* poly_wait reasons with a cached profiler counter */
 
 
 
@@ -93,12 +95,19 @@ struct _work_unit_shared
 	polygon_info *		polygon;				/* pointer to polygon */
 	volatile UINT32		count_next;				/* number of scanlines and index of next item to process */
 	INT16				scanline;				/* starting scanline and count */
-	UINT16				previtem;				/* index of previous item in the same bucket */
+	union
+	{
+		UINT16			previtem;				/* index of previous item in the same bucket (immediate mode) */
+		UINT16			nextitem;				/* index of next item in the same bucket (deferred mode) */
+	};
 #ifndef PTR64
 	UINT32				dummy;					/* pad to 16 bytes */
 #endif
 };
 
+/* fails to compile if work_unit_shared is no longer 16 bytes */
+typedef char work_unit_shared_size_check[(sizeof(work_unit_shared) == 16) ? 1 : -1];
+
 
 /* tri_work_unit is a triangle-specific work-unit */
 typedef struct _tri_work_unit tri_work_unit;
@@ -128,6 +137,15 @@ union _work_unit
 };
 
 
+/* poly_bucket is the work item for one bucket's worth of deferred rendering */
+typedef struct _poly_bucket poly_bucket;
+struct _poly_bucket
+{
+	poly_manager *		poly;					/* pointer back to the poly manager */
+	UINT16				firstitem;				/* index of the first item in the bucket */
+};
+
+
 /* polygon_info describes a single polygon, which includes the poly_params */
 struct _polygon_info
 {
@@ -175,8 +193,14 @@ struct _poly_manager
 	/* misc data */
 	UINT8				flags;					/* flags */
 
+	/* profiler counters for poly_wait, keyed by the reason string pointer */
+	int					wait_reasons;			/* number of cached reasons */
+	const char *		wait_reason[MAX_WAIT_REASONS]; /* reason strings */
+	int					wait_counter[MAX_WAIT_REASONS]; /* matching counter indexes */
+
 	/* buckets */
 	UINT16				unit_bucket[TOTAL_BUCKETS]; /* buckets for tracking unit usage */
+	poly_bucket			bucket[TOTAL_BUCKETS];	/* per-bucket lists for deferred rendering */
 
 	/* statistics */
 	UINT32				triangles;				/* number of triangles queued */
@@ -202,6 +226,8 @@ struct _poly_manager
 
 static void **allocate_array(running_machine *machine, size_t *itemsize, UINT32 itemcount);
 static void *poly_item_callback(void *param, int threadid);
+static void *poly_bucket_callback(void *param, int threadid);
+static void reset_buckets(poly_manager *poly);
 static STATE_PRESAVE( poly_state_presave );
 
 
@@ -277,6 +303,83 @@ INLINE void copy_vertex(poly_vertex *outv, const poly_vertex *v, int paramcount)
 }
 
 
+/*-------------------------------------------------
+    add_unit_to_bucket - append a work unit to
+    the list for its bucket
+-------------------------------------------------*/
+
+INLINE void add_unit_to_bucket(poly_manager *poly, work_unit_shared *shared, UINT32 bucketnum, UINT32 unit_index)
+{
+	UINT16 lastitem = poly->unit_bucket[bucketnum];
+
+	/* deferred rendering links forwards, so the bucket can be walked in submission order */
+	if (poly->flags & POLYFLAG_DEFERRED)
+	{
+		shared->nextitem = 0xffff;
+		if (lastitem != 0xffff)
+			poly->unit[lastitem]->shared.nextitem = unit_index;
+		else
+			poly->bucket[bucketnum].firstitem = unit_index;
+	}
+
+	/* immediate rendering links backwards for conflict detection; the previous
+       unit may already be running, so it must not be touched */
+	else
+		shared->previtem = lastitem;
+	poly->unit_bucket[bucketnum] = unit_index;
+}
+
+
+/*-------------------------------------------------
+    render_work_unit - call the scanline callback
+    for each scanline in a work unit
+-------------------------------------------------*/
+
+INLINE void render_work_unit(const work_unit *unit, int threadid)
+{
+	const polygon_info *polygon = unit->shared.polygon;
+	int count = unit->shared.count_next & 0xffff;
+	int curscan;
+
+	for (curscan = 0; curscan < count; curscan++)
+	{
+		if (polygon->numverts == 3)
+		{
+			poly_extent tmpextent;
+			convert_tri_extent_to_poly_extent(&tmpextent, &unit->tri.extent[curscan], polygon, unit->shared.scanline + curscan);
+			(*polygon->callback)(polygon->dest, unit->shared.scanline + curscan, &tmpextent, polygon->extra, threadid);
+		}
+		else
+			(*polygon->callback)(polygon->dest, unit->shared.scanline + curscan, &unit->quad.extent[curscan], polygon->extra, threadid);
+	}
+}
+
+
+/*-------------------------------------------------
+    wait_counter - return the profiler counter
+    for a poly_wait reason, registering it only
+    the first time that string is seen
+-------------------------------------------------*/
+
+INLINE int wait_counter(poly_manager *poly, const char *debug_reason)
+{
+	int reasonnum, counter;
+
+	/* callers pass string literals, so the pointer is enough */
+	for (reasonnum = 0; reasonnum < poly->wait_reasons; reasonnum++)
+		if (poly->wait_reason[reasonnum] == debug_reason)
+			return poly->wait_counter[reasonnum];
+
+	counter = profiler_counter_register("poly_wait", debug_reason);
+	if (poly->wait_reasons < MAX_WAIT_REASONS)
+	{
+		poly->wait_reason[poly->wait_reasons] = debug_reason;
+		poly->wait_counter[poly->wait_reasons++] = counter;
+	}
+	return counter;
+}
+
+
 /*-------------------------------------------------
     allocate_polygon - allocate a new polygon
     object, blocking if we run out
@@ -319,6 +422,7 @@ INLINE polygon_info *allocate_polygon(poly_manager *poly, int miny, int maxy)
 poly_manager *poly_alloc(running_machine *machine, int max_polys, size_t extra_data_size, UINT8 flags)
 {
 	poly_manager *poly;
+	int bucketnum;
 
 	/* allocate the manager itself */
 	poly = auto_alloc_clear(machine, poly_manager);
@@ -342,6 +446,11 @@ poly_manager *poly_alloc(running_machine *machine, int max_polys, size_t extra_d
 	poly->unit_next = 0;
 	poly->unit = (work_unit **)allocate_array(machine, &poly->unit_size, poly->unit_count);
 
+	/* start with all the buckets empty */
+	for (bucketnum = 0; bucketnum < TOTAL_BUCKETS; bucketnum++)
+		poly->bucket[bucketnum].poly = poly;
+	reset_buckets(poly);
+
 	/* create the work queue */
 	if (!(flags & POLYFLAG_NO_WORK_QUEUE))
 		poly->queue = osd_work_queue_alloc(WORK_QUEUE_FLAG_MULTI | WORK_QUEUE_FLAG_HIGH_FREQ);
@@ -403,18 +512,28 @@ void poly_wait(poly_manager *poly, const char *debug_reason)
 	if (LOG_WAITS)
 		time = get_profile_ticks();
 
+	/* count the wait against its reason; the lookup only runs while the profiler is on */
+	profiler_counter_add(wait_counter(poly, debug_reason), 1);
+	profiler_mark_start(PROFILER_POLY_WAIT);
+
+	/* in deferred mode nothing is queued yet; hand out one work item per bucket now */
+	if (poly->queue != NULL && (poly->flags & POLYFLAG_DEFERRED) && poly->unit_next > 0)
+		osd_work_item_queue_multiple(poly->queue, poly_bucket_callback, TOTAL_BUCKETS, &poly->bucket[0], sizeof(poly->bucket[0]), WORK_ITEM_FLAG_AUTO_RELEASE);
+
 	/* wait for all pending work items to complete */
 	if (poly->queue != NULL)
 		osd_work_queue_wait(poly->queue, osd_ticks_per_second() * 100);
 
-	/* if we don't have a queue, just run the whole list now */
+	/* if we don't have a queue, just run the whole list now; submission order needs no links */
 	else
 	{
 		int unitnum;
 		for (unitnum = 0; unitnum < poly->unit_next; unitnum++)
-			poly_item_callback(poly->unit[unitnum], 0);
+			render_work_unit(poly->unit[unitnum], 0);
 	}
 
+	profiler_mark_end();
+
 	/* log any long waits */
 	if (LOG_WAITS)
 	{
@@ -425,7 +544,7 @@ void poly_wait(poly_manager *poly, const char *debug_reason)
 
 	/* reset the state */
 	poly->polygon_next = poly->unit_next = 0;
-	memset(poly->unit_bucket, 0xff, sizeof(poly->unit_bucket));
+	reset_buckets(poly);
 
 	/* we need to preserve the last extra data that was supplied */
 	if (poly->extra_next > 1)
@@ -551,8 +670,7 @@ UINT32 poly_render_triangle(poly_manager *poly, void *dest, const rectangle *cli
 		unit->shared.polygon = polygon;
 		unit->shared.count_next = MIN(v3yclip - curscan, scaninc);
 		unit->shared.scanline = curscan;
-		unit->shared.previtem = poly->unit_bucket[bucketnum];
-		poly->unit_bucket[bucketnum] = unit_index;
+		add_unit_to_bucket(poly, &unit->shared, bucketnum, unit_index);
 
 		/* iterate over extents */
 		for (extnum = 0; extnum < unit->shared.count_next; extnum++)
@@ -641,8 +759,8 @@ UINT32 poly_render_triangle(poly_manager *poly, void *dest, const rectangle *cli
 		}
 	}
 
-	/* enqueue the work items */
-	if (poly->queue != NULL)
+	/* enqueue the work items, unless we're deferring them to the next wait */
+	if (poly->queue != NULL && !(poly->flags & POLYFLAG_DEFERRED))
 		osd_work_item_queue_multiple(poly->queue, poly_item_callback, poly->unit_next - startunit, poly->unit[startunit], poly->unit_size, WORK_ITEM_FLAG_AUTO_RELEASE);
 
 	/* return the total number of pixels in the triangle */
@@ -723,8 +841,7 @@ UINT32 poly_render_triangle_custom(poly_manager *poly, void *dest, const rectang
 		unit->shared.polygon = polygon;
 		unit->shared.count_next = MIN(v3yclip - curscan, scaninc);
 		unit->shared.scanline = curscan;
-		unit->shared.previtem = poly->unit_bucket[bucketnum];
-		poly->unit_bucket[bucketnum] = unit_index;
+		add_unit_to_bucket(poly, &unit->shared, bucketnum, unit_index);
 
 		/* iterate over extents */
 		for (extnum = 0; extnum < unit->shared.count_next; extnum++)
@@ -760,8 +877,8 @@ UINT32 poly_render_triangle_custom(poly_manager *poly, void *dest, const rectang
 	poly->unit_max = MAX(poly->unit_max, poly->unit_next);
 #endif
 
-	/* enqueue the work items */
-	if (poly->queue != NULL)
+	/* enqueue the work items, unless we're deferring them to the next wait */
+	if (poly->queue != NULL && !(poly->flags & POLYFLAG_DEFERRED))
 		osd_work_item_queue_multiple(poly->queue, poly_item_callback, poly->unit_next - startunit, poly->unit[startunit], poly->unit_size, WORK_ITEM_FLAG_AUTO_RELEASE);
 
 	/* return the total number of pixels in the object */
@@ -920,8 +1037,7 @@ UINT32 poly_render_quad(poly_manager *poly, void *dest, const rectangle *cliprec
 		unit->shared.polygon = polygon;
 		unit->shared.count_next = MIN(maxyclip - curscan, scaninc);
 		unit->shared.scanline = curscan;
-		unit->shared.previtem = poly->unit_bucket[bucketnum];
-		poly->unit_bucket[bucketnum] = unit_index;
+		add_unit_to_bucket(poly, &unit->shared, bucketnum, unit_index);
 
 		/* iterate over extents */
 		for (extnum = 0; extnum < unit->shared.count_next; extnum++)
@@ -991,8 +1107,8 @@ UINT32 poly_render_quad(poly_manager *poly, void *dest, const rectangle *cliprec
 	poly->unit_max = MAX(poly->unit_max, poly->unit_next);
 #endif
 
-	/* enqueue the work items */
-	if (poly->queue != NULL)
+	/* enqueue the work items, unless we're deferring them to the next wait */
+	if (poly->queue != NULL && !(poly->flags & POLYFLAG_DEFERRED))
 		osd_work_item_queue_multiple(poly->queue, poly_item_callback, poly->unit_next - startunit, poly->unit[startunit], poly->unit_size, WORK_ITEM_FLAG_AUTO_RELEASE);
 
 	/* return the total number of pixels in the triangle */
@@ -1158,8 +1274,7 @@ UINT32 poly_render_polygon(poly_manager *poly, void *dest, const rectangle *clip
 		unit->shared.polygon = polygon;
 		unit->shared.count_next = MIN(maxyclip - curscan, scaninc);
 		unit->shared.scanline = curscan;
-		unit->shared.previtem = poly->unit_bucket[bucketnum];
-		poly->unit_bucket[bucketnum] = unit_index;
+		add_unit_to_bucket(poly, &unit->shared, bucketnum, unit_index);
 
 		/* iterate over extents */
 		for (extnum = 0; extnum < unit->shared.count_next; extnum++)
@@ -1229,8 +1344,8 @@ UINT32 poly_render_polygon(poly_manager *poly, void *dest, const rectangle *clip
 	poly->unit_max = MAX(poly->unit_max, poly->unit_next);
 #endif
 
-	/* enqueue the work items */
-	if (poly->queue != NULL)
+	/* enqueue the work items, unless we're deferring them to the next wait */
+	if (poly->queue != NULL && !(poly->flags & POLYFLAG_DEFERRED))
 		osd_work_item_queue_multiple(poly->queue, poly_item_callback, poly->unit_next - startunit, poly->unit[startunit], poly->unit_size, WORK_ITEM_FLAG_AUTO_RELEASE);
 
 	/* return the total number of pixels in the triangle */
@@ -1322,9 +1437,7 @@ static void *poly_item_callback(void *param, int threadid)
 	{
 		work_unit *unit = (work_unit *)param;
 		polygon_info *polygon = unit->shared.polygon;
-		int count = unit->shared.count_next & 0xffff;
 		UINT32 orig_count_next;
-		int curscan;
 
 		/* if our previous item isn't done yet, enqueue this item to the end and proceed */
 		if (unit->shared.previtem != 0xffff)
@@ -1355,17 +1468,7 @@ static void *poly_item_callback(void *param, int threadid)
 		}
 
 		/* iterate over extents */
-		for (curscan = 0; curscan < count; curscan++)
-		{
-			if (polygon->numverts == 3)
-			{
-				poly_extent tmpextent;
-				convert_tri_extent_to_poly_extent(&tmpextent, &unit->tri.extent[curscan], polygon, unit->shared.scanline + curscan);
-				(*polygon->callback)(polygon->dest, unit->shared.scanline + curscan, &tmpextent, polygon->extra, threadid);
-			}
-			else
-				(*polygon->callback)(polygon->dest, unit->shared.scanline + curscan, &unit->quad.extent[curscan], polygon->extra, threadid);
-		}
+		render_work_unit(unit, threadid);
 
 		/* set our count to 0 and re-fetch the original count value */
 		do
@@ -1383,6 +1486,37 @@ static void *poly_item_callback(void *param, int threadid)
 }
 
 
+/*-------------------------------------------------
+    poly_bucket_callback - callback for each
+    bucket in deferred mode; the bucket's items
+    are rendered in the order they were submitted
+-------------------------------------------------*/
+
+static void *poly_bucket_callback(void *param, int threadid)
+{
+	poly_bucket *bucket = (poly_bucket *)param;
+	UINT32 unitnum;
+
+	for (unitnum = bucket->firstitem; unitnum != 0xffff; unitnum = bucket->poly->unit[unitnum]->shared.nextitem)
+		render_work_unit(bucket->poly->unit[unitnum], threadid);
+	return NULL;
+}
+
+
+/*-------------------------------------------------
+    reset_buckets - empty out all the buckets
+-------------------------------------------------*/
+
+static void reset_buckets(poly_manager *poly)
+{
+	int bucketnum;
+
+	memset(poly->unit_bucket, 0xff, sizeof(poly->unit_bucket));
+	for (bucketnum = 0; bucketnum < TOTAL_BUCKETS; bucketnum++)
+		poly->bucket[bucketnum].firstitem = 0xffff;
+}
+
+
 /*-------------------------------------------------
     poly_state_presave - pre-save callback to
     ensure everything is synced before saving
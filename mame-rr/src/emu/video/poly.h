@@ -47,6 +47,7 @@
 #define POLYFLAG_INCLUDE_RIGHT_EDGE			0x02
 #define POLYFLAG_NO_WORK_QUEUE				0x04
 #define POLYFLAG_ALLOW_QUADS				0x08
+#define POLYFLAG_DEFERRED					0x10	/* hold everything until poly_wait, then render by bucket */
 
 
 
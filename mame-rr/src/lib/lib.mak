@@ -76,9 +76,12 @@ $(LIBOBJ)/expat/%.o: $(LIBSRC)/explat/%.c | $(OSPREBUILD)
 
 
 #-------------------------------------------------
-# lua library objects
+# lua library objects (not needed when linking
+# against an external LuaJIT)
 #-------------------------------------------------
 
+ifneq ($(USE_LUAJIT),1)
+
 LUAOBJS = \
 	$(LIBOBJ)/lua/lapi.o \
 	$(LIBOBJ)/lua/lauxlib.o \
@@ -119,6 +122,8 @@ $(LIBOBJ)/lua/%.o: $(LIBSRC)/lua/%.c | $(OSPREBUILD)
 	@echo Compiling $<...
 	$(CC) $(CDEFS) $(CCOMFLAGS) -Wno-error $(CONLYFLAGS) -c $< -o $@
 
+endif
+
 
 #-------------------------------------------------
 # zlib library objects
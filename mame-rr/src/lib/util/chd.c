@@ -86,6 +86,9 @@
 
 #define NO_MATCH					(~0)
 
+#define READ_AHEAD_THRESHOLD		2			/* in-order reads before we start reading ahead */
+#define PIPELINE_SLOTS				16			/* hunks in flight while compressing or verifying */
+
 
 
 /***************************************************************************
@@ -148,6 +151,20 @@ struct _metadata_entry
 };
 
 
+/* a decompressed hunk in the LRU cache */
+typedef struct _hunk_cache_entry hunk_cache_entry;
+struct _hunk_cache_entry
+{
+	UINT8 *					data;			/* hunk data, allocated on first use */
+	UINT32					hunknum;		/* hunk held here, or ~0 if none */
+	UINT32					lastuse;		/* cache clock at the last use */
+};
+
+
+/* a hunk being compressed or verified on another thread */
+typedef struct _pipeline_slot pipeline_slot;
+
+
 /* internal representation of an open CHD file */
 struct _chd_file
 {
@@ -191,6 +208,35 @@ struct _chd_file
 	osd_work_item *			workitem;		/* active work item, or NULL if none */
 	UINT32					async_hunknum;	/* hunk index for asynchronous operations */
 	void *					async_buffer;	/* buffer pointer for asynchronous operations */
+
+	hunk_cache_entry *		hunkcache;		/* LRU cache of decompressed hunks for chd_read */
+	UINT32					cachehunks;		/* number of entries in hunkcache */
+	UINT32					cacheclock;		/* use counter for the LRU */
+	UINT32					seqhunk;		/* hunk that would continue the current run */
+	UINT32					seqcount;		/* number of in-order reads in the current run */
+	osd_work_item *			readahead;		/* read-ahead work item, or NULL if none */
+	hunk_cache_entry *		readaheadentry;	/* cache entry being read ahead into */
+	UINT32					readaheadhunk;	/* hunk being read ahead */
+
+	osd_work_queue *		pipequeue;		/* multiprocessor queue for the pipeline */
+	pipeline_slot *			pipeline;		/* PIPELINE_SLOTS slots, or NULL to work serially */
+	chd_error				pipeerr;		/* first error written out by the pipeline */
+	UINT32					compwritten;	/* number of hunks the pipeline has written out */
+	UINT32					verqueued;		/* next hunk the pipeline will verify */
+};
+
+
+/* one slot of the compression/verification pipeline; the private chd_file */
+/* carries what the codecs use: the header, codec state and compressed buffer */
+struct _pipeline_slot
+{
+	chd_file				codec;			/* private codec context for this slot */
+	osd_work_item *			item;			/* work item, or NULL if idle */
+	UINT32					hunknum;		/* hunk being worked on */
+	UINT8 *					data;			/* uncompressed hunk data */
+	UINT32					length;			/* compressed length */
+	UINT32					crc;			/* CRC of the uncompressed data */
+	chd_error				err;			/* result of the work */
 };
 
 
@@ -240,6 +286,24 @@ static const UINT8 nullsha1[CHD_SHA1_BYTES] = { 0 };
 /* internal async operations */
 static void *async_read_callback(void *param, int threadid);
 static void *async_write_callback(void *param, int threadid);
+static void *read_ahead_callback(void *param, int threadid);
+static void *compress_slot_callback(void *param, int threadid);
+static void *verify_slot_callback(void *param, int threadid);
+
+/* internal hunk cache */
+static hunk_cache_entry *hunk_cache_find(chd_file *chd, UINT32 hunknum);
+static hunk_cache_entry *hunk_cache_victim(chd_file *chd);
+static void hunk_cache_invalidate(chd_file *chd);
+static void hunk_cache_free(chd_file *chd);
+static void hunk_cache_read_ahead(chd_file *chd, UINT32 hunknum);
+
+/* internal compression/verification pipeline */
+static void pipeline_alloc(chd_file *chd);
+static void pipeline_free(chd_file *chd);
+static pipeline_slot *pipeline_retire(chd_file *chd, UINT32 hunknum);
+static void pipeline_flush_compress(chd_file *chd);
+static void pipeline_queue_verify(chd_file *chd, UINT32 hunknum);
+static chd_error compress_write_hunk(chd_file *chd, UINT32 hunknum, const UINT8 *data, const pipeline_slot *slot);
 
 /* internal header operations */
 static chd_error header_validate(const chd_header *header);
@@ -249,7 +313,7 @@ static chd_error header_write(core_file *file, const chd_header *header);
 /* internal hunk read/write */
 static chd_error hunk_read_into_cache(chd_file *chd, UINT32 hunknum);
 static chd_error hunk_read_into_memory(chd_file *chd, UINT32 hunknum, UINT8 *dest);
-static chd_error hunk_write_from_memory(chd_file *chd, UINT32 hunknum, const UINT8 *src);
+static chd_error hunk_write_from_memory(chd_file *chd, UINT32 hunknum, const UINT8 *src, const pipeline_slot *slot);
 
 /* internal map access */
 static chd_error map_write_initial(core_file *file, chd_file *parent, const chd_header *header);
@@ -515,6 +579,16 @@ INLINE void wait_for_pending_async(chd_file *chd)
 		if (!wait_successful)
 			osd_break_into_debugger("Pending async operation never completed!");
 	}
+
+	/* reads ahead are internal, so retire them here too */
+	if (chd->readahead != NULL)
+	{
+		int wait_successful = osd_work_item_wait(chd->readahead, 10 * osd_ticks_per_second());
+		if (!wait_successful)
+			osd_break_into_debugger("Pending read ahead never completed!");
+		osd_work_item_release(chd->readahead);
+		chd->readahead = NULL;
+	}
 }
 
 
@@ -716,6 +790,11 @@ chd_error chd_open_file(core_file *file, int mode, chd_file *parent, chd_file **
 	if (err != CHDERR_NONE)
 		EARLY_EXIT(err);
 
+	/* set up the default hunk cache */
+	err = chd_set_cache_size(newchd, CHD_DEFAULT_CACHE_HUNKS);
+	if (err != CHDERR_NONE)
+		EARLY_EXIT(err);
+
 	/* all done */
 	*chd = newchd;
 	return CHDERR_NONE;
@@ -820,6 +899,9 @@ void chd_close(chd_file *chd)
 	/* wait for any pending async operations */
 	wait_for_pending_async(chd);
 
+	/* stop any compression or verification still in flight */
+	pipeline_free(chd);
+
 	/* kill the work queue and any work item */
 	if (chd->workitem != NULL)
 		osd_work_item_release(chd->workitem);
@@ -839,6 +921,7 @@ void chd_close(chd_file *chd)
 		free(chd->compare);
 	if (chd->cache != NULL)
 		free(chd->cache);
+	hunk_cache_free(chd);
 
 	/* free the hunk map */
 	if (chd->map != NULL)
@@ -1025,6 +1108,9 @@ cleanup:
 
 chd_error chd_read(chd_file *chd, UINT32 hunknum, void *buffer)
 {
+	hunk_cache_entry *entry;
+	chd_error err;
+
 	/* punt if NULL or invalid */
 	if (chd == NULL || chd->cookie != COOKIE_VALUE)
 		return CHDERR_INVALID_PARAMETER;
@@ -1036,8 +1122,28 @@ chd_error chd_read(chd_file *chd, UINT32 hunknum, void *buffer)
 	/* wait for any pending async operations */
 	wait_for_pending_async(chd);
 
-	/* perform the read */
-	return hunk_read_into_memory(chd, hunknum, (UINT8 *)buffer);
+	/* without a cache (or a buffer, for codecs that decompress elsewhere), read directly */
+	if (chd->hunkcache == NULL || buffer == NULL)
+		return hunk_read_into_memory(chd, hunknum, (UINT8 *)buffer);
+
+	/* decompress into the least recently used entry if we don't have it */
+	entry = hunk_cache_find(chd, hunknum);
+	if (entry == NULL)
+	{
+		entry = hunk_cache_victim(chd);
+		if (entry == NULL)
+			return CHDERR_OUT_OF_MEMORY;
+		err = hunk_read_into_memory(chd, hunknum, entry->data);
+		if (err != CHDERR_NONE)
+			return err;
+		entry->hunknum = hunknum;
+	}
+	entry->lastuse = ++chd->cacheclock;
+	memcpy(buffer, entry->data, chd->header.hunkbytes);
+
+	/* if we are streaming, start on the next hunk in the background */
+	hunk_cache_read_ahead(chd, hunknum);
+	return CHDERR_NONE;
 }
 
 
@@ -1091,7 +1197,7 @@ chd_error chd_write(chd_file *chd, UINT32 hunknum, const void *buffer)
 	wait_for_pending_async(chd);
 
 	/* then write out the hunk */
-	return hunk_write_from_memory(chd, hunknum, (const UINT8 *)buffer);
+	return hunk_write_from_memory(chd, hunknum, (const UINT8 *)buffer, NULL);
 }
 
 
@@ -1152,6 +1258,43 @@ chd_error chd_async_complete(chd_file *chd)
 }
 
 
+/*-------------------------------------------------
+    chd_set_cache_size - set how many decompressed
+    hunks chd_read keeps for this file
+-------------------------------------------------*/
+
+chd_error chd_set_cache_size(chd_file *chd, UINT32 hunks)
+{
+	UINT32 entrynum;
+
+	/* punt if NULL or invalid */
+	if (chd == NULL || chd->cookie != COOKIE_VALUE)
+		return CHDERR_INVALID_PARAMETER;
+
+	/* A/V hunks are decompressed into the caller's frame buffers, so there is nothing to keep */
+	if (chd->header.compression == CHDCOMPRESSION_AV)
+		hunks = 0;
+
+	/* wait for any pending async operations */
+	wait_for_pending_async(chd);
+
+	/* free the old cache */
+	hunk_cache_free(chd);
+	if (hunks == 0)
+		return CHDERR_NONE;
+
+	/* allocate the entries; their data comes as they are used */
+	chd->hunkcache = (hunk_cache_entry *)malloc(hunks * sizeof(chd->hunkcache[0]));
+	if (chd->hunkcache == NULL)
+		return CHDERR_OUT_OF_MEMORY;
+	memset(chd->hunkcache, 0, hunks * sizeof(chd->hunkcache[0]));
+	for (entrynum = 0; entrynum < hunks; entrynum++)
+		chd->hunkcache[entrynum].hunknum = ~0;
+	chd->cachehunks = hunks;
+	return CHDERR_NONE;
+}
+
+
 
 /***************************************************************************
     METADATA MANAGEMENT
@@ -1412,6 +1555,11 @@ chd_error chd_compress_begin(chd_file *chd)
 	chd->compressing = TRUE;
 	chd->comphunk = 0;
 
+	/* compress on all processors if we can */
+	pipeline_alloc(chd);
+	chd->pipeerr = CHDERR_NONE;
+	chd->compwritten = 0;
+
 	return CHDERR_NONE;
 }
 
@@ -1424,49 +1572,45 @@ chd_error chd_compress_begin(chd_file *chd)
 chd_error chd_compress_hunk(chd_file *chd, const void *data, double *curratio)
 {
 	UINT32 thishunk = chd->comphunk++;
-	UINT64 sourceoffset = (UINT64)thishunk * (UINT64)chd->header.hunkbytes;
-	UINT32 bytestochecksum;
-	const void *crcdata;
+	pipeline_slot *slot;
 	chd_error err;
 
 	/* error if in the wrong state */
 	if (!chd->compressing)
 		return CHDERR_INVALID_STATE;
 
-	/* write out the hunk */
-	err = hunk_write_from_memory(chd, thishunk, (const UINT8 *)data);
-	if (err != CHDERR_NONE)
-		return err;
-
-	/* if we are lossy, then we need to use the decompressed version in */
-	/* the cache as our MD5/SHA1 source */
-	crcdata = (chd->codecintf->lossy || data == NULL) ? chd->cache : data;
+	/* wait for any pending async operations */
+	wait_for_pending_async(chd);
 
-	/* update the MD5/SHA1 */
-	bytestochecksum = chd->header.hunkbytes;
-	if (sourceoffset + chd->header.hunkbytes > chd->header.logicalbytes)
+	/* without the pipeline (or data to give it), write everything out in order and then this hunk */
+	if (chd->pipeline == NULL || data == NULL)
 	{
-		if (sourceoffset >= chd->header.logicalbytes)
-			bytestochecksum = 0;
-		else
-			bytestochecksum = chd->header.logicalbytes - sourceoffset;
+		pipeline_flush_compress(chd);
+		if (chd->pipeerr != CHDERR_NONE)
+			return chd->pipeerr;
+		err = compress_write_hunk(chd, thishunk, (const UINT8 *)data, NULL);
+		if (err != CHDERR_NONE)
+			return err;
 	}
-	if (bytestochecksum > 0)
+
+	/* otherwise, write out the hunk last compressed in our slot and hand this one to it */
+	else
 	{
-		MD5Update(&chd->compmd5, (const unsigned char *)crcdata, bytestochecksum);
-		sha1_update(&chd->compsha1, bytestochecksum, (const UINT8 *)crcdata);
+		slot = pipeline_retire(chd, thishunk);
+		if (chd->pipeerr != CHDERR_NONE)
+			return chd->pipeerr;
+		slot->hunknum = thishunk;
+		memcpy(slot->data, data, chd->header.hunkbytes);
+		slot->item = osd_work_item_queue(chd->pipequeue, compress_slot_callback, slot, 0);
+		if (slot->item == NULL)
+			compress_slot_callback(slot, 0);
 	}
 
-	/* update our CRC map */
-	if ((chd->map[thishunk].flags & MAP_ENTRY_FLAG_TYPE_MASK) != MAP_ENTRY_TYPE_SELF_HUNK &&
-		(chd->map[thishunk].flags & MAP_ENTRY_FLAG_TYPE_MASK) != MAP_ENTRY_TYPE_PARENT_HUNK)
-		crcmap_add_entry(chd, thishunk);
-
 	/* update the ratio */
-	if (curratio != NULL)
+	if (curratio != NULL && chd->compwritten > 0)
 	{
 		UINT64 curlength = core_fsize(chd->file);
-		*curratio = 1.0 - (double)curlength / (double)((UINT64)chd->comphunk * (UINT64)chd->header.hunkbytes);
+		*curratio = 1.0 - (double)curlength / (double)((UINT64)chd->compwritten * (UINT64)chd->header.hunkbytes);
 	}
 
 	return CHDERR_NONE;
@@ -1480,10 +1624,23 @@ chd_error chd_compress_hunk(chd_file *chd, const void *data, double *curratio)
 
 chd_error chd_compress_finish(chd_file *chd, int write_protect)
 {
+	chd_error err;
+
 	/* error if in the wrong state */
 	if (!chd->compressing)
 		return CHDERR_INVALID_STATE;
 
+	/* write out whatever is still in the pipeline */
+	wait_for_pending_async(chd);
+	pipeline_flush_compress(chd);
+	pipeline_free(chd);
+	err = chd->pipeerr;
+	if (err != CHDERR_NONE)
+	{
+		chd->compressing = FALSE;
+		return err;
+	}
+
 	/* compute the final MD5/SHA1 values */
 	MD5Final(chd->header.md5, &chd->compmd5);
 	sha1_final(&chd->compsha1);
@@ -1527,6 +1684,10 @@ chd_error chd_verify_begin(chd_file *chd)
 	chd->verifying = TRUE;
 	chd->verhunk = 0;
 
+	/* decompress on all processors if we can */
+	pipeline_alloc(chd);
+	chd->verqueued = 0;
+
 	return CHDERR_NONE;
 }
 
@@ -1540,17 +1701,53 @@ chd_error chd_verify_hunk(chd_file *chd)
 {
 	UINT32 thishunk = chd->verhunk++;
 	UINT64 hunkoffset = (UINT64)thishunk * (UINT64)chd->header.hunkbytes;
+	hunk_cache_entry *cacheentry;
+	pipeline_slot *slot;
 	map_entry *entry;
+	const UINT8 *data;
 	chd_error err;
+	UINT32 crc;
 
 	/* error if in the wrong state */
 	if (!chd->verifying)
 		return CHDERR_INVALID_STATE;
 
-	/* read the hunk into the cache */
-	err = hunk_read_into_cache(chd, thishunk);
-	if (err != CHDERR_NONE)
-		return err;
+	/* wait for any pending async operations */
+	wait_for_pending_async(chd);
+
+	/* without the pipeline, read the hunk into the cache */
+	if (chd->pipeline == NULL || thishunk >= chd->header.totalhunks)
+	{
+		err = hunk_read_into_cache(chd, thishunk);
+		if (err != CHDERR_NONE)
+			return err;
+		data = chd->cache;
+		crc = crc32(0, chd->cache, chd->header.hunkbytes);
+	}
+
+	/* otherwise, keep the pipeline full and take this hunk out of it */
+	else
+	{
+		while (chd->verqueued < chd->header.totalhunks && chd->verqueued < thishunk + PIPELINE_SLOTS)
+			pipeline_queue_verify(chd, chd->verqueued++);
+		slot = pipeline_retire(chd, thishunk);
+		if (slot->err != CHDERR_NONE)
+			return slot->err;
+		data = slot->data;
+		crc = slot->crc;
+
+		/* chd_read is likely to want this next, so keep a copy */
+		if (chd->hunkcache != NULL && hunk_cache_find(chd, thishunk) == NULL)
+		{
+			cacheentry = hunk_cache_victim(chd);
+			if (cacheentry != NULL)
+			{
+				memcpy(cacheentry->data, data, chd->header.hunkbytes);
+				cacheentry->hunknum = thishunk;
+				cacheentry->lastuse = ++chd->cacheclock;
+			}
+		}
+	}
 
 	/* update the MD5/SHA1 */
 	if (hunkoffset < chd->header.logicalbytes)
@@ -1558,14 +1755,14 @@ chd_error chd_verify_hunk(chd_file *chd)
 		UINT64 bytestochecksum = MIN(chd->header.hunkbytes, chd->header.logicalbytes - hunkoffset);
 		if (bytestochecksum > 0)
 		{
-			MD5Update(&chd->vermd5, chd->cache, bytestochecksum);
-			sha1_update(&chd->versha1, bytestochecksum, chd->cache);
+			MD5Update(&chd->vermd5, data, bytestochecksum);
+			sha1_update(&chd->versha1, bytestochecksum, data);
 		}
 	}
 
 	/* validate the CRC if we have one */
 	entry = &chd->map[thishunk];
-	if (!(entry->flags & MAP_ENTRY_FLAG_NO_CRC) && entry->crc != crc32(0, chd->cache, chd->header.hunkbytes))
+	if (!(entry->flags & MAP_ENTRY_FLAG_NO_CRC) && entry->crc != crc)
 		return CHDERR_DECOMPRESSION_ERROR;
 
 	return CHDERR_NONE;
@@ -1583,6 +1780,10 @@ chd_error chd_verify_finish(chd_file *chd, chd_verify_result *result)
 	if (!chd->verifying)
 		return CHDERR_INVALID_STATE;
 
+	/* drop anything we decompressed ahead */
+	wait_for_pending_async(chd);
+	pipeline_free(chd);
+
 	/* compute the final MD5 */
 	MD5Final(result->md5, &chd->vermd5);
 
@@ -1674,7 +1875,7 @@ static void *async_write_callback(void *param, int threadid)
 	chd_error err;
 
 	/* write the hunk from memory */
-	err = hunk_write_from_memory(chd, chd->async_hunknum, (const UINT8 *)chd->async_buffer);
+	err = hunk_write_from_memory(chd, chd->async_hunknum, (const UINT8 *)chd->async_buffer, NULL);
 
 	/* return the error */
 	return (void *)err;
@@ -1682,6 +1883,410 @@ static void *async_write_callback(void *param, int threadid)
 
 
 
+/*-------------------------------------------------
+    read_ahead_callback - decompress the next hunk
+    of a sequential run into the cache
+-------------------------------------------------*/
+
+static void *read_ahead_callback(void *param, int threadid)
+{
+	chd_file *chd = (chd_file *)param;
+
+	/* only publish the entry if it worked; a failure is reported when it is really read */
+	if (hunk_read_into_memory(chd, chd->readaheadhunk, chd->readaheadentry->data) == CHDERR_NONE)
+		chd->readaheadentry->hunknum = chd->readaheadhunk;
+	return NULL;
+}
+
+
+/*-------------------------------------------------
+    compress_slot_callback - CRC and compress a
+    hunk with a pipeline slot's codec
+-------------------------------------------------*/
+
+static void *compress_slot_callback(void *param, int threadid)
+{
+	pipeline_slot *slot = (pipeline_slot *)param;
+	chd_file *codec = &slot->codec;
+
+	slot->crc = crc32(0, slot->data, codec->header.hunkbytes);
+	slot->err = CHDERR_COMPRESSION_ERROR;
+	slot->length = 0;
+	if (codec->codecintf->compress != NULL)
+		slot->err = (*codec->codecintf->compress)(codec, slot->data, &slot->length);
+	return NULL;
+}
+
+
+/*-------------------------------------------------
+    verify_slot_callback - decompress and CRC a
+    hunk with a pipeline slot's codec
+-------------------------------------------------*/
+
+static void *verify_slot_callback(void *param, int threadid)
+{
+	pipeline_slot *slot = (pipeline_slot *)param;
+	chd_file *codec = &slot->codec;
+
+	slot->err = (*codec->codecintf->decompress)(codec, slot->length, slot->data);
+	if (slot->err == CHDERR_NONE)
+		slot->crc = crc32(0, slot->data, codec->header.hunkbytes);
+	return NULL;
+}
+
+
+
+/***************************************************************************
+    INTERNAL HUNK CACHE
+***************************************************************************/
+
+/*-------------------------------------------------
+    hunk_cache_find - return the cache entry
+    holding a hunk, or NULL
+-------------------------------------------------*/
+
+static hunk_cache_entry *hunk_cache_find(chd_file *chd, UINT32 hunknum)
+{
+	UINT32 entrynum;
+
+	for (entrynum = 0; entrynum < chd->cachehunks; entrynum++)
+		if (chd->hunkcache[entrynum].hunknum == hunknum)
+			return &chd->hunkcache[entrynum];
+	return NULL;
+}
+
+
+/*-------------------------------------------------
+    hunk_cache_victim - empty out the least
+    recently used cache entry and return it
+-------------------------------------------------*/
+
+static hunk_cache_entry *hunk_cache_victim(chd_file *chd)
+{
+	hunk_cache_entry *victim = &chd->hunkcache[0];
+	UINT32 entrynum;
+
+	/* unused entries have a lastuse of 0, so they go first */
+	for (entrynum = 1; entrynum < chd->cachehunks; entrynum++)
+		if (chd->cacheclock - chd->hunkcache[entrynum].lastuse > chd->cacheclock - victim->lastuse)
+			victim = &chd->hunkcache[entrynum];
+
+	if (victim->data == NULL)
+	{
+		victim->data = (UINT8 *)malloc(chd->header.hunkbytes);
+		if (victim->data == NULL)
+			return NULL;
+	}
+	victim->hunknum = ~0;
+	return victim;
+}
+
+
+/*-------------------------------------------------
+    hunk_cache_invalidate - forget everything in
+    the cache
+-------------------------------------------------*/
+
+static void hunk_cache_invalidate(chd_file *chd)
+{
+	UINT32 entrynum;
+
+	/* any hunk may refer to the one being written, so drop them all */
+	for (entrynum = 0; entrynum < chd->cachehunks; entrynum++)
+		chd->hunkcache[entrynum].hunknum = ~0;
+	chd->seqcount = 0;
+}
+
+
+/*-------------------------------------------------
+    hunk_cache_free - free the cache and all of
+    its entries
+-------------------------------------------------*/
+
+static void hunk_cache_free(chd_file *chd)
+{
+	UINT32 entrynum;
+
+	if (chd->hunkcache != NULL)
+	{
+		for (entrynum = 0; entrynum < chd->cachehunks; entrynum++)
+			if (chd->hunkcache[entrynum].data != NULL)
+				free(chd->hunkcache[entrynum].data);
+		free(chd->hunkcache);
+	}
+	chd->hunkcache = NULL;
+	chd->cachehunks = 0;
+	chd->seqcount = 0;
+}
+
+
+/*-------------------------------------------------
+    hunk_cache_read_ahead - after a few reads in
+    order, decompress the next hunk on the work
+    queue so it is waiting when asked for
+-------------------------------------------------*/
+
+static void hunk_cache_read_ahead(chd_file *chd, UINT32 hunknum)
+{
+	hunk_cache_entry *entry;
+
+	/* track the length of the current run */
+	chd->seqcount = (hunknum == chd->seqhunk) ? chd->seqcount + 1 : 0;
+	chd->seqhunk = hunknum + 1;
+
+	/* we need a run, somewhere to put it, and something left to read; */
+	/* while verifying, the pipeline is already decompressing ahead of us */
+	if (chd->seqcount < READ_AHEAD_THRESHOLD || chd->cachehunks < 2 || chd->seqhunk >= chd->header.totalhunks)
+		return;
+	if (chd->pipeline != NULL)
+		return;
+	if (hunk_cache_find(chd, chd->seqhunk) != NULL)
+		return;
+
+	/* if no queue yet, create one on the fly */
+	if (chd->workqueue == NULL)
+	{
+		chd->workqueue = osd_work_queue_alloc(WORK_QUEUE_FLAG_IO);
+		if (chd->workqueue == NULL)
+			return;
+	}
+
+	/* claim an entry now so the LRU doesn't hand it out again */
+	entry = hunk_cache_victim(chd);
+	if (entry == NULL)
+		return;
+	entry->lastuse = ++chd->cacheclock;
+	chd->readaheadentry = entry;
+	chd->readaheadhunk = chd->seqhunk;
+	chd->readahead = osd_work_item_queue(chd->workqueue, read_ahead_callback, chd, 0);
+}
+
+
+
+/***************************************************************************
+    INTERNAL PIPELINE
+***************************************************************************/
+
+/*-------------------------------------------------
+    pipeline_alloc - set up the slots for
+    compressing or verifying on all processors;
+    on failure we just work serially
+-------------------------------------------------*/
+
+static void pipeline_alloc(chd_file *chd)
+{
+	int slotnum;
+
+	/* lossy codecs need the decompressed result in order, so they stay serial */
+	if (chd->pipeline != NULL || chd->codecintf->lossy)
+		return;
+
+	/* allocate the queue */
+	chd->pipequeue = osd_work_queue_alloc(WORK_QUEUE_FLAG_MULTI);
+	if (chd->pipequeue == NULL)
+		return;
+
+	/* allocate the slots */
+	chd->pipeline = (pipeline_slot *)malloc(PIPELINE_SLOTS * sizeof(chd->pipeline[0]));
+	if (chd->pipeline == NULL)
+	{
+		pipeline_free(chd);
+		return;
+	}
+	memset(chd->pipeline, 0, PIPELINE_SLOTS * sizeof(chd->pipeline[0]));
+
+	/* give each one its own buffers and codec state */
+	for (slotnum = 0; slotnum < PIPELINE_SLOTS; slotnum++)
+	{
+		pipeline_slot *slot = &chd->pipeline[slotnum];
+		chd_error err = CHDERR_NONE;
+
+		slot->hunknum = ~0;
+		slot->codec.cookie = COOKIE_VALUE;
+		slot->codec.header = chd->header;
+		slot->codec.codecintf = chd->codecintf;
+		slot->codec.compressed = (UINT8 *)malloc(chd->header.hunkbytes);
+		slot->data = (UINT8 *)malloc(chd->header.hunkbytes);
+		if (slot->codec.compressed == NULL || slot->data == NULL)
+			err = CHDERR_OUT_OF_MEMORY;
+		else if (chd->codecintf->init != NULL)
+			err = (*chd->codecintf->init)(&slot->codec);
+		if (err != CHDERR_NONE)
+		{
+			pipeline_free(chd);
+			return;
+		}
+	}
+}
+
+
+/*-------------------------------------------------
+    pipeline_free - wait for and throw away
+    anything in the pipeline, and free it
+-------------------------------------------------*/
+
+static void pipeline_free(chd_file *chd)
+{
+	int slotnum;
+
+	if (chd->pipeline != NULL)
+	{
+		for (slotnum = 0; slotnum < PIPELINE_SLOTS; slotnum++)
+		{
+			pipeline_slot *slot = &chd->pipeline[slotnum];
+
+			if (slot->item != NULL)
+			{
+				osd_work_item_wait(slot->item, 10 * osd_ticks_per_second());
+				osd_work_item_release(slot->item);
+			}
+			if (slot->codec.codecdata != NULL && chd->codecintf->free != NULL)
+				(*chd->codecintf->free)(&slot->codec);
+			if (slot->codec.compressed != NULL)
+				free(slot->codec.compressed);
+			if (slot->data != NULL)
+				free(slot->data);
+		}
+		free(chd->pipeline);
+	}
+	if (chd->pipequeue != NULL)
+		osd_work_queue_free(chd->pipequeue);
+	chd->pipeline = NULL;
+	chd->pipequeue = NULL;
+}
+
+
+/*-------------------------------------------------
+    pipeline_retire - wait for the slot that
+    hunknum maps to; when compressing, write out
+    the hunk it held
+-------------------------------------------------*/
+
+static pipeline_slot *pipeline_retire(chd_file *chd, UINT32 hunknum)
+{
+	pipeline_slot *slot = &chd->pipeline[hunknum % PIPELINE_SLOTS];
+
+	/* wait for the work to complete */
+	if (slot->item != NULL)
+	{
+		/* 10 seconds should be enough for anything! */
+		int wait_successful = osd_work_item_wait(slot->item, 10 * osd_ticks_per_second());
+		if (!wait_successful)
+			osd_break_into_debugger("Pipelined hunk never completed!");
+		osd_work_item_release(slot->item);
+		slot->item = NULL;
+	}
+
+	/* hunks are written in the order they were given to us, so the file matches a serial run */
+	if (chd->compressing && slot->hunknum != ~0 && chd->pipeerr == CHDERR_NONE)
+		chd->pipeerr = compress_write_hunk(chd, slot->hunknum, slot->data, slot);
+	slot->hunknum = ~0;
+	return slot;
+}
+
+
+/*-------------------------------------------------
+    pipeline_flush_compress - write out every
+    hunk still being compressed, oldest first
+-------------------------------------------------*/
+
+static void pipeline_flush_compress(chd_file *chd)
+{
+	int slotnum;
+
+	if (chd->pipeline == NULL)
+		return;
+
+	/* the oldest hunk in flight is the one after the newest */
+	for (slotnum = 0; slotnum < PIPELINE_SLOTS; slotnum++)
+		pipeline_retire(chd, chd->comphunk + slotnum);
+}
+
+
+/*-------------------------------------------------
+    pipeline_queue_verify - read a hunk and queue
+    it for decompression
+-------------------------------------------------*/
+
+static void pipeline_queue_verify(chd_file *chd, UINT32 hunknum)
+{
+	pipeline_slot *slot = pipeline_retire(chd, hunknum);
+	map_entry *entry = &chd->map[hunknum];
+
+	/* the file is only ever touched from this thread; other types are cheap to do right here */
+	slot->hunknum = hunknum;
+	if ((entry->flags & MAP_ENTRY_FLAG_TYPE_MASK) != MAP_ENTRY_TYPE_COMPRESSED || chd->codecintf->decompress == NULL)
+	{
+		slot->err = hunk_read_into_memory(chd, hunknum, slot->data);
+		if (slot->err == CHDERR_NONE)
+			slot->crc = crc32(0, slot->data, chd->header.hunkbytes);
+		return;
+	}
+
+	/* read the compressed data */
+	core_fseek(chd->file, entry->offset, SEEK_SET);
+	if (core_fread(chd->file, slot->codec.compressed, entry->length) != entry->length)
+	{
+		slot->err = CHDERR_READ_ERROR;
+		return;
+	}
+	slot->length = entry->length;
+
+	/* decompress it elsewhere, or here if we can't */
+	slot->item = osd_work_item_queue(chd->pipequeue, verify_slot_callback, slot, 0);
+	if (slot->item == NULL)
+		verify_slot_callback(slot, 0);
+}
+
+
+/*-------------------------------------------------
+    compress_write_hunk - write out the next
+    hunk being compressed and add it to the
+    checksums
+-------------------------------------------------*/
+
+static chd_error compress_write_hunk(chd_file *chd, UINT32 hunknum, const UINT8 *data, const pipeline_slot *slot)
+{
+	UINT64 sourceoffset = (UINT64)hunknum * (UINT64)chd->header.hunkbytes;
+	UINT32 bytestochecksum;
+	const void *crcdata;
+	chd_error err;
+
+	/* write out the hunk */
+	err = hunk_write_from_memory(chd, hunknum, data, slot);
+	if (err != CHDERR_NONE)
+		return err;
+
+	/* if we are lossy, then we need to use the decompressed version in */
+	/* the cache as our MD5/SHA1 source */
+	crcdata = (chd->codecintf->lossy || data == NULL) ? chd->cache : data;
+
+	/* update the MD5/SHA1 */
+	bytestochecksum = chd->header.hunkbytes;
+	if (sourceoffset + chd->header.hunkbytes > chd->header.logicalbytes)
+	{
+		if (sourceoffset >= chd->header.logicalbytes)
+			bytestochecksum = 0;
+		else
+			bytestochecksum = chd->header.logicalbytes - sourceoffset;
+	}
+	if (bytestochecksum > 0)
+	{
+		MD5Update(&chd->compmd5, (const unsigned char *)crcdata, bytestochecksum);
+		sha1_update(&chd->compsha1, bytestochecksum, (const UINT8 *)crcdata);
+	}
+
+	/* update our CRC map */
+	if ((chd->map[hunknum].flags & MAP_ENTRY_FLAG_TYPE_MASK) != MAP_ENTRY_TYPE_SELF_HUNK &&
+		(chd->map[hunknum].flags & MAP_ENTRY_FLAG_TYPE_MASK) != MAP_ENTRY_TYPE_PARENT_HUNK)
+		crcmap_add_entry(chd, hunknum);
+
+	chd->compwritten = hunknum + 1;
+	return CHDERR_NONE;
+}
+
+
+
 /***************************************************************************
     INTERNAL HEADER OPERATIONS
 ***************************************************************************/
@@ -1993,7 +2598,7 @@ static chd_error hunk_read_into_memory(chd_file *chd, UINT32 hunknum, UINT8 *des
     memory into a CHD
 -------------------------------------------------*/
 
-static chd_error hunk_write_from_memory(chd_file *chd, UINT32 hunknum, const UINT8 *src)
+static chd_error hunk_write_from_memory(chd_file *chd, UINT32 hunknum, const UINT8 *src, const pipeline_slot *slot)
 {
 	map_entry *entry = &chd->map[hunknum];
 	map_entry newentry;
@@ -2006,9 +2611,14 @@ static chd_error hunk_write_from_memory(chd_file *chd, UINT32 hunknum, const UIN
 	if (hunknum > chd->maxhunk)
 		chd->maxhunk = hunknum;
 
-	/* first compute the CRC of the original data */
+	/* anything we kept may now be stale */
+	hunk_cache_invalidate(chd);
+
+	/* first compute the CRC of the original data, unless the pipeline did */
 	newentry.crc = 0;
-	if (src != NULL)
+	if (slot != NULL)
+		newentry.crc = slot->crc;
+	else if (src != NULL)
 		newentry.crc = crc32(0, &src[0], chd->header.hunkbytes);
 
 	/* if we're not a lossy codec, compute the CRC and look for matches */
@@ -2056,9 +2666,14 @@ static chd_error hunk_write_from_memory(chd_file *chd, UINT32 hunknum, const UIN
 		}
 	}
 
-	/* now try compressing the data */
+	/* now try compressing the data; the pipeline has already done so */
 	err = CHDERR_COMPRESSION_ERROR;
-	if (chd->codecintf->compress != NULL)
+	if (slot != NULL)
+	{
+		err = slot->err;
+		bytes = slot->length;
+	}
+	else if (chd->codecintf->compress != NULL)
 		err = (*chd->codecintf->compress)(chd, src, &bytes);
 
 	/* if that worked, and we're lossy, decompress and CRC the result */
@@ -2072,7 +2687,7 @@ static chd_error hunk_write_from_memory(chd_file *chd, UINT32 hunknum, const UIN
 	/* if we succeeded in compressing the data, replace our data pointer and mark it so */
 	if (err == CHDERR_NONE)
 	{
-		data = chd->compressed;
+		data = (slot != NULL) ? slot->codec.compressed : chd->compressed;
 		newentry.length = bytes;
 		newentry.flags = MAP_ENTRY_TYPE_COMPRESSED;
 	}
@@ -196,6 +196,9 @@
 #define CHD_OPEN_READ				1
 #define CHD_OPEN_READWRITE			2
 
+/* decompressed hunks chd_read keeps by default */
+#define CHD_DEFAULT_CACHE_HUNKS		16
+
 /* error types */
 enum _chd_error
 {
@@ -337,6 +340,10 @@ chd_error chd_write_async(chd_file *chd, UINT32 hunknum, const void *buffer);
 /* wait for a previously issued async read/write to complete and return the error */
 chd_error chd_async_complete(chd_file *chd);
 
+/* set how many decompressed hunks chd_read keeps, and reads ahead into, for this
+   file (0 disables); a parent must not be read directly while a child is in use */
+chd_error chd_set_cache_size(chd_file *chd, UINT32 hunks);
+
 
 
 /* ----- metadata management ----- */
@@ -357,7 +364,8 @@ chd_error chd_clone_metadata(chd_file *source, chd_file *dest);
 /* begin compressing data to a CHD */
 chd_error chd_compress_begin(chd_file *chd);
 
-/* compress the next hunk of data */
+/* compress the next hunk of data; this is done on all processors, so an error */
+/* may belong to an earlier hunk, and curratio trails the hunks given so far */
 chd_error chd_compress_hunk(chd_file *chd, const void *data, double *curratio);
 
 /* finish compressing data to a CHD */
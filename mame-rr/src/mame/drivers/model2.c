@@ -88,6 +88,7 @@
 
 #include "emu.h"
 #include "deprecat.h"
+#include "profiler.h"
 #include "machine/eeprom.h"
 #include "video/segaic24.h"
 #include "cpu/i960/i960.h"
@@ -127,6 +128,10 @@ static int dsp_type;
 
 
 
+/* profiler counters for the copro FIFOs */
+static int prof_fifoin_words, prof_fifoin_depth;
+static int prof_fifoout_words, prof_fifoout_depth;
+
 #define COPRO_FIFOIN_SIZE	32000
 static int copro_fifoin_rpos, copro_fifoin_wpos;
 static UINT32 copro_fifoin_data[COPRO_FIFOIN_SIZE];
@@ -186,6 +191,8 @@ static void copro_fifoin_push(running_device *device, UINT32 data)
 	}
 
 	copro_fifoin_num++;
+	profiler_counter_add(prof_fifoin_words, 1);
+	profiler_counter_max(prof_fifoin_depth, copro_fifoin_num);
 
 	// clear FIFO empty flag on SHARC
 	if (dsp_type == DSP_TYPE_SHARC)
@@ -259,6 +266,8 @@ static void copro_fifoout_push(running_device *device, UINT32 data)
 	}
 
 	copro_fifoout_num++;
+	profiler_counter_add(prof_fifoout_words, 1);
+	profiler_counter_max(prof_fifoout_depth, copro_fifoout_num);
 
 	// set SHARC flag 1: 0 if space available, 1 if FIFO full
 	if (dsp_type == DSP_TYPE_SHARC)
@@ -380,6 +389,11 @@ static MACHINE_RESET(model2_common)
 	model2_timers[3] = machine->device<timer_device>("timer3");
 	for (i=0; i<4; i++)
 		model2_timers[i]->reset();
+
+	prof_fifoin_words = profiler_counter_register("Model 2", "copro FIFO in words");
+	prof_fifoin_depth = profiler_counter_register("Model 2", "copro FIFO in peak depth");
+	prof_fifoout_words = profiler_counter_register("Model 2", "copro FIFO out words");
+	prof_fifoout_depth = profiler_counter_register("Model 2", "copro FIFO out peak depth");
 }
 
 static MACHINE_RESET(model2o)
@@ -216,7 +216,7 @@ void K001005_init(running_machine *machine)
 
 	K001005_3d_fifo = auto_alloc_array(machine, UINT32, 0x10000);
 
-	poly = poly_alloc(machine, 4000, sizeof(poly_extra_data), POLYFLAG_ALLOW_QUADS);
+	poly = poly_alloc(machine, 4000, sizeof(poly_extra_data), POLYFLAG_ALLOW_QUADS | POLYFLAG_DEFERRED);
 	machine->add_notifier(MACHINE_NOTIFY_EXIT, K001005_exit);
 
 	for (i=0; i < 128; i++)
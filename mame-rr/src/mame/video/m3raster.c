@@ -17,6 +17,8 @@ static void draw_scanline_normal(void *dest, INT32 scanline, const poly_extent *
 	UINT32 width = 6 + texture->width;
 	int x;
 
+	profiler_counter_add(prof_pixels_normal, extent->stopx - extent->startx);
+
 	for (x = extent->startx; x < extent->stopx; x++)
 	{
 		UINT32 iz = ooz * 256.0f;
@@ -67,6 +69,8 @@ static void draw_scanline_trans(void *dest, INT32 scanline, const poly_extent *e
 	UINT32 width = 6 + texture->width;
 	int x;
 
+	profiler_counter_add(prof_pixels_trans, extent->stopx - extent->startx);
+
 	for (x = extent->startx; x < extent->stopx; x++)
 	{
 		UINT32 iz = ooz * 256.0f;
@@ -122,6 +126,8 @@ static void draw_scanline_alpha(void *dest, INT32 scanline, const poly_extent *e
 	UINT32 width = 6 + texture->width;
 	int x;
 
+	profiler_counter_add(prof_pixels_alpha, extent->stopx - extent->startx);
+
 	for (x = extent->startx; x < extent->stopx; x++)
 	{
 		UINT32 iz = ooz * 256.0f;
@@ -180,6 +186,8 @@ static void draw_scanline_alpha_test(void *dest, INT32 scanline, const poly_exte
 	UINT32 width = 6 + texture->width;
 	int x;
 
+	profiler_counter_add(prof_pixels_alpha_test, extent->stopx - extent->startx);
+
 	for (x = extent->startx; x < extent->stopx; x++)
 	{
 		UINT32 iz = ooz * 256.0f;
@@ -233,6 +241,8 @@ static void draw_scanline_color(void *dest, INT32 scanline, const poly_extent *e
 	int fb = extra->color & 0x001f;
 	int x;
 
+	profiler_counter_add(prof_pixels_color, extent->stopx - extent->startx);
+
 	// apply intensity
 	fr = (fr * extra->polygon_intensity) >> 8;
 	fg = (fg * extra->polygon_intensity) >> 8;
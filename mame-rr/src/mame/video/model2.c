@@ -86,6 +86,7 @@
 
 *********************************************************************************************************************************/
 #include "emu.h"
+#include "profiler.h"
 #include "video/segaic24.h"
 #include "video/poly.h"
 #include "includes/model2.h"
@@ -94,6 +95,22 @@
 
 static poly_manager *poly;
 
+/* profiler counters; geometry decode is timed as User 1 and the 3D frame as User 2 */
+static int prof_polys_in, prof_polys_culled, prof_polys_clipped, prof_tris_out;
+static int prof_pixels[8];
+
+static const char *const prof_pixel_names[8] =
+{
+	"pixels flat",
+	"pixels flat translucent",
+	"pixels textured",
+	"pixels textured translucent",
+	"pixels checker flat",
+	"pixels checker flat translucent",
+	"pixels checker textured",
+	"pixels checker textured translucent"
+};
+
 #define pz		p[0]
 #define pu		p[1]
 #define pv		p[2]
@@ -247,7 +264,7 @@ static INT32 clip_polygon(poly_vertex *v, INT32 num_vertices, plane *cp, poly_ve
 {
 	poly_vertex *cur, *out;
 	float	curdot, nextdot, scale;
-	INT32	i, curin, nextin, nextvert, outcount;
+	INT32	i, curin, nextin, nextvert, outcount, allin;
 
 	outcount = 0;
 
@@ -256,6 +273,7 @@ static INT32 clip_polygon(poly_vertex *v, INT32 num_vertices, plane *cp, poly_ve
 
 	curdot = dot_product( cur, &cp->normal );
 	curin = (curdot >= cp->distance) ? 1 : 0;
+	allin = curin;
 
 	for( i = 0; i < num_vertices; i++ )
 	{
@@ -266,6 +284,7 @@ static INT32 clip_polygon(poly_vertex *v, INT32 num_vertices, plane *cp, poly_ve
 
 		nextdot = dot_product( &v[nextvert], &cp->normal );
 		nextin = (nextdot >= cp->distance) ? 1 : 0;
+		allin &= nextin;
 
 		/* Add a clipped vertex if one end of the current edge is inside the plane and the other is outside */
         if ( curin != nextin )
@@ -285,6 +304,10 @@ static INT32 clip_polygon(poly_vertex *v, INT32 num_vertices, plane *cp, poly_ve
         cur++;
 	}
 
+	/* count it even when the clipped polygon keeps its vertex count */
+	if ( !allin )
+		profiler_counter_add( prof_polys_clipped, 1 );
+
 	return outcount;
 }
 
@@ -367,6 +390,8 @@ static void model2_3d_process_quad( UINT32 attr )
 	float		zvalue;
 	float		min_z, max_z;
 
+	profiler_counter_add( prof_polys_in, 1 );
+
 	/* extract P0(n-1) */
 	object.v[1].x = u2f( raster.command_buffer[2] << 8 );
 	object.v[1].y = u2f( raster.command_buffer[3] << 8 );
@@ -483,7 +508,9 @@ static void model2_3d_process_quad( UINT32 attr )
 		raster.triangle_z = zvalue;
 	}
 
-	if ( cull == 0 )
+	if ( cull != 0 )
+		profiler_counter_add( prof_polys_culled, 1 );
+	else
 	{
 		INT32		clipped_verts;
 		poly_vertex	verts[10];
@@ -562,6 +589,8 @@ static void model2_3d_process_quad( UINT32 attr )
 				ztri = tri;
 			}
 
+			profiler_counter_add( prof_tris_out, clipped_verts - 2 );
+
 			/* keep around the min and max z values for this frame */
 			if ( object.z < raster.min_z ) raster.min_z = object.z;
 			if ( object.z > raster.max_z ) raster.max_z = object.z;
@@ -607,6 +636,8 @@ static void model2_3d_process_triangle( UINT32 attr )
 	float		zvalue;
 	float		min_z, max_z;
 
+	profiler_counter_add( prof_polys_in, 1 );
+
 	/* extract P0(n-1) */
 	object.v[1].x = u2f( raster.command_buffer[2] << 8 );
 	object.v[1].y = u2f( raster.command_buffer[3] << 8 );
@@ -720,7 +751,9 @@ static void model2_3d_process_triangle( UINT32 attr )
 	}
 
 	/* if we're not culling, do z-clip and add to out triangle list */
-	if ( cull == 0 )
+	if ( cull != 0 )
+		profiler_counter_add( prof_polys_culled, 1 );
+	else
 	{
 		INT32		clipped_verts;
 		poly_vertex	verts[10];
@@ -799,6 +832,8 @@ static void model2_3d_process_triangle( UINT32 attr )
 				ztri = tri;
 			}
 
+			profiler_counter_add( prof_tris_out, clipped_verts - 2 );
+
 			/* keep around the min and max z values for this frame */
 			if ( object.z < raster.min_z ) raster.min_z = object.z;
 			if ( object.z > raster.max_z ) raster.max_z = object.z;
@@ -2693,11 +2728,12 @@ VIDEO_START(model2)
 	const rectangle &visarea = machine->primary_screen->visible_area();
 	int	width = visarea.max_x - visarea.min_x;
 	int	height = visarea.max_y - visarea.min_y;
+	int i;
 
 	sys24_tile_vh_start(machine, 0x3fff);
 	sys24_bitmap = auto_alloc(machine, bitmap_t(width, height+4, BITMAP_FORMAT_INDEXED16));
 
-	poly = poly_alloc(machine, 4000, sizeof(poly_extra_data), 0);
+	poly = poly_alloc(machine, 4000, sizeof(poly_extra_data), POLYFLAG_DEFERRED);
 	machine->add_notifier(MACHINE_NOTIFY_EXIT, model2_exit);
 
 	/* initialize the geometry engine */
@@ -2705,6 +2741,14 @@ VIDEO_START(model2)
 
 	/* initialize the hardware rasterizer */
 	model2_3d_init( machine, (UINT16*)memory_region(machine, "user3") );
+
+	/* register the profiler counters */
+	prof_polys_in = profiler_counter_register("Model 2", "polygons in");
+	prof_polys_culled = profiler_counter_register("Model 2", "polygons culled");
+	prof_polys_clipped = profiler_counter_register("Model 2", "polygons z-clipped");
+	prof_tris_out = profiler_counter_register("Model 2", "triangles out");
+	for (i = 0; i < 8; i++)
+		prof_pixels[i] = profiler_counter_register("Model 2", prof_pixel_names[i]);
 }
 
 static void convert_bitmap( running_machine *machine, bitmap_t *dst, bitmap_t *src, const rectangle *rect )
@@ -2742,10 +2786,14 @@ VIDEO_UPDATE(model2)
 	model2_3d_frame_start();
 
 	/* let the geometry engine do it's thing */
+	profiler_mark_start(PROFILER_USER1);
 	geo_parse();
+	profiler_mark_end();
 
 	/* have the rasterizer output the frame */
+	profiler_mark_start(PROFILER_USER2);
 	model2_3d_frame_end( bitmap, cliprect );
+	profiler_mark_end();
 
 	bitmap_fill(sys24_bitmap, cliprect, 0);
 	sys24_tile_draw(screen->machine, sys24_bitmap, cliprect, 3, 0, 0);
@@ -96,6 +96,8 @@ static void MODEL2_FUNC_NAME(void *dest, INT32 scanline, const poly_extent *exte
 	/* build the final color */
 	color = MAKE_RGB(tr, tg, tb);
 
+	profiler_counter_add(prof_pixels[MODEL2_FUNC], extent->stopx - extent->startx);
+
 	for(x = extent->startx; x < extent->stopx; x++)
 #if defined(MODEL2_CHECKER)
 		if ((x^scanline) & 1) p[x] = color;
@@ -147,6 +149,8 @@ static void MODEL2_FUNC_NAME(void *dest, INT32 scanline, const poly_extent *exte
 	colortable_g += ((colorbase >>  5) & 0x1f) << 8;
 	colortable_b += ((colorbase >> 10) & 0x1f) << 8;
 
+	profiler_counter_add(prof_pixels[MODEL2_FUNC], extent->stopx - extent->startx);
+
 	for(x = extent->startx; x < extent->stopx; x++, uoz += duoz, voz += dvoz, ooz += dooz)
 	{
 		float z = recip_approx(ooz) * 256.0f;
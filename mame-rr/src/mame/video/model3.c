@@ -1,4 +1,5 @@
 #include "emu.h"
+#include "profiler.h"
 #include "video/poly.h"
 #include "video/rgbutil.h"
 #include "includes/model3.h"
@@ -113,6 +114,10 @@ static float ambient_light_intensity;
 static poly_manager *poly;
 static cached_texture *texcache[2][1024/32][2048/32];
 
+/* profiler counters; display list traversal is timed as User 1 */
+static int prof_polys_in, prof_polys_culled, prof_polys_clipped, prof_tris_out;
+static int prof_pixels_normal, prof_pixels_trans, prof_pixels_alpha, prof_pixels_alpha_test, prof_pixels_color;
+
 
 static int list_depth = 0;
 
@@ -164,7 +169,7 @@ VIDEO_START( model3 )
 {
 	int width, height;
 
-	poly = poly_alloc(machine, 4000, sizeof(poly_extra_data), 0);
+	poly = poly_alloc(machine, 4000, sizeof(poly_extra_data), POLYFLAG_DEFERRED);
 	machine->add_notifier(MACHINE_NOTIFY_EXIT, model3_exit);
 
 	width = machine->primary_screen->width();
@@ -201,6 +206,17 @@ VIDEO_START( model3 )
 	viewport_region_height = 384;
 
 	init_matrix_stack();
+
+	/* register the profiler counters */
+	prof_polys_in = profiler_counter_register("Model 3", "polygons in");
+	prof_polys_culled = profiler_counter_register("Model 3", "polygons culled");
+	prof_polys_clipped = profiler_counter_register("Model 3", "polygon/plane clips");
+	prof_tris_out = profiler_counter_register("Model 3", "triangles out");
+	prof_pixels_normal = profiler_counter_register("Model 3", "pixels textured");
+	prof_pixels_trans = profiler_counter_register("Model 3", "pixels textured translucent");
+	prof_pixels_alpha = profiler_counter_register("Model 3", "pixels textured alpha");
+	prof_pixels_alpha_test = profiler_counter_register("Model 3", "pixels textured alpha test");
+	prof_pixels_color = profiler_counter_register("Model 3", "pixels flat");
 }
 
 static void draw_tile_4bit(bitmap_t *bitmap, int tx, int ty, int tilenum)
@@ -1027,6 +1043,7 @@ static int clip_polygon(const poly_vertex *v, int num_vertices, PLANE cp, poly_v
 {
 	poly_vertex clipv[10];
 	int clip_verts = 0;
+	int all_in = TRUE;
 	float t;
 	int i;
 
@@ -1036,6 +1053,7 @@ static int clip_polygon(const poly_vertex *v, int num_vertices, PLANE cp, poly_v
 	{
 		int v1_in = is_point_inside(v[i].x, v[i].y, v[i].pz, cp);
 		int v2_in = is_point_inside(v[previ].x, v[previ].y, v[previ].pz, cp);
+		all_in &= v1_in;
 
 		if (v1_in && v2_in)			/* edge is completely inside the volume */
 		{
@@ -1071,6 +1089,11 @@ static int clip_polygon(const poly_vertex *v, int num_vertices, PLANE cp, poly_v
 
 		previ = i;
 	}
+
+	/* count it even when the clipped polygon keeps its vertex count */
+	if (!all_in)
+		profiler_counter_add(prof_polys_clipped, 1);
+
 	memcpy(&vout[0], &clipv[0], sizeof(vout[0]) * clip_verts);
 	return clip_verts;
 }
@@ -1237,6 +1260,7 @@ static void draw_model(running_machine *machine, UINT32 addr)
 		}
 
 		/* clip against view frustum */
+		profiler_counter_add(prof_polys_in, 1);
 		num_vertices = clip_polygon(clip_vert, num_vertices, clip_plane[0], clip_vert);
 		num_vertices = clip_polygon(clip_vert, num_vertices, clip_plane[1], clip_vert);
 		num_vertices = clip_polygon(clip_vert, num_vertices, clip_plane[2], clip_vert);
@@ -1253,7 +1277,9 @@ static void draw_model(running_machine *machine, UINT32 addr)
 		else
 			back_face = 0;	//no culling for transparent or two-sided polygons
 
-		if(!back_face)	{
+		if(back_face)
+			profiler_counter_add(prof_polys_culled, 1);
+		else {
 			/* homogeneous Z-divide, screen-space transformation */
 			for(i=0; i < num_vertices; i++) {
 				float ooz = 1.0f / clip_vert[i].pz;
@@ -1281,6 +1307,9 @@ static void draw_model(running_machine *machine, UINT32 addr)
 				intensity = 256;
 			}
 
+			if (num_vertices > 2)
+				profiler_counter_add(prof_tris_out, num_vertices - 2);
+
 			for (i=2; i < num_vertices; i++)
 			{
 				memcpy(&tri.v[0], &clip_vert[0], sizeof(poly_vertex));
@@ -1519,9 +1548,13 @@ static void real3d_traverse_display_list(running_machine *machine)
 
 	init_matrix_stack();
 
+	profiler_mark_start(PROFILER_USER1);
+
 	for (pri = 0; pri < 4; pri++)
 		draw_viewport(machine, pri, 0x800000);
 
 	poly_wait(poly, "real3d_traverse_display_list");
+
+	profiler_mark_end();
 }
 
@@ -2221,9 +2221,9 @@ static VIDEO_START( common )
 	mpPolyH = mpPolyM + mPtRomSize;
 
 #ifdef RENDER_AS_QUADS
-	poly = poly_alloc(machine, 4000, sizeof(poly_extra_data), POLYFLAG_ALLOW_QUADS);
+	poly = poly_alloc(machine, 4000, sizeof(poly_extra_data), POLYFLAG_ALLOW_QUADS | POLYFLAG_DEFERRED);
 #else
-	poly = poly_alloc(machine, 4000, sizeof(poly_extra_data), 0);
+	poly = poly_alloc(machine, 4000, sizeof(poly_extra_data), POLYFLAG_DEFERRED);
 #endif
 	machine->add_notifier(MACHINE_NOTIFY_RESET, namcos22_reset);
 	machine->add_notifier(MACHINE_NOTIFY_EXIT, namcos22_exit);
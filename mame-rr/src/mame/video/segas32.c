@@ -144,6 +144,7 @@
 #include "emu.h"
 #include "profiler.h"
 #include "includes/segas32.h"
+#include "video/layerjob.h"
 
 
 
@@ -213,6 +214,14 @@ struct extents_list
 };
 
 
+struct nbg_job
+{
+	struct layer_info *		layer;
+	int						bgnum;
+	bitmap_t *				pixmaps[4];
+};
+
+
 struct cache_entry
 {
 	struct cache_entry *	next;
@@ -254,6 +263,10 @@ static UINT16 mixer_control[2][0x40];
 static UINT16 *solid_0000;
 static UINT16 *solid_ffff;
 
+/* layer rendering jobs */
+static layer_jobs *layer_job_set;
+static struct nbg_job nbg_jobs[4];
+
 /* sprite data */
 static UINT8 sprite_render_count;
 static UINT8 sprite_control_latched[8];
@@ -282,6 +295,12 @@ static void sprite_render_list(running_machine *machine);
  *
  *************************************/
 
+static void common_exit(running_machine &machine)
+{
+	layer_jobs_free(layer_job_set);
+}
+
+
 static void common_start(running_machine *machine, int multi32)
 {
 	int tmap;
@@ -320,6 +339,10 @@ static void common_start(running_machine *machine, int multi32)
 	solid_ffff = auto_alloc_array(machine, UINT16, 512);
 	memset(solid_ffff, 0xff, sizeof(solid_ffff[0]) * 512);
 
+	/* the seven layers can all be rendered independently */
+	layer_job_set = layer_jobs_alloc(machine, 7);
+	machine->add_notifier(MACHINE_NOTIFY_EXIT, common_exit);
+
 	/* initialize videoram */
 	system32_videoram[0x1ff00/2] = 0x8000;
 }
@@ -936,21 +959,29 @@ INLINE void get_tilemaps(int bgnum, tilemap_t **tilemaps)
 }
 
 
-static void update_tilemap_zoom(screen_device &screen, struct layer_info *layer, const rectangle *cliprect, int bgnum)
+INLINE void get_pixmaps(int bgnum, bitmap_t **pixmaps)
+{
+	tilemap_t *tilemaps[4];
+	int pagenum;
+
+	/* bring all four pages up to date so the layer can render them on any thread */
+	get_tilemaps(bgnum, tilemaps);
+	for (pagenum = 0; pagenum < 4; pagenum++)
+		pixmaps[pagenum] = tilemap_get_pixmap(tilemaps[pagenum]);
+}
+
+
+static void update_tilemap_zoom(screen_device &screen, struct layer_info *layer, const rectangle *cliprect, int bgnum, bitmap_t **pixmaps)
 {
 	int clipenable, clipout, clips, clipdraw_start;
 	bitmap_t *bitmap = layer->bitmap;
 	struct extents_list clip_extents;
-	tilemap_t *tilemaps[4];
 	UINT32 srcx, srcx_start, srcy;
 	UINT32 srcxstep, srcystep;
 	int dstxstep, dstystep;
 	int flip, opaque;
 	int x, y;
 
-	/* get the tilemaps */
-	get_tilemaps(bgnum, tilemaps);
-
 	/* configure the layer */
 	opaque = 0;
 //opaque = (system32_videoram[0x1ff8e/2] >> (8 + bgnum)) & 1;
@@ -1023,8 +1054,8 @@ static void update_tilemap_zoom(screen_device &screen, struct layer_info *layer,
 			UINT16 *src[2];
 
 			/* look up the pages and get their source pixmaps */
-			tm0 = tilemap_get_pixmap(tilemaps[((srcy >> 27) & 2) + 0]);
-			tm1 = tilemap_get_pixmap(tilemaps[((srcy >> 27) & 2) + 1]);
+			tm0 = pixmaps[((srcy >> 27) & 2) + 0];
+			tm1 = pixmaps[((srcy >> 27) & 2) + 1];
 			src[0] = BITMAP_ADDR16(tm0, (srcy >> 20) & 0xff, 0);
 			src[1] = BITMAP_ADDR16(tm1, (srcy >> 20) & 0xff, 0);
 
@@ -1089,12 +1120,11 @@ static void update_tilemap_zoom(screen_device &screen, struct layer_info *layer,
  *
  *************************************/
 
-static void update_tilemap_rowscroll(screen_device &screen, struct layer_info *layer, const rectangle *cliprect, int bgnum)
+static void update_tilemap_rowscroll(screen_device &screen, struct layer_info *layer, const rectangle *cliprect, int bgnum, bitmap_t **pixmaps)
 {
 	int clipenable, clipout, clips, clipdraw_start;
 	bitmap_t *bitmap = layer->bitmap;
 	struct extents_list clip_extents;
-	tilemap_t *tilemaps[4];
 	int rowscroll, rowselect;
 	int xscroll, yscroll;
 	UINT16 *table;
@@ -1102,9 +1132,6 @@ static void update_tilemap_rowscroll(screen_device &screen, struct layer_info *l
 	int flip, opaque;
 	int x, y;
 
-	/* get the tilemaps */
-	get_tilemaps(bgnum, tilemaps);
-
 	/* configure the layer */
 	opaque = 0;
 //opaque = (system32_videoram[0x1ff8e/2] >> (8 + bgnum)) & 1;
@@ -1181,8 +1208,8 @@ static void update_tilemap_rowscroll(screen_device &screen, struct layer_info *l
 			}
 
 			/* look up the pages and get their source pixmaps */
-			tm0 = tilemap_get_pixmap(tilemaps[((srcy >> 7) & 2) + 0]);
-			tm1 = tilemap_get_pixmap(tilemaps[((srcy >> 7) & 2) + 1]);
+			tm0 = pixmaps[((srcy >> 7) & 2) + 0];
+			tm1 = pixmaps[((srcy >> 7) & 2) + 1];
 			src[0] = BITMAP_ADDR16(tm0, srcy & 0xff, 0);
 			src[1] = BITMAP_ADDR16(tm1, srcy & 0xff, 0);
 
@@ -1527,6 +1554,50 @@ static void update_background(struct layer_info *layer, const rectangle *cliprec
 }
 
 
+static void render_nbg_zoom(screen_device *screen, void *param, const rectangle *cliprect, int threadid)
+{
+	struct nbg_job *job = (struct nbg_job *)param;
+	update_tilemap_zoom(*screen, job->layer, cliprect, job->bgnum, job->pixmaps);
+}
+
+
+static void render_nbg_rowscroll(screen_device *screen, void *param, const rectangle *cliprect, int threadid)
+{
+	struct nbg_job *job = (struct nbg_job *)param;
+	update_tilemap_rowscroll(*screen, job->layer, cliprect, job->bgnum, job->pixmaps);
+}
+
+
+static void render_text(screen_device *screen, void *param, const rectangle *cliprect, int threadid)
+{
+	update_tilemap_text(*screen, (struct layer_info *)param, cliprect);
+}
+
+
+static void render_bitmap(screen_device *screen, void *param, const rectangle *cliprect, int threadid)
+{
+	update_bitmap(*screen, (struct layer_info *)param, cliprect);
+}
+
+
+static void render_background(screen_device *screen, void *param, const rectangle *cliprect, int threadid)
+{
+	update_background((struct layer_info *)param, cliprect);
+}
+
+
+static void add_nbg_job(layer_render_func render, int layernum, int bgnum)
+{
+	struct nbg_job *job = &nbg_jobs[bgnum];
+
+	/* the tilemap cache and lazy tile updates aren't thread safe, so resolve them here */
+	job->layer = &layer_data[layernum];
+	job->bgnum = bgnum;
+	get_pixmaps(bgnum, job->pixmaps);
+	layer_jobs_add(layer_job_set, render, job);
+}
+
+
 static UINT8 update_tilemaps(screen_device &screen, const rectangle *cliprect)
 {
 	int enable0 = !(system32_videoram[0x1ff02/2] & 0x0001) && !(system32_videoram[0x1ff8e/2] & 0x0002);
@@ -1536,20 +1607,23 @@ static UINT8 update_tilemaps(screen_device &screen, const rectangle *cliprect)
 	int enablet = !(system32_videoram[0x1ff02/2] & 0x0010) && !(system32_videoram[0x1ff8e/2] & 0x0001);
 	int enableb = !(system32_videoram[0x1ff02/2] & 0x0020) && !(system32_videoram[0x1ff8e/2] & 0x0020);
 
-	/* update any tilemaps */
+	/* queue up any tilemaps; each renders only into its own layer */
 	if (enable0)
-		update_tilemap_zoom(screen, &layer_data[MIXER_LAYER_NBG0], cliprect, 0);
+		add_nbg_job(render_nbg_zoom, MIXER_LAYER_NBG0, 0);
 	if (enable1)
-		update_tilemap_zoom(screen, &layer_data[MIXER_LAYER_NBG1], cliprect, 1);
+		add_nbg_job(render_nbg_zoom, MIXER_LAYER_NBG1, 1);
 	if (enable2)
-		update_tilemap_rowscroll(screen, &layer_data[MIXER_LAYER_NBG2], cliprect, 2);
+		add_nbg_job(render_nbg_rowscroll, MIXER_LAYER_NBG2, 2);
 	if (enable3)
-		update_tilemap_rowscroll(screen, &layer_data[MIXER_LAYER_NBG3], cliprect, 3);
+		add_nbg_job(render_nbg_rowscroll, MIXER_LAYER_NBG3, 3);
 	if (enablet)
-		update_tilemap_text(screen, &layer_data[MIXER_LAYER_TEXT], cliprect);
+		layer_jobs_add(layer_job_set, render_text, &layer_data[MIXER_LAYER_TEXT]);
 	if (enableb)
-		update_bitmap(screen, &layer_data[MIXER_LAYER_BITMAP], cliprect);
-	update_background(&layer_data[MIXER_LAYER_BACKGROUND], cliprect);
+		layer_jobs_add(layer_job_set, render_bitmap, &layer_data[MIXER_LAYER_BITMAP]);
+	layer_jobs_add(layer_job_set, render_background, &layer_data[MIXER_LAYER_BACKGROUND]);
+
+	/* render them all before the mixer gets to look at them */
+	layer_jobs_run(layer_job_set, &screen, cliprect);
 
 	return (enablet << 0) | (enable0 << 1) | (enable1 << 2) | (enable2 << 3) | (enable3 << 4) | (enableb << 5);
 }
@@ -354,6 +354,106 @@ int osd_is_absolute_path(const char *path);
 
 
 
+/***************************************************************************
+    SOCKET INTERFACES
+***************************************************************************/
+
+/* osd_socket is an opaque type which represents a TCP socket */
+typedef struct _osd_socket osd_socket;
+
+
+/*-----------------------------------------------------------------------------
+    osd_socket_listen: create a socket listening for connections on the
+        local machine
+
+    Parameters:
+
+        port - the TCP port to listen on
+
+    Return value:
+
+        a pointer to an osd_socket, or NULL if sockets are not supported
+        or the port could not be bound
+
+    Notes:
+
+        Only connections from the local machine need to be accepted.
+-----------------------------------------------------------------------------*/
+osd_socket *osd_socket_listen(int port);
+
+
+/*-----------------------------------------------------------------------------
+    osd_socket_accept: accept a pending connection without blocking
+
+    Parameters:
+
+        listener - an osd_socket returned by osd_socket_listen
+
+    Return value:
+
+        a pointer to an osd_socket for the new connection, or NULL if no
+        connection is pending
+-----------------------------------------------------------------------------*/
+osd_socket *osd_socket_accept(osd_socket *listener);
+
+
+/*-----------------------------------------------------------------------------
+    osd_socket_read: read whatever data is available without blocking
+
+    Parameters:
+
+        socket - an osd_socket returned by osd_socket_accept
+
+        buffer - pointer to memory that will receive the data read
+
+        length - the maximum number of bytes to read
+
+        actual - pointer to a UINT32 to receive the number of bytes actually
+            read, which is 0 if nothing is pending
+
+    Return value:
+
+        FILERR_NONE if the connection is still open, or another file_error
+        if it was closed or failed
+-----------------------------------------------------------------------------*/
+file_error osd_socket_read(osd_socket *socket, void *buffer, UINT32 length, UINT32 *actual);
+
+
+/*-----------------------------------------------------------------------------
+    osd_socket_write: write data, blocking until all of it has been sent
+
+    Parameters:
+
+        socket - an osd_socket returned by osd_socket_accept
+
+        buffer - pointer to the data to write
+
+        length - the number of bytes to write
+
+    Return value:
+
+        FILERR_NONE if all the data was written, or another file_error if
+        the connection was closed or failed
+-----------------------------------------------------------------------------*/
+file_error osd_socket_write(osd_socket *socket, const void *buffer, UINT32 length);
+
+
+/*-----------------------------------------------------------------------------
+    osd_socket_close: close a socket
+
+    Parameters:
+
+        socket - an osd_socket returned by osd_socket_listen or
+            osd_socket_accept
+
+    Return value:
+
+        None
+-----------------------------------------------------------------------------*/
+void osd_socket_close(osd_socket *socket);
+
+
+
 /***************************************************************************
     TIMING INTERFACES
 ***************************************************************************/
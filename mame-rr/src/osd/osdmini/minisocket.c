@@ -0,0 +1,93 @@
+//============================================================
+//
+//  minisocket.c - Minimal core socket functions
+//
+//============================================================
+//
+//  Copyright Aaron Giles
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or
+//  without modification, are permitted provided that the
+//  following conditions are met:
+//
+//    * Redistributions of source code must retain the above
+//      copyright notice, this list of conditions and the
+//      following disclaimer.
+//    * Redistributions in binary form must reproduce the
+//      above copyright notice, this list of conditions and
+//      the following disclaimer in the documentation and/or
+//      other materials provided with the distribution.
+//    * Neither the name 'MAME' nor the names of its
+//      contributors may be used to endorse or promote
+//      products derived from this software without specific
+//      prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY AARON GILES ''AS IS'' AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+//  EVENT SHALL AARON GILES BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//  DAMAGE (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+//  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+//  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+//  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+//  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//============================================================
+
+#include "osdcore.h"
+
+
+//============================================================
+//  osd_socket_listen
+//============================================================
+
+osd_socket *osd_socket_listen(int port)
+{
+	// no sockets in the minimal OSD
+	return NULL;
+}
+
+
+//============================================================
+//  osd_socket_accept
+//============================================================
+
+osd_socket *osd_socket_accept(osd_socket *listener)
+{
+	return NULL;
+}
+
+
+//============================================================
+//  osd_socket_read
+//============================================================
+
+file_error osd_socket_read(osd_socket *socket, void *buffer, UINT32 length, UINT32 *actual)
+{
+	*actual = 0;
+	return FILERR_FAILURE;
+}
+
+
+//============================================================
+//  osd_socket_write
+//============================================================
+
+file_error osd_socket_write(osd_socket *socket, const void *buffer, UINT32 length)
+{
+	return FILERR_FAILURE;
+}
+
+
+//============================================================
+//  osd_socket_close
+//============================================================
+
+void osd_socket_close(osd_socket *socket)
+{
+}
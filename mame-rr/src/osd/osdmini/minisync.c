@@ -41,6 +41,20 @@
 
 #include "osdcore.h"
 
+#include <stdlib.h>
+#include <pthread.h>
+
+
+//============================================================
+//  TYPE DEFINITIONS
+//============================================================
+
+struct _osd_lock
+{
+	pthread_mutex_t		mutex;
+};
+
+
 
 //============================================================
 //  osd_lock_alloc
@@ -48,9 +62,20 @@
 
 osd_lock *osd_lock_alloc(void)
 {
-	// the minimal implementation does not support threading
-	// just return a dummy value here
-	return (osd_lock *)1;
+	pthread_mutexattr_t attr;
+	osd_lock *lock;
+
+	// work items run on their own threads now, so these need to be real;
+	// the same thread is allowed to take a lock more than once
+	lock = (osd_lock *)malloc(sizeof(*lock));
+	if (lock == NULL)
+		return NULL;
+
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&lock->mutex, &attr);
+	pthread_mutexattr_destroy(&attr);
+	return lock;
 }
 
 
@@ -60,8 +85,7 @@ osd_lock *osd_lock_alloc(void)
 
 void osd_lock_acquire(osd_lock *lock)
 {
-	// the minimal implementation does not support threading
-	// the acquire always "succeeds"
+	pthread_mutex_lock(&lock->mutex);
 }
 
 
@@ -71,9 +95,7 @@ void osd_lock_acquire(osd_lock *lock)
 
 int osd_lock_try(osd_lock *lock)
 {
-	// the minimal implementation does not support threading
-	// the acquire always "succeeds"
-	return TRUE;
+	return (pthread_mutex_trylock(&lock->mutex) == 0);
 }
 
 
@@ -83,8 +105,7 @@ int osd_lock_try(osd_lock *lock)
 
 void osd_lock_release(osd_lock *lock)
 {
-	// the minimal implementation does not support threading
-	// do nothing here
+	pthread_mutex_unlock(&lock->mutex);
 }
 
 
@@ -94,6 +115,6 @@ void osd_lock_release(osd_lock *lock)
 
 void osd_lock_free(osd_lock *lock)
 {
-	// the minimal implementation does not support threading
-	// do nothing here
+	pthread_mutex_destroy(&lock->mutex);
+	free(lock);
 }
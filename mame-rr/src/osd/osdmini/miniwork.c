@@ -41,6 +41,21 @@
 
 #include "osdcore.h"
 
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+
+
+//============================================================
+//  PARAMETERS
+//============================================================
+
+#define WORK_MAX_THREADS		16
+
+
 
 //============================================================
 //  TYPE DEFINITIONS
@@ -48,20 +63,96 @@
 
 struct _osd_work_item
 {
-	void *result;
+	osd_work_item *		next;			// pointer to next item
+	osd_work_queue *	queue;			// pointer back to the owning queue
+	osd_work_callback	callback;		// callback function
+	void *				param;			// callback parameter
+	void *				result;			// callback result
+	UINT32				flags;			// creation flags
+	int					done;			// is the item done?
+};
+
+
+struct _osd_work_queue
+{
+	pthread_mutex_t		lock;			// lock protecting everything below
+	pthread_cond_t		workcond;		// signalled when items are queued or on exit
+	pthread_cond_t		donecond;		// broadcast when an item completes
+	osd_work_item *		list;			// list of items in the queue
+	osd_work_item **	tailptr;		// pointer to the tail pointer of work items in the queue
+	osd_work_item *		free;			// free list of work items
+	int					items;			// items queued or running
+	int					exiting;		// should the threads exit on their next opportunity?
+	int					threads;		// number of threads in this queue
+	pthread_t			thread[WORK_MAX_THREADS];	// the threads themselves
+	UINT32				flags;			// creation flags
+};
+
+
+typedef struct _work_thread_info work_thread_info;
+struct _work_thread_info
+{
+	osd_work_queue *	queue;			// the queue we serve
+	int					threadid;		// our index, as passed to callbacks
 };
 
 
 
+//============================================================
+//  FUNCTION PROTOTYPES
+//============================================================
+
+static void *worker_thread_entry(void *param);
+static int worker_run_one(osd_work_queue *queue, int threadid);
+static void compute_deadline(struct timespec *deadline, osd_ticks_t timeout);
+
+
+
 //============================================================
 //  osd_work_queue_alloc
 //============================================================
 
 osd_work_queue *osd_work_queue_alloc(int flags)
 {
-	// this minimal implementation doesn't need to keep any state
-	// so we just return a non-NULL pointer
-	return (osd_work_queue *)1;
+	long numprocs = sysconf(_SC_NPROCESSORS_ONLN);
+	osd_work_queue *queue;
+	int threads, threadnum;
+
+	// allocate a new queue
+	queue = (osd_work_queue *)malloc(sizeof(*queue));
+	if (queue == NULL)
+		return NULL;
+	memset(queue, 0, sizeof(*queue));
+	queue->tailptr = &queue->list;
+	queue->flags = flags;
+	pthread_mutex_init(&queue->lock, NULL);
+	pthread_cond_init(&queue->workcond, NULL);
+	pthread_cond_init(&queue->donecond, NULL);
+
+	// one thread for I/O queues, (n-1) for multi queues since the caller helps
+	// out, and one for everything else; with no threads we run synchronously
+	if (numprocs <= 1)
+		threads = (flags & WORK_QUEUE_FLAG_IO) ? 1 : 0;
+	else
+		threads = (flags & WORK_QUEUE_FLAG_MULTI) ? (int)(numprocs - 1) : 1;
+	threads = MIN(threads, WORK_MAX_THREADS);
+
+	// start the threads; if we can't start them all, make do with what we got
+	for (threadnum = 0; threadnum < threads; threadnum++)
+	{
+		work_thread_info *info = (work_thread_info *)malloc(sizeof(*info));
+		if (info == NULL)
+			break;
+		info->queue = queue;
+		info->threadid = threadnum;
+		if (pthread_create(&queue->thread[threadnum], NULL, worker_thread_entry, info) != 0)
+		{
+			free(info);
+			break;
+		}
+		queue->threads++;
+	}
+	return queue;
 }
 
 
@@ -71,8 +162,12 @@ osd_work_queue *osd_work_queue_alloc(int flags)
 
 int osd_work_queue_items(osd_work_queue *queue)
 {
-	// we never have pending items
-	return 0;
+	int items;
+
+	pthread_mutex_lock(&queue->lock);
+	items = queue->items;
+	pthread_mutex_unlock(&queue->lock);
+	return items;
 }
 
 
@@ -82,8 +177,23 @@ int osd_work_queue_items(osd_work_queue *queue)
 
 int osd_work_queue_wait(osd_work_queue *queue, osd_ticks_t timeout)
 {
-	// never anything to wait for, so do nothing
-	return TRUE;
+	struct timespec deadline;
+	int result;
+
+	// if this is a multi queue, help out rather than doing nothing
+	if (queue->flags & WORK_QUEUE_FLAG_MULTI)
+		while (worker_run_one(queue, queue->threads))
+			;
+
+	// wait for whatever the threads are still running
+	compute_deadline(&deadline, timeout);
+	pthread_mutex_lock(&queue->lock);
+	while (queue->items != 0)
+		if (pthread_cond_timedwait(&queue->donecond, &queue->lock, &deadline) == ETIMEDOUT)
+			break;
+	result = (queue->items == 0);
+	pthread_mutex_unlock(&queue->lock);
+	return result;
 }
 
 
@@ -93,7 +203,34 @@ int osd_work_queue_wait(osd_work_queue *queue, osd_ticks_t timeout)
 
 void osd_work_queue_free(osd_work_queue *queue)
 {
-	// never allocated anything, so nothing to do
+	int threadnum;
+
+	// signal all the threads to exit and wait for them to go away
+	pthread_mutex_lock(&queue->lock);
+	queue->exiting = TRUE;
+	pthread_cond_broadcast(&queue->workcond);
+	pthread_mutex_unlock(&queue->lock);
+	for (threadnum = 0; threadnum < queue->threads; threadnum++)
+		pthread_join(queue->thread[threadnum], NULL);
+
+	// free all items in the free list and anything left unprocessed
+	while (queue->free != NULL)
+	{
+		osd_work_item *item = queue->free;
+		queue->free = item->next;
+		free(item);
+	}
+	while (queue->list != NULL)
+	{
+		osd_work_item *item = queue->list;
+		queue->list = item->next;
+		free(item);
+	}
+
+	pthread_cond_destroy(&queue->donecond);
+	pthread_cond_destroy(&queue->workcond);
+	pthread_mutex_destroy(&queue->lock);
+	free(queue);
 }
 
 
@@ -103,31 +240,63 @@ void osd_work_queue_free(osd_work_queue *queue)
 
 osd_work_item *osd_work_item_queue_multiple(osd_work_queue *queue, osd_work_callback callback, INT32 numitems, void *parambase, INT32 paramstep, UINT32 flags)
 {
-	osd_work_item *item;
+	osd_work_item *itemlist = NULL, *lastitem = NULL;
+	osd_work_item **item_tailptr = &itemlist;
 	int itemnum;
 
-	// allocate memory to hold the result
-	item = malloc(sizeof(*item));
-	if (item == NULL)
-		return NULL;
+	pthread_mutex_lock(&queue->lock);
 
-	// loop over all requested items
+	// loop over items, building up a local list of work
 	for (itemnum = 0; itemnum < numitems; itemnum++)
 	{
-		// execute the call directly
-		item->result = (*callback)(parambase, 0);
-
-		// advance the param
+		osd_work_item *item = queue->free;
+
+		// try the free list first, then allocate something new
+		if (item != NULL)
+			queue->free = item->next;
+		else
+		{
+			item = (osd_work_item *)malloc(sizeof(*item));
+			if (item == NULL)
+				break;
+		}
+
+		// fill in the basics
+		item->next = NULL;
+		item->queue = queue;
+		item->callback = callback;
+		item->param = parambase;
+		item->result = NULL;
+		item->flags = flags;
+		item->done = FALSE;
+
+		// advance to the next
+		lastitem = item;
+		*item_tailptr = item;
+		item_tailptr = &item->next;
 		parambase = (UINT8 *)parambase + paramstep;
 	}
 
-	// free the item if requested
-	if (flags & WORK_ITEM_FLAG_AUTO_RELEASE)
+	// append the whole thing and wake up the threads
+	if (itemlist != NULL)
 	{
-		free(item);
-		item = NULL;
+		*queue->tailptr = itemlist;
+		queue->tailptr = item_tailptr;
+		queue->items += itemnum;
+		if (itemnum > 1)
+			pthread_cond_broadcast(&queue->workcond);
+		else
+			pthread_cond_signal(&queue->workcond);
 	}
-	return item;
+	pthread_mutex_unlock(&queue->lock);
+
+	// if no threads, run the queue now on this thread
+	if (queue->threads == 0)
+		while (worker_run_one(queue, 0))
+			;
+
+	// only return the item if it won't get released automatically
+	return (flags & WORK_ITEM_FLAG_AUTO_RELEASE) ? NULL : lastitem;
 }
 
 
@@ -137,8 +306,18 @@ osd_work_item *osd_work_item_queue_multiple(osd_work_queue *queue, osd_work_call
 
 int osd_work_item_wait(osd_work_item *item, osd_ticks_t timeout)
 {
-	// never anything to wait for, so do nothing
-	return TRUE;
+	osd_work_queue *queue = item->queue;
+	struct timespec deadline;
+	int result;
+
+	compute_deadline(&deadline, timeout);
+	pthread_mutex_lock(&queue->lock);
+	while (!item->done)
+		if (pthread_cond_timedwait(&queue->donecond, &queue->lock, &deadline) == ETIMEDOUT)
+			break;
+	result = item->done;
+	pthread_mutex_unlock(&queue->lock);
+	return result;
 }
 
 
@@ -158,5 +337,104 @@ void *osd_work_item_result(osd_work_item *item)
 
 void osd_work_item_release(osd_work_item *item)
 {
-	free(item);
+	osd_work_queue *queue = item->queue;
+
+	// make sure we're done first
+	osd_work_item_wait(item, 100 * osd_ticks_per_second());
+
+	// add us to the free list on our queue
+	pthread_mutex_lock(&queue->lock);
+	item->next = queue->free;
+	queue->free = item;
+	pthread_mutex_unlock(&queue->lock);
+}
+
+
+//============================================================
+//  worker_thread_entry
+//============================================================
+
+static void *worker_thread_entry(void *param)
+{
+	work_thread_info info = *(work_thread_info *)param;
+	osd_work_queue *queue = info.queue;
+
+	free(param);
+
+	// loop until we exit
+	pthread_mutex_lock(&queue->lock);
+	for ( ;; )
+	{
+		// block waiting for work or exit
+		while (!queue->exiting && queue->list == NULL)
+			pthread_cond_wait(&queue->workcond, &queue->lock);
+		if (queue->exiting)
+			break;
+
+		// run what we find
+		pthread_mutex_unlock(&queue->lock);
+		while (worker_run_one(queue, info.threadid))
+			;
+		pthread_mutex_lock(&queue->lock);
+	}
+	pthread_mutex_unlock(&queue->lock);
+	return NULL;
+}
+
+
+//============================================================
+//  worker_run_one
+//============================================================
+
+static int worker_run_one(osd_work_queue *queue, int threadid)
+{
+	osd_work_item *item;
+	void *result;
+
+	// pull the item from the queue
+	pthread_mutex_lock(&queue->lock);
+	item = queue->list;
+	if (item != NULL)
+	{
+		queue->list = item->next;
+		if (queue->list == NULL)
+			queue->tailptr = &queue->list;
+	}
+	pthread_mutex_unlock(&queue->lock);
+	if (item == NULL)
+		return FALSE;
+
+	// call the callback outside the lock
+	result = (*item->callback)(item->param, threadid);
+
+	// mark it done and let any waiters know; auto-release items go straight back
+	pthread_mutex_lock(&queue->lock);
+	item->result = result;
+	item->done = TRUE;
+	queue->items--;
+	if (item->flags & WORK_ITEM_FLAG_AUTO_RELEASE)
+	{
+		item->next = queue->free;
+		queue->free = item;
+	}
+	pthread_cond_broadcast(&queue->donecond);
+	pthread_mutex_unlock(&queue->lock);
+	return TRUE;
+}
+
+
+//============================================================
+//  compute_deadline
+//============================================================
+
+static void compute_deadline(struct timespec *deadline, osd_ticks_t timeout)
+{
+	osd_ticks_t tps = osd_ticks_per_second();
+	UINT64 nsec = (UINT64)(timeout % tps) * 1000000000 / tps;
+
+	// the osd_ticks clock isn't necessarily wall time, so convert to an absolute time
+	clock_gettime(CLOCK_REALTIME, deadline);
+	nsec += deadline->tv_nsec;
+	deadline->tv_sec += timeout / tps + nsec / 1000000000;
+	deadline->tv_nsec = nsec % 1000000000;
 }
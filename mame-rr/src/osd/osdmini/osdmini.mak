@@ -57,6 +57,7 @@ OSDCOREOBJS = \
 	$(MINIOBJ)/minidir.o \
 	$(MINIOBJ)/minifile.o \
 	$(MINIOBJ)/minimisc.o \
+	$(MINIOBJ)/minisocket.o \
 	$(MINIOBJ)/minisync.o \
 	$(MINIOBJ)/minitime.o \
 	$(MINIOBJ)/miniwork.o \
@@ -79,3 +80,11 @@ OSDOBJS = \
 $(LIBOCORE): $(OSDCOREOBJS)
 
 $(LIBOSD): $(OSDOBJS)
+
+
+
+#-------------------------------------------------
+# the work queues run on pthreads
+#-------------------------------------------------
+
+LIBS += -lpthread
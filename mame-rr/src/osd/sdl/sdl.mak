@@ -259,6 +259,7 @@ OSDCOREOBJS = \
 	$(SDLOBJ)/sdlfile.o 	\
 	$(SDLOBJ)/sdlmisc_$(BASE_TARGETOS).o	\
 	$(SDLOBJ)/sdlos_$(BASE_TARGETOS).o	\
+	$(SDLOBJ)/sdlsocket.o	\
 	$(SDLOBJ)/sdlsync_$(SYNC_IMPLEMENTATION).o     \
 	$(SDLOBJ)/sdlwork.o
 
@@ -367,7 +368,7 @@ endif
 
 LDFLAGS += -static-libgcc
 LIBS += -Wl,-Bstatic -lSDL -Wl,-Bdynamic
-LIBS += -luser32 -lgdi32 -lddraw -ldsound -ldxguid -lwinmm -ladvapi32 -lcomctl32 -lshlwapi
+LIBS += -luser32 -lgdi32 -lddraw -ldsound -ldxguid -lwinmm -ladvapi32 -lcomctl32 -lshlwapi -lws2_32
 
 endif	# Win32
 
@@ -0,0 +1,200 @@
+//============================================================
+//
+//  sdlsocket.c - SDL socket access functions
+//
+//  Copyright (c) 1996-2010, Nicola Salmoria and the MAME Team.
+//  Visit http://mamedev.org for licensing and usage restrictions.
+//
+//  SDLMAME by Olivier Galibert and R. Belmont
+//
+//============================================================
+
+#ifdef SDLMAME_WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <winsock2.h>
+#else
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+#include <stdlib.h>
+#include <string.h>
+
+// MAME headers
+#include "osdcore.h"
+#include "sdlos.h"
+
+//============================================================
+//  CONSTANTS
+//============================================================
+
+#ifdef SDLMAME_WIN32
+#define socket_close		closesocket
+#define socket_would_block()	(WSAGetLastError() == WSAEWOULDBLOCK)
+#else
+typedef int SOCKET;
+#define INVALID_SOCKET		(-1)
+#define socket_close		close
+#define socket_would_block()	(errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+#endif
+
+// a vanished peer must give us an error, not a SIGPIPE
+#ifdef MSG_NOSIGNAL
+#define SEND_FLAGS			MSG_NOSIGNAL
+#else
+#define SEND_FLAGS			0
+#endif
+
+
+//============================================================
+//  TYPE DEFINITIONS
+//============================================================
+
+struct _osd_socket
+{
+	SOCKET	handle;
+};
+
+
+//============================================================
+//  socket_alloc
+//============================================================
+
+static osd_socket *socket_alloc(SOCKET handle)
+{
+	osd_socket *sock;
+
+	// all our sockets are non-blocking; writes loop until done
+#ifdef SDLMAME_WIN32
+	u_long nonblocking = 1;
+	ioctlsocket(handle, FIONBIO, &nonblocking);
+#else
+	fcntl(handle, F_SETFL, fcntl(handle, F_GETFL, 0) | O_NONBLOCK);
+#if !defined(MSG_NOSIGNAL) && defined(SO_NOSIGPIPE)
+	{
+		int nosigpipe = 1;
+		setsockopt(handle, SOL_SOCKET, SO_NOSIGPIPE, &nosigpipe, sizeof(nosigpipe));
+	}
+#endif
+#endif
+
+	sock = (osd_socket *)malloc(sizeof(*sock));
+	if (sock == NULL)
+	{
+		socket_close(handle);
+		return NULL;
+	}
+	sock->handle = handle;
+	return sock;
+}
+
+
+//============================================================
+//  osd_socket_listen
+//============================================================
+
+osd_socket *osd_socket_listen(int port)
+{
+	struct sockaddr_in addr;
+	SOCKET handle;
+	int reuse = 1;
+
+#ifdef SDLMAME_WIN32
+	static int winsock_started;
+	if (!winsock_started)
+	{
+		WSADATA data;
+		if (WSAStartup(MAKEWORD(2, 0), &data) != 0)
+			return NULL;
+		winsock_started = TRUE;
+	}
+#endif
+
+	handle = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (handle == INVALID_SOCKET)
+		return NULL;
+	setsockopt(handle, SOL_SOCKET, SO_REUSEADDR, (const char *)&reuse, sizeof(reuse));
+
+	// only accept connections from this machine
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = htons(port);
+	if (bind(handle, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(handle, 1) != 0)
+	{
+		socket_close(handle);
+		return NULL;
+	}
+	return socket_alloc(handle);
+}
+
+
+//============================================================
+//  osd_socket_accept
+//============================================================
+
+osd_socket *osd_socket_accept(osd_socket *listener)
+{
+	SOCKET handle = accept(listener->handle, NULL, NULL);
+	if (handle == INVALID_SOCKET)
+		return NULL;
+	return socket_alloc(handle);
+}
+
+
+//============================================================
+//  osd_socket_read
+//============================================================
+
+file_error osd_socket_read(osd_socket *socket, void *buffer, UINT32 length, UINT32 *actual)
+{
+	int result = recv(socket->handle, (char *)buffer, length, 0);
+
+	*actual = 0;
+	if (result > 0)
+		*actual = result;
+	else if (result == 0 || !socket_would_block())
+		return FILERR_FAILURE;
+	return FILERR_NONE;
+}
+
+
+//============================================================
+//  osd_socket_write
+//============================================================
+
+file_error osd_socket_write(osd_socket *socket, const void *buffer, UINT32 length)
+{
+	const char *data = (const char *)buffer;
+
+	while (length > 0)
+	{
+		int result = send(socket->handle, data, length, SEND_FLAGS);
+		if (result > 0)
+		{
+			data += result;
+			length -= result;
+		}
+		else if (result < 0 && socket_would_block())
+			osd_sleep(osd_ticks_per_second() / 1000);
+		else
+			return FILERR_FAILURE;
+	}
+	return FILERR_NONE;
+}
+
+
+//============================================================
+//  osd_socket_close
+//============================================================
+
+void osd_socket_close(osd_socket *socket)
+{
+	socket_close(socket->handle);
+	free(socket);
+}
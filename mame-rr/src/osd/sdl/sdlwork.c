@@ -47,6 +47,8 @@ int sdl_num_processors = 0;
 #define INFINITE				(osd_ticks_per_second() *  (osd_ticks_t) 10000)
 #define SPIN_LOOP_TIME			(osd_ticks_per_second() / 10000)
 
+#define WORK_DEQUE_SIZE			1024		// items each thread holds where others can steal them (power of 2)
+
 
 //============================================================
 //  MACROS
@@ -76,6 +78,12 @@ struct _work_thread_info
 	osd_event *			wakeevent;		// wake event for the thread
 	volatile INT32		active;			// are we actively processing work?
 
+	// each thread fills its own deque and takes from the top; idle threads steal from
+	// the top too, so only the owner ever writes, and taking is a single compare/exchange
+	osd_work_item * volatile *deque;	// ring of WORK_DEQUE_SIZE items
+	volatile INT32		top;			// index of the next item to take
+	volatile INT32		bottom;			// index of the next slot the owner fills
+
 #if KEEP_STATISTICS
 	INT32				itemsdone;
 	osd_ticks_t			actruntime;
@@ -88,11 +96,10 @@ struct _work_thread_info
 
 struct _osd_work_queue
 {
-	osd_scalable_lock *	lock;			// lock for protecting the queue
-	osd_work_item * volatile list;		// list of items in the queue
-	osd_work_item ** volatile tailptr;	// pointer to the tail pointer of work items in the queue
+	osd_work_item * volatile incoming;	// items not yet claimed by a thread, newest first
 	osd_work_item * volatile free;		// free list of work items
 	volatile INT32		items;			// items in the queue
+	volatile INT32		pending;		// items in the queue not yet started
 	volatile INT32		livethreads;	// number of live threads
 	volatile INT32		waiting;		// is someone waiting on the queue to complete?
 	volatile UINT8		exiting;		// should the threads exit on their next opportunity?
@@ -106,6 +113,7 @@ struct _osd_work_queue
 	volatile INT32		setevents;		// number of times we called SetEvent
 	volatile INT32		extraitems;		// how many extra items we got after the first in the queue loop
 	volatile INT32		spinloops;		// how many times spinning bought us more items
+	volatile INT32		steals;			// how many items were taken from another thread's deque
 #endif
 };
 
@@ -138,6 +146,10 @@ static int effective_num_processors(void);
 static UINT32 effective_cpu_mask(int index);
 static void * worker_thread_entry(void *param);
 static void worker_thread_process(osd_work_queue *queue, work_thread_info *thread);
+static osd_work_item *worker_next_item(osd_work_queue *queue, work_thread_info *thread);
+static osd_work_item *deque_take(work_thread_info *thread);
+static void requeue_items(osd_work_queue *queue, osd_work_item *list);
+static void free_item_list(osd_work_item *item);
 
 
 //============================================================
@@ -157,7 +169,6 @@ osd_work_queue *osd_work_queue_alloc(int flags)
 	memset(queue, 0, sizeof(*queue));
 
 	// initialize basic queue members
-	queue->tailptr = (osd_work_item **)&queue->list;
 	queue->flags = flags;
 
 	// allocate events for the queue
@@ -165,11 +176,6 @@ osd_work_queue *osd_work_queue_alloc(int flags)
 	if (queue->doneevent == NULL)
 		goto error;
 
-	// initialize the critical section
-	queue->lock = osd_scalable_lock_alloc();
-	if (queue->lock == NULL)
-		goto error;
-
 	// determine how many threads to create...
 	// on a single-CPU system, create 1 thread for I/O queues, and 0 threads for everything else
 	if (numprocs == 1)
@@ -188,6 +194,14 @@ osd_work_queue *osd_work_queue_alloc(int flags)
 		goto error;
 	memset(queue->thread, 0, (queue->threads + 1) * sizeof(queue->thread[0]));
 
+	// allocate a deque for each thread, including the calling thread
+	for (threadnum = 0; threadnum <= queue->threads; threadnum++)
+	{
+		queue->thread[threadnum].deque = (osd_work_item * volatile *)osd_malloc(WORK_DEQUE_SIZE * sizeof(queue->thread[0].deque[0]));
+		if (queue->thread[threadnum].deque == NULL)
+			goto error;
+	}
+
 	// iterate over threads
 	for (threadnum = 0; threadnum < queue->threads; threadnum++)
 	{
@@ -288,11 +302,24 @@ int osd_work_queue_wait(osd_work_queue *queue, osd_ticks_t timeout)
 		begin_timing(thread->waittime);
 	}
 
-	// reset our done event and double-check the items before waiting
-	osd_event_reset(queue->doneevent);
+	// any thread running out of work sets the done event, even while another is
+	// still finishing its last item, so keep waiting until the count really hits 0
 	atomic_exchange32(&queue->waiting, TRUE);
-	if (queue->items != 0)
-		osd_event_wait(queue->doneevent, timeout);
+	{
+		osd_ticks_t stopwait = osd_ticks() + timeout;
+
+		for ( ;; )
+		{
+			osd_ticks_t now;
+
+			// reset our done event and double-check the items before waiting
+			osd_event_reset(queue->doneevent);
+			now = osd_ticks();
+			if (queue->items == 0 || now >= stopwait)
+				break;
+			osd_event_wait(queue->doneevent, stopwait - now);
+		}
+	}
 	atomic_exchange32(&queue->waiting, FALSE);
 
 	// return TRUE if we actually hit 0
@@ -356,6 +383,28 @@ void osd_work_queue_free(osd_work_queue *queue)
 #endif
 	}
 
+	// free anything left unprocessed, and the deques
+	free_item_list((osd_work_item *)queue->incoming);
+	if (queue->thread != NULL)
+	{
+		int threadnum;
+
+		for (threadnum = 0; threadnum <= queue->threads; threadnum++)
+		{
+			work_thread_info *thread = &queue->thread[threadnum];
+			osd_work_item *item;
+
+			if (thread->deque == NULL)
+				continue;
+			while ((item = deque_take(thread)) != NULL)
+			{
+				item->next = NULL;
+				free_item_list(item);
+			}
+			osd_free((void *)thread->deque);
+		}
+	}
+
 	// free the list
 	if (queue->thread != NULL)
 		osd_free(queue->thread);
@@ -365,33 +414,16 @@ void osd_work_queue_free(osd_work_queue *queue)
 		osd_event_free(queue->doneevent);
 
 	// free all items in the free list
-	while (queue->free != NULL)
-	{
-		osd_work_item *item = (osd_work_item *)queue->free;
-		queue->free = item->next;
-		if (item->event != NULL)
-			osd_event_free(item->event);
-		osd_free(item);
-	}
-
-	// free all items in the active list
-	while (queue->list != NULL)
-	{
-		osd_work_item *item = (osd_work_item *)queue->list;
-		queue->list = item->next;
-		if (item->event != NULL)
-			osd_event_free(item->event);
-		osd_free(item);
-	}
+	free_item_list((osd_work_item *)queue->free);
 
 #if KEEP_STATISTICS
 	printf("Items queued   = %9d\n", queue->itemsqueued);
 	printf("SetEvent calls = %9d\n", queue->setevents);
 	printf("Extra items    = %9d\n", queue->extraitems);
 	printf("Spin loops     = %9d\n", queue->spinloops);
+	printf("Steals         = %9d\n", queue->steals);
 #endif
 
-	osd_scalable_lock_free(queue->lock);
 	// free the queue itself
 	osd_free(queue);
 }
@@ -403,24 +435,27 @@ void osd_work_queue_free(osd_work_queue *queue)
 
 osd_work_item *osd_work_item_queue_multiple(osd_work_queue *queue, osd_work_callback callback, INT32 numitems, void *parambase, INT32 paramstep, UINT32 flags)
 {
-	osd_work_item *itemlist = NULL, *lastitem = NULL;
-	osd_work_item **item_tailptr = &itemlist;
-	INT32 lockslot;
+	osd_work_item *itemlist = NULL, *firstitem = NULL, *freelist, *head;
 	int itemnum;
 
-	// loop over items, building up a local list of work
+	// claim the whole free list; popping single items would be open to ABA
+	do
+	{
+		freelist = (osd_work_item *)queue->free;
+	} while (freelist != NULL && compare_exchange_ptr((PVOID volatile *)&queue->free, freelist, NULL) != freelist);
+
+	// loop over items, building up a local list of work, newest first
 	for (itemnum = 0; itemnum < numitems; itemnum++)
 	{
 		osd_work_item *item;
 
 		// first allocate a new work item; try the free list first
-		do
-		{
-			item = (osd_work_item *)queue->free;
-		} while (item != NULL && compare_exchange_ptr((PVOID volatile *)&queue->free, item, item->next) != item);
+		item = freelist;
+		if (item != NULL)
+			freelist = item->next;
 
 		// if nothing, allocate something new
-		if (item == NULL)
+		else
 		{
 			// allocate the item
 			item = (osd_work_item *)osd_malloc(sizeof(*item));
@@ -431,7 +466,7 @@ osd_work_item *osd_work_item_queue_multiple(osd_work_queue *queue, osd_work_call
 		}
 
 		// fill in the basics
-		item->next = NULL;
+		item->next = itemlist;
 		item->callback = callback;
 		item->param = parambase;
 		item->result = NULL;
@@ -439,22 +474,41 @@ osd_work_item *osd_work_item_queue_multiple(osd_work_queue *queue, osd_work_call
 		item->done = FALSE;
 
 		// advance to the next
-		lastitem = item;
-		*item_tailptr = item;
-		item_tailptr = &item->next;
+		if (firstitem == NULL)
+			firstitem = item;
+		itemlist = item;
 		parambase = (UINT8 *)parambase + paramstep;
 	}
 
-	// enqueue the whole thing within the critical section
-	lockslot = osd_scalable_lock_acquire(queue->lock);
-	*queue->tailptr = itemlist;
-	queue->tailptr = item_tailptr;
-	osd_scalable_lock_release(queue->lock, lockslot);
+	// give back what we didn't use
+	if (freelist != NULL)
+	{
+		osd_work_item *freetail = freelist;
+		while (freetail->next != NULL)
+			freetail = freetail->next;
+		do
+		{
+			head = (osd_work_item *)queue->free;
+			freetail->next = head;
+		} while (compare_exchange_ptr((PVOID volatile *)&queue->free, head, freelist) != head);
+	}
+
+	// nothing to do if there was nothing to queue
+	if (itemlist == NULL)
+		return NULL;
 
 	// increment the number of items in the queue
 	atomic_add32(&queue->items, numitems);
+	atomic_add32(&queue->pending, numitems);
 	add_to_stat(&queue->itemsqueued, numitems);
 
+	// push the whole thing onto the incoming list; whoever claims it reverses it
+	do
+	{
+		head = (osd_work_item *)queue->incoming;
+		firstitem->next = head;
+	} while (compare_exchange_ptr((PVOID volatile *)&queue->incoming, head, itemlist) != head);
+
 	// look for free threads to do the work
 	if (queue->livethreads < queue->threads)
 	{
@@ -486,7 +540,7 @@ osd_work_item *osd_work_item_queue_multiple(osd_work_queue *queue, osd_work_call
 		begin_timing(queue->thread[0].waittime);
 	}
 	// only return the item if it won't get released automatically
-	return (flags & WORK_ITEM_FLAG_AUTO_RELEASE) ? NULL : lastitem;
+	return (flags & WORK_ITEM_FLAG_AUTO_RELEASE) ? NULL : itemlist;
 }
 
 
@@ -632,7 +686,7 @@ static void *worker_thread_entry(void *param)
 	{
 		// block waiting for work or exit
 		// bail on exit, and only wait if there are no pending items in queue
-		if (!queue->exiting && queue->list == NULL)
+		if (!queue->exiting && queue->pending == 0)
 		{
 			begin_timing(thread->waittime);
 			osd_event_wait(thread->wakeevent, INFINITE);
@@ -654,7 +708,7 @@ static void *worker_thread_entry(void *param)
 			worker_thread_process(queue, thread);
 
 			// if we're a high frequency queue, spin for a while before giving up
-			if (queue->flags & WORK_QUEUE_FLAG_HIGH_FREQ && queue->list == NULL)
+			if (queue->flags & WORK_QUEUE_FLAG_HIGH_FREQ && queue->pending == 0)
 			{
 				// spin for a while looking for more work
 				begin_timing(thread->spintime);
@@ -662,14 +716,14 @@ static void *worker_thread_entry(void *param)
 
 				do {
 					int spin = 10000;
-					while (--spin && queue->list == NULL)
+					while (--spin && queue->pending == 0)
 						osd_yield_processor();
-				} while (queue->list == NULL && osd_ticks() < stopspin);
+				} while (queue->pending == 0 && osd_ticks() < stopspin);
 				end_timing(thread->spintime);
 			}
 
 			// if nothing more, release the processor
-			if (queue->list == NULL)
+			if (queue->pending == 0)
 				break;
 			add_to_stat(&queue->spinloops, 1);
 		}
@@ -689,67 +743,199 @@ static void *worker_thread_entry(void *param)
 static void worker_thread_process(osd_work_queue *queue, work_thread_info *thread)
 {
 	int threadid = thread - queue->thread;
+	osd_work_item *item;
 
 	begin_timing(thread->runtime);
 
-	// loop until everything is processed
-	while (queue->list != NULL)
+	// loop until we can't find anything more to do
+	while ((item = worker_next_item(queue, thread)) != NULL)
 	{
-		osd_work_item *item;
-		INT32 lockslot;
+		atomic_decrement32(&queue->pending);
+
+		// call the callback and stash the result
+		begin_timing(thread->actruntime);
+		item->result = (*item->callback)(item->param, threadid);
+		end_timing(thread->actruntime);
+
+		// decrement the item count after we are done
+		atomic_decrement32(&queue->items);
+		atomic_exchange32(&item->done, TRUE);
+		add_to_stat(&thread->itemsdone, 1);
 
-		// use a critical section to synchronize the removal of items
-		lockslot = osd_scalable_lock_acquire(queue->lock);
+		// if it's an auto-release item, release it
+		if (item->flags & WORK_ITEM_FLAG_AUTO_RELEASE)
+			osd_work_item_release(item);
+
+		// set the result and signal the event
+		else if (item->event != NULL)
 		{
-			// pull the item from the queue
-			item = (osd_work_item *)queue->list;
-			if (item != NULL)
-			{
-				queue->list = item->next;
-				if (queue->list == NULL)
-					queue->tailptr = (osd_work_item **)&queue->list;
-			}
+			osd_event_set(item->event);
+			add_to_stat(&item->queue->setevents, 1);
 		}
-		osd_scalable_lock_release(queue->lock, lockslot);
 
-		// process non-NULL items
+		// if we removed an item and there's still work to do, bump the stats
+		if (queue->pending != 0)
+			add_to_stat(&queue->extraitems, 1);
+	}
+
+	// we don't need to set the doneevent for multi queues because they spin
+	if (queue->waiting)
+	{
+		osd_event_set(queue->doneevent);
+		add_to_stat(&queue->setevents, 1);
+	}
+
+	end_timing(thread->runtime);
+}
+
+
+//============================================================
+//  worker_next_item
+//============================================================
+
+static osd_work_item *worker_next_item(osd_work_queue *queue, work_thread_info *thread)
+{
+	int threadnum;
+
+	for ( ;; )
+	{
+		osd_work_item *item, *list;
+
+		// our own deque comes first
+		item = deque_take(thread);
 		if (item != NULL)
+			return item;
+
+		// then refill it from anything newly queued
+		if (queue->incoming != NULL)
 		{
-			// call the callback and stash the result
-			begin_timing(thread->actruntime);
-			item->result = (*item->callback)(item->param, threadid);
-			end_timing(thread->actruntime);
-
-			// decrement the item count after we are done
-			atomic_decrement32(&queue->items);
-			atomic_exchange32(&item->done, TRUE);
-			add_to_stat(&thread->itemsdone, 1);
-
-			// if it's an auto-release item, release it
-			if (item->flags & WORK_ITEM_FLAG_AUTO_RELEASE)
-				osd_work_item_release(item);
-
-			// set the result and signal the event
-			else if (item->event != NULL)
+			osd_work_item *ordered = NULL;
+			INT32 bottom = thread->bottom;
+
+			// claim everything at once
+			do
+			{
+				list = (osd_work_item *)queue->incoming;
+			} while (list != NULL && compare_exchange_ptr((PVOID volatile *)&queue->incoming, list, NULL) != list);
+
+			// it was pushed newest first, so reverse it to run in the order it was queued
+			while (list != NULL)
+			{
+				item = list;
+				list = item->next;
+				item->next = ordered;
+				ordered = item;
+			}
+
+			// fill the deque as far as we can; the new bottom publishes the items
+			while (ordered != NULL && bottom - thread->top < WORK_DEQUE_SIZE)
 			{
-				osd_event_set(item->event);
-				add_to_stat(&item->queue->setevents, 1);
+				thread->deque[bottom++ & (WORK_DEQUE_SIZE - 1)] = ordered;
+				ordered = ordered->next;
 			}
+			atomic_exchange32(&thread->bottom, bottom);
 
-			// if we removed an item and there's still work to do, bump the stats
-			if (queue->list != NULL)
-				add_to_stat(&queue->extraitems, 1);
+			// hand back whatever didn't fit, so idle threads can claim it instead of spinning
+			if (ordered != NULL)
+				requeue_items(queue, ordered);
+			continue;
 		}
+
+		// otherwise, steal from the other threads, starting with our neighbor
+		for (threadnum = 1; threadnum <= queue->threads; threadnum++)
+		{
+			work_thread_info *victim = &queue->thread[(thread - queue->thread + threadnum) % (queue->threads + 1)];
+			item = deque_take(victim);
+			if (item != NULL)
+			{
+				add_to_stat(&queue->steals, 1);
+				return item;
+			}
+		}
+
+		// nothing we can get at right now; anything still pending is on its way into a deque
+		return NULL;
 	}
+}
 
-	// we don't need to set the doneevent for multi queues because they spin
-	if (queue->waiting)
+
+//============================================================
+//  deque_take
+//============================================================
+
+static osd_work_item *deque_take(work_thread_info *thread)
+{
+	for ( ;; )
 	{
-		osd_event_set(queue->doneevent);
-		add_to_stat(&queue->setevents, 1);
+		INT32 top = thread->top;
+		osd_work_item *item;
+
+		// empty?
+		if (thread->bottom - top <= 0)
+			return NULL;
+
+		// read the item, then claim it; if someone else got there first, try again
+		item = thread->deque[top & (WORK_DEQUE_SIZE - 1)];
+		if (compare_exchange32(&thread->top, top, top + 1) == top)
+			return item;
 	}
+}
 
-	end_timing(thread->runtime);
+
+//============================================================
+//  requeue_items
+//============================================================
+
+static void requeue_items(osd_work_queue *queue, osd_work_item *list)
+{
+	osd_work_item *head = NULL;
+
+	// our items are in queue order; turn them back into newest first
+	while (list != NULL)
+	{
+		osd_work_item *item = list;
+		list = item->next;
+		item->next = head;
+		head = item;
+	}
+
+	// they are older than anything queued since we claimed them, so they belong at the
+	// end of the incoming list; take what is there, put it in front and try again
+	for ( ;; )
+	{
+		osd_work_item *newer, *last;
+
+		do
+		{
+			newer = (osd_work_item *)queue->incoming;
+		} while (newer != NULL && compare_exchange_ptr((PVOID volatile *)&queue->incoming, newer, NULL) != newer);
+
+		if (newer != NULL)
+		{
+			for (last = newer; last->next != NULL; last = last->next) ;
+			last->next = head;
+			head = newer;
+		}
+		if (compare_exchange_ptr((PVOID volatile *)&queue->incoming, NULL, head) == NULL)
+			break;
+	}
+}
+
+
+//============================================================
+//  free_item_list
+//============================================================
+
+static void free_item_list(osd_work_item *item)
+{
+	while (item != NULL)
+	{
+		osd_work_item *next = item->next;
+		if (item->event != NULL)
+			osd_event_free(item->event);
+		osd_free(item);
+		item = next;
+	}
 }
 
 #endif // SDLMAME_NOASM
@@ -131,6 +131,7 @@ enum
 	ID_LOGICAL_ADDRESSES,
 	ID_PHYSICAL_ADDRESSES,
 	ID_REVERSE_VIEW,
+	ID_HEATMAP_VIEW,
 	ID_INCREASE_MEM_WIDTH,
 	ID_DECREASE_MEM_WIDTH,
 
@@ -1748,6 +1749,7 @@ static void memory_create_window(running_machine *machine)
 	AppendMenu(optionsmenu, MF_ENABLED, ID_PHYSICAL_ADDRESSES, TEXT("Physical Addresses\tCtrl+Y"));
 	AppendMenu(optionsmenu, MF_DISABLED | MF_SEPARATOR, 0, TEXT(""));
 	AppendMenu(optionsmenu, MF_ENABLED, ID_REVERSE_VIEW, TEXT("Reverse View\tCtrl+R"));
+	AppendMenu(optionsmenu, MF_ENABLED, ID_HEATMAP_VIEW, TEXT("Heatmap Colours"));
 	AppendMenu(optionsmenu, MF_DISABLED | MF_SEPARATOR, 0, TEXT(""));
 	AppendMenu(optionsmenu, MF_ENABLED, ID_INCREASE_MEM_WIDTH, TEXT("Increase bytes per line\tCtrl+P"));
 	AppendMenu(optionsmenu, MF_ENABLED, ID_DECREASE_MEM_WIDTH, TEXT("Decrease bytes per line\tCtrl+O"));
@@ -1886,6 +1888,7 @@ static void memory_update_menu(debugwin_info *info)
 	CheckMenuItem(GetMenu(info->wnd), ID_LOGICAL_ADDRESSES, MF_BYCOMMAND | (memview->physical() ? MF_UNCHECKED : MF_CHECKED));
 	CheckMenuItem(GetMenu(info->wnd), ID_PHYSICAL_ADDRESSES, MF_BYCOMMAND | (memview->physical() ? MF_CHECKED : MF_UNCHECKED));
 	CheckMenuItem(GetMenu(info->wnd), ID_REVERSE_VIEW, MF_BYCOMMAND | (memview->reverse() ? MF_CHECKED : MF_UNCHECKED));
+	CheckMenuItem(GetMenu(info->wnd), ID_HEATMAP_VIEW, MF_BYCOMMAND | (memview->heatmap() ? MF_CHECKED : MF_UNCHECKED));
 }
 
 
@@ -1947,6 +1950,10 @@ static int memory_handle_command(debugwin_info *info, WPARAM wparam, LPARAM lpar
 					memview->set_reverse(!memview->reverse());
 					return 1;
 
+				case ID_HEATMAP_VIEW:
+					memview->set_heatmap(!memview->heatmap());
+					return 1;
+
 				case ID_INCREASE_MEM_WIDTH:
 					memview->set_chunks_per_row(memview->chunks_per_row() + 1);
 					return 1;
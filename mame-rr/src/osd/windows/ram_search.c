@@ -1,31 +1,18 @@
 // A few notes about this implementation of a RAM search window:
 //
-// Speed of update was one of the highest priories.
-// This is because I wanted the RAM search window to be able to
-// update every single value in RAM every single frame, and
-// keep track of the exact number of frames across which each value has changed,
-// without causing the emulation to run noticeably slower than normal.
+// The searching itself is done by the RAM search engine in emu/ramsearch.c,
+// the same one behind the debugger's rs* commands and the Lua ramsearch library.
+// This file is only the dialog around it: it turns the radio buttons and
+// edit boxes into engine searches, and shows the surviving candidates
+// in a virtual list view.
 //
-// The data representation was changed from one entry per valid address
-// to one entry per contiguous range of uneliminated addresses
-// which references uniform pools of per-address properties.
-// - This saves time when there are many items because
-//   it minimizes the amount of data that needs to be stored and processed per address.
-// - It also saves time when there are few items because
-//   it ensures that no time is wasted in iterating through
-//   addresses that have already been eliminated from the search.
-//
-// The worst-case scenario is when every other item has been
-// eliminated from the search, maximizing the number of regions.
-// This implementation manages to handle even that pathological case
-// acceptably well. In fact, it still updates faster than the previous implementation.
-// The time spent setting up or clearing such a large number of regions
-// is somewhat horrendous, but it seems reasonable to have poor worst-case speed
-// during these sporadic "setup" steps to achieve an all-around faster per-update speed.
-// (You can test this case by performing the search: Modulo 2 Is Specific Address 0)
+// The engine hands out candidates by position in address order,
+// so the list view fetches a page of them at a time and keeps it
+// until an update or a search changes the candidates or their values.
 
 #include <iostream>
 #include "emu.h"
+#include "ramsearch.h"
 #include <windows.h>
 #include "emuopts.h"
 #include "window.h"
@@ -34,32 +21,12 @@
 #include "ramwatch.h"
 #include <assert.h>
 #include <commctrl.h>
-#include <list>
 #include <vector>
 #include <string>
 
 static std::string empty_driver("empty");
 
-#define INVALID_HARDWARE_ADDRESS ((HWAddressType) -1)
-#undef realloc
-
-struct MemoryRegion
-{
-	HWAddressType hardwareAddress; // hardware address of the start of this region
-	unsigned int size; // number of bytes to the end of this region
-
-	unsigned int virtualIndex; // index into s_prevValues, s_curValues, and s_numChanges, valid after being initialized in ResetMemoryRegions()
-	unsigned int itemIndex; // index into listbox items, valid when s_itemIndicesInvalid is false
-};
-
-int MAX_RAM_SIZE = 0;
-static unsigned char* s_prevValues = 0; // values at last search or reset
-static unsigned char* s_curValues = 0; // values at last frame update
-static unsigned short* s_numChanges = 0; // number of changes of the item starting at this virtual index address
-static MemoryRegion** s_itemIndexToRegionPointer = 0; // used for random access into the memory list (trading memory size to get speed here, too bad it's so much memory), only valid when s_itemIndicesInvalid is false
-static BOOL s_itemIndicesInvalid = true; // if true, the link from listbox items to memory regions (s_itemIndexToRegionPointer) and the link from memory regions to list box items (MemoryRegion::itemIndex) both need to be recalculated
-static BOOL s_prevValuesNeedUpdate = true; // if true, the "prev" values should be updated using the "cur" values on the next frame update signaled
-static unsigned int s_maxItemIndex = 0; // max currently valid item index, the listbox sometimes tries to update things past the end of the list so we need to know this to ignore those attempts
+#define RESULT_CACHE_SIZE 256 // list view items fetched from the engine at a time
 
 HWND RamSearchHWnd;
 #define hWnd win_window_list->hwnd
@@ -68,31 +35,42 @@ static char Str_Tmp [1024];
 
 int disableRamSearchUpdate = false;
 
-// list of contiguous uneliminated memory regions
-typedef std::list<MemoryRegion> MemoryList;
-static MemoryList s_activeMemoryRegions;
-static CRITICAL_SECTION s_activeMemoryRegionsCS;
+// the search itself; it is allocated from the machine and goes away with it
+static ramsearch_state* s_search = NULL;
+static CRITICAL_SECTION s_searchCS;
+
+// a page of results for the list view, valid until the candidates or their values change
+static ramsearch_result s_resultCache[RESULT_CACHE_SIZE];
+static unsigned int s_resultCacheFirst = 0;
+static unsigned int s_resultCacheCount = 0;
 
-// for undo support (could be better, but this way was really easy)
-static MemoryList s_activeMemoryRegionsBackup;
+// for undo support
 static int s_undoType = 0; // 0 means can't undo, 1 means can undo, 2 means can redo
 
-void RamSearchSaveUndoStateIfNotTooBig(HWND hDlg);
-static const int tooManyRegionsForUndo = 10000;
+void RamSearchSaveUndoState(HWND hDlg);
 
 running_machine *machine_rw;
-HWAddressType MemoryAddressStart = INVALID_HARDWARE_ADDRESS;
-HWAddressType MemoryAddressEnd = INVALID_HARDWARE_ADDRESS;
-bool littleEndian = false;
+
+char rs_c='s';
+char rs_o='=';
+char rs_t='s';
+int rs_param=0, rs_val=0, rs_val_valid=0;
+char rs_type_size = 'b', rs_last_type_size = rs_type_size;
+bool noMisalign = true, rs_last_no_misalign = noMisalign;
+int last_rs_possible = -1;
+int ResultCount=0;
+
+struct AutoCritSect
+{
+	AutoCritSect(CRITICAL_SECTION* cs) : m_cs(cs) { EnterCriticalSection(m_cs); }
+	~AutoCritSect() { LeaveCriticalSection(m_cs); }
+	CRITICAL_SECTION* m_cs;
+};
 
 bool IsHardwareAddressValid(HWAddressType address)
 {
-	if (MemoryAddressStart == INVALID_HARDWARE_ADDRESS || MemoryAddressEnd == INVALID_HARDWARE_ADDRESS)
-		return false;
-	if (address >= MemoryAddressStart && address <= MemoryAddressEnd)
-		return true;
-	else
-		return false;
+	AutoCritSect cs(&s_searchCS);
+	return s_search != NULL && ramsearch_contains(s_search, address);
 }
 
 static UINT16 custom_read_word(const address_space *space, offs_t address) {
@@ -139,675 +117,113 @@ unsigned int ReadValueAtHardwareAddress(HWAddressType address, unsigned int size
 		return custom_read_dword(space, address);
 }
 
-void ResetMemoryRegions()
+static ramsearch_state* GetSearch()
 {
-//	AudBlankSound();
-	EnterCriticalSection(&s_activeMemoryRegionsCS);
-
-	s_activeMemoryRegions.clear();
-
-	// figure out what all the possible memory regions are
-	static const int regionSearchGranularity = 1; // if this is too small, we'll waste time (in this function only), but if any region in RAM isn't evenly divisible by this, we might crash.
-	const char * region_share[100];
-	int region_count = 0;
-	address_map_entry *entry;
-	const address_space *space = cpu_get_address_space(machine_rw->firstcpu, ADDRESS_SPACE_PROGRAM);
-
-	MemoryAddressStart = INVALID_HARDWARE_ADDRESS;
-	MemoryAddressEnd = INVALID_HARDWARE_ADDRESS;
-	
-	if (space->endianness == ENDIANNESS_LITTLE)
-		littleEndian = true;
-	else
-		littleEndian = false;
-	for (entry = space->map->entrylist; entry != NULL; entry = entry->next)
-	{
-		int shared = 0;
-		HWAddressType offset = memory_address_to_byte(space, entry->addrstart) & space->bytemask;
-		HWAddressType endoffset = memory_address_to_byte(space, entry->addrend) & space->bytemask;
-		region_share[region_count] = entry->share;
-
-		if (entry->share != NULL)
-			for (int i = 0; i < region_count; i++)
-				if (region_share[i] != NULL)
-					if (strcmp(region_share[i], entry->share)==0)
-						shared = 1;
-
-		if (!shared && entry->write.type == AMH_RAM) {
-			MemoryRegion region = { offset, regionSearchGranularity + (endoffset - offset) };
-			s_activeMemoryRegions.push_back(region);
-
-		if (MemoryAddressStart == INVALID_HARDWARE_ADDRESS)
-			MemoryAddressStart = offset;
-		if (MemoryAddressEnd == INVALID_HARDWARE_ADDRESS || MemoryAddressEnd < endoffset)
-			MemoryAddressEnd = endoffset;
-		}
-
-		region_count++;
-	}
-
-	int nextVirtualIndex = 0;
-	for(MemoryList::iterator iter = s_activeMemoryRegions.begin(); iter != s_activeMemoryRegions.end(); ++iter)
-	{
-		MemoryRegion& region = *iter;
-		region.virtualIndex = nextVirtualIndex;
-		nextVirtualIndex = region.virtualIndex + region.size;
-	}
-	//assert(nextVirtualIndex <= MAX_RAM_SIZE);
-
-	if(nextVirtualIndex > MAX_RAM_SIZE)
-	{
-		s_prevValues = (unsigned char*)realloc(s_prevValues, sizeof(char)*(nextVirtualIndex+4));
-		memset(s_prevValues, 0, sizeof(char)*(nextVirtualIndex+4));
-
-		s_curValues = (unsigned char*)realloc(s_curValues, sizeof(char)*(nextVirtualIndex+4));
-		memset(s_curValues, 0, sizeof(char)*(nextVirtualIndex+4));
-
-		s_numChanges = (unsigned short*)realloc(s_numChanges, sizeof(short)*(nextVirtualIndex+4));
-		memset(s_numChanges, 0, sizeof(short)*(nextVirtualIndex+4));
-
-		s_itemIndexToRegionPointer = (MemoryRegion**)realloc(s_itemIndexToRegionPointer, sizeof(MemoryRegion*)*(nextVirtualIndex+4));
-		memset(s_itemIndexToRegionPointer, 0, sizeof(MemoryRegion*)*(nextVirtualIndex+4));
-
-		MAX_RAM_SIZE = nextVirtualIndex;
-	}
-	LeaveCriticalSection(&s_activeMemoryRegionsCS);
-}
-
-// eliminates a range of hardware addresses from the search results
-// returns 2 if it changed the region and moved the iterator to another region
-// returns 1 if it changed the region but didn't move the iterator
-// returns 0 if it had no effect
-// warning: don't call anything that takes an itemIndex in a loop that calls DeactivateRegion...
-//   doing so would be tremendously slow because DeactivateRegion invalidates the index cache
-int DeactivateRegion(MemoryRegion& region, MemoryList::iterator& iter, HWAddressType hardwareAddress, unsigned int size)
-{
-	if(hardwareAddress + size <= region.hardwareAddress || hardwareAddress >= region.hardwareAddress + region.size)
-	{
-		// region is unaffected
-		return 0;
-	}
-	else if(hardwareAddress > region.hardwareAddress && hardwareAddress + size >= region.hardwareAddress + region.size)
-	{
-		// erase end of region
-		region.size = hardwareAddress - region.hardwareAddress;
-		return 1;
-	}
-	else if(hardwareAddress <= region.hardwareAddress && hardwareAddress + size < region.hardwareAddress + region.size)
-	{
-		// erase start of region
-		int eraseSize = (hardwareAddress + size) - region.hardwareAddress;
-		region.hardwareAddress += eraseSize;
-		region.size -= eraseSize;
-		region.virtualIndex += eraseSize;
-		return 1;
-	}
-	else if(hardwareAddress <= region.hardwareAddress && hardwareAddress + size >= region.hardwareAddress + region.size)
-	{
-		// erase entire region
-		iter = s_activeMemoryRegions.erase(iter);
-		s_itemIndicesInvalid = TRUE;
-		return 2;
-	}
-	else //if(hardwareAddress > region.hardwareAddress && hardwareAddress + size < region.hardwareAddress + region.size)
-	{
-		// split region
-		int eraseSize = (hardwareAddress + size) - region.hardwareAddress;
-		MemoryRegion region2 = {region.hardwareAddress + eraseSize, region.size - eraseSize, region.virtualIndex + eraseSize};
-		region.size = hardwareAddress - region.hardwareAddress;
-		iter = s_activeMemoryRegions.insert(++iter, region2);
-		s_itemIndicesInvalid = TRUE;
-		return 2;
-	}
+	if(!s_search)
+		s_search = ramsearch_alloc(machine_rw);
+	return s_search;
 }
 
-/*
-// eliminates a range of hardware addresses from the search results
-// this is a simpler but usually slower interface for the above function
-void DeactivateRegion(HWAddressType hardwareAddress, unsigned int size)
+void Exit_RAM_Search(running_machine &machine) // the search is freed along with the machine, so forget about it
 {
-	for(MemoryList::iterator iter = s_activeMemoryRegions.begin(); iter != s_activeMemoryRegions.end(); )
-	{
-		MemoryRegion& region = *iter;
-		if(2 != DeactivateRegion(region, iter, hardwareAddress, size))
-			++iter;
-	}
+	AutoCritSect cs(&s_searchCS);
+	s_search = NULL;
+	s_resultCacheCount = 0;
+	ResultCount = 0;
 }
-*/
-
-struct AutoCritSect
-{
-	AutoCritSect(CRITICAL_SECTION* cs) : m_cs(cs) { EnterCriticalSection(m_cs); }
-	~AutoCritSect() { LeaveCriticalSection(m_cs); }
-	CRITICAL_SECTION* m_cs;
-};
 
-// warning: can be slow
-void CalculateItemIndices(int itemSize)
+// call after anything that changes the candidates or their values
+static inline void InvalidateResultCache()
 {
-	AutoCritSect cs(&s_activeMemoryRegionsCS);
-	unsigned int itemIndex = 0;
-	for(MemoryList::iterator iter = s_activeMemoryRegions.begin(); iter != s_activeMemoryRegions.end(); ++iter)
-	{
-		MemoryRegion& region = *iter;
-		region.itemIndex = itemIndex;
-		int startSkipSize = ((unsigned int)(itemSize - (unsigned int)region.hardwareAddress)) % itemSize; // FIXME: is this still ok?
-		unsigned int start = startSkipSize;
-		unsigned int end = region.size;
-		for(unsigned int i = start; i < end; i += itemSize)
-			s_itemIndexToRegionPointer[itemIndex++] = &region;
-	}
-	s_maxItemIndex = itemIndex;
-	s_itemIndicesInvalid = FALSE;
+	s_resultCacheCount = 0;
 }
 
-template<typename stepType, typename compareType>
-void UpdateRegionT(const MemoryRegion& region, const MemoryRegion* nextRegionPtr)
+// fetches the result shown at a list view item, returns false past the end of the list
+static bool GetResult(unsigned int itemIndex, ramsearch_result& result)
 {
-	//if(GetAsyncKeyState(VK_SHIFT) & 0x8000) // speed hack
-	//	return;
-
-	if(s_prevValuesNeedUpdate)
-		memcpy(s_prevValues + region.virtualIndex, s_curValues + region.virtualIndex, region.size + sizeof(compareType) - sizeof(stepType));
-
-	unsigned int startSkipSize = ((unsigned int)(sizeof(stepType) - region.hardwareAddress)) % sizeof(stepType);
-
-
-	HWAddressType hwSourceAddr = region.hardwareAddress - region.virtualIndex;
-
-	unsigned int indexStart = region.virtualIndex + startSkipSize;
-	unsigned int indexEnd = region.virtualIndex + region.size;
-
-	if(sizeof(compareType) == 1)
+	AutoCritSect cs(&s_searchCS);
+	if(!s_search)
+		return false;
+	if(itemIndex < s_resultCacheFirst || itemIndex >= s_resultCacheFirst + s_resultCacheCount)
 	{
-		for(unsigned int i = indexStart; i < indexEnd; i++)
-		{
-			unsigned int valueAtAddress = ReadValueAtHardwareAddress(hwSourceAddr+i, 1);
-			if(s_curValues[i] != valueAtAddress) // if value changed
-			{
-				s_curValues[i] = valueAtAddress; // update value
-				//if(s_numChanges[i] != 0xFFFF)
-					s_numChanges[i]++; // increase change count
-			}
-		}
-	}
-	else // it's more complicated for non-byte sizes because:
-	{    // - more than one byte can affect a given change count entry
-	     // - when more than one of those bytes changes simultaneously the entry's change count should only increase by 1
-	     // - a few of those bytes can be outside the region
-
-		unsigned int endSkipSize = ((unsigned int)(startSkipSize - region.size)) % sizeof(stepType);
-		unsigned int lastIndexToRead = indexEnd + endSkipSize + sizeof(compareType) - sizeof(stepType);
-		unsigned int lastIndexToCopy = lastIndexToRead;
-		if(nextRegionPtr)
-		{
-			const MemoryRegion& nextRegion = *nextRegionPtr;
-			int nextStartSkipSize = ((unsigned int)(sizeof(stepType) - nextRegion.hardwareAddress)) % sizeof(stepType);
-			unsigned int nextIndexStart = nextRegion.virtualIndex + nextStartSkipSize;
-			if(lastIndexToCopy > nextIndexStart)
-				lastIndexToCopy = nextIndexStart;
-		}
-
-		unsigned int nextValidChange [sizeof(compareType)];
-		for(unsigned int i = 0; i < sizeof(compareType); i++)
-			nextValidChange[i] = indexStart + i;
-
-		for(unsigned int i = indexStart, j = 0; i < lastIndexToRead; i++, j++)
-		{
-			unsigned int valueAtAddress = ReadValueAtHardwareAddress(hwSourceAddr+i, 1);
-			if(s_curValues[i] != valueAtAddress) // if value of this byte changed
-			{
-				if(i < lastIndexToCopy)
-					s_curValues[i] = valueAtAddress; // update value
-				for(int k = 0; k < (int)sizeof(compareType); k++) // loop through the previous entries that contain this byte
-				{
-					if(i >= indexEnd+k)
-						continue;
-					int m = (j-k+sizeof(compareType)) & (sizeof(compareType)-1);
-					if(nextValidChange[m]+sizeof(compareType) <= i+sizeof(compareType)) // if we didn't already increase the change count for this entry
-					{
-						//if(s_numChanges[i-k] != 0xFFFF)
-							s_numChanges[i-k]++; // increase the change count for this entry
-						nextValidChange[m] = i+sizeof(compareType); // and remember not to increase it again
-					}
-				}
-			}
-		}
+		// center the page on the item, so scrolling either way stays inside it for a while
+		s_resultCacheFirst = (itemIndex > RESULT_CACHE_SIZE/2) ? itemIndex - RESULT_CACHE_SIZE/2 : 0;
+		s_resultCacheCount = ramsearch_results(s_search, s_resultCacheFirst, s_resultCache, RESULT_CACHE_SIZE);
+		if(itemIndex >= s_resultCacheFirst + s_resultCacheCount)
+			return false;
 	}
+	result = s_resultCache[itemIndex - s_resultCacheFirst];
+	return true;
 }
 
-template<typename stepType, typename compareType>
-void UpdateRegionsT()
+static int SearchSize()
 {
-	for(MemoryList::iterator iter = s_activeMemoryRegions.begin(); iter != s_activeMemoryRegions.end();)
-	{
-		const MemoryRegion& region = *iter;
-		++iter;
-		const MemoryRegion* nextRegion = (iter == s_activeMemoryRegions.end()) ? NULL : &*iter;
-
-		UpdateRegionT<stepType, compareType>(region, nextRegion);
-	}
-
-	s_prevValuesNeedUpdate = false;
+	return (rs_type_size == 'd') ? 4 : (rs_type_size == 'w') ? 2 : 1;
 }
 
-template<typename stepType, typename compareType>
-int CountRegionItemsT()
+static int SearchCompare(char o)
 {
-	AutoCritSect cs(&s_activeMemoryRegionsCS);
-	if(sizeof(stepType) == 1)
-	{
-		if(s_activeMemoryRegions.empty())
-			return 0;
-
-		if(s_itemIndicesInvalid)
-			CalculateItemIndices(sizeof(stepType));
-
-		MemoryRegion& lastRegion = s_activeMemoryRegions.back();
-		return lastRegion.itemIndex + lastRegion.size;
-	}
-	else // the branch above is faster but won't work if the step size isn't 1
+	switch (o)
 	{
-		int total = 0;
-		for(MemoryList::iterator iter = s_activeMemoryRegions.begin(); iter != s_activeMemoryRegions.end(); ++iter)
-		{
-			MemoryRegion& region = *iter;
-			int startSkipSize = ((unsigned int)(sizeof(stepType) - region.hardwareAddress)) % sizeof(stepType);
-			total += (region.size - startSkipSize + (sizeof(stepType)-1)) / sizeof(stepType);
-		}
-		return total;
+		case '<': return RAMSEARCH_LESS;
+		case '>': return RAMSEARCH_GREATER;
+		case 'l': return RAMSEARCH_LESS_EQUAL;
+		case 'm': return RAMSEARCH_GREATER_EQUAL;
+		case '=': return RAMSEARCH_EQUAL;
+		case '!': return RAMSEARCH_NOT_EQUAL;
+		case 'd': return RAMSEARCH_DIFFERENT_BY;
+		case '%': return RAMSEARCH_MODULO;
+		default: assert(!"Invalid operator for this search type."); return RAMSEARCH_EQUAL;
 	}
 }
 
-// returns information about the item in the form of a "fake" region
-// that has the item in it and nothing else
-template<typename stepType, typename compareType>
-void ItemIndexToVirtualRegion(unsigned int itemIndex, MemoryRegion& virtualRegion)
+static int SearchTarget(char c)
 {
-	if(s_itemIndicesInvalid)
-		CalculateItemIndices(sizeof(stepType));
-
-	if(itemIndex >= s_maxItemIndex)
+	switch (c)
 	{
-		memset(&virtualRegion, 0, sizeof(MemoryRegion));
-		return;
-	}
-
-	const MemoryRegion* regionPtr = s_itemIndexToRegionPointer[itemIndex];
-	const MemoryRegion& region = *regionPtr;
-
-	int bytesWithinRegion = (itemIndex - region.itemIndex) * sizeof(stepType);
-	int startSkipSize = ((unsigned int)(sizeof(stepType) - region.hardwareAddress)) % sizeof(stepType);
-	bytesWithinRegion += startSkipSize;
-	
-	virtualRegion.size = sizeof(compareType);
-	virtualRegion.hardwareAddress = region.hardwareAddress + bytesWithinRegion;
-	virtualRegion.virtualIndex = region.virtualIndex + bytesWithinRegion;
-	virtualRegion.itemIndex = itemIndex;
-	return;
-}
-
-template<typename stepType, typename compareType>
-unsigned int ItemIndexToVirtualIndex(unsigned int itemIndex)
-{
-	MemoryRegion virtualRegion;
-	ItemIndexToVirtualRegion<stepType,compareType>(itemIndex, virtualRegion);
-	return virtualRegion.virtualIndex;
-}
-
-static inline unsigned short bswap_16(unsigned short x) {
-	return (x>>8) | (x<<8);
-}
-
-static inline unsigned int bswap_32(unsigned int x) {
-	return (bswap_16(x&0xffff)<<16) | (bswap_16(x>>16));
-}
-
-template<typename T>
-T ReadLocalValue(const unsigned char* data)
-{
-	T value = *(const T*)data;
-
-	if(littleEndian) {
-		return value;
-	}
-	else {
-		if (sizeof(T) == 1)
-			return value;
-		else if (sizeof(T) == 2)
-			return bswap_16(value);
-		else //if (sizeof(T) == 4)
-			return bswap_32(value);
+		case 'r': return RAMSEARCH_PREVIOUS;
+		case 's': return RAMSEARCH_SPECIFIC;
+		case 'a': return RAMSEARCH_ADDRESS;
+		case 'n': return RAMSEARCH_CHANGES;
+		default: assert(!"Invalid search comparison type."); return RAMSEARCH_PREVIOUS;
 	}
 }
-//template<> signed char ReadLocalValue(const unsigned char* data) { return *data; }
-//template<> unsigned char ReadLocalValue(const unsigned char* data) { return *data; }
 
-
-template<typename stepType, typename compareType>
-compareType GetPrevValueFromVirtualIndex(unsigned int virtualIndex)
-{
-	return ReadLocalValue<compareType>(s_prevValues + virtualIndex);
-	//return *(compareType*)(s_prevValues+virtualIndex);
-}
-template<typename stepType, typename compareType>
-compareType GetCurValueFromVirtualIndex(unsigned int virtualIndex)
-{
-	return ReadLocalValue<compareType>(s_curValues + virtualIndex);
-//	return *(compareType*)(s_curValues+virtualIndex);
-}
-template<typename stepType, typename compareType>
-unsigned short GetNumChangesFromVirtualIndex(unsigned int virtualIndex)
+static INT64 SearchOperand(char c, int v)
 {
-	unsigned short num = s_numChanges[virtualIndex];
-	//for(unsigned int i = 1; i < sizeof(stepType); i++)
-	//	if(num < s_numChanges[virtualIndex+i])
-	//		num = s_numChanges[virtualIndex+i];
-	return num;
+	// only a specific value can be negative, and only if we're searching signed values
+	if(c == 's' && rs_t == 's')
+		return v;
+	return (UINT32)v;
 }
 
-template<typename stepType, typename compareType>
-compareType GetPrevValueFromItemIndex(unsigned int itemIndex)
-{
-	int virtualIndex = ItemIndexToVirtualIndex<stepType,compareType>(itemIndex);
-	return GetPrevValueFromVirtualIndex<stepType,compareType>(virtualIndex);
-}
-template<typename stepType, typename compareType>
-compareType GetCurValueFromItemIndex(unsigned int itemIndex)
-{
-	int virtualIndex = ItemIndexToVirtualIndex<stepType,compareType>(itemIndex);
-	return GetCurValueFromVirtualIndex<stepType,compareType>(virtualIndex);
-}
-template<typename stepType, typename compareType>
-unsigned short GetNumChangesFromItemIndex(unsigned int itemIndex)
-{
-	int virtualIndex = ItemIndexToVirtualIndex<stepType,compareType>(itemIndex);
-	return GetNumChangesFromVirtualIndex<stepType,compareType>(virtualIndex);
-}
-template<typename stepType, typename compareType>
-unsigned int GetHardwareAddressFromItemIndex(unsigned int itemIndex)
-{
-	MemoryRegion virtualRegion;
-	ItemIndexToVirtualRegion<stepType,compareType>(itemIndex, virtualRegion);
-	return virtualRegion.hardwareAddress;
-}
+void UpdatePossibilities(int rs_possible);
 
-// this one might be unreliable, haven't used it much
-template<typename stepType, typename compareType>
-unsigned int HardwareAddressToItemIndex(HWAddressType hardwareAddress)
+void CompactAddrs()
 {
-	if(s_itemIndicesInvalid)
-		CalculateItemIndices(sizeof(stepType));
+	int prevResultCount = ResultCount;
 
-	for(MemoryList::iterator iter = s_activeMemoryRegions.begin(); iter != s_activeMemoryRegions.end(); ++iter)
 	{
-		MemoryRegion& region = *iter;
-		if(hardwareAddress >= region.hardwareAddress && hardwareAddress < region.hardwareAddress + region.size)
-		{
-			int indexWithinRegion = (hardwareAddress - region.hardwareAddress) / sizeof(stepType);
-			return region.itemIndex + indexWithinRegion;
-		}
+		AutoCritSect cs(&s_searchCS);
+		ResultCount = s_search ? ramsearch_count(s_search) : 0;
 	}
 
-	return -1;
-}
-
+	UpdatePossibilities(ResultCount);
 
-
-// workaround for MSVC 7 that doesn't support varadic C99 macros
-#define CALL_WITH_T_SIZE_TYPES_0(functionName, sizeTypeID, isSigned, requiresAligned) \
-	(sizeTypeID == 'b' \
-		? (isSigned \
-			? functionName<char, signed char>() \
-			: functionName<char, unsigned char>()) \
-	: sizeTypeID == 'w' \
-		? (isSigned \
-			? (requiresAligned \
-				? functionName<short, signed short>() \
-				: functionName<char, signed short>()) \
-			: (requiresAligned \
-				? functionName<short, unsigned short>() \
-				: functionName<char, unsigned short>())) \
-	: sizeTypeID == 'd' \
-		? (isSigned \
-			? (requiresAligned \
-				? functionName<short, signed long>() \
-				: functionName<char, signed long>()) \
-			: (requiresAligned \
-				? functionName<short, unsigned long>() \
-				: functionName<char, unsigned long>())) \
-	: functionName<char, signed char>())
-
-#define CALL_WITH_T_SIZE_TYPES_1(functionName, sizeTypeID, isSigned, requiresAligned, p0) \
-	(sizeTypeID == 'b' \
-		? (isSigned \
-			? functionName<char, signed char>(p0) \
-			: functionName<char, unsigned char>(p0)) \
-	: sizeTypeID == 'w' \
-		? (isSigned \
-			? (requiresAligned \
-				? functionName<short, signed short>(p0) \
-				: functionName<char, signed short>(p0)) \
-			: (requiresAligned \
-				? functionName<short, unsigned short>(p0) \
-				: functionName<char, unsigned short>(p0))) \
-	: sizeTypeID == 'd' \
-		? (isSigned \
-			? (requiresAligned \
-				? functionName<short, signed long>(p0) \
-				: functionName<char, signed long>(p0)) \
-			: (requiresAligned \
-				? functionName<short, unsigned long>(p0) \
-				: functionName<char, unsigned long>(p0))) \
-	: functionName<char, signed char>(p0))
-
-#define CALL_WITH_T_SIZE_TYPES_3(functionName, sizeTypeID, isSigned, requiresAligned, p0, p1, p2) \
-	(sizeTypeID == 'b' \
-		? (isSigned \
-			? functionName<char, signed char>(p0, p1, p2) \
-			: functionName<char, unsigned char>(p0, p1, p2)) \
-	: sizeTypeID == 'w' \
-		? (isSigned \
-			? (requiresAligned \
-				? functionName<short, signed short>(p0, p1, p2) \
-				: functionName<char, signed short>(p0, p1, p2)) \
-			: (requiresAligned \
-				? functionName<short, unsigned short>(p0, p1, p2) \
-				: functionName<char, unsigned short>(p0, p1, p2))) \
-	: sizeTypeID == 'd' \
-		? (isSigned \
-			? (requiresAligned \
-				? functionName<short, signed long>(p0, p1, p2) \
-				: functionName<char, signed long>(p0, p1, p2)) \
-			: (requiresAligned \
-				? functionName<short, unsigned long>(p0, p1, p2) \
-				: functionName<char, unsigned long>(p0, p1, p2))) \
-	: functionName<char, signed char>(p0, p1, p2))
-
-#define CALL_WITH_T_SIZE_TYPES_4(functionName, sizeTypeID, isSigned, requiresAligned, p0, p1, p2, p3) \
-	(sizeTypeID == 'b' \
-		? (isSigned \
-			? functionName<char, signed char>(p0, p1, p2, p3) \
-			: functionName<char, unsigned char>(p0, p1, p2, p3)) \
-	: sizeTypeID == 'w' \
-		? (isSigned \
-			? (requiresAligned \
-				? functionName<short, signed short>(p0, p1, p2, p3) \
-				: functionName<char, signed short>(p0, p1, p2, p3)) \
-			: (requiresAligned \
-				? functionName<short, unsigned short>(p0, p1, p2, p3) \
-				: functionName<char, unsigned short>(p0, p1, p2, p3))) \
-	: sizeTypeID == 'd' \
-		? (isSigned \
-			? (requiresAligned \
-				? functionName<short, signed long>(p0, p1, p2, p3) \
-				: functionName<char, signed long>(p0, p1, p2, p3)) \
-			: (requiresAligned \
-				? functionName<short, unsigned long>(p0, p1, p2, p3) \
-				: functionName<char, unsigned long>(p0, p1, p2, p3))) \
-	: functionName<char, signed char>(p0, p1, p2, p3))
-
-// version that takes a forced comparison type
-#define CALL_WITH_T_STEP_3(functionName, sizeTypeID, type, requiresAligned, p0, p1, p2) \
-	(sizeTypeID == 'b' \
-		? functionName<char, type>(p0, p1, p2) \
-	: sizeTypeID == 'w' \
-		? (requiresAligned \
-			? functionName<short, type>(p0, p1, p2) \
-			: functionName<char, type>(p0, p1, p2)) \
-	: sizeTypeID == 'd' \
-		? (requiresAligned \
-			? functionName<short, type>(p0, p1, p2) \
-			: functionName<char, type>(p0, p1, p2)) \
-	: functionName<char, type>(p0, p1, p2))
-
-// version that takes a forced comparison type
-#define CALL_WITH_T_STEP_4(functionName, sizeTypeID, type, requiresAligned, p0, p1, p2, p3) \
-	(sizeTypeID == 'b' \
-		? functionName<char, type>(p0, p1, p2, p3) \
-	: sizeTypeID == 'w' \
-		? (requiresAligned \
-			? functionName<short, type>(p0, p1, p2, p3) \
-			: functionName<char, type>(p0, p1, p2, p3)) \
-	: sizeTypeID == 'd' \
-		? (requiresAligned \
-			? functionName<short, type>(p0, p1, p2, p3) \
-			: functionName<char, type>(p0, p1, p2, p3)) \
-	: functionName<char, type>(p0, p1, p2, p3))
-
-// basic comparison functions:
-template <typename T> inline bool LessCmp (T x, T y, T i)        { i = i; return x < y; }
-template <typename T> inline bool MoreCmp (T x, T y, T i)        { i = i; return x > y; }
-template <typename T> inline bool LessEqualCmp (T x, T y, T i)   { i = i; return x <= y; }
-template <typename T> inline bool MoreEqualCmp (T x, T y, T i)   { i = i; return x >= y; }
-template <typename T> inline bool EqualCmp (T x, T y, T i)       { i = i; return x == y; }
-template <typename T> inline bool UnequalCmp (T x, T y, T i)     { i = i; return x != y; }
-template <typename T> inline bool DiffByCmp (T x, T y, T p)      { return x - y == p || y - x == p; }
-template <typename T> inline bool ModIsCmp (T x, T y, T p)       { return p && x % p == y; }
-
-// compare-to type functions:
-template<typename stepType, typename T>
-void SearchRelative (bool(*cmpFun)(T,T,T), T ignored, T param)
-{
-	ignored = ignored;
-	for(MemoryList::iterator iter = s_activeMemoryRegions.begin(); iter != s_activeMemoryRegions.end(); )
-	{
-		MemoryRegion& region = *iter;
-		int startSkipSize = ((unsigned int)(sizeof(stepType) - region.hardwareAddress)) % sizeof(stepType);
-		unsigned int start = region.virtualIndex + startSkipSize;
-		unsigned int end = region.virtualIndex + region.size;
-		for(unsigned int i = start, hwaddr = region.hardwareAddress; i < end; i += sizeof(stepType), hwaddr += sizeof(stepType))
-			if(!cmpFun(GetCurValueFromVirtualIndex<stepType,T>(i), GetPrevValueFromVirtualIndex<stepType,T>(i), param))
-				if(2 == DeactivateRegion(region, iter, hwaddr, sizeof(stepType)))
-					goto outerContinue;
-		++iter;
-outerContinue:
-		continue;
-	}
-}
-template<typename stepType, typename T>
-void SearchSpecific (bool(*cmpFun)(T,T,T), T value, T param)
-{
-	for(MemoryList::iterator iter = s_activeMemoryRegions.begin(); iter != s_activeMemoryRegions.end(); )
-	{
-		MemoryRegion& region = *iter;
-		int startSkipSize = ((unsigned int)(sizeof(stepType) - region.hardwareAddress)) % sizeof(stepType);
-		unsigned int start = region.virtualIndex + startSkipSize;
-		unsigned int end = region.virtualIndex + region.size;
-		for(unsigned int i = start, hwaddr = region.hardwareAddress; i < end; i += sizeof(stepType), hwaddr += sizeof(stepType))
-			if(!cmpFun(GetCurValueFromVirtualIndex<stepType,T>(i), value, param))
-				if(2 == DeactivateRegion(region, iter, hwaddr, sizeof(stepType)))
-					goto outerContinue;
-		++iter;
-outerContinue:
-		continue;
-	}
-}
-template<typename stepType, typename T>
-void SearchAddress (bool(*cmpFun)(T,T,T), T address, T param)
-{
-	for(MemoryList::iterator iter = s_activeMemoryRegions.begin(); iter != s_activeMemoryRegions.end(); )
-	{
-		MemoryRegion& region = *iter;
-		int startSkipSize = ((unsigned int)(sizeof(stepType) - region.hardwareAddress)) % sizeof(stepType);
-		unsigned int start = region.virtualIndex + startSkipSize;
-		unsigned int end = region.virtualIndex + region.size;
-		for(unsigned int i = start, hwaddr = region.hardwareAddress; i < end; i += sizeof(stepType), hwaddr += sizeof(stepType))
-			if(!cmpFun(hwaddr, address, param))
-				if(2 == DeactivateRegion(region, iter, hwaddr, sizeof(stepType)))
-					goto outerContinue;
-		++iter;
-outerContinue:
-		continue;
-	}
-}
-template<typename stepType, typename T>
-void SearchChanges (bool(*cmpFun)(T,T,T), T changes, T param)
-{
-	for(MemoryList::iterator iter = s_activeMemoryRegions.begin(); iter != s_activeMemoryRegions.end(); )
-	{
-		MemoryRegion& region = *iter;
-		int startSkipSize = ((unsigned int)(sizeof(stepType) - region.hardwareAddress)) % sizeof(stepType);
-		unsigned int start = region.virtualIndex + startSkipSize;
-		unsigned int end = region.virtualIndex + region.size;
-		for(unsigned int i = start, hwaddr = region.hardwareAddress; i < end; i += sizeof(stepType), hwaddr += sizeof(stepType))
-			if(!cmpFun(GetNumChangesFromVirtualIndex<stepType,T>(i), changes, param))
-				if(2 == DeactivateRegion(region, iter, hwaddr, sizeof(stepType)))
-					goto outerContinue;
-		++iter;
-outerContinue:
-		continue;
-	}
+	if(ResultCount != prevResultCount)
+		ListView_SetItemCount(GetDlgItem(RamSearchHWnd,IDC_RAMLIST),ResultCount);
 }
 
-char rs_c='s';
-char rs_o='=';
-char rs_t='s';
-int rs_param=0, rs_val=0, rs_val_valid=0;
-char rs_type_size = 'b', rs_last_type_size = rs_type_size;
-bool noMisalign = true, rs_last_no_misalign = noMisalign;
-int last_rs_possible = -1;
-int last_rs_regions = -1;
-
-void prune(char c,char o,char t,int v,int p)
+void prune(char c,char o,int v,int p)
 {
-	// repetition-reducing macros
-	#define DO_SEARCH(sf) \
-	switch (o) \
-	{ \
-		case '<': DO_SEARCH_2(LessCmp,sf); break; \
-		case '>': DO_SEARCH_2(MoreCmp,sf); break; \
-		case '=': DO_SEARCH_2(EqualCmp,sf); break; \
-		case '!': DO_SEARCH_2(UnequalCmp,sf); break; \
-		case 'l': DO_SEARCH_2(LessEqualCmp,sf); break; \
-		case 'm': DO_SEARCH_2(MoreEqualCmp,sf); break; \
-		case 'd': DO_SEARCH_2(DiffByCmp,sf); break; \
-		case '%': DO_SEARCH_2(ModIsCmp,sf); break; \
-		default: assert(!"Invalid operator for this search type."); break; \
-	}
+	int prevNumItems = last_rs_possible;
 
-	// perform the search, eliminating nonmatching values
-	switch (c)
 	{
-		#define DO_SEARCH_2(CmpFun,sf) CALL_WITH_T_SIZE_TYPES_3(sf, rs_type_size, t, noMisalign, CmpFun,v,p)
-		case 'r': DO_SEARCH(SearchRelative); break;
-		case 's': DO_SEARCH(SearchSpecific); break;
-
-		#undef DO_SEARCH_2
-		#define DO_SEARCH_2(CmpFun,sf) CALL_WITH_T_STEP_3(sf, rs_type_size, unsigned int, noMisalign, CmpFun,v,p)
-		case 'a': DO_SEARCH(SearchAddress); break;
-
-		#undef DO_SEARCH_2
-		#define DO_SEARCH_2(CmpFun,sf) CALL_WITH_T_STEP_3(sf, rs_type_size, unsigned short, noMisalign, CmpFun,v,p)
-		case 'n': DO_SEARCH(SearchChanges); break;
-
-		default: assert(!"Invalid search comparison type."); break;
+		AutoCritSect cs(&s_searchCS);
+		ramsearch_search(GetSearch(), SearchCompare(o), SearchTarget(c), SearchOperand(c, v), p);
+		InvalidateResultCache();
 	}
 
-	s_prevValuesNeedUpdate = true;
-
-	int prevNumItems = last_rs_possible;
-
 	CompactAddrs();
 
 	if(prevNumItems == last_rs_possible)
@@ -816,31 +232,6 @@ void prune(char c,char o,char t,int v,int p)
 	}
 }
 
-
-
-
-template<typename stepType, typename T>
-bool CompareRelativeAtItem (bool(*cmpFun)(T,T,T), int itemIndex, T ignored, T param)
-{
-	ignored = ignored;
-	return cmpFun(GetCurValueFromItemIndex<stepType,T>(itemIndex), GetPrevValueFromItemIndex<stepType,T>(itemIndex), param);
-}
-template<typename stepType, typename T>
-bool CompareSpecificAtItem (bool(*cmpFun)(T,T,T), int itemIndex, T value, T param)
-{
-	return cmpFun(GetCurValueFromItemIndex<stepType,T>(itemIndex), value, param);
-}
-template<typename stepType, typename T>
-bool CompareAddressAtItem (bool(*cmpFun)(T,T,T), int itemIndex, T address, T param)
-{
-	return cmpFun(GetHardwareAddressFromItemIndex<stepType,T>(itemIndex), address, param);
-}
-template<typename stepType, typename T>
-bool CompareChangesAtItem (bool(*cmpFun)(T,T,T), int itemIndex, T changes, T param)
-{
-	return cmpFun(GetNumChangesFromItemIndex<stepType,T>(itemIndex), changes, param);
-}
-
 int ReadControlInt(int controlID, bool forceHex, BOOL& success)
 {
 	int rv = 0;
@@ -964,23 +355,10 @@ bool IsSatisfied(int itemIndex)
 {
 	if(!rs_val_valid)
 		return true;
-	int o = rs_o;
-	switch (rs_c)
-	{
-		#undef DO_SEARCH_2
-		#define DO_SEARCH_2(CmpFun,sf) return CALL_WITH_T_SIZE_TYPES_4(sf, rs_type_size,(rs_t=='s'),noMisalign, CmpFun,itemIndex,rs_val,rs_param);
-		case 'r': DO_SEARCH(CompareRelativeAtItem); break;
-		case 's': DO_SEARCH(CompareSpecificAtItem); break;
-
-		#undef DO_SEARCH_2
-		#define DO_SEARCH_2(CmpFun,sf) return CALL_WITH_T_STEP_4(sf, rs_type_size, unsigned int, noMisalign, CmpFun,itemIndex,rs_val,rs_param);
-		case 'a': DO_SEARCH(CompareAddressAtItem); break;
-
-		#undef DO_SEARCH_2
-		#define DO_SEARCH_2(CmpFun,sf) return CALL_WITH_T_STEP_4(sf, rs_type_size, unsigned short, noMisalign, CmpFun,itemIndex,rs_val,rs_param);
-		case 'n': DO_SEARCH(CompareChangesAtItem); break;
-	}
-	return false;
+	ramsearch_result result;
+	if(!GetResult(itemIndex, result))
+		return false;
+	return ramsearch_result_matches(&result, SearchCompare(rs_o), SearchTarget(rs_c), SearchOperand(rs_c, rs_val), rs_param) != 0;
 }
 
 
@@ -1004,71 +382,33 @@ void WriteValueAtSoftwareAddress(unsigned char* address, unsigned int value, uns
 	}
 }
 
-int ResultCount=0;
 bool AutoSearch=false;
 bool AutoSearchAutoRetry=false;
 LRESULT CALLBACK PromptWatchNameProc(HWND, UINT, WPARAM, LPARAM);
-void UpdatePossibilities(int rs_possible, int regions);
 
 
-void CompactAddrs()
+// starts the search over with every value in RAM as a candidate
+static void reset_search()
 {
-	int size = (rs_type_size=='b' || !noMisalign) ? 1 : 2;
-	int prevResultCount = ResultCount;
-
-	CalculateItemIndices(size);
-	ResultCount = CALL_WITH_T_SIZE_TYPES_0(CountRegionItemsT, rs_type_size,rs_t=='s',noMisalign);
-
-	UpdatePossibilities(ResultCount, (int)s_activeMemoryRegions.size());
-
-	if(ResultCount != prevResultCount)
-		ListView_SetItemCount(GetDlgItem(RamSearchHWnd,IDC_RAMLIST),ResultCount);
-}
-
-void soft_reset_address_info (bool resetPrevValues = false)
-{
-	if (resetPrevValues) {
-		memcpy(s_prevValues, s_curValues, sizeof(s_prevValues));
-		s_prevValuesNeedUpdate = false;
-	}
-	ResetMemoryRegions();
-	if(s_numChanges)
-		memset(s_numChanges, 0, (sizeof(*s_numChanges)*(MAX_RAM_SIZE)));
-	CompactAddrs();
+	AutoCritSect cs(&s_searchCS);
+	ramsearch_reset(GetSearch(), cpu_get_address_space(machine_rw->firstcpu, ADDRESS_SPACE_PROGRAM), SearchSize(), rs_t == 's', noMisalign);
+	InvalidateResultCache();
 }
 void reset_address_info ()
 {
 	SetRamSearchUndoType(RamSearchHWnd, 0);
-	EnterCriticalSection(&s_activeMemoryRegionsCS);
-	s_activeMemoryRegionsBackup.clear(); // not necessary, but we'll take the time hit here instead of at the next thing that sets up an undo
-	LeaveCriticalSection(&s_activeMemoryRegionsCS);
-	if(s_prevValues)
-		memcpy(s_prevValues, s_curValues, (sizeof(*s_prevValues)*(MAX_RAM_SIZE)));
-	s_prevValuesNeedUpdate = false;
-	ResetMemoryRegions();
-	if(!RamSearchHWnd)
-	{
-		EnterCriticalSection(&s_activeMemoryRegionsCS);
-		s_activeMemoryRegions.clear();
-		LeaveCriticalSection(&s_activeMemoryRegionsCS);
-		ResultCount = 0;
-	}
-	else
-	{
-		// force s_prevValues to be valid
-		signal_new_frame();
-		s_prevValuesNeedUpdate = true;
-		signal_new_frame();
-	}
-	memset(s_numChanges, 0, (sizeof(*s_numChanges)*(MAX_RAM_SIZE)));
+	reset_search();
 	CompactAddrs();
 }
 
 void signal_new_frame ()
 {
-	EnterCriticalSection(&s_activeMemoryRegionsCS);
-	CALL_WITH_T_SIZE_TYPES_0(UpdateRegionsT, rs_type_size, rs_t=='s', noMisalign);
-	LeaveCriticalSection(&s_activeMemoryRegionsCS);
+	AutoCritSect cs(&s_searchCS);
+	if(s_search)
+	{
+		ramsearch_update(s_search);
+		InvalidateResultCache();
+	}
 }
 
 
@@ -1151,48 +491,16 @@ void RefreshRamListSelectedCountControlStatus(HWND hDlg)
 
 
 
-struct AddrRange
-{
-	unsigned int addr;
-	unsigned int size;
-	unsigned int End() const { return addr + size; }
-	AddrRange(unsigned int a, unsigned int s) : addr(a),size(s){}
-};
-
 void signal_new_size ()
 {
 	HWND lv = GetDlgItem(RamSearchHWnd,IDC_RAMLIST);
 
-	int oldSize = (rs_last_type_size=='b' || !rs_last_no_misalign) ? 1 : 2;
-	int newSize = (rs_type_size=='b' || !noMisalign) ? 1 : 2;
-	bool numberOfItemsChanged = (oldSize != newSize);
+	bool numberOfItemsChanged = (rs_type_size != rs_last_type_size || noMisalign != rs_last_no_misalign);
 
-	unsigned int itemsPerPage = ListView_GetCountPerPage(lv);
-	unsigned int oldTopIndex = ListView_GetTopIndex(lv);
-	unsigned int oldSelectionIndex = ListView_GetSelectionMark(lv);
-	unsigned int oldTopAddr = CALL_WITH_T_SIZE_TYPES_1(GetHardwareAddressFromItemIndex, rs_last_type_size,rs_t=='s',rs_last_no_misalign, oldTopIndex);
-	unsigned int oldSelectionAddr = CALL_WITH_T_SIZE_TYPES_1(GetHardwareAddressFromItemIndex, rs_last_type_size,rs_t=='s',rs_last_no_misalign, oldSelectionIndex);
-
-	oldSelectionAddr = oldSelectionAddr;
-
-	std::vector<AddrRange> selHardwareAddrs;
-	if(numberOfItemsChanged)
 	{
-		// store selection ranges
-		// unfortunately this can take a while if the user has a huge range of items selected
-//		AudBlankSound();
-		int selCount = ListView_GetSelectedCount(lv);
-		int size = (rs_last_type_size=='b' || !rs_last_no_misalign) ? 1 : 2;
-		int watchIndex = -1;
-		for(int i = 0; i < selCount; ++i)
-		{
-			watchIndex = ListView_GetNextItem(lv, watchIndex, LVNI_SELECTED);
-			int addr = CALL_WITH_T_SIZE_TYPES_1(GetHardwareAddressFromItemIndex, rs_last_type_size,rs_t=='s',rs_last_no_misalign, watchIndex);
-			if(!selHardwareAddrs.empty() && addr == (int)selHardwareAddrs.back().End())
-				selHardwareAddrs.back().size += size;
-			else
-				selHardwareAddrs.push_back(AddrRange(addr,size));
-		}
+		AutoCritSect cs(&s_searchCS);
+		ramsearch_set_format(GetSearch(), SearchSize(), rs_t == 's', noMisalign);
+		InvalidateResultCache();
 	}
 
 	CompactAddrs();
@@ -1202,42 +510,8 @@ void signal_new_size ()
 
 	if(numberOfItemsChanged)
 	{
-		// restore selection ranges
-		unsigned int newTopIndex = CALL_WITH_T_SIZE_TYPES_1(HardwareAddressToItemIndex, rs_type_size,rs_t=='s',noMisalign, oldTopAddr);
-		unsigned int newBottomIndex = newTopIndex + itemsPerPage - 1;
-		SendMessage(lv, WM_SETREDRAW, FALSE, 0);
+		// the items were renumbered, so the old selection no longer means anything
 		ListView_SetItemState(lv, -1, 0, LVIS_SELECTED|LVIS_FOCUSED); // deselect all
-		for(unsigned int i = 0; i < selHardwareAddrs.size(); i++)
-		{
-			// calculate index ranges of this selection
-			const AddrRange& range = selHardwareAddrs[i];
-			int selRangeTop = CALL_WITH_T_SIZE_TYPES_1(HardwareAddressToItemIndex, rs_type_size,rs_t=='s',noMisalign, range.addr);
-			int selRangeBottom = -1;
-			for(int endAddr = range.End()-1; endAddr >= selRangeTop && selRangeBottom == -1; endAddr--)
-				selRangeBottom = CALL_WITH_T_SIZE_TYPES_1(HardwareAddressToItemIndex, rs_type_size,rs_t=='s',noMisalign, endAddr);
-			if(selRangeBottom == -1)
-				selRangeBottom = selRangeTop;
-			if(selRangeTop == -1)
-				continue;
-
-			// select the entire range at once without deselecting the other ranges
-			// looks hacky but it works, and the only documentation I found on how to do this was blatantly false and equally hacky anyway
-			POINT pos;
-			ListView_EnsureVisible(lv, selRangeTop, 0);
-			ListView_GetItemPosition(lv, selRangeTop, &pos);
-			SendMessage(lv, WM_LBUTTONDOWN, MK_LBUTTON|MK_CONTROL, MAKELONG(pos.x,pos.y));
-			ListView_EnsureVisible(lv, selRangeBottom, 0);
-			ListView_GetItemPosition(lv, selRangeBottom, &pos);
-			SendMessage(lv, WM_LBUTTONDOWN, MK_LBUTTON|MK_CONTROL|MK_SHIFT, MAKELONG(pos.x,pos.y));
-		}
-
-		// restore previous scroll position
-		if(newBottomIndex != (unsigned int)-1)
-			ListView_EnsureVisible(lv, newBottomIndex, 0);
-		if(newTopIndex != (unsigned int)-1)
-			ListView_EnsureVisible(lv, newTopIndex, 0);
-
-		SendMessage(lv, WM_SETREDRAW, TRUE, 0);
 
 		RefreshRamListSelectedCountControlStatus(RamSearchHWnd);
 
@@ -1311,26 +585,30 @@ void Update_RAM_Search(running_machine &machine) //keeps RAM values up to date i
 		reset_address_info();
 	}
 
-	int prevValuesNeededUpdate = s_prevValuesNeedUpdate;
-	if (RamSearchHWnd)
-	{
-		// update active RAM values
-		signal_new_frame();
-	}
-
+	bool searched = false;
 	if (AutoSearch && ResultCount)
 	{
 //		AudBlankSound();
 		if(!rs_val_valid)
 			rs_val_valid = Set_RS_Val();
 		if(rs_val_valid)
-			prune(rs_c,rs_o,rs_t=='s',rs_val,rs_param);
+		{
+			// searching updates the RAM values too
+			prune(rs_c,rs_o,rs_val,rs_param);
+			searched = true;
+		}
+	}
+
+	if (RamSearchHWnd && !searched)
+	{
+		// update active RAM values
+		signal_new_frame();
 	}
 
 	if(RamSearchHWnd)
 	{
 		HWND lv = GetDlgItem(RamSearchHWnd,IDC_RAMLIST);
-		if(prevValuesNeededUpdate != s_prevValuesNeedUpdate)
+		if(searched)
 		{
 			// previous values got updated, refresh everything visible
 			ListView_Update(lv, -1);
@@ -1339,12 +617,21 @@ void Update_RAM_Search(running_machine &machine) //keeps RAM values up to date i
 		{
 			// refresh any visible parts of the listview box that changed
 			static int changes[128];
+			ramsearch_result results[128];
 			int top = ListView_GetTopIndex(lv);
 			int count = ListView_GetCountPerPage(lv);
+			int found = 0;
+			if(count > 127)
+				count = 127;
+			{
+				AutoCritSect cs(&s_searchCS);
+				if(s_search)
+					found = ramsearch_results(s_search, top, results, count + 1);
+			}
 			int start = -1;
 			for(int i = top; i <= top+count; i++)
 			{
-				int changeNum = CALL_WITH_T_SIZE_TYPES_1(GetNumChangesFromItemIndex, rs_type_size,rs_t=='s',noMisalign, i); //s_numChanges[i];
+				int changeNum = (i - top < found) ? results[i-top].changes : 0;
 				int changed = changeNum != changes[i-top];
 				if(changed)
 					changes[i-top] = changeNum;
@@ -1509,8 +796,6 @@ LRESULT CALLBACK RamSearchProc(HWND hDlg, UINT uMsg, WPARAM wParam, LPARAM lPara
 					break;
 			}
 
-			s_prevValuesNeedUpdate = true;
-
 			SendDlgItemMessage(hDlg,IDC_C_AUTOSEARCH,BM_SETCHECK,AutoSearch?BST_CHECKED:BST_UNCHECKED,0);
 			//const char* names[5] = {"Address","Value","Previous","Changes","Notes"};
 			//int widths[5] = {62,64,64,55,55};
@@ -1539,7 +824,7 @@ LRESULT CALLBACK RamSearchProc(HWND hDlg, UINT uMsg, WPARAM wParam, LPARAM lPara
 
 			// force possibility count to refresh
 			last_rs_possible--;
-			UpdatePossibilities(ResultCount, (int)s_activeMemoryRegions.size());
+			UpdatePossibilities(ResultCount);
 			
 			rs_val_valid = Set_RS_Val();
 
@@ -1572,17 +857,19 @@ LRESULT CALLBACK RamSearchProc(HWND hDlg, UINT uMsg, WPARAM wParam, LPARAM lPara
 					Item->item.iImage = 0;
 					const unsigned int iNum = Item->item.iItem;
 					static WCHAR num[22];
+					ramsearch_result result;
+					if(!GetResult(iNum, result))
+						memset(&result, 0, sizeof(result));
 					switch (Item->item.iSubItem)
 					{
 						case 0:
 						{
-							int addr = CALL_WITH_T_SIZE_TYPES_1(GetHardwareAddressFromItemIndex, rs_type_size,rs_t=='s',noMisalign, iNum);
-							wsprintf(num,L"%08X",addr);
+							wsprintf(num,L"%08X",result.address);
 							Item->item.pszText = num;
 						}	return true;
 						case 1:
 						{
-							int i = CALL_WITH_T_SIZE_TYPES_1(GetCurValueFromItemIndex, rs_type_size,rs_t=='s',noMisalign, iNum);
+							int i = (int)result.value;
 							const WCHAR* formatString = ((rs_t=='s') ? L"%d" : (rs_t=='u') ? L"%u" : (rs_type_size=='d' ? L"%08X" : rs_type_size=='w' ? L"%04X" : L"%02X"));
 							switch (rs_type_size)
 							{
@@ -1595,7 +882,7 @@ LRESULT CALLBACK RamSearchProc(HWND hDlg, UINT uMsg, WPARAM wParam, LPARAM lPara
 						}	return true;
 						case 2:
 						{
-							int i = CALL_WITH_T_SIZE_TYPES_1(GetPrevValueFromItemIndex, rs_type_size,rs_t=='s',noMisalign, iNum);
+							int i = (int)result.previous;
 							const WCHAR* formatString = ((rs_t=='s') ? L"%d" : (rs_t=='u') ? L"%u" : (rs_type_size=='d' ? L"%08X" : rs_type_size=='w' ? L"%04X" : L"%02X"));
 							switch (rs_type_size)
 							{
@@ -1608,8 +895,7 @@ LRESULT CALLBACK RamSearchProc(HWND hDlg, UINT uMsg, WPARAM wParam, LPARAM lPara
 						}	return true;
 						case 3:
 						{
-							int i = CALL_WITH_T_SIZE_TYPES_1(GetNumChangesFromItemIndex, rs_type_size,rs_t=='s',noMisalign, iNum);
-							wsprintf(num,L"%d",i);
+							wsprintf(num,L"%d",result.changes);
 
 							Item->item.pszText = num;
 						}	return true;
@@ -1756,10 +1042,11 @@ LRESULT CALLBACK RamSearchProc(HWND hDlg, UINT uMsg, WPARAM wParam, LPARAM lPara
 				}	{rv = true; break;}
 				case IDC_C_RESET:
 				{
-					RamSearchSaveUndoStateIfNotTooBig(RamSearchHWnd);
+					RamSearchSaveUndoState(RamSearchHWnd);
 					int prevNumItems = last_rs_possible;
 
-					soft_reset_address_info(true);
+					reset_search();
+					CompactAddrs();
 
 					if(prevNumItems == last_rs_possible)
 						SetRamSearchUndoType(RamSearchHWnd, 0); // nothing to undo
@@ -1771,7 +1058,11 @@ LRESULT CALLBACK RamSearchProc(HWND hDlg, UINT uMsg, WPARAM wParam, LPARAM lPara
 					{rv = true; break;}
 				}
 				case IDC_C_RESET_CHANGES:
-					memset(s_numChanges, 0, (sizeof(*s_numChanges)*(MAX_RAM_SIZE)));
+					{
+						AutoCritSect cs(&s_searchCS);
+						ramsearch_clear_changes(GetSearch());
+						InvalidateResultCache();
+					}
 					ListView_Update(GetDlgItem(hDlg,IDC_RAMLIST), -1);
 					//SetRamSearchUndoType(hDlg, 0);
 					{rv = true; break;}
@@ -1779,21 +1070,12 @@ LRESULT CALLBACK RamSearchProc(HWND hDlg, UINT uMsg, WPARAM wParam, LPARAM lPara
 					if(s_undoType>0)
 					{
 //						AudBlankSound();
-						EnterCriticalSection(&s_activeMemoryRegionsCS);
-						if(s_activeMemoryRegions.size() < (unsigned int)tooManyRegionsForUndo)
-						{
-							MemoryList tempMemoryList = s_activeMemoryRegions;
-							s_activeMemoryRegions = s_activeMemoryRegionsBackup;
-							s_activeMemoryRegionsBackup = tempMemoryList;
-							LeaveCriticalSection(&s_activeMemoryRegionsCS);
-							SetRamSearchUndoType(hDlg, 3 - s_undoType);
-						}
-						else
 						{
-							s_activeMemoryRegions = s_activeMemoryRegionsBackup;
-							LeaveCriticalSection(&s_activeMemoryRegionsCS);
-							SetRamSearchUndoType(hDlg, -1);
+							AutoCritSect cs(&s_searchCS);
+							ramsearch_undo(GetSearch());
+							InvalidateResultCache();
 						}
+						SetRamSearchUndoType(hDlg, 3 - s_undoType);
 						CompactAddrs();
 						ListView_SetItemState(GetDlgItem(hDlg,IDC_RAMLIST), -1, 0, LVIS_SELECTED); // deselect all
 						ListView_SetSelectionMark(GetDlgItem(hDlg,IDC_RAMLIST), 0);
@@ -1813,9 +1095,9 @@ LRESULT CALLBACK RamSearchProc(HWND hDlg, UINT uMsg, WPARAM wParam, LPARAM lPara
 
 					if(ResultCount)
 					{
-						RamSearchSaveUndoStateIfNotTooBig(hDlg);
+						RamSearchSaveUndoState(hDlg);
 
-						prune(rs_c,rs_o,rs_t=='s',rs_val,rs_param);
+						prune(rs_c,rs_o,rs_val,rs_param);
 
 						RefreshRamListSelectedCountControlStatus(hDlg);
 					}
@@ -1824,7 +1106,8 @@ LRESULT CALLBACK RamSearchProc(HWND hDlg, UINT uMsg, WPARAM wParam, LPARAM lPara
 					{
 
 						MessageBoxA(RamSearchHWnd,"Resetting search.","Out of results.",MB_OK|MB_ICONINFORMATION);
-						soft_reset_address_info();
+						reset_search();
+						CompactAddrs();
 					}
 
 					{rv = true; break;}
@@ -1841,10 +1124,11 @@ invalid_field:
 				case IDC_C_WATCH:
 				{
 					int watchItemIndex = ListView_GetSelectionMark(GetDlgItem(hDlg,IDC_RAMLIST));
-					if(watchItemIndex >= 0)
+					ramsearch_result result;
+					if(watchItemIndex >= 0 && GetResult(watchItemIndex, result))
 					{
 						AddressWatcher tempWatch;
-						tempWatch.Address = CALL_WITH_T_SIZE_TYPES_1(GetHardwareAddressFromItemIndex, rs_type_size,rs_t=='s',noMisalign, watchItemIndex);
+						tempWatch.Address = result.address;
 						tempWatch.Size = rs_type_size;
 						tempWatch.Type = rs_t;
 						tempWatch.WrongEndian = 0; //Replace when I get little endian working
@@ -1864,58 +1148,33 @@ invalid_field:
 				// eliminate all selected items
 				case IDC_C_ELIMINATE:
 				{
-					RamSearchSaveUndoStateIfNotTooBig(hDlg);
+					RamSearchSaveUndoState(hDlg);
 
 					HWND ramListControl = GetDlgItem(hDlg,IDC_RAMLIST);
-					int size = (rs_type_size=='b' || !noMisalign) ? 1 : 2;
 					int selCount = ListView_GetSelectedCount(ramListControl);
 					watchIndex = -1;
 
-					// time-saving trick #1:
-					// condense the selected items into an array of address ranges
-					std::vector<AddrRange> selHardwareAddrs;
+					// collect the addresses first, since every elimination renumbers the items after it
+					std::vector<offs_t> selHardwareAddrs;
 					for(int i = 0, j = 1024; i < selCount; ++i, --j)
 					{
 						watchIndex = ListView_GetNextItem(ramListControl, watchIndex, LVNI_SELECTED);
-						int addr = CALL_WITH_T_SIZE_TYPES_1(GetHardwareAddressFromItemIndex, rs_type_size,rs_t=='s',noMisalign, watchIndex);
-						if(!selHardwareAddrs.empty() && addr == (int)selHardwareAddrs.back().End())
-							selHardwareAddrs.back().size += size;
-						else
-							selHardwareAddrs.push_back(AddrRange(addr,size));
+						ramsearch_result result;
+						if(GetResult(watchIndex, result))
+							selHardwareAddrs.push_back(result.address);
 
-						if(!j) UpdateRamSearchProgressBar(i * 50 / selCount), j = 1024;
+						if(!j) UpdateRamSearchProgressBar(i * 100 / selCount), j = 1024;
 					}
 
-					// now deactivate the ranges
-
-					// time-saving trick #2:
-					// take advantage of the fact that the listbox items must be in the same order as the regions
-					MemoryList::iterator iter = s_activeMemoryRegions.begin();
-					int numHardwareAddrRanges = selHardwareAddrs.size();
-					for(int i = 0, j = 16; i < numHardwareAddrRanges; ++i, --j)
+					// now eliminate them
 					{
-						int addr = selHardwareAddrs[i].addr;
-						int sizeElim = selHardwareAddrs[i].size;
-						bool affected = false;
-						while(iter != s_activeMemoryRegions.end())
-						{
-							MemoryRegion& region = *iter;
-							int affNow = DeactivateRegion(region, iter, addr, sizeElim);
-							if(affNow)
-								affected = true;
-							else if(affected)
-								break;
-							if(affNow != 2)
-								++iter;
-						}
-
-						if(!j) UpdateRamSearchProgressBar(50 + (i * 50 / selCount)), j = 16;
+						AutoCritSect cs(&s_searchCS);
+						for(unsigned int i = 0; i < selHardwareAddrs.size(); ++i)
+							ramsearch_eliminate(GetSearch(), selHardwareAddrs[i]);
+						InvalidateResultCache();
 					}
 					UpdateRamSearchTitleBar();
 
-					// careful -- if the above two time-saving tricks aren't working,
-					// the runtime can absolutely explode (seconds -> hours) when there are lots of regions
-
 					ListView_SetItemState(ramListControl, -1, 0, LVIS_SELECTED); // deselect all
 					signal_new_size();
 					{rv = true; break;}
@@ -1988,25 +1247,23 @@ void UpdateRamSearchTitleBar(int percent)
 {
 #define HEADER_STR " RAM Search - "
 #define PROGRESS_STR " %d%% ... "
-#define STATUS_STR "%d Possibilit%s (%d Region%s)"
+#define STATUS_STR "%d Possibilit%s"
 
 	int poss = last_rs_possible;
-	int regions = last_rs_regions;
 	if(poss <= 0)
 		strcpy(Str_Tmp," RAM Search");
 	else if(percent <= 0)
-		sprintf(Str_Tmp, HEADER_STR STATUS_STR, poss, poss==1?"y":"ies", regions, regions==1?"":"s");
+		sprintf(Str_Tmp, HEADER_STR STATUS_STR, poss, poss==1?"y":"ies");
 	else
-		sprintf(Str_Tmp, PROGRESS_STR STATUS_STR, percent, poss, poss==1?"y":"ies", regions, regions==1?"":"s");
+		sprintf(Str_Tmp, PROGRESS_STR STATUS_STR, percent, poss, poss==1?"y":"ies");
 	SetWindowTextA(RamSearchHWnd, Str_Tmp);
 }
 
-void UpdatePossibilities(int rs_possible, int regions)
+void UpdatePossibilities(int rs_possible)
 {
 	if(rs_possible != last_rs_possible)
 	{
 		last_rs_possible = rs_possible;
-		last_rs_regions = regions;
 		UpdateRamSearchTitleBar();
 	}
 }
@@ -2023,31 +1280,24 @@ void SetRamSearchUndoType(HWND hDlg, int type)
 	}
 }
 
-void RamSearchSaveUndoStateIfNotTooBig(HWND hDlg)
+void RamSearchSaveUndoState(HWND hDlg)
 {
-	EnterCriticalSection(&s_activeMemoryRegionsCS);
-	if(s_activeMemoryRegions.size() < (unsigned int)tooManyRegionsForUndo)
-	{
-		s_activeMemoryRegionsBackup = s_activeMemoryRegions;
-		LeaveCriticalSection(&s_activeMemoryRegionsCS);
-		SetRamSearchUndoType(hDlg, 1);
-	}
-	else
 	{
-		LeaveCriticalSection(&s_activeMemoryRegionsCS);
-		SetRamSearchUndoType(hDlg, 0);
+		AutoCritSect cs(&s_searchCS);
+		ramsearch_checkpoint(GetSearch());
 	}
+	SetRamSearchUndoType(hDlg, 1);
 }
 
 struct InitRamSearch
 {
 	InitRamSearch()
 	{
-		InitializeCriticalSection(&s_activeMemoryRegionsCS);
+		InitializeCriticalSection(&s_searchCS);
 	}
 	~InitRamSearch()
 	{
-		DeleteCriticalSection(&s_activeMemoryRegionsCS);
+		DeleteCriticalSection(&s_searchCS);
 	}
 } initRamSearch;
 
@@ -9,7 +9,7 @@ extern running_machine *machine_rw;
 
 unsigned int sizeConv(unsigned int index,char size, char *prevSize = &rs_type_size, bool usePrev = false);
 unsigned int GetRamValue(unsigned int Addr,char Size);
-void prune(char Search, char Operater, char Type, int Value, int OperatorParameter);
+void prune(char Search, char Operater, int Value, int OperatorParameter);
 void CompactAddrs();
 void reset_address_info();
 void signal_new_frame();
@@ -25,6 +25,7 @@ void ResetResults();
 void CloseRamWindows(); //Close the Ram Search & Watch windows when rom closes
 void ReopenRamWindows(); //Reopen them when a new Rom is loaded
 void Update_RAM_Search(running_machine *machine); //keeps RAM values up to date in the search and watch windows
+void Exit_RAM_Search(running_machine &machine); //forgets the search, which is freed along with the machine
 
 extern HWND RamSearchHWnd;
 extern LRESULT CALLBACK RamSearchProc(HWND hDlg, UINT uMsg, WPARAM wParam, LPARAM lParam);
@@ -241,7 +241,7 @@ endif
 LDFLAGS += -static-libgcc
 
 # add the windows libraries
-LIBS += -luser32 -lgdi32 -lddraw -ldsound -ldxguid -lwinmm -ladvapi32 -lcomctl32 -lshlwapi -ldinput8 -lcomdlg32
+LIBS += -luser32 -lgdi32 -lddraw -ldsound -ldxguid -lwinmm -ladvapi32 -lcomctl32 -lshlwapi -ldinput8 -lcomdlg32 -lws2_32
 
 ifeq ($(DIRECTINPUT),8)
 LIBS += -ldinput8
@@ -263,6 +263,7 @@ OSDCOREOBJS = \
 	$(WINOBJ)/windir.o \
 	$(WINOBJ)/winfile.o \
 	$(WINOBJ)/winmisc.o \
+	$(WINOBJ)/winsocket.o \
 	$(WINOBJ)/winsync.o \
 	$(WINOBJ)/wintime.o \
 	$(WINOBJ)/winutf8.o \
@@ -0,0 +1,196 @@
+//============================================================
+//
+//  winsocket.c - Win32 OSD core socket functions
+//
+//============================================================
+//
+//  Copyright Aaron Giles
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or
+//  without modification, are permitted provided that the
+//  following conditions are met:
+//
+//    * Redistributions of source code must retain the above
+//      copyright notice, this list of conditions and the
+//      following disclaimer.
+//    * Redistributions in binary form must reproduce the
+//      above copyright notice, this list of conditions and
+//      the following disclaimer in the documentation and/or
+//      other materials provided with the distribution.
+//    * Neither the name 'MAME' nor the names of its
+//      contributors may be used to endorse or promote
+//      products derived from this software without specific
+//      prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY AARON GILES ''AS IS'' AND
+//  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+//  EVENT SHALL AARON GILES BE LIABLE FOR ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//  DAMAGE (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+//  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+//  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+//  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+//  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+//  IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//============================================================
+
+
+// standard windows headers
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <winsock2.h>
+#include <stdlib.h>
+
+// MAME headers
+#include "osdcore.h"
+
+
+//============================================================
+//  TYPE DEFINITIONS
+//============================================================
+
+struct _osd_socket
+{
+	SOCKET		handle;
+};
+
+
+
+//============================================================
+//  GLOBAL VARIABLES
+//============================================================
+
+static int winsock_started;
+
+
+
+//============================================================
+//  socket_alloc
+//============================================================
+
+static osd_socket *socket_alloc(SOCKET handle)
+{
+	osd_socket *sock;
+	u_long nonblocking = 1;
+
+	// all our sockets are non-blocking; writes loop until done
+	ioctlsocket(handle, FIONBIO, &nonblocking);
+
+	sock = (osd_socket *)malloc(sizeof(*sock));
+	if (sock == NULL)
+	{
+		closesocket(handle);
+		return NULL;
+	}
+	sock->handle = handle;
+	return sock;
+}
+
+
+//============================================================
+//  osd_socket_listen
+//============================================================
+
+osd_socket *osd_socket_listen(int port)
+{
+	struct sockaddr_in addr;
+	SOCKET handle;
+
+	// start winsock the first time through
+	if (!winsock_started)
+	{
+		WSADATA data;
+		if (WSAStartup(MAKEWORD(2, 0), &data) != 0)
+			return NULL;
+		winsock_started = TRUE;
+	}
+
+	handle = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (handle == INVALID_SOCKET)
+		return NULL;
+
+	// only accept connections from this machine
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = htons(port);
+	if (bind(handle, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(handle, 1) != 0)
+	{
+		closesocket(handle);
+		return NULL;
+	}
+	return socket_alloc(handle);
+}
+
+
+//============================================================
+//  osd_socket_accept
+//============================================================
+
+osd_socket *osd_socket_accept(osd_socket *listener)
+{
+	SOCKET handle = accept(listener->handle, NULL, NULL);
+	if (handle == INVALID_SOCKET)
+		return NULL;
+	return socket_alloc(handle);
+}
+
+
+//============================================================
+//  osd_socket_read
+//============================================================
+
+file_error osd_socket_read(osd_socket *socket, void *buffer, UINT32 length, UINT32 *actual)
+{
+	int result = recv(socket->handle, (char *)buffer, length, 0);
+
+	*actual = 0;
+	if (result > 0)
+		*actual = result;
+	else if (result == 0)
+		return FILERR_FAILURE;
+	else if (WSAGetLastError() != WSAEWOULDBLOCK)
+		return FILERR_FAILURE;
+	return FILERR_NONE;
+}
+
+
+//============================================================
+//  osd_socket_write
+//============================================================
+
+file_error osd_socket_write(osd_socket *socket, const void *buffer, UINT32 length)
+{
+	const char *data = (const char *)buffer;
+
+	while (length > 0)
+	{
+		int result = send(socket->handle, data, length, 0);
+		if (result > 0)
+		{
+			data += result;
+			length -= result;
+		}
+		else if (result == SOCKET_ERROR && WSAGetLastError() == WSAEWOULDBLOCK)
+			Sleep(1);
+		else
+			return FILERR_FAILURE;
+	}
+	return FILERR_NONE;
+}
+
+
+//============================================================
+//  osd_socket_close
+//============================================================
+
+void osd_socket_close(osd_socket *socket)
+{
+	closesocket(socket->handle);
+	free(socket);
+}
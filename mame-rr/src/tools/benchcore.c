@@ -0,0 +1,64 @@
+/***************************************************************************
+
+    benchcore.c
+
+    Core stubs for the benchmark tools.
+
+    Copyright Nicola Salmoria and the MAME Team.
+    Visit http://mamedev.org for licensing and usage restrictions.
+
+    Pulling a core module such as tilemap.o or poly.o out of libemu
+    drags in the running machine and, through it, the whole emulator.
+    The benchmarks therefore #include the one core .c file they
+    measure, and link this file for the handful of core functions it
+    calls. The machine is never constructed, nothing is saved, and
+    nothing is freed until exit.
+
+***************************************************************************/
+
+#include "benchutil.h"
+
+
+
+/***************************************************************************
+    CORE STUBS
+***************************************************************************/
+
+void *malloc_file_line(size_t size, const char *file, int line)
+{
+	return osd_malloc(size);
+}
+
+void free_file_line(void *memory, const char *file, int line)
+{
+	osd_free(memory);
+}
+
+/* nothing is ever freed, so there is nothing to track */
+void resource_pool::add(resource_pool_item &item)
+{
+}
+
+void resource_pool::remove(void *ptr)
+{
+}
+
+void state_save_register_memory(running_machine *machine, const char *module, const char *tag, UINT32 index, const char *name, void *val, UINT32 valsize, UINT32 valcount, const char *file, int line)
+{
+}
+
+void state_save_register_presave(running_machine *machine, state_presave_func func, void *param)
+{
+}
+
+void state_save_register_postload(running_machine *machine, state_postload_func func, void *param)
+{
+}
+
+void running_machine::add_notifier(machine_notification event, notify_callback callback)
+{
+}
+
+void CLIB_DECL logerror(const char *format, ...)
+{
+}
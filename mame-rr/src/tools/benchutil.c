@@ -0,0 +1,110 @@
+/***************************************************************************
+
+    benchutil.c
+
+    Shared helpers for the core benchmark tools.
+
+    Copyright Nicola Salmoria and the MAME Team.
+    Visit http://mamedev.org for licensing and usage restrictions.
+
+***************************************************************************/
+
+#include "benchutil.h"
+
+
+
+/***************************************************************************
+    GLOBAL VARIABLES
+***************************************************************************/
+
+static UINT32 random_state = 0x12345678;
+
+
+
+/***************************************************************************
+    IMPLEMENTATION
+***************************************************************************/
+
+/*-------------------------------------------------
+    bench_random_seed - reseed the generator
+-------------------------------------------------*/
+
+void bench_random_seed(UINT32 seed)
+{
+	random_state = (seed != 0) ? seed : 0x12345678;
+}
+
+
+/*-------------------------------------------------
+    bench_random - simple xorshift generator
+-------------------------------------------------*/
+
+UINT32 bench_random(void)
+{
+	random_state ^= random_state << 13;
+	random_state ^= random_state >> 17;
+	random_state ^= random_state << 5;
+	return random_state;
+}
+
+
+/*-------------------------------------------------
+    bench_parse_count - parse the optional count
+    argument that scales the timing runs
+-------------------------------------------------*/
+
+int bench_parse_count(int argc, char *argv[], const char *usage, int multiplier, int defcount)
+{
+	int count = defcount;
+
+	if (argc > 2)
+	{
+		fprintf(stderr, "Usage:\n  %s\n", usage);
+		return 0;
+	}
+	if (argc == 2)
+		count = atoi(argv[1]) * multiplier;
+	return (count > 0) ? count : defcount;
+}
+
+
+/*-------------------------------------------------
+    bench_best_of - warm up once, then return the
+    fastest of several runs
+-------------------------------------------------*/
+
+osd_ticks_t bench_best_of(bench_run_func run, void *param)
+{
+	osd_ticks_t best = 0;
+	int runnum;
+
+	(*run)(param);
+	for (runnum = 0; runnum < BENCH_TIMING_RUNS; runnum++)
+	{
+		osd_ticks_t ticks = (*run)(param);
+		if (runnum == 0 || ticks < best)
+			best = ticks;
+	}
+	return best;
+}
+
+
+/*-------------------------------------------------
+    bench_ms - convert ticks to milliseconds
+-------------------------------------------------*/
+
+double bench_ms(osd_ticks_t ticks)
+{
+	return (double)ticks * 1000.0 / (double)osd_ticks_per_second();
+}
+
+
+/*-------------------------------------------------
+    bench_speedup - return the ratio of two
+    timings
+-------------------------------------------------*/
+
+double bench_speedup(osd_ticks_t before, osd_ticks_t after)
+{
+	return (after == 0) ? 0.0 : (double)before / (double)after;
+}
@@ -0,0 +1,64 @@
+/***************************************************************************
+
+    benchutil.h
+
+    Shared helpers for the core benchmark tools.
+
+    Copyright Nicola Salmoria and the MAME Team.
+    Visit http://mamedev.org for licensing and usage restrictions.
+
+***************************************************************************/
+
+#pragma once
+
+#ifndef __BENCHUTIL_H__
+#define __BENCHUTIL_H__
+
+/* core code built into a benchmark marks profiler time; there is no profiler to mark it in */
+#undef MAME_PROFILER
+
+#include "emu.h"
+
+
+
+/***************************************************************************
+    CONSTANTS
+***************************************************************************/
+
+#define BENCH_TIMING_RUNS		5			/* timed runs per measurement, after one to warm up */
+
+
+
+/***************************************************************************
+    TYPE DEFINITIONS
+***************************************************************************/
+
+/* one run of whatever is being measured; returns the ticks it took */
+typedef osd_ticks_t (*bench_run_func)(void *param);
+
+
+
+/***************************************************************************
+    FUNCTION PROTOTYPES
+***************************************************************************/
+
+/* reseed the shared xorshift generator */
+void bench_random_seed(UINT32 seed);
+
+/* return the next value from the shared xorshift generator */
+UINT32 bench_random(void);
+
+/* parse the optional count argument; returns 0 after printing the usage if it is malformed */
+int bench_parse_count(int argc, char *argv[], const char *usage, int multiplier, int defcount);
+
+/* run once to warm up, then return the best of BENCH_TIMING_RUNS runs */
+osd_ticks_t bench_best_of(bench_run_func run, void *param);
+
+/* convert ticks to milliseconds */
+double bench_ms(osd_ticks_t ticks);
+
+/* return how many times faster 'after' is than 'before' */
+double bench_speedup(osd_ticks_t before, osd_ticks_t after);
+
+
+#endif	/* __BENCHUTIL_H__ */
@@ -0,0 +1,489 @@
+/***************************************************************************
+
+    drawgfx row kernel benchmark
+
+    Copyright Nicola Salmoria and the MAME Team.
+    Visit http://mamedev.org for licensing and usage restrictions.
+
+    Draws random sprites through the drawgfx cores twice, once with the
+    plain PIXEL_OP loops and once with the ROW_OP kernels, and checks
+    that the destination and priority bitmaps come out identical. Then
+    times a screenful of sprites both ways for each destination format,
+    operation and priority mode that has an SSE2 specialization,
+    unzoomed and zoomed, keeping the best of several runs.
+
+***************************************************************************/
+
+#include "benchutil.h"
+#include "drawgfxm.h"
+
+
+/***************************************************************************
+    CONSTANTS & DEFINES
+***************************************************************************/
+
+#define SCREEN_WIDTH			384			/* size of the target bitmaps */
+#define SCREEN_HEIGHT			256
+#define MAX_GFX_DIM				64			/* largest test element */
+#define NUM_PENS				256			/* palette entries */
+#define NUM_CODES				64			/* elements in the test gfx */
+
+#define DEFAULT_CHECKS			20000		/* random sprites to verify */
+#define DEFAULT_SPRITES			200000		/* sprites per timing run */
+
+
+
+/***************************************************************************
+    TYPE DEFINITIONS
+***************************************************************************/
+
+/* everything one drawgfx call needs */
+typedef struct _blit_params blit_params;
+struct _blit_params
+{
+	bitmap_t *		dest;
+	bitmap_t *		priority;
+	const rectangle *cliprect;
+	const gfx_element *gfx;
+	const pen_t *	paldata;
+	UINT32			code;
+	UINT32			color;
+	int				flipx, flipy;
+	INT32			destx, desty;
+	UINT32			scalex, scaley;
+	UINT32			transpen;
+	UINT32			transmask;
+	UINT32			pmask;
+};
+
+typedef void (*blit_func)(const blit_params *params);
+
+/* a pair of functions drawing the same thing two ways */
+typedef struct _blit_test blit_test;
+struct _blit_test
+{
+	const char *	name;
+	int				bpp;
+	int				zoom;
+	int				timed;				/* TRUE if the ROW_OP has a specialization worth timing */
+	blit_func		pixel;				/* PIXEL_OP loops only */
+	blit_func		row;				/* with the ROW_OP kernel */
+};
+
+/* one way of drawing a test, as timed by bench_best_of */
+typedef struct _timing_run timing_run;
+struct _timing_run
+{
+	const blit_test *test;
+	blit_func		func;
+	int				numsprites;
+};
+
+
+
+/***************************************************************************
+    GLOBAL VARIABLES
+***************************************************************************/
+
+static UINT8 gfxdata[NUM_CODES * MAX_GFX_DIM * MAX_GFX_DIM];
+static UINT8 gfxdirty[NUM_CODES];
+static pen_t palette[NUM_PENS];
+
+
+
+/***************************************************************************
+    BLITTERS
+***************************************************************************/
+
+/* the cores read these by name */
+#define paldata		(params->paldata)
+#define color		(params->color)
+#define scalex		(params->scalex)
+#define scaley		(params->scaley)
+#define transpen	(params->transpen)
+#define transmask	(params->transmask)
+#define pmask		(params->pmask)
+
+#define BLIT_LOCALS																	\
+	bitmap_t *dest = params->dest;													\
+	bitmap_t *priority = params->priority;											\
+	const rectangle *cliprect = params->cliprect;									\
+	const gfx_element *gfx = params->gfx;											\
+	UINT32 code = params->code;														\
+	int flipx = params->flipx;														\
+	int flipy = params->flipy;														\
+	INT32 destx = params->destx;													\
+	INT32 desty = params->desty;													\
+
+#define BLIT_FUNCS(NAME, PIXEL_TYPE, PIXEL_OP, ROW_OP, PRIORITY_TYPE)				\
+static void NAME##_pixel(const blit_params *params)									\
+{																					\
+	BLIT_LOCALS																		\
+	DRAWGFX_CORE(PIXEL_TYPE, PIXEL_OP, PRIORITY_TYPE);								\
+}																					\
+static void NAME##_row(const blit_params *params)									\
+{																					\
+	BLIT_LOCALS																		\
+	DRAWGFX_ROW_CORE(PIXEL_TYPE, PIXEL_OP, ROW_OP, PRIORITY_TYPE);					\
+}																					\
+static void NAME##_zoom_pixel(const blit_params *params)							\
+{																					\
+	BLIT_LOCALS																		\
+	DRAWGFXZOOM_CORE(PIXEL_TYPE, PIXEL_OP, PRIORITY_TYPE);							\
+}																					\
+static void NAME##_zoom_row(const blit_params *params)								\
+{																					\
+	BLIT_LOCALS																		\
+	DRAWGFXZOOM_ROW_CORE(PIXEL_TYPE, PIXEL_OP, ROW_OP, PRIORITY_TYPE);				\
+}																					\
+
+BLIT_FUNCS(transpen16, UINT16, PIXEL_OP_REMAP_TRANSPEN, ROW_OP_REMAP_TRANSPEN, NO_PRIORITY)
+BLIT_FUNCS(transpen32, UINT32, PIXEL_OP_REMAP_TRANSPEN, ROW_OP_REMAP_TRANSPEN, NO_PRIORITY)
+BLIT_FUNCS(ptranspen16, UINT16, PIXEL_OP_REMAP_TRANSPEN_PRIORITY, ROW_OP_REMAP_TRANSPEN_PRIORITY, UINT8)
+BLIT_FUNCS(ptranspen32, UINT32, PIXEL_OP_REMAP_TRANSPEN_PRIORITY, ROW_OP_REMAP_TRANSPEN_PRIORITY, UINT8)
+BLIT_FUNCS(transmask16, UINT16, PIXEL_OP_REMAP_TRANSMASK, ROW_OP_REMAP_TRANSMASK, NO_PRIORITY)
+BLIT_FUNCS(transmask32, UINT32, PIXEL_OP_REMAP_TRANSMASK, ROW_OP_REMAP_TRANSMASK, NO_PRIORITY)
+BLIT_FUNCS(ptransmask16, UINT16, PIXEL_OP_REMAP_TRANSMASK_PRIORITY, ROW_OP_REMAP_TRANSMASK_PRIORITY, UINT8)
+BLIT_FUNCS(ptransmask32, UINT32, PIXEL_OP_REMAP_TRANSMASK_PRIORITY, ROW_OP_REMAP_TRANSMASK_PRIORITY, UINT8)
+BLIT_FUNCS(raw16, UINT16, PIXEL_OP_REBASE_TRANSPEN, ROW_OP_REBASE_TRANSPEN, NO_PRIORITY)
+BLIT_FUNCS(raw32, UINT32, PIXEL_OP_REBASE_TRANSPEN, ROW_OP_REBASE_TRANSPEN, NO_PRIORITY)
+BLIT_FUNCS(praw16, UINT16, PIXEL_OP_REBASE_TRANSPEN_PRIORITY, ROW_OP_REBASE_TRANSPEN_PRIORITY, UINT8)
+BLIT_FUNCS(praw32, UINT32, PIXEL_OP_REBASE_TRANSPEN_PRIORITY, ROW_OP_REBASE_TRANSPEN_PRIORITY, UINT8)
+
+#undef paldata
+#undef color
+#undef scalex
+#undef scaley
+#undef transpen
+#undef transmask
+#undef pmask
+
+#define BLIT_TESTS(NAME, BPP, TIMED)												\
+	{ #NAME, BPP, FALSE, TIMED, NAME##_pixel, NAME##_row },							\
+	{ #NAME, BPP, TRUE, TIMED, NAME##_zoom_pixel, NAME##_zoom_row }
+
+/* remapping without a priority bitmap stays on the generic ROW_OP loop, so it is only checked */
+static const blit_test tests[] =
+{
+	BLIT_TESTS(transpen16, 16, FALSE),
+	BLIT_TESTS(transpen32, 32, FALSE),
+	BLIT_TESTS(ptranspen16, 16, TRUE),
+	BLIT_TESTS(ptranspen32, 32, TRUE),
+	BLIT_TESTS(transmask16, 16, FALSE),
+	BLIT_TESTS(transmask32, 32, FALSE),
+	BLIT_TESTS(ptransmask16, 16, TRUE),
+	BLIT_TESTS(ptransmask32, 32, TRUE),
+	BLIT_TESTS(raw16, 16, TRUE),
+	BLIT_TESTS(raw32, 32, TRUE),
+	BLIT_TESTS(praw16, 16, TRUE),
+	BLIT_TESTS(praw32, 32, TRUE)
+};
+
+
+
+/***************************************************************************
+    IMPLEMENTATION
+***************************************************************************/
+
+/*-------------------------------------------------
+    gfx_element_decode - never called, since no
+    element is ever dirty, but the cores refer
+    to it
+-------------------------------------------------*/
+
+void gfx_element_decode(const gfx_element *gfx, UINT32 code)
+{
+}
+
+
+/*-------------------------------------------------
+    fill_bitmap - fill a bitmap with random data,
+    keeping each pixel below 'limit'
+-------------------------------------------------*/
+
+static void fill_bitmap(bitmap_t *bitmap, UINT32 limit)
+{
+	int x, y;
+
+	for (y = 0; y < bitmap->height; y++)
+		for (x = 0; x < bitmap->width; x++)
+		{
+			UINT32 value = bench_random() % limit;
+			if (bitmap->bpp == 8)
+				*BITMAP_ADDR8(bitmap, y, x) = value;
+			else if (bitmap->bpp == 16)
+				*BITMAP_ADDR16(bitmap, y, x) = value;
+			else
+				*BITMAP_ADDR32(bitmap, y, x) = value;
+		}
+}
+
+
+/*-------------------------------------------------
+    copy_bitmap - copy one bitmap over another of
+    the same size and format
+-------------------------------------------------*/
+
+static void copy_bitmap(bitmap_t *dest, bitmap_t *src)
+{
+	int y;
+
+	for (y = 0; y < src->height; y++)
+		memcpy(BITMAP_ADDR8(dest, y, 0), BITMAP_ADDR8(src, y, 0), src->width * src->bpp / 8);
+}
+
+
+/*-------------------------------------------------
+    bitmaps_equal - compare the visible pixels of
+    two bitmaps
+-------------------------------------------------*/
+
+static int bitmaps_equal(bitmap_t *bitmap1, bitmap_t *bitmap2)
+{
+	int y;
+
+	for (y = 0; y < bitmap1->height; y++)
+		if (memcmp(BITMAP_ADDR8(bitmap1, y, 0), BITMAP_ADDR8(bitmap2, y, 0), bitmap1->width * bitmap1->bpp / 8) != 0)
+			return FALSE;
+	return TRUE;
+}
+
+
+/*-------------------------------------------------
+    init_gfx - build a test element; most pixels
+    use the low 16 pens, some go above 32 to
+    exercise the transmask wraparound
+-------------------------------------------------*/
+
+static void init_gfx(gfx_element *gfx, int width, int height, int shaped)
+{
+	int pixnum;
+
+	memset(gfx, 0, sizeof(*gfx));
+	gfx->width = gfx->origwidth = width;
+	gfx->height = gfx->origheight = height;
+	gfx->total_elements = NUM_CODES;
+	gfx->color_granularity = 16;
+	gfx->total_colors = NUM_PENS / 16;
+	gfx->gfxdata = gfxdata;
+	gfx->line_modulo = width;
+	gfx->char_modulo = width * height;
+	gfx->dirty = gfxdirty;
+
+	for (pixnum = 0; pixnum < NUM_CODES * width * height; pixnum++)
+	{
+		UINT32 value = bench_random();
+		gfxdata[pixnum] = ((value & 0xf00) == 0) ? (value & 0xff) : (value & 0x0f);
+	}
+
+	/* shaped elements look more like real sprites: solid blobs of varying size on a transparent pen 0 background */
+	if (shaped)
+	{
+		UINT32 code;
+		int x, y;
+
+		for (code = 0; code < NUM_CODES; code++)
+		{
+			int radx = width / 4 + bench_random() % (width / 4 + 1);
+			int rady = height / 4 + bench_random() % (height / 4 + 1);
+			int centerx = width / 2 + bench_random() % 5 - 2;
+			int centery = height / 2 + bench_random() % 5 - 2;
+			UINT8 *base = &gfxdata[code * width * height];
+
+			for (y = 0; y < height; y++)
+				for (x = 0; x < width; x++)
+				{
+					int dx = (x - centerx) * rady, dy = (y - centery) * radx;
+					int inside = (dx * dx + dy * dy <= radx * radx * rady * rady) && (bench_random() & 15) != 0;
+					base[y * width + x] = inside ? 1 + bench_random() % 14 : 0;
+				}
+		}
+	}
+}
+
+
+/*-------------------------------------------------
+    random_params - pick a random sprite to draw
+-------------------------------------------------*/
+
+static void random_params(blit_params *params, gfx_element *gfx, int zoom)
+{
+	static const UINT32 scales[] = { 0x10000, 0x20000, 0x30000, 0x8000, 0x18000, 0xc000, 0x14000 };
+	static const int sizes[] = { 8, 16, 24, 32, 48, 64, 17, 31 };
+	int width = sizes[bench_random() % ARRAY_LENGTH(sizes)];
+	int height = sizes[bench_random() % ARRAY_LENGTH(sizes)];
+
+	init_gfx(gfx, width, height, bench_random() & 1);
+	params->gfx = gfx;
+	params->code = bench_random() % NUM_CODES;
+	params->color = bench_random() % 0x10000;
+	params->flipx = bench_random() & 1;
+	params->flipy = bench_random() & 1;
+	params->scalex = zoom ? scales[bench_random() % ARRAY_LENGTH(scales)] : 0x10000;
+	params->scaley = zoom ? scales[bench_random() % ARRAY_LENGTH(scales)] : 0x10000;
+	params->destx = (INT32)(bench_random() % (SCREEN_WIDTH + 2 * MAX_GFX_DIM)) - MAX_GFX_DIM;
+	params->desty = (INT32)(bench_random() % (SCREEN_HEIGHT + 2 * MAX_GFX_DIM)) - MAX_GFX_DIM;
+	params->transpen = ((bench_random() & 7) == 0) ? 0x100 : (bench_random() & 0x0f);
+	params->transmask = bench_random() & bench_random();
+	params->pmask = (bench_random() & bench_random()) | (1 << 31);
+}
+
+
+/*-------------------------------------------------
+    check_test - draw random sprites both ways
+    and compare the results
+-------------------------------------------------*/
+
+static int check_test(const blit_test *test, int numchecks)
+{
+	bitmap_format format = (test->bpp == 16) ? BITMAP_FORMAT_INDEXED16 : BITMAP_FORMAT_RGB32;
+	bitmap_t dest1(SCREEN_WIDTH, SCREEN_HEIGHT, format);
+	bitmap_t dest2(SCREEN_WIDTH, SCREEN_HEIGHT, format);
+	bitmap_t priority1(SCREEN_WIDTH, SCREEN_HEIGHT, BITMAP_FORMAT_INDEXED8);
+	bitmap_t priority2(SCREEN_WIDTH, SCREEN_HEIGHT, BITMAP_FORMAT_INDEXED8);
+	rectangle cliprect;
+	gfx_element gfx;
+	blit_params params;
+	int checknum;
+
+	for (checknum = 0; checknum < numchecks; checknum++)
+	{
+		/* start both from the same random state, every so often */
+		if (checknum % 64 == 0)
+		{
+			fill_bitmap(&dest1, (test->bpp == 16) ? 0x10000 : 0xffffffff);
+			fill_bitmap(&priority1, ((bench_random() & 3) == 0) ? 256 : 32);
+			copy_bitmap(&dest2, &dest1);
+			copy_bitmap(&priority2, &priority1);
+		}
+
+		/* pick a sprite and a clip */
+		random_params(&params, &gfx, test->zoom);
+		cliprect.min_x = bench_random() % 32;
+		cliprect.max_x = SCREEN_WIDTH - 1 - bench_random() % 32;
+		cliprect.min_y = bench_random() % 32;
+		cliprect.max_y = SCREEN_HEIGHT - 1 - bench_random() % 32;
+		params.cliprect = &cliprect;
+		params.paldata = palette;
+
+		params.dest = &dest1;
+		params.priority = &priority1;
+		(*test->pixel)(&params);
+		params.dest = &dest2;
+		params.priority = &priority2;
+		(*test->row)(&params);
+
+		if (!bitmaps_equal(&dest1, &dest2) || !bitmaps_equal(&priority1, &priority2))
+		{
+			fprintf(stderr, "%s%s: mismatch drawing %dx%d at %d,%d flip %d,%d scale %X,%X\n", test->name, test->zoom ? " zoom" : "",
+					gfx.width, gfx.height, params.destx, params.desty, params.flipx, params.flipy, params.scalex, params.scaley);
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+
+/*-------------------------------------------------
+    time_run - time a run of shaped 16x16
+    sprites, in the same places and with the
+    same flips both ways
+-------------------------------------------------*/
+
+static osd_ticks_t time_run(void *param)
+{
+	const timing_run *run = (const timing_run *)param;
+	const blit_test *test = run->test;
+	bitmap_format format = (test->bpp == 16) ? BITMAP_FORMAT_INDEXED16 : BITMAP_FORMAT_RGB32;
+	bitmap_t dest(SCREEN_WIDTH, SCREEN_HEIGHT, format);
+	bitmap_t priority(SCREEN_WIDTH, SCREEN_HEIGHT, BITMAP_FORMAT_INDEXED8);
+	osd_ticks_t start;
+	gfx_element gfx;
+	blit_params params;
+	int spritenum;
+
+	init_gfx(&gfx, 16, 16, TRUE);
+	bench_random_seed(0x12345678);
+	fill_bitmap(&priority, 4);
+
+	memset(&params, 0, sizeof(params));
+	params.dest = &dest;
+	params.priority = &priority;
+	params.cliprect = &dest.cliprect;
+	params.gfx = &gfx;
+	params.paldata = palette;
+	params.scalex = params.scaley = test->zoom ? 0x20000 : 0x10000;
+	params.transpen = 0;
+	params.transmask = 0x8001;
+	params.pmask = 0xfffc | (1 << 31);
+
+	start = osd_ticks();
+	for (spritenum = 0; spritenum < run->numsprites; spritenum++)
+	{
+		UINT32 value = bench_random();
+		params.destx = (INT32)(value % (SCREEN_WIDTH + 16)) - 16;
+		params.desty = (INT32)((value >> 9) % (SCREEN_HEIGHT + 16)) - 16;
+		params.flipx = (value >> 30) & 1;
+		params.flipy = (value >> 31) & 1;
+		params.code = (value >> 20) % NUM_CODES;
+		(*run->func)(&params);
+	}
+	return osd_ticks() - start;
+}
+
+
+/*-------------------------------------------------
+    time_test - return the best time for one
+    way of drawing a test
+-------------------------------------------------*/
+
+static osd_ticks_t time_test(const blit_test *test, blit_func func, int numsprites)
+{
+	timing_run run;
+
+	run.test = test;
+	run.func = func;
+	run.numsprites = numsprites;
+	return bench_best_of(time_run, &run);
+}
+
+
+/*-------------------------------------------------
+    main - main entry point
+-------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+	int numsprites = bench_parse_count(argc, argv, "blitbench [thousands of sprites per timing run]", 1000, DEFAULT_SPRITES);
+	int failures = 0;
+	int pennum, testnum;
+
+	if (numsprites == 0)
+		return 1;
+
+	for (pennum = 0; pennum < NUM_PENS; pennum++)
+		palette[pennum] = bench_random();
+
+	/* first make sure every kernel matches its PIXEL_OP */
+	for (testnum = 0; testnum < ARRAY_LENGTH(tests); testnum++)
+		if (!check_test(&tests[testnum], DEFAULT_CHECKS))
+			failures++;
+	printf("%d of %d kernels match the PIXEL_OP path\n", (int)ARRAY_LENGTH(tests) - failures, (int)ARRAY_LENGTH(tests));
+
+	/* then time the specialized ones */
+	printf("\nOperation     Zoom  PIXEL_OP(ms)  ROW_OP(ms)  Speedup\n");
+	for (testnum = 0; testnum < ARRAY_LENGTH(tests); testnum++)
+	{
+		const blit_test *test = &tests[testnum];
+		osd_ticks_t pixel, row;
+
+		if (!test->timed)
+			continue;
+		pixel = time_test(test, test->pixel, numsprites);
+		row = time_test(test, test->row, numsprites);
+
+		printf("%-12s  %4s  %12.2f  %10.2f  %6.2fx\n", test->name, test->zoom ? "2x" : "1x",
+				bench_ms(pixel), bench_ms(row), bench_speedup(pixel, row));
+	}
+	return (failures == 0) ? 0 : 1;
+}
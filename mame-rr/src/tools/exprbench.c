@@ -0,0 +1,565 @@
+/***************************************************************************
+
+    debugger expression benchmark
+
+    Copyright Nicola Salmoria and the MAME Team.
+    Visit http://mamedev.org for licensing and usage restrictions.
+
+    Loads a cheat file and parses every action, condition and output
+    argument in it the way the cheat engine does, with the same per-cheat
+    symbols. Each expression is parsed twice and one copy has its
+    compiled program discarded, so both go through expression_execute:
+    one runs the compiled program and the other the token interpreter.
+    Both start from the same variables and memory, and the results,
+    errors and final variables and memory must come out identical. Then
+    times each expression both ways, keeping the best of several runs.
+
+***************************************************************************/
+
+#include <ctype.h>
+#include "benchutil.h"
+#include "xmlfile.h"
+#include "debug/express.h"
+
+
+/***************************************************************************
+    CONSTANTS & DEFINES
+***************************************************************************/
+
+#define CHEAT_VERSION			1			/* version of the cheat file format */
+#define DEFAULT_TEMP_VARIABLES	10			/* temp variables in a cheat by default */
+
+#define MEMORY_SIZE				0x10000		/* bytes in each memory bank */
+#define NUM_BANKS				4			/* banks the memory names and spaces map onto */
+
+#define DEFAULT_CHECKS			1000		/* runs of each expression to verify */
+#define DEFAULT_RUNS			100000		/* runs of each expression to time */
+
+#define NAME_LENGTH				40			/* characters of each expression to print */
+
+
+
+/***************************************************************************
+    TYPE DEFINITIONS
+***************************************************************************/
+
+/* the variables of one cheat, as the cheat engine provides them */
+typedef struct _bench_cheat bench_cheat;
+struct _bench_cheat
+{
+	bench_cheat *	next;
+	symbol_table *	symbols;
+	UINT64			argindex;
+	UINT64			param;
+	int				numtemp;
+	UINT64 *		tempvar;
+};
+
+
+/* one expression from the file, parsed both ways */
+typedef struct _bench_expression bench_expression;
+struct _bench_expression
+{
+	bench_expression *next;
+	bench_cheat *	cheat;
+	const char *	string;
+	int				compiled;			/* TRUE if expression_parse compiled it */
+	parsed_expression *program;			/* runs the compiled program, if there is one */
+	parsed_expression *tokens;			/* always runs the token interpreter */
+};
+
+
+/* one way of running an expression, as timed by bench_best_of */
+typedef struct _timing_run timing_run;
+struct _timing_run
+{
+	bench_expression *expr;
+	parsed_expression *parsed;
+	int				numruns;
+};
+
+
+
+/***************************************************************************
+    GLOBAL VARIABLES
+***************************************************************************/
+
+static UINT64 framecount;
+static UINT8 memory[NUM_BANKS][MEMORY_SIZE];
+
+
+
+/***************************************************************************
+    CALLBACKS
+***************************************************************************/
+
+/*-------------------------------------------------
+    variable_get/variable_set - symbol callbacks
+    for the cheat variables
+-------------------------------------------------*/
+
+static UINT64 variable_get(void *globalref, void *symref)
+{
+	return *(UINT64 *)symref;
+}
+
+static void variable_set(void *globalref, void *symref, UINT64 value)
+{
+	*(UINT64 *)symref = value;
+}
+
+
+/*-------------------------------------------------
+    execute_frombcd/execute_tobcd - the BCD
+    functions the cheat engine provides
+-------------------------------------------------*/
+
+static UINT64 execute_frombcd(void *globalref, void *ref, UINT32 params, const UINT64 *param)
+{
+	UINT64 value = param[0];
+	UINT64 multiplier = 1;
+	UINT64 result = 0;
+
+	while (value != 0)
+	{
+		result += (value & 0x0f) * multiplier;
+		value >>= 4;
+		multiplier *= 10;
+	}
+	return result;
+}
+
+static UINT64 execute_tobcd(void *globalref, void *ref, UINT32 params, const UINT64 *param)
+{
+	UINT64 value = param[0];
+	UINT64 result = 0;
+	UINT8 shift = 0;
+
+	while (value != 0)
+	{
+		result += (value % 10) << shift;
+		value /= 10;
+		shift += 4;
+	}
+	return result;
+}
+
+
+/*-------------------------------------------------
+    memory_bank - pick the bank a memory name
+    and space refer to
+-------------------------------------------------*/
+
+static UINT8 *memory_bank(const char *name, int space)
+{
+	UINT32 hash = space;
+
+	if (name != NULL)
+		while (*name != 0)
+			hash = hash * 31 + (UINT8)*name++;
+	return memory[hash % NUM_BANKS];
+}
+
+
+/*-------------------------------------------------
+    memory_read/memory_write/memory_valid -
+    memory callbacks; every name and space is
+    valid and maps onto a flat little-endian bank
+-------------------------------------------------*/
+
+static UINT64 memory_read(void *cbparam, const char *name, int space, UINT32 offset, int size)
+{
+	const UINT8 *base = memory_bank(name, space);
+	UINT64 result = 0;
+	int bytenum;
+
+	for (bytenum = size - 1; bytenum >= 0; bytenum--)
+		result = (result << 8) | base[(offset + bytenum) % MEMORY_SIZE];
+	return result;
+}
+
+static void memory_write(void *cbparam, const char *name, int space, UINT32 offset, int size, UINT64 value)
+{
+	UINT8 *base = memory_bank(name, space);
+	int bytenum;
+
+	for (bytenum = 0; bytenum < size; bytenum++, value >>= 8)
+		base[(offset + bytenum) % MEMORY_SIZE] = value;
+}
+
+static EXPRERR memory_valid(void *cbparam, const char *name, int space)
+{
+	return EXPRERR_NONE;
+}
+
+static const express_callbacks callbacks =
+{
+	memory_read,
+	memory_write,
+	memory_valid
+};
+
+
+
+/***************************************************************************
+    CHEAT FILE LOADING
+***************************************************************************/
+
+/*-------------------------------------------------
+    cheat_alloc - create a cheat and its symbol
+    table, the way the cheat engine does
+-------------------------------------------------*/
+
+static bench_cheat *cheat_alloc(const char *filename, xml_data_node *cheatnode)
+{
+	int tempcount = xml_get_attribute_int(cheatnode, "tempvariables", DEFAULT_TEMP_VARIABLES);
+	bench_cheat *cheat;
+	int curtemp;
+
+	if (tempcount < 1)
+	{
+		fprintf(stderr, "%s(%d): invalid tempvariables attribute (%d)\n", filename, cheatnode->line, tempcount);
+		return NULL;
+	}
+
+	cheat = (bench_cheat *)osd_malloc(sizeof(*cheat));
+	memset(cheat, 0, sizeof(*cheat));
+	cheat->numtemp = tempcount;
+	cheat->tempvar = (UINT64 *)osd_malloc(tempcount * sizeof(cheat->tempvar[0]));
+	memset(cheat->tempvar, 0, tempcount * sizeof(cheat->tempvar[0]));
+
+	cheat->symbols = symtable_alloc(NULL, NULL);
+	symtable_add_register(cheat->symbols, "frame", &framecount, variable_get, NULL);
+	symtable_add_register(cheat->symbols, "argindex", &cheat->argindex, variable_get, NULL);
+	for (curtemp = 0; curtemp < tempcount; curtemp++)
+	{
+		char tempname[20];
+		sprintf(tempname, "temp%d", curtemp);
+		symtable_add_register(cheat->symbols, tempname, &cheat->tempvar[curtemp], variable_get, variable_set);
+	}
+	symtable_add_function(cheat->symbols, "frombcd", NULL, 1, 1, execute_frombcd);
+	symtable_add_function(cheat->symbols, "tobcd", NULL, 1, 1, execute_tobcd);
+	if (xml_get_sibling(cheatnode->child, "parameter") != NULL)
+		symtable_add_register(cheat->symbols, "param", &cheat->param, variable_get, NULL);
+	return cheat;
+}
+
+
+/*-------------------------------------------------
+    add_expression - parse an expression both
+    ways and append it to the list; expressions
+    that don't parse are reported and skipped
+-------------------------------------------------*/
+
+static int add_expression(const char *filename, int line, bench_cheat *cheat, const char *string, bench_expression ***tailptr)
+{
+	bench_expression *expr;
+	parsed_expression *program, *tokens;
+	EXPRERR err;
+
+	if (string == NULL || string[0] == 0)
+		return FALSE;
+
+	err = expression_parse(string, cheat->symbols, &callbacks, NULL, &program);
+	if (err != EXPRERR_NONE)
+	{
+		fprintf(stderr, "%s(%d): error parsing cheat expression \"%s\" (%s)\n", filename, line, string, exprerr_to_string(err));
+		return FALSE;
+	}
+	expression_parse(string, cheat->symbols, &callbacks, NULL, &tokens);
+
+	expr = (bench_expression *)osd_malloc(sizeof(*expr));
+	expr->next = NULL;
+	expr->cheat = cheat;
+	expr->string = string;
+	expr->program = program;
+	expr->tokens = tokens;
+	expr->compiled = expression_uncompile(tokens);
+
+	**tailptr = expr;
+	*tailptr = &expr->next;
+	return TRUE;
+}
+
+
+/*-------------------------------------------------
+    load_cheats - gather every expression in a
+    cheat file; returns the number that didn't
+    parse, or -1 if the file itself is bad
+-------------------------------------------------*/
+
+static int load_cheats(const char *filename, xml_data_node *rootnode, bench_cheat **cheatlist, bench_expression **exprlist)
+{
+	bench_cheat **cheattail = cheatlist;
+	bench_expression **exprtail = exprlist;
+	xml_data_node *mamecheatnode, *cheatnode, *scriptnode, *entrynode, *argnode;
+	int skipped = 0;
+
+	mamecheatnode = xml_get_sibling(rootnode->child, "mamecheat");
+	if (mamecheatnode == NULL)
+	{
+		fprintf(stderr, "%s: missing mamecheat node\n", filename);
+		return -1;
+	}
+	if (xml_get_attribute_int(mamecheatnode, "version", 0) != CHEAT_VERSION)
+	{
+		fprintf(stderr, "%s(%d): unsupported cheat file version\n", filename, mamecheatnode->line);
+		return -1;
+	}
+
+	for (cheatnode = xml_get_sibling(mamecheatnode->child, "cheat"); cheatnode != NULL; cheatnode = xml_get_sibling(cheatnode->next, "cheat"))
+	{
+		bench_cheat *cheat = cheat_alloc(filename, cheatnode);
+		if (cheat == NULL)
+			return -1;
+		*cheattail = cheat;
+		cheattail = &cheat->next;
+
+		/* actions and outputs, each with an optional condition */
+		for (scriptnode = xml_get_sibling(cheatnode->child, "script"); scriptnode != NULL; scriptnode = xml_get_sibling(scriptnode->next, "script"))
+			for (entrynode = scriptnode->child; entrynode != NULL; entrynode = entrynode->next)
+			{
+				const char *condition = xml_get_attribute_string(entrynode, "condition", NULL);
+
+				if (condition != NULL)
+					skipped += !add_expression(filename, entrynode->line, cheat, condition, &exprtail);
+				if (strcmp(entrynode->name, "action") == 0)
+					skipped += !add_expression(filename, entrynode->line, cheat, entrynode->value, &exprtail);
+				else if (strcmp(entrynode->name, "output") == 0)
+					for (argnode = xml_get_sibling(entrynode->child, "argument"); argnode != NULL; argnode = xml_get_sibling(argnode->next, "argument"))
+						skipped += !add_expression(filename, argnode->line, cheat, argnode->value, &exprtail);
+			}
+	}
+	return skipped;
+}
+
+
+
+/***************************************************************************
+    IMPLEMENTATION
+***************************************************************************/
+
+/*-------------------------------------------------
+    reset_state - put the variables and memory
+    back to a known state
+-------------------------------------------------*/
+
+static void reset_state(bench_cheat *cheat)
+{
+	int tempnum, bank, offset;
+
+	bench_random_seed(0x12345678);
+	framecount = bench_random() & 0xffff;
+	cheat->argindex = bench_random() & 3;
+	cheat->param = bench_random() & 0xff;
+	for (tempnum = 0; tempnum < cheat->numtemp; tempnum++)
+		cheat->tempvar[tempnum] = bench_random() & 0xffff;
+	for (bank = 0; bank < NUM_BANKS; bank++)
+		for (offset = 0; offset < MEMORY_SIZE; offset++)
+			memory[bank][offset] = bench_random();
+}
+
+
+/*-------------------------------------------------
+    hash_value - fold a value into a hash
+-------------------------------------------------*/
+
+static UINT64 hash_value(UINT64 hash, UINT64 value)
+{
+	return (hash ^ value) * U64(1099511628211);
+}
+
+
+/*-------------------------------------------------
+    run_expression - run an expression once a
+    frame for a number of frames from the reset
+    state and return a hash of everything it did
+-------------------------------------------------*/
+
+static UINT64 run_expression(bench_cheat *cheat, parsed_expression *parsed, int numruns)
+{
+	UINT64 hash = U64(14695981039346656037);
+	int runnum, tempnum, bank, offset;
+
+	reset_state(cheat);
+	for (runnum = 0; runnum < numruns; runnum++, framecount++)
+	{
+		UINT64 result = 0;
+		EXPRERR err = expression_execute(parsed, &result);
+
+		hash = hash_value(hash, err);
+		hash = hash_value(hash, result);
+	}
+
+	hash = hash_value(hash, framecount);
+	for (tempnum = 0; tempnum < cheat->numtemp; tempnum++)
+		hash = hash_value(hash, cheat->tempvar[tempnum]);
+	for (bank = 0; bank < NUM_BANKS; bank++)
+		for (offset = 0; offset < MEMORY_SIZE; offset++)
+			hash = hash_value(hash, memory[bank][offset]);
+	return hash;
+}
+
+
+/*-------------------------------------------------
+    time_run - time a number of runs of an
+    expression
+-------------------------------------------------*/
+
+static osd_ticks_t time_run(void *param)
+{
+	const timing_run *run = (const timing_run *)param;
+	osd_ticks_t start;
+	UINT64 result;
+	int runnum;
+
+	reset_state(run->expr->cheat);
+	start = osd_ticks();
+	for (runnum = 0; runnum < run->numruns; runnum++, framecount++)
+		expression_execute(run->parsed, &result);
+	return osd_ticks() - start;
+}
+
+
+/*-------------------------------------------------
+    time_expression - return the best time for
+    one way of running an expression
+-------------------------------------------------*/
+
+static osd_ticks_t time_expression(bench_expression *expr, parsed_expression *parsed, int numruns)
+{
+	timing_run run;
+
+	run.expr = expr;
+	run.parsed = parsed;
+	run.numruns = numruns;
+	return bench_best_of(time_run, &run);
+}
+
+
+/*-------------------------------------------------
+    short_name - return the start of an
+    expression on one line, for printing
+-------------------------------------------------*/
+
+static const char *short_name(const char *string)
+{
+	static char buffer[NAME_LENGTH + 1];
+	int length = 0;
+
+	while (*string != 0 && isspace((UINT8)*string))
+		string++;
+	for ( ; *string != 0 && length < NAME_LENGTH; string++)
+		if (!isspace((UINT8)*string))
+			buffer[length++] = *string;
+		else if (buffer[length - 1] != ' ')
+			buffer[length++] = ' ';
+	buffer[length] = 0;
+	return buffer;
+}
+
+
+/*-------------------------------------------------
+    main - main entry point
+-------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+	const char *usage = "exprbench <cheatfile.xml> [thousands of runs per expression]";
+	bench_cheat *cheatlist = NULL, *cheat;
+	bench_expression *exprlist = NULL, *expr;
+	osd_ticks_t totaltokens = 0, totalprogram = 0;
+	int total = 0, compiled = 0, failures = 0;
+	xml_parse_options options;
+	xml_parse_error error;
+	xml_data_node *rootnode;
+	core_file *file;
+	int numruns, skipped;
+
+	/* the cheat file comes first; an optional argument after it scales the timing runs */
+	if (argc < 2)
+	{
+		fprintf(stderr, "Usage:\n  %s\n", usage);
+		return 1;
+	}
+	numruns = bench_parse_count(argc - 1, argv + 1, usage, 1000, DEFAULT_RUNS);
+	if (numruns == 0)
+		return 1;
+
+	/* read the cheat file */
+	if (core_fopen(argv[1], OPEN_FLAG_READ, &file) != FILERR_NONE)
+	{
+		fprintf(stderr, "%s: unable to open file\n", argv[1]);
+		return 1;
+	}
+	memset(&options, 0, sizeof(options));
+	options.error = &error;
+	rootnode = xml_file_read(file, &options);
+	core_fclose(file);
+	if (rootnode == NULL)
+	{
+		fprintf(stderr, "%s(%d): error parsing XML (%s)\n", argv[1], error.error_line, error.error_message);
+		return 1;
+	}
+
+	/* parse everything up front */
+	skipped = load_cheats(argv[1], rootnode, &cheatlist, &exprlist);
+	if (skipped < 0)
+		return 1;
+
+	/* first make sure every compiled program matches the interpreter */
+	for (expr = exprlist; expr != NULL; expr = expr->next)
+	{
+		total++;
+		if (!expr->compiled)
+			continue;
+		compiled++;
+		if (run_expression(expr->cheat, expr->tokens, DEFAULT_CHECKS) != run_expression(expr->cheat, expr->program, DEFAULT_CHECKS))
+		{
+			fprintf(stderr, "%s: compiled program does not match the interpreter\n", expr->string);
+			failures++;
+		}
+	}
+	printf("%d expressions (%d skipped), %d compiled, %d match the interpreter\n", total, skipped, compiled, compiled - failures);
+
+	/* then time them */
+	printf("\n%-*s  Tokens(ms)  Compiled(ms)  Speedup\n", NAME_LENGTH, "Expression");
+	for (expr = exprlist; expr != NULL; expr = expr->next)
+	{
+		osd_ticks_t tokens = time_expression(expr, expr->tokens, numruns);
+		osd_ticks_t program;
+
+		if (!expr->compiled)
+		{
+			printf("%-*s  %10.2f  %12s\n", NAME_LENGTH, short_name(expr->string), bench_ms(tokens), "-");
+			continue;
+		}
+		program = time_expression(expr, expr->program, numruns);
+		totaltokens += tokens;
+		totalprogram += program;
+		printf("%-*s  %10.2f  %12.2f  %6.2fx\n", NAME_LENGTH, short_name(expr->string),
+				bench_ms(tokens), bench_ms(program), bench_speedup(tokens, program));
+	}
+	printf("%-*s  %10.2f  %12.2f  %6.2fx\n", NAME_LENGTH, "(all compiled)",
+			bench_ms(totaltokens), bench_ms(totalprogram), bench_speedup(totaltokens, totalprogram));
+
+	/* free everything */
+	while (exprlist != NULL)
+	{
+		expr = exprlist;
+		exprlist = expr->next;
+		expression_free(expr->program);
+		expression_free(expr->tokens);
+		osd_free(expr);
+	}
+	while (cheatlist != NULL)
+	{
+		cheat = cheatlist;
+		cheatlist = cheat->next;
+		symtable_free(cheat->symbols);
+		osd_free(cheat->tempvar);
+		osd_free(cheat);
+	}
+	xml_file_free(rootnode);
+	return (failures == 0) ? 0 : 1;
+}
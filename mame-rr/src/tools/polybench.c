@@ -0,0 +1,267 @@
+/***************************************************************************
+
+    polygon rendering benchmark
+
+    Copyright Nicola Salmoria and the MAME Team.
+    Visit http://mamedev.org for licensing and usage restrictions.
+
+    Renders a fixed scene of random triangles and quads through poly.c
+    with no work queue, with the work queue, and with POLYFLAG_DEFERRED,
+    and checks that every mode leaves the same frame hash. The scanline
+    callback blends into the frame in an order-dependent way, so any
+    change in the order polygons reach a scanline shows up in the hash.
+    A small manager is run as well, so polygons and work units run out
+    and force flushes in the middle of a frame. Then times each mode,
+    keeping the best of several runs.
+
+***************************************************************************/
+
+#include "benchutil.h"
+
+/* measured directly; see benchcore.c */
+#include "video/poly.c"
+
+
+/***************************************************************************
+    CONSTANTS & DEFINES
+***************************************************************************/
+
+#define FRAME_WIDTH				640			/* size of the frame */
+#define FRAME_HEIGHT			480
+#define SCENE_POLYS				3000		/* polygons per frame */
+#define SCENE_FRAMES			4			/* frames per scene */
+#define LARGE_MANAGER			4000		/* polygons in the normal manager */
+#define SMALL_MANAGER			200			/* polygons in the flushing manager */
+
+#define DEFAULT_SCENES			3			/* random scenes to verify */
+#define DEFAULT_RUNS			5			/* scenes per timing run */
+
+
+
+/***************************************************************************
+    TYPE DEFINITIONS
+***************************************************************************/
+
+/* per-polygon data for the scanline callback */
+typedef struct _poly_extra poly_extra;
+struct _poly_extra
+{
+	UINT32			color;
+	UINT8			blend;
+};
+
+
+/* a way of running the scene */
+typedef struct _poly_mode poly_mode;
+struct _poly_mode
+{
+	const char *	name;
+	UINT8			flags;
+};
+
+
+/* one mode, as timed by bench_best_of */
+typedef struct _timing_run timing_run;
+struct _timing_run
+{
+	running_machine *machine;
+	UINT8			flags;
+	int				numruns;
+};
+
+
+
+/***************************************************************************
+    GLOBAL VARIABLES
+***************************************************************************/
+
+static UINT32 frame[FRAME_HEIGHT][FRAME_WIDTH];
+
+/* the machine is never constructed; poly.c only hands it back to the stubs */
+static UINT64 machine_buffer[(sizeof(running_machine) + 7) / 8];
+
+static const poly_mode modes[] =
+{
+	{ "serial", POLYFLAG_NO_WORK_QUEUE },
+	{ "immediate", 0 },
+	{ "deferred", POLYFLAG_DEFERRED }
+};
+
+
+
+/***************************************************************************
+    IMPLEMENTATION
+***************************************************************************/
+
+/*-------------------------------------------------
+    random_coord - random coordinate within
+    'size' of 'center'
+-------------------------------------------------*/
+
+static float random_coord(float center, float size)
+{
+	return center + ((float)(bench_random() % 1000) / 1000.0f - 0.5f) * size;
+}
+
+
+/*-------------------------------------------------
+    draw_scanline - blend a span into the frame;
+    each write depends on the one before it
+-------------------------------------------------*/
+
+static void draw_scanline(void *dest, INT32 scanline, const poly_extent *extent, const void *extradata, int threadid)
+{
+	const poly_extra *extra = (const poly_extra *)extradata;
+	UINT32 *row = (UINT32 *)dest + scanline * FRAME_WIDTH;
+	float z = extent->param[0].start;
+	int x;
+
+	for (x = extent->startx; x < extent->stopx; x++, z += extent->param[0].dpdx)
+	{
+		if (extra->blend)
+			row[x] = row[x] * 31 + extra->color + (UINT32)(z * 16.0f);
+		else
+			row[x] = extra->color ^ (UINT32)(z * 256.0f);
+	}
+}
+
+
+/*-------------------------------------------------
+    render_scene - render a random scene and
+    return the hash of the final frame
+-------------------------------------------------*/
+
+static UINT32 render_scene(running_machine *machine, UINT8 flags, int max_polys, UINT32 seed)
+{
+	poly_manager *poly = poly_alloc(machine, max_polys, sizeof(poly_extra), flags);
+	rectangle cliprect;
+	UINT32 hash = 2166136261U;
+	int framenum, polynum, x, y;
+
+	cliprect.min_x = 0;
+	cliprect.max_x = FRAME_WIDTH - 1;
+	cliprect.min_y = 0;
+	cliprect.max_y = FRAME_HEIGHT - 1;
+	memset(frame, 0, sizeof(frame));
+	bench_random_seed(seed);
+
+	for (framenum = 0; framenum < SCENE_FRAMES; framenum++)
+	{
+		for (polynum = 0; polynum < SCENE_POLYS; polynum++)
+		{
+			poly_extra *extra = (poly_extra *)poly_get_extra_data(poly);
+			float centerx = (float)(bench_random() % (FRAME_WIDTH + 100)) - 50.0f;
+			float centery = (float)(bench_random() % (FRAME_HEIGHT + 100)) - 50.0f;
+			float size = (float)(((bench_random() & 3) == 0) ? bench_random() % 300 : bench_random() % 20);
+			poly_vertex v[4];
+			int vertnum;
+
+			extra->color = bench_random();
+			extra->blend = bench_random() & 1;
+			for (vertnum = 0; vertnum < 4; vertnum++)
+			{
+				v[vertnum].x = random_coord(centerx, size);
+				v[vertnum].y = random_coord(centery, size);
+				v[vertnum].p[0] = (float)(bench_random() % 100) / 10.0f;
+			}
+
+			if ((flags & POLYFLAG_ALLOW_QUADS) && (polynum & 1))
+				poly_render_quad(poly, frame, &cliprect, draw_scanline, 1, &v[0], &v[1], &v[2], &v[3]);
+			else
+				poly_render_triangle(poly, frame, &cliprect, draw_scanline, 1, &v[0], &v[1], &v[2]);
+		}
+		poly_wait(poly, "frame");
+	}
+	poly_free(poly);
+
+	for (y = 0; y < FRAME_HEIGHT; y++)
+		for (x = 0; x < FRAME_WIDTH; x++)
+			hash = (hash ^ frame[y][x]) * 16777619U;
+	return hash;
+}
+
+
+/*-------------------------------------------------
+    check_scene - render one scene in every mode
+    and compare the hashes
+-------------------------------------------------*/
+
+static int check_scene(running_machine *machine, UINT8 extraflags, int max_polys, UINT32 seed)
+{
+	UINT32 expected = 0;
+	int result = TRUE;
+	int modenum;
+
+	for (modenum = 0; modenum < ARRAY_LENGTH(modes); modenum++)
+	{
+		UINT32 hash = render_scene(machine, modes[modenum].flags | extraflags, max_polys, seed);
+
+		if (modenum == 0)
+			expected = hash;
+		else if (hash != expected)
+		{
+			fprintf(stderr, "%s%s, %d polygons, seed %08X: hash %08X, expected %08X\n", modes[modenum].name,
+					(extraflags & POLYFLAG_ALLOW_QUADS) ? " quads" : "", max_polys, seed, hash, expected);
+			result = FALSE;
+		}
+	}
+	return result;
+}
+
+
+/*-------------------------------------------------
+    time_run - time a run of scenes in one mode
+-------------------------------------------------*/
+
+static osd_ticks_t time_run(void *param)
+{
+	const timing_run *run = (const timing_run *)param;
+	osd_ticks_t start = osd_ticks();
+	int runnum;
+
+	for (runnum = 0; runnum < run->numruns; runnum++)
+		render_scene(run->machine, run->flags, LARGE_MANAGER, 0x12345678 + runnum);
+	return osd_ticks() - start;
+}
+
+
+/*-------------------------------------------------
+    main - main entry point
+-------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+	running_machine *machine = (running_machine *)machine_buffer;
+	int numruns = bench_parse_count(argc, argv, "polybench [scenes per timing run]", 1, DEFAULT_RUNS);
+	int checks = 0, failures = 0;
+	int scenenum, modenum;
+
+	if (numruns == 0)
+		return 1;
+
+	/* first make sure every mode draws the same frames */
+	for (scenenum = 0; scenenum < DEFAULT_SCENES; scenenum++)
+	{
+		UINT32 seed = 0x12345678 + scenenum * 0x9e3779b9;
+
+		checks += 4;
+		failures += !check_scene(machine, 0, LARGE_MANAGER, seed);
+		failures += !check_scene(machine, POLYFLAG_ALLOW_QUADS, LARGE_MANAGER, seed);
+		failures += !check_scene(machine, 0, SMALL_MANAGER, seed);
+		failures += !check_scene(machine, POLYFLAG_ALLOW_QUADS, SMALL_MANAGER, seed);
+	}
+	printf("%d of %d scenes match in every mode\n", checks - failures, checks);
+
+	/* then time them */
+	printf("\nMode        Time(ms)\n");
+	for (modenum = 0; modenum < ARRAY_LENGTH(modes); modenum++)
+	{
+		timing_run run;
+
+		run.machine = machine;
+		run.flags = modes[modenum].flags;
+		run.numruns = numruns;
+		printf("%-10s  %8.2f\n", modes[modenum].name, bench_ms(bench_best_of(time_run, &run)));
+	}
+	return (failures == 0) ? 0 : 1;
+}
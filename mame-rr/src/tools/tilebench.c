@@ -0,0 +1,470 @@
+/***************************************************************************
+
+    tilemap drawing benchmark
+
+    Copyright Nicola Salmoria and the MAME Team.
+    Visit http://mamedev.org for licensing and usage restrictions.
+
+    Scrolls a random tilemap around for a number of frames, rewriting a
+    few tiles and changing the clip each frame, and draws it in several
+    layers through tilemap_draw_primask. Each layer is also drawn by a
+    plain per-pixel loop straight from the tilemap's pixmap and flagsmap,
+    and the destination and priority bitmaps must come out identical.
+    Then times a run of frames both ways for each destination format,
+    keeping the best of several runs.
+
+***************************************************************************/
+
+#include "benchutil.h"
+
+/* measured directly; see benchcore.c */
+#include "tilemap.c"
+
+
+/***************************************************************************
+    CONSTANTS & DEFINES
+***************************************************************************/
+
+#define SCREEN_WIDTH			320			/* size of the target bitmaps */
+#define SCREEN_HEIGHT			224
+#define TILE_SIZE				8			/* size of each tile */
+#define TILEMAP_COLS			64			/* size of the tilemap in tiles */
+#define TILEMAP_ROWS			32
+#define NUM_CODES				64			/* tiles in the test graphics */
+#define NUM_PENS				1024		/* palette entries */
+
+#define DEFAULT_CHECKS			500			/* random frames to verify */
+#define DEFAULT_FRAMES			2000		/* frames per timing run */
+
+
+
+/***************************************************************************
+    TYPE DEFINITIONS
+***************************************************************************/
+
+/* one layer of a frame */
+typedef struct _layer_pass layer_pass;
+struct _layer_pass
+{
+	UINT32			flags;				/* tilemap_draw flags */
+	UINT8			priority;			/* priority code */
+	int				to_priority;		/* draw only to the priority bitmap */
+	int				rgb_only;			/* skip for indexed destinations */
+};
+
+
+/* a destination format to test */
+typedef struct _format_test format_test;
+struct _format_test
+{
+	const char *	name;
+	bitmap_format	format;
+};
+
+
+typedef void (*draw_func)(bitmap_t *dest, const rectangle *cliprect, tilemap_t *tmap, UINT32 flags, UINT8 priority, UINT8 priority_mask);
+
+
+/* one way of drawing a format, as timed by bench_best_of */
+typedef struct _timing_run timing_run;
+struct _timing_run
+{
+	running_machine *machine;
+	const format_test *test;
+	draw_func		draw;
+	int				numframes;
+};
+
+
+
+/***************************************************************************
+    GLOBAL VARIABLES
+***************************************************************************/
+
+static UINT8 gfxdata[NUM_CODES][TILE_SIZE * TILE_SIZE];
+static UINT16 videoram[TILEMAP_COLS * TILEMAP_ROWS];
+static pen_t palette[NUM_PENS];
+
+/* the machine and screen are never constructed; only the few fields the
+   tilemap code looks at are filled in */
+static UINT64 machine_buffer[(sizeof(running_machine) + 7) / 8];
+static UINT64 screen_buffer[(sizeof(screen_device) + 7) / 8];
+
+static const layer_pass passes[] =
+{
+	{ TILEMAP_DRAW_OPAQUE, 0, FALSE, FALSE },
+	{ TILEMAP_DRAW_LAYER1 | 1, 1, FALSE, FALSE },
+	{ TILEMAP_DRAW_LAYER0, 2, FALSE, FALSE },
+	{ (UINT32)(TILEMAP_DRAW_LAYER0 | TILEMAP_DRAW_ALL_CATEGORIES | TILEMAP_DRAW_ALPHA(0x80)), 4, FALSE, TRUE },
+	{ TILEMAP_DRAW_LAYER1, 8, TRUE, FALSE }
+};
+
+static const format_test formats[] =
+{
+	{ "ind16", BITMAP_FORMAT_INDEXED16 },
+	{ "rgb15", BITMAP_FORMAT_RGB15 },
+	{ "rgb32", BITMAP_FORMAT_RGB32 }
+};
+
+
+
+/***************************************************************************
+    IMPLEMENTATION
+***************************************************************************/
+
+/*-------------------------------------------------
+    wrap - reduce a coordinate into 0..size-1
+-------------------------------------------------*/
+
+INLINE int wrap(int value, int size)
+{
+	value %= size;
+	return (value < 0) ? value + size : value;
+}
+
+
+/*-------------------------------------------------
+    get_tile_info - tile callback; the test
+    graphics aren't a gfx_element, so fill in
+    the tile_data by hand rather than with
+    SET_TILE_INFO
+-------------------------------------------------*/
+
+static TILE_GET_INFO( get_tile_info )
+{
+	UINT16 data = videoram[tile_index];
+
+	tileinfo->pen_data = gfxdata[data % NUM_CODES];
+	tileinfo->palette_base = ((data >> 6) & 15) * 16;
+	tileinfo->category = (data >> 10) & 1;
+	tileinfo->group = (data >> 11) & 1;
+	tileinfo->flags = TILE_FLIPYX(data >> 12);
+}
+
+
+/*-------------------------------------------------
+    random_tile - pick a tile; mostly wholly
+    opaque and wholly transparent ones, so the
+    rows break into long runs as in real games
+-------------------------------------------------*/
+
+static UINT16 random_tile(void)
+{
+	UINT32 kind = bench_random() % 100;
+	UINT16 code = (kind < 35) ? 0 : (kind < 75) ? 1 : bench_random() % NUM_CODES;
+
+	return code | ((bench_random() & 15) << 6) | (((bench_random() & 7) == 0) << 10) | (((bench_random() & 3) == 0) << 11) | ((bench_random() & 3) << 12);
+}
+
+
+/*-------------------------------------------------
+    init_gfx - build the test tiles: 0 is empty,
+    1 is solid and the rest are shapes, with a
+    few pens above 15 for the group 1 transmask
+-------------------------------------------------*/
+
+static void init_gfx(void)
+{
+	int code, x, y;
+
+	for (code = 0; code < NUM_CODES; code++)
+		for (y = 0; y < TILE_SIZE; y++)
+			for (x = 0; x < TILE_SIZE; x++)
+			{
+				int dx = x - TILE_SIZE / 2, dy = y - TILE_SIZE / 2;
+				UINT8 pen = 1 + bench_random() % 15;
+
+				if (code >= 48)
+					pen = bench_random() % 32;
+				else if (code == 0 || (code >= 2 && dx * dx + dy * dy > code % 24))
+					pen = 0;
+				gfxdata[code][y * TILE_SIZE + x] = pen;
+			}
+}
+
+
+/*-------------------------------------------------
+    reference_draw - draw a tilemap one pixel at
+    a time from its pixmap and flagsmap
+-------------------------------------------------*/
+
+static void reference_draw(bitmap_t *dest, const rectangle *cliprect, tilemap_t *tmap, UINT32 flags, UINT8 priority, UINT8 priority_mask)
+{
+	bitmap_t *pixmap = tilemap_get_pixmap(tmap);
+	bitmap_t *flagsmap = tilemap_get_flagsmap(tmap);
+	bitmap_t *priority_bitmap = tmap->machine->priority_bitmap;
+	blit_parameters blit;
+	UINT32 pcode, pal;
+	int x, y;
+
+	/* only borrow the mask, value and priority code; the drawing is all here */
+	configure_blit_parameters(&blit, tmap, dest, cliprect, flags, priority, priority_mask);
+	pcode = blit.tilemap_priority_code;
+	pal = pcode >> 16;
+
+	for (y = cliprect->min_y; y <= cliprect->max_y; y++)
+	{
+		int srcy = wrap(y + tmap->colscroll[0], tmap->height);
+		int scrollx = tmap->rowscroll[srcy * tmap->scrollrows / tmap->height];
+
+		for (x = cliprect->min_x; x <= cliprect->max_x; x++)
+		{
+			int srcx = wrap(x + scrollx, tmap->width);
+			UINT16 pixel = *BITMAP_ADDR16(pixmap, srcy, srcx);
+			UINT8 *pri = BITMAP_ADDR8(priority_bitmap, y, x);
+
+			if ((*BITMAP_ADDR8(flagsmap, srcy, srcx) & blit.mask) != blit.value)
+				continue;
+
+			if (dest == NULL)
+				;
+			else if (dest->format == BITMAP_FORMAT_INDEXED16)
+				*BITMAP_ADDR16(dest, y, x) = pixel + pal;
+			else if (dest->format == BITMAP_FORMAT_RGB15)
+				*BITMAP_ADDR16(dest, y, x) = (blit.alpha < 0xff) ? alpha_blend_r16(*BITMAP_ADDR16(dest, y, x), palette[pal + pixel], blit.alpha) : palette[pal + pixel];
+			else
+				*BITMAP_ADDR32(dest, y, x) = (blit.alpha < 0xff) ? alpha_blend_r32(*BITMAP_ADDR32(dest, y, x), palette[pal + pixel], blit.alpha) : palette[pal + pixel];
+			*pri = (*pri & (pcode >> 8)) | pcode;
+		}
+	}
+}
+
+
+/*-------------------------------------------------
+    copy_bitmap - copy one bitmap over another of
+    the same size and format
+-------------------------------------------------*/
+
+static void copy_bitmap(bitmap_t *dest, bitmap_t *src)
+{
+	int y;
+
+	for (y = 0; y < src->height; y++)
+		memcpy(BITMAP_ADDR8(dest, y, 0), BITMAP_ADDR8(src, y, 0), src->width * src->bpp / 8);
+}
+
+
+/*-------------------------------------------------
+    bitmaps_equal - compare the visible pixels of
+    two bitmaps
+-------------------------------------------------*/
+
+static int bitmaps_equal(bitmap_t *bitmap1, bitmap_t *bitmap2)
+{
+	int y;
+
+	for (y = 0; y < bitmap1->height; y++)
+		if (memcmp(BITMAP_ADDR8(bitmap1, y, 0), BITMAP_ADDR8(bitmap2, y, 0), bitmap1->width * bitmap1->bpp / 8) != 0)
+			return FALSE;
+	return TRUE;
+}
+
+
+/*-------------------------------------------------
+    next_frame - rewrite a few tiles and move the
+    scroll on; every so often switch between a
+    single scroll value and per-line scroll
+-------------------------------------------------*/
+
+static void next_frame(tilemap_t *tmap, int framenum)
+{
+	int tilenum, line;
+
+	for (tilenum = 0; tilenum < 8; tilenum++)
+	{
+		int index = bench_random() % (TILEMAP_COLS * TILEMAP_ROWS);
+		videoram[index] = random_tile();
+		tilemap_mark_tile_dirty(tmap, index);
+	}
+
+	if (framenum % 64 == 0)
+		tilemap_set_scroll_rows(tmap, ((framenum / 64) & 1) ? tmap->height : 1);
+	for (line = 0; line < tmap->scrollrows; line++)
+		tilemap_set_scrollx(tmap, line, framenum * 3 + ((line * 7 + framenum) % 23));
+	tilemap_set_scrolly(tmap, 0, framenum);
+	tilemap_set_palette_offset(tmap, (framenum & 64) ? 0x100 : 0);
+}
+
+
+/*-------------------------------------------------
+    draw_frame - draw every layer of a frame
+-------------------------------------------------*/
+
+static void draw_frame(draw_func draw, bitmap_t *dest, const rectangle *cliprect, tilemap_t *tmap)
+{
+	int passnum;
+
+	for (passnum = 0; passnum < ARRAY_LENGTH(passes); passnum++)
+	{
+		const layer_pass *pass = &passes[passnum];
+
+		if (pass->rgb_only && dest->format == BITMAP_FORMAT_INDEXED16)
+			continue;
+		(*draw)(pass->to_priority ? NULL : dest, cliprect, tmap, pass->flags, pass->priority, 0xff);
+	}
+}
+
+
+/*-------------------------------------------------
+    create_tilemap - create a tilemap with random
+    contents
+-------------------------------------------------*/
+
+static tilemap_t *create_tilemap(running_machine *machine)
+{
+	tilemap_t *tmap = tilemap_create(machine, get_tile_info, tilemap_scan_rows, TILE_SIZE, TILE_SIZE, TILEMAP_COLS, TILEMAP_ROWS);
+	int index;
+
+	for (index = 0; index < TILEMAP_COLS * TILEMAP_ROWS; index++)
+		videoram[index] = random_tile();
+
+	/* group 0 has a plain transparent pen; group 1 splits its pens over two layers */
+	tilemap_set_transparent_pen(tmap, 0);
+	tilemap_set_transmask(tmap, 1, 0x00000001, 0xffff0001);
+	return tmap;
+}
+
+
+/*-------------------------------------------------
+    check_format - draw random frames both ways
+    and compare the results
+-------------------------------------------------*/
+
+static int check_format(running_machine *machine, const format_test *test, int numchecks)
+{
+	bitmap_t dest1(SCREEN_WIDTH, SCREEN_HEIGHT, test->format);
+	bitmap_t dest2(SCREEN_WIDTH, SCREEN_HEIGHT, test->format);
+	bitmap_t priority1(SCREEN_WIDTH, SCREEN_HEIGHT, BITMAP_FORMAT_INDEXED8);
+	bitmap_t priority2(SCREEN_WIDTH, SCREEN_HEIGHT, BITMAP_FORMAT_INDEXED8);
+	tilemap_t *tmap = create_tilemap(machine);
+	rectangle cliprect;
+	int checknum;
+
+	for (checknum = 0; checknum < numchecks; checknum++)
+	{
+		next_frame(tmap, checknum);
+
+		/* start both from the same state */
+		bitmap_fill(&dest1, NULL, bench_random());
+		bitmap_fill(&priority1, NULL, 0);
+		copy_bitmap(&dest2, &dest1);
+		copy_bitmap(&priority2, &priority1);
+
+		/* mostly full screen, but often just a band to exercise partial rows */
+		cliprect.min_x = 0;
+		cliprect.max_x = SCREEN_WIDTH - 1;
+		cliprect.min_y = 0;
+		cliprect.max_y = SCREEN_HEIGHT - 1;
+		if (bench_random() & 1)
+		{
+			cliprect.min_x = bench_random() % SCREEN_WIDTH;
+			cliprect.max_x = cliprect.min_x + bench_random() % (SCREEN_WIDTH - cliprect.min_x);
+			cliprect.min_y = bench_random() % SCREEN_HEIGHT;
+			cliprect.max_y = cliprect.min_y + bench_random() % (SCREEN_HEIGHT - cliprect.min_y);
+		}
+
+		machine->priority_bitmap = &priority1;
+		draw_frame(tilemap_draw_primask, &dest1, &cliprect, tmap);
+		machine->priority_bitmap = &priority2;
+		draw_frame(reference_draw, &dest2, &cliprect, tmap);
+
+		if (!bitmaps_equal(&dest1, &dest2) || !bitmaps_equal(&priority1, &priority2))
+		{
+			fprintf(stderr, "%s: mismatch in frame %d, clip %d-%d,%d-%d\n", test->name, checknum,
+					cliprect.min_x, cliprect.max_x, cliprect.min_y, cliprect.max_y);
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+
+/*-------------------------------------------------
+    time_run - time a run of full screen frames
+-------------------------------------------------*/
+
+static osd_ticks_t time_run(void *param)
+{
+	const timing_run *run = (const timing_run *)param;
+	running_machine *machine = run->machine;
+	bitmap_t dest(SCREEN_WIDTH, SCREEN_HEIGHT, run->test->format);
+	bitmap_t priority(SCREEN_WIDTH, SCREEN_HEIGHT, BITMAP_FORMAT_INDEXED8);
+	osd_ticks_t start, total = 0;
+	tilemap_t *tmap;
+	int framenum;
+
+	bench_random_seed(0x12345678);
+	tmap = create_tilemap(machine);
+	machine->priority_bitmap = &priority;
+	bitmap_fill(&dest, NULL, 0);
+
+	for (framenum = 0; framenum < run->numframes; framenum++)
+	{
+		next_frame(tmap, framenum);
+		bitmap_fill(&priority, NULL, 0);
+
+		start = osd_ticks();
+		draw_frame(run->draw, &dest, &dest.cliprect, tmap);
+		total += osd_ticks() - start;
+	}
+	return total;
+}
+
+
+/*-------------------------------------------------
+    time_format - return the best time for one
+    way of drawing a format
+-------------------------------------------------*/
+
+static osd_ticks_t time_format(running_machine *machine, const format_test *test, draw_func draw, int numframes)
+{
+	timing_run run;
+
+	run.machine = machine;
+	run.test = test;
+	run.draw = draw;
+	run.numframes = numframes;
+	return bench_best_of(time_run, &run);
+}
+
+
+/*-------------------------------------------------
+    main - main entry point
+-------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+	running_machine *machine = (running_machine *)machine_buffer;
+	int numframes = bench_parse_count(argc, argv, "tilebench [frames per timing run]", 1, DEFAULT_FRAMES);
+	int failures = 0;
+	int pennum, testnum;
+
+	if (numframes == 0)
+		return 1;
+
+	/* the tilemaps are never flipped, so the screen size doesn't matter */
+	machine->primary_screen = (screen_device *)screen_buffer;
+	machine->pens = palette;
+	for (pennum = 0; pennum < NUM_PENS; pennum++)
+		palette[pennum] = bench_random();
+	init_gfx();
+
+	/* first make sure every format matches the per-pixel drawing */
+	for (testnum = 0; testnum < ARRAY_LENGTH(formats); testnum++)
+		if (!check_format(machine, &formats[testnum], DEFAULT_CHECKS))
+			failures++;
+	printf("%d of %d formats match the per-pixel reference\n", (int)ARRAY_LENGTH(formats) - failures, (int)ARRAY_LENGTH(formats));
+
+	/* then time them */
+	printf("\nFormat  Reference(ms)  Tilemap(ms)  Speedup\n");
+	for (testnum = 0; testnum < ARRAY_LENGTH(formats); testnum++)
+	{
+		const format_test *test = &formats[testnum];
+		osd_ticks_t reference = time_format(machine, test, reference_draw, numframes);
+		osd_ticks_t tilemap = time_format(machine, test, tilemap_draw_primask, numframes);
+
+		printf("%-6s  %13.2f  %11.2f  %6.2fx\n", test->name,
+				bench_ms(reference), bench_ms(tilemap), bench_speedup(reference, tilemap));
+	}
+	return (failures == 0) ? 0 : 1;
+}
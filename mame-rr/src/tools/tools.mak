@@ -61,6 +61,11 @@ TOOLS += \
 	srcclean$(EXE) \
 	src2html$(EXE) \
 	split$(EXE) \
+	wqbench$(EXE) \
+	blitbench$(EXE) \
+	tilebench$(EXE) \
+	polybench$(EXE) \
+	exprbench$(EXE) \
 
 
 
@@ -192,3 +197,74 @@ SPLITOBJS = \
 split$(EXE): $(SPLITOBJS) $(LIBUTIL) $(LIBOCORE) $(ZLIB) $(EXPAT)
 	@echo Linking $@...
 	$(LD) $(LDFLAGS) $^ $(LIBS) -o $@
+
+
+
+#-------------------------------------------------
+# wqbench
+#-------------------------------------------------
+
+WQBENCHOBJS = \
+	$(TOOLSOBJ)/wqbench.o \
+
+wqbench$(EXE): $(WQBENCHOBJS) $(LIBUTIL) $(LIBOCORE) $(ZLIB) $(EXPAT)
+	@echo Linking $@...
+	$(LD) $(LDFLAGS) $^ $(LIBS) -o $@
+
+
+
+#-------------------------------------------------
+# blitbench
+#-------------------------------------------------
+
+BLITBENCHOBJS = \
+	$(TOOLSOBJ)/blitbench.o \
+	$(TOOLSOBJ)/benchutil.o \
+
+blitbench$(EXE): $(BLITBENCHOBJS) $(LIBUTIL) $(LIBOCORE) $(ZLIB) $(EXPAT)
+	@echo Linking $@...
+	$(LD) $(LDFLAGS) $^ $(LIBS) -o $@
+
+
+
+#-------------------------------------------------
+# tilebench
+#-------------------------------------------------
+
+TILEBENCHOBJS = \
+	$(TOOLSOBJ)/tilebench.o \
+	$(TOOLSOBJ)/benchcore.o \
+	$(TOOLSOBJ)/benchutil.o \
+
+tilebench$(EXE): $(TILEBENCHOBJS) $(LIBUTIL) $(LIBOCORE) $(ZLIB) $(EXPAT)
+	@echo Linking $@...
+	$(LD) $(LDFLAGS) $^ $(LIBS) -o $@
+
+
+
+#-------------------------------------------------
+# polybench
+#-------------------------------------------------
+
+POLYBENCHOBJS = \
+	$(TOOLSOBJ)/polybench.o \
+	$(TOOLSOBJ)/benchcore.o \
+	$(TOOLSOBJ)/benchutil.o \
+
+polybench$(EXE): $(POLYBENCHOBJS) $(LIBUTIL) $(LIBOCORE) $(ZLIB) $(EXPAT)
+	@echo Linking $@...
+	$(LD) $(LDFLAGS) $^ $(LIBS) -o $@
+
+
+
+#-------------------------------------------------
+# exprbench
+#-------------------------------------------------
+
+EXPRBENCHOBJS = \
+	$(TOOLSOBJ)/exprbench.o \
+	$(TOOLSOBJ)/benchutil.o \
+
+exprbench$(EXE): $(EXPRBENCHOBJS) $(LIBEMU) $(LIBUTIL) $(LIBOCORE) $(ZLIB) $(EXPAT)
+	@echo Linking $@...
+	$(LD) $(LDFLAGS) $^ $(LIBS) -o $@
@@ -0,0 +1,222 @@
+/***************************************************************************
+
+    OSD work queue benchmark
+
+    Copyright Nicola Salmoria and the MAME Team.
+    Visit http://mamedev.org for licensing and usage restrictions.
+
+    Queues the same amount of work through osd_work_item_queue_multiple
+    at a range of item sizes and batch sizes, the way the poly renderer,
+    Voodoo and discrete sound use it, and compares each against calling
+    the work directly. Build the OSD with KEEP_STATISTICS set to get the
+    per-thread run/spin/wait breakdown as each queue is freed.
+
+***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "osdcore.h"
+
+
+/***************************************************************************
+    CONSTANTS & DEFINES
+***************************************************************************/
+
+#define DEFAULT_TOTAL_WORK		(1 << 26)		/* work units per test */
+#define MAX_ITEMS				(1 << 16)		/* most items in one test */
+
+
+
+/***************************************************************************
+    TYPE DEFINITIONS
+***************************************************************************/
+
+typedef struct _bench_item bench_item;
+struct _bench_item
+{
+	UINT32			units;					/* how much work to do */
+	UINT32			result;					/* result, to keep the work honest */
+	UINT32			runs;					/* how many times we were called */
+};
+
+
+
+/***************************************************************************
+    GLOBAL VARIABLES
+***************************************************************************/
+
+static const UINT32 item_units[] = { 16, 256, 4096, 65536 };
+static const INT32 batch_sizes[] = { 1, 16, 256, 4096 };
+
+static bench_item items[MAX_ITEMS];
+
+
+
+/***************************************************************************
+    IMPLEMENTATION
+***************************************************************************/
+
+/*-------------------------------------------------
+    bench_callback - do some busy work
+-------------------------------------------------*/
+
+static void *bench_callback(void *param, int threadid)
+{
+	bench_item *item = (bench_item *)param;
+	UINT32 value = item->units;
+	UINT32 unit;
+
+	for (unit = 0; unit < item->units; unit++)
+		value = value * 1103515245 + 12345;
+	item->result = value;
+	item->runs++;
+	return NULL;
+}
+
+
+/*-------------------------------------------------
+    reset_items - prepare the item array
+-------------------------------------------------*/
+
+static void reset_items(int numitems, UINT32 units)
+{
+	int itemnum;
+
+	for (itemnum = 0; itemnum < numitems; itemnum++)
+	{
+		items[itemnum].units = units;
+		items[itemnum].result = 0;
+		items[itemnum].runs = 0;
+	}
+}
+
+
+/*-------------------------------------------------
+    check_items - make sure every item ran
+    exactly once
+-------------------------------------------------*/
+
+static int check_items(int numitems)
+{
+	int itemnum;
+
+	for (itemnum = 0; itemnum < numitems; itemnum++)
+		if (items[itemnum].runs != 1)
+		{
+			fprintf(stderr, "Item %d ran %d times\n", itemnum, items[itemnum].runs);
+			return FALSE;
+		}
+	return TRUE;
+}
+
+
+/*-------------------------------------------------
+    run_serial - time calling the work directly
+-------------------------------------------------*/
+
+static osd_ticks_t run_serial(int numitems, UINT32 units)
+{
+	osd_ticks_t start;
+	int itemnum;
+
+	reset_items(numitems, units);
+	start = osd_ticks();
+	for (itemnum = 0; itemnum < numitems; itemnum++)
+		bench_callback(&items[itemnum], 0);
+	return osd_ticks() - start;
+}
+
+
+/*-------------------------------------------------
+    run_queued - time queueing the work in
+    batches and waiting for it all
+-------------------------------------------------*/
+
+static osd_ticks_t run_queued(osd_work_queue *queue, int numitems, UINT32 units, INT32 batch)
+{
+	osd_ticks_t start, elapsed;
+	int itemnum;
+
+	reset_items(numitems, units);
+	start = osd_ticks();
+	for (itemnum = 0; itemnum < numitems; itemnum += batch)
+		osd_work_item_queue_multiple(queue, bench_callback, MIN(batch, numitems - itemnum), &items[itemnum], sizeof(items[0]), WORK_ITEM_FLAG_AUTO_RELEASE);
+	if (!osd_work_queue_wait(queue, 100 * osd_ticks_per_second()))
+		fprintf(stderr, "Timed out waiting for the queue\n");
+	elapsed = osd_ticks() - start;
+
+	if (!check_items(numitems))
+		exit(1);
+	return elapsed;
+}
+
+
+/*-------------------------------------------------
+    run_tests - run every size against one
+    kind of queue
+-------------------------------------------------*/
+
+static void run_tests(const char *name, int flags, UINT64 totalwork)
+{
+	double tps = (double)osd_ticks_per_second();
+	osd_work_queue *queue;
+	int unitnum, batchnum;
+
+	queue = osd_work_queue_alloc(flags);
+	if (queue == NULL)
+	{
+		fprintf(stderr, "Unable to allocate work queue\n");
+		exit(1);
+	}
+
+	printf("\n%s queue:\n", name);
+	printf("Units/item  Batch   Items   Direct(ms)  Queued(ms)  Speedup  Items/sec\n");
+	for (unitnum = 0; unitnum < ARRAY_LENGTH(item_units); unitnum++)
+	{
+		UINT32 units = item_units[unitnum];
+		int numitems = (int)MIN(totalwork / units, MAX_ITEMS);
+		osd_ticks_t serial = run_serial(numitems, units);
+
+		for (batchnum = 0; batchnum < ARRAY_LENGTH(batch_sizes); batchnum++)
+		{
+			INT32 batch = batch_sizes[batchnum];
+			osd_ticks_t queued;
+
+			if (batch > numitems)
+				continue;
+			queued = run_queued(queue, numitems, units, batch);
+			printf("%10d  %5d  %6d  %10.2f  %10.2f  %6.2fx  %9.0f\n", units, batch, numitems,
+					(double)serial * 1000.0 / tps, (double)queued * 1000.0 / tps,
+					(queued == 0) ? 0.0 : (double)serial / (double)queued,
+					(queued == 0) ? 0.0 : (double)numitems * tps / (double)queued);
+		}
+	}
+
+	osd_work_queue_free(queue);
+}
+
+
+/*-------------------------------------------------
+    main - main entry point
+-------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+	UINT64 totalwork = DEFAULT_TOTAL_WORK;
+
+	/* an optional argument scales the amount of work */
+	if (argc > 2)
+	{
+		fprintf(stderr, "Usage:\n  wqbench [millions of work units per test]\n");
+		return 1;
+	}
+	if (argc == 2)
+		totalwork = (UINT64)atoi(argv[1]) * 1000000;
+	if (totalwork == 0)
+		totalwork = DEFAULT_TOTAL_WORK;
+
+	run_tests("Multi", WORK_QUEUE_FLAG_MULTI, totalwork);
+	run_tests("Multi high frequency", WORK_QUEUE_FLAG_MULTI | WORK_QUEUE_FLAG_HIGH_FREQ, totalwork);
+	return 0;
+}